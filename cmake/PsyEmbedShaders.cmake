@@ -0,0 +1,185 @@
+#
+# This file is part of psylib library
+#
+# psylib library is free software: you can redistribute it and/or modify
+# it under the terms of the Lesser General Public License as published by
+# the Free Software Foundation, either version 2.1 of the License, or
+# (at your option) any later version.
+#
+# The psylib library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the Lesser General Public License
+# along with psylib. If not, see <http://www.gnu.org/licenses/>
+#
+
+# Turns .vert and .frag files into a C source file with a sorted table of
+# PsyBuiltinShader entries (see src/BuiltinShaders.h). The name of a shader
+# is its file name without extension, so only [A-Za-z0-9_] may be used in
+# the file names. Shaders for OpenGL ES use the same name with an "_es"
+# suffix, just like the shaders in test/gl_shaders.
+#
+# Usage:
+#   psy_embed_shaders(<output.c> <table_name> shader1.vert shader1.frag ...)
+#
+# This file is included by the build and also run as a script via
+# cmake -P in order to generate the output at build time.
+
+if (NOT CMAKE_SCRIPT_MODE_FILE)
+
+    set(PSY_EMBED_SHADERS_SCRIPT "${CMAKE_CURRENT_LIST_FILE}")
+    get_filename_component(
+        PSY_EMBED_SHADERS_HEADER
+        "${CMAKE_CURRENT_LIST_DIR}/../src/BuiltinShaders.h"
+        ABSOLUTE
+        )
+
+    function(psy_embed_shaders output table)
+        set(shaders "")
+        foreach(shader ${ARGN})
+            get_filename_component(shader_path "${shader}" ABSOLUTE)
+            list(APPEND shaders "${shader_path}")
+        endforeach()
+        # a ';' doesn't survive the command line, use '|' as separator.
+        string(REPLACE ";" "|" shader_arg "${shaders}")
+
+        add_custom_command(
+            OUTPUT "${output}"
+            COMMAND "${CMAKE_COMMAND}"
+                "-DPSY_EMBED_OUTPUT=${output}"
+                "-DPSY_EMBED_TABLE=${table}"
+                "-DPSY_EMBED_HEADER=${PSY_EMBED_SHADERS_HEADER}"
+                "-DPSY_EMBED_MINIFY=${PSY_MINIFY_SHADERS}"
+                "-DPSY_EMBED_SHADERS=${shader_arg}"
+                -P "${PSY_EMBED_SHADERS_SCRIPT}"
+            DEPENDS ${shaders} "${PSY_EMBED_SHADERS_SCRIPT}"
+            COMMENT "Embedding shaders in ${table}"
+            VERBATIM
+            )
+    endfunction()
+
+    return()
+endif()
+
+# **** script mode: generate the table **** #
+
+string(REPLACE "|" ";" shaders "${PSY_EMBED_SHADERS}")
+
+# Strips the // and /* */ comments from the variable named var. Like the
+# GLSL preprocessor does, a block comment is replaced by a space, a line
+# comment keeps its newline.
+function(psy_strip_comments var)
+    set(src "${${var}}")
+    set(out "")
+    string(FIND "${src}" "//" line)
+    string(FIND "${src}" "/*" block)
+    while (NOT line EQUAL -1 OR NOT block EQUAL -1)
+        if (block EQUAL -1 OR (NOT line EQUAL -1 AND line LESS block))
+            string(SUBSTRING "${src}" 0 ${line} head)
+            string(APPEND out "${head}")
+            string(SUBSTRING "${src}" ${line} -1 src)
+            string(FIND "${src}" "\n" end)
+            if (end EQUAL -1)
+                set(src "")
+            else()
+                string(SUBSTRING "${src}" ${end} -1 src)
+            endif()
+        else()
+            string(SUBSTRING "${src}" 0 ${block} head)
+            string(APPEND out "${head} ")
+            math(EXPR start "${block} + 2")
+            string(SUBSTRING "${src}" ${start} -1 src)
+            string(FIND "${src}" "*/" end)
+            if (end EQUAL -1)
+                set(src "")
+            else()
+                math(EXPR end "${end} + 2")
+                string(SUBSTRING "${src}" ${end} -1 src)
+            endif()
+        endif()
+        string(FIND "${src}" "//" line)
+        string(FIND "${src}" "/*" block)
+    endwhile()
+    set(${var} "${out}${src}" PARENT_SCOPE)
+endfunction()
+
+# Sort on the file name, this yields the order the lookup in
+# BuiltinShaders.c expects.
+set(entries "")
+foreach(shader ${shaders})
+    get_filename_component(file_name "${shader}" NAME)
+    list(APPEND entries "${file_name}|${shader}")
+endforeach()
+list(SORT entries)
+
+set(sources "")
+set(rows "")
+set(index 0)
+
+foreach(entry ${entries})
+    string(REPLACE "|" ";" entry "${entry}")
+    list(GET entry 1 shader)
+    get_filename_component(name "${shader}" NAME_WE)
+    get_filename_component(ext "${shader}" EXT)
+
+    if (NOT name MATCHES "^[A-Za-z0-9_]+$")
+        message(FATAL_ERROR "${shader}: use only [A-Za-z0-9_] in shader names")
+    endif()
+
+    if (ext STREQUAL ".vert")
+        set(type PSY_SHADER_VERTEX)
+    elseif (ext STREQUAL ".frag")
+        set(type PSY_SHADER_FRAGMENT)
+    else()
+        message(FATAL_ERROR "${shader}: unknown shader extension \"${ext}\"")
+    endif()
+
+    file(READ "${shader}" src)
+
+    if (PSY_EMBED_MINIFY)
+        # Strip comments, indentation, trailing and empty lines. The
+        # newlines must stay, since the preprocessor works line based.
+        psy_strip_comments(src)
+        string(REGEX REPLACE "[ \t]+\n" "\n" src "${src}")
+        string(REGEX REPLACE "\n[ \t]+" "\n" src "${src}")
+        string(REGEX REPLACE "^[ \t\n]+" "" src "${src}")
+        string(REGEX REPLACE "\n\n+" "\n" src "${src}")
+    endif()
+
+    string(REPLACE "\\" "\\\\" src "${src}")
+    string(REPLACE "\"" "\\\"" src "${src}")
+    string(REPLACE "\n" "\\n\"\n    \"" src "${src}")
+
+    set(var "${PSY_EMBED_TABLE}_src_${index}")
+    string(APPEND sources
+        "static const char ${var}[] =\n    \"${src}\";\n\n"
+        )
+    string(APPEND rows
+        "    {\"${name}\", ${type}, ${var}, sizeof(${var}) - 1},\n"
+        )
+    math(EXPR index "${index} + 1")
+endforeach()
+
+set(content
+"/* Generated by PsyEmbedShaders.cmake, do not edit. */
+
+#include \"${PSY_EMBED_HEADER}\"
+
+${sources}const PsyBuiltinShader ${PSY_EMBED_TABLE}[] = {
+${rows}};
+
+const size_t ${PSY_EMBED_TABLE}_size =
+    sizeof(${PSY_EMBED_TABLE}) / sizeof(${PSY_EMBED_TABLE}[0]);
+"
+)
+
+# Only touch the output when it changes, to prevent needless rebuilds.
+if (EXISTS "${PSY_EMBED_OUTPUT}")
+    file(READ "${PSY_EMBED_OUTPUT}" old_content)
+    if (old_content STREQUAL content)
+        return()
+    endif()
+endif()
+file(WRITE "${PSY_EMBED_OUTPUT}" "${content}")
@@ -0,0 +1,90 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file BuiltinShaders.c
+ * \brief Lookup in tables of embedded shaders.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "BuiltinShaders.h"
+#include "gl/gl_util.h"
+
+typedef struct _ShaderKey {
+    const char*     name;
+    psy_shader_t    type;
+} ShaderKey;
+
+/*
+ * The tables are sorted on file name, so within one name the .frag shader
+ * precedes the .vert shader.
+ */
+static int
+type_rank(psy_shader_t type)
+{
+    return type == PSY_SHADER_FRAGMENT ? 0 : 1;
+}
+
+static int
+compare_shader(const void* key, const void* element)
+{
+    const ShaderKey* k = key;
+    const PsyBuiltinShader* shader = element;
+    int cmp = strcmp(k->name, shader->name);
+    if (cmp)
+        return cmp;
+    return type_rank(k->type) - type_rank(shader->type);
+}
+
+static const PsyBuiltinShader*
+find(
+    const PsyBuiltinShader* table,
+    size_t                  size,
+    const char*             name,
+    psy_shader_t            type
+    )
+{
+    ShaderKey key = {name, type};
+    return bsearch(&key, table, size, sizeof(PsyBuiltinShader), compare_shader);
+}
+
+const PsyBuiltinShader*
+psy_builtin_shader_find(
+    const PsyBuiltinShader* table,
+    size_t                  size,
+    const char*             name,
+    psy_shader_t            type
+    )
+{
+    const PsyBuiltinShader* shader = NULL;
+    char es_name[BUFSIZ];
+
+    if (!table || !name)
+        return NULL;
+
+    if (psy_gl_context_is_es()) {
+        int n = snprintf(es_name, sizeof(es_name), "%s_es", name);
+        if (n > 0 && (size_t) n < sizeof(es_name))
+            shader = find(table, size, es_name, type);
+    }
+    if (!shader)
+        shader = find(table, size, name, type);
+
+    return shader;
+}
@@ -0,0 +1,96 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file BuiltinShaders.h
+ * \brief Tables of shaders that are compiled into a binary.
+ *
+ * The build turns .vert and .frag files into a sorted table of
+ * PsyBuiltinShader with psy_embed_shaders() from cmake/PsyEmbedShaders.cmake.
+ * Shaders from such a table can be compiled without any file I/O. PsyLib
+ * embeds the shaders in src/shaders, see psy_shader_compile_builtin().
+ */
+
+#ifndef PSY_BUILTIN_SHADERS_H
+#define PSY_BUILTIN_SHADERS_H
+
+#include <stddef.h>
+#include "Shader.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief An entry in a table of embedded shaders.
+ */
+typedef struct _PsyBuiltinShader {
+    /**
+     * \brief The file name of the shader without extension.
+     */
+    const char*     name;
+    /**
+     * \brief PSY_SHADER_VERTEX for .vert and PSY_SHADER_FRAGMENT for .frag.
+     */
+    psy_shader_t    type;
+    /**
+     * \brief The null terminated source of the shader.
+     */
+    const char*     source;
+    /**
+     * \brief strlen(source).
+     */
+    size_t          length;
+} PsyBuiltinShader;
+
+/**
+ * \brief The shaders that are embedded in psylib itself.
+ */
+PSY_EXPORT extern const PsyBuiltinShader psy_builtin_shaders[];
+
+/**
+ * \brief The number of entries in psy_builtin_shaders.
+ */
+PSY_EXPORT extern const size_t psy_builtin_shaders_size;
+
+/**
+ * \brief Find a shader in a table of embedded shaders.
+ *
+ * When the current OpenGL context is an OpenGL ES context, the shader named
+ * name + "_es" is preferred and name is used when it isn't present.
+ * Hence, call this function with a valid OpenGL context.
+ *
+ * @param [in] table A table generated by psy_embed_shaders().
+ * @param [in] size  The number of entries in table.
+ * @param [in] name  The name of the shader without extension.
+ * @param [in] type  The type of the shader.
+ *
+ * @return The entry in the table or NULL when it isn't found.
+ */
+PSY_EXPORT const PsyBuiltinShader*
+psy_builtin_shader_find(
+    const PsyBuiltinShader* table,
+    size_t                  size,
+    const char*             name,
+    psy_shader_t            type
+    );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_BUILTIN_SHADERS_H
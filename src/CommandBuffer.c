@@ -0,0 +1,745 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "MetaClass.h"
+#include "Error.h"
+#include "CommandBuffer.h"
+#include "gl/gl_util.h"
+
+/* The most arrays a replay disables afterwards, 16 is what GL 3.3 offers. */
+#define MAX_ENABLED_ATTRIBUTES 16
+
+typedef enum {
+    OP_USE_PROGRAM,
+    OP_BIND_TEXTURE,
+    OP_BIND_VERTEX_ARRAY,
+    OP_VERTEX_ATTRIBUTE,
+    OP_BLEND,
+    OP_UNIFORM,
+    OP_DRAW_ARRAYS,
+    OP_DRAW_ARRAYS_INSTANCED,
+    OP_CALL
+} Op;
+
+/*
+ * The meaning of the fields depends on op, see the record functions below.
+ * All commands have the same size, so replay walks a plain array.
+ * OP_USE_PROGRAM keeps the generation of the program in value, OP_UNIFORM
+ * the offset of the name of the uniform in names in c, or -1.
+ */
+struct Command {
+    Op              op;
+    GLenum          e;
+    GLint           a;
+    GLint           b;
+    GLint           c;
+    GLint           d;
+    size_t          value;
+    void*           ptr;
+    PsyDrawFunc     draw;
+};
+
+static void
+set_error(SeeError** error, const char* func, const char* msg)
+{
+    PsyError* err = NULL;
+    psy_error_create(&err);
+    psy_error_printf(err, "%s: %s", func, msg);
+    *error = SEE_ERROR(err);
+}
+
+static int
+grow(void** array, size_t* capacity, size_t needed, size_t elem_size)
+{
+    size_t new_capacity = *capacity ? *capacity : 16;
+    void* new_array;
+
+    if (needed <= *capacity)
+        return 1;
+    while (new_capacity < needed)
+        new_capacity *= 2;
+
+    new_array = realloc(*array, new_capacity * elem_size);
+    if (!new_array)
+        return 0;
+
+    *array = new_array;
+    *capacity = new_capacity;
+    return 1;
+}
+
+static Command*
+push_command(PsyCommandBuffer* buffer, Op op, SeeError** error)
+{
+    Command* cmd;
+
+    if (!grow((void**) &buffer->commands, &buffer->capacity,
+              buffer->num_commands + 1, sizeof(Command))) {
+        set_error(error, __func__, "out of memory");
+        return NULL;
+    }
+
+    cmd = &buffer->commands[buffer->num_commands++];
+    memset(cmd, 0, sizeof(Command));
+    cmd->op = op;
+    return cmd;
+}
+
+/*
+ * Stores the name of the uniform at location of the program in use, so its
+ * location can be looked up again once the program is reloaded.
+ */
+static GLint
+record_uniform_name(PsyCommandBuffer* buffer, GLint location)
+{
+    const PsyProgramResource* resources;
+    size_t num_resources, length, i;
+    GLint offset;
+
+    if (!buffer->program || location < 0)
+        return -1;
+
+    resources = psy_shader_program_resources(buffer->program, &num_resources);
+    for (i = 0; i < num_resources; i++)
+        if (resources[i].kind == PSY_PROGRAM_UNIFORM &&
+            resources[i].location == location)
+            break;
+    if (i == num_resources)
+        return -1;
+
+    length = strlen(resources[i].name) + 1;
+    if (!grow((void**) &buffer->names, &buffer->names_capacity,
+              buffer->names_size + length, 1))
+        return -1;
+
+    offset = (GLint) buffer->names_size;
+    memcpy(buffer->names + offset, resources[i].name, length);
+    buffer->names_size += length;
+    return offset;
+}
+
+/*
+ * Remembers that replay enabled the array at location while no vertex
+ * array object was bound, those arrays are global state.
+ */
+static void
+add_enabled(GLint* enabled, size_t* num_enabled, GLint location)
+{
+    for (size_t i = 0; i < *num_enabled; i++)
+        if (enabled[i] == location)
+            return;
+    if (*num_enabled < MAX_ENABLED_ATTRIBUTES)
+        enabled[(*num_enabled)++] = location;
+}
+
+/*
+ * Looks up the uniforms that are set after cmd, which uses a program that
+ * has been reloaded since it was recorded.
+ */
+static void
+find_uniforms(const PsyCommandBuffer* buffer, Command* cmd)
+{
+    const PsyShaderProgram* program = cmd->ptr;
+    const Command* end = buffer->commands + buffer->num_commands;
+    Command* next;
+
+    for (next = cmd + 1; next < end && next->op != OP_USE_PROGRAM; next++)
+        if (next->op == OP_UNIFORM && next->c >= 0)
+            next->a = psy_shader_program_uniform_location(
+                program, buffer->names + next->c
+                );
+    cmd->value = psy_shader_program_generation(program);
+}
+
+static size_t
+uniform_components(PsyUniformType type)
+{
+    switch (type) {
+        case PSY_UNIFORM_FLOAT: return 1;
+        case PSY_UNIFORM_VEC2:  return 2;
+        case PSY_UNIFORM_VEC3:  return 3;
+        case PSY_UNIFORM_VEC4:  return 4;
+        case PSY_UNIFORM_INT:   return 1;
+        case PSY_UNIFORM_MAT4:  return 16;
+    }
+    return 0;
+}
+
+static void
+set_uniform(const PsyCommandBuffer* buffer, const Command* cmd)
+{
+    const GLfloat* f = buffer->floats + cmd->value;
+    GLsizei count = cmd->b;
+
+    switch ((PsyUniformType) cmd->e) {
+        case PSY_UNIFORM_FLOAT:
+            glUniform1fv(cmd->a, count, f);
+            break;
+        case PSY_UNIFORM_VEC2:
+            glUniform2fv(cmd->a, count, f);
+            break;
+        case PSY_UNIFORM_VEC3:
+            glUniform3fv(cmd->a, count, f);
+            break;
+        case PSY_UNIFORM_VEC4:
+            glUniform4fv(cmd->a, count, f);
+            break;
+        case PSY_UNIFORM_INT:
+            glUniform1iv(cmd->a, count, buffer->ints + cmd->value);
+            break;
+        case PSY_UNIFORM_MAT4:
+            glUniformMatrix4fv(cmd->a, count, GL_FALSE, f);
+            break;
+    }
+}
+
+/* **** functions that implement PsyCommandBuffer or override SeeObject **** */
+
+static int
+command_buffer_init(
+    PsyCommandBuffer*               buffer,
+    const PsyCommandBufferClass*    buffer_cls,
+    SeeError**                      error
+    )
+{
+    const SeeObjectClass* parent_cls = SEE_OBJECT_CLASS(buffer_cls);
+    (void) error;
+
+    parent_cls->object_init(
+        SEE_OBJECT(buffer),
+        SEE_OBJECT_CLASS(buffer_cls)
+        );
+
+    return SEE_SUCCESS;
+}
+
+static int
+init(const SeeObjectClass* cls, SeeObject* obj, va_list args)
+{
+    const PsyCommandBufferClass* buffer_cls = PSY_COMMAND_BUFFER_CLASS(cls);
+    PsyCommandBuffer* buffer = PSY_COMMAND_BUFFER(obj);
+
+    SeeError** error = va_arg(args, SeeError**);
+
+    return buffer_cls->command_buffer_init(buffer, buffer_cls, error);
+}
+
+static void
+command_buffer_clear(PsyCommandBuffer* buffer)
+{
+    size_t i;
+
+    for (i = 0; i < buffer->num_commands; i++)
+        if (buffer->commands[i].op == OP_USE_PROGRAM)
+            see_object_decref(SEE_OBJECT(buffer->commands[i].ptr));
+
+    buffer->num_commands = 0;
+    buffer->num_floats = 0;
+    buffer->num_ints = 0;
+    buffer->names_size = 0;
+    buffer->program = NULL;
+}
+
+static void
+destroy(SeeObject* obj)
+{
+    PsyCommandBuffer* buffer = PSY_COMMAND_BUFFER(obj);
+
+    command_buffer_clear(buffer);
+    free(buffer->commands);
+    free(buffer->floats);
+    free(buffer->ints);
+    free(buffer->names);
+
+    see_object_class()->destroy(obj);
+}
+
+static int
+command_buffer_replay(
+    PsyCommandBuffer*   buffer,
+    const GLfloat*      transform,
+    SeeError**          error
+    )
+{
+    Command* cmd = buffer->commands;
+    const Command* end = cmd + buffer->num_commands;
+    GLint enabled[MAX_ENABLED_ATTRIBUTES];
+    size_t num_enabled = 0;
+    GLuint vao = 0;
+    int ret = SEE_SUCCESS;
+
+    for (; cmd < end; cmd++) {
+        switch (cmd->op) {
+            case OP_USE_PROGRAM:
+                psy_gl_use_program(((PsyShaderProgram*) cmd->ptr)->program_id);
+                if (psy_shader_program_generation(cmd->ptr) != cmd->value)
+                    find_uniforms(buffer, cmd);
+                break;
+            case OP_BIND_TEXTURE:
+                psy_gl_bind_texture((GLuint) cmd->a, cmd->e, (GLuint) cmd->b);
+                break;
+            case OP_BIND_VERTEX_ARRAY:
+                vao = (GLuint) cmd->a;
+                glBindVertexArray(vao);
+                break;
+            case OP_VERTEX_ATTRIBUTE:
+                if (!vao)
+                    add_enabled(enabled, &num_enabled, cmd->a);
+                glBindBuffer(GL_ARRAY_BUFFER, (GLuint) cmd->b);
+                glEnableVertexAttribArray((GLuint) cmd->a);
+                glVertexAttribPointer(
+                    (GLuint) cmd->a, cmd->c, cmd->e, GL_FALSE, cmd->d,
+                    (const void*) cmd->value
+                    );
+                break;
+            case OP_BLEND:
+                if (cmd->a) {
+                    glEnable(GL_BLEND);
+                    glBlendFunc((GLenum) cmd->b, (GLenum) cmd->c);
+                }
+                else {
+                    glDisable(GL_BLEND);
+                }
+                break;
+            case OP_UNIFORM:
+                set_uniform(buffer, cmd);
+                break;
+            case OP_DRAW_ARRAYS:
+                glDrawArrays(cmd->e, cmd->a, cmd->b);
+                break;
+            case OP_DRAW_ARRAYS_INSTANCED:
+                glDrawArraysInstanced(cmd->e, cmd->a, cmd->b, cmd->c);
+                break;
+            case OP_CALL:
+                ret = cmd->draw(cmd->ptr, transform, error);
+                break;
+        }
+        if (ret)
+            break;
+    }
+
+    // Without a vertex array object the next draw would read them too.
+    if (num_enabled) {
+        if (vao)
+            glBindVertexArray(0);
+        psy_gl_disable_attributes(enabled, num_enabled);
+        if (vao)
+            glBindVertexArray(vao);
+    }
+
+    return ret;
+}
+
+/* **** implementation of the public API **** */
+
+int
+psy_command_buffer_create(PsyCommandBuffer** buffer, SeeError** error)
+{
+    const PsyCommandBufferClass* cls = psy_command_buffer_class();
+    const SeeObjectClass* see_cls = SEE_OBJECT_CLASS(cls);
+
+    if (!cls)
+        return SEE_NOT_INITIALIZED;
+
+    if (!buffer || *buffer)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return see_cls->new_obj(see_cls, 0, (SeeObject**) buffer, error);
+}
+
+void
+psy_command_buffer_clear(PsyCommandBuffer* buffer)
+{
+    if (buffer)
+        PSY_COMMAND_BUFFER_GET_CLASS(buffer)->clear(buffer);
+}
+
+int
+psy_command_buffer_use_program(
+    PsyCommandBuffer*   buffer,
+    PsyShaderProgram*   program,
+    SeeError**          error
+    )
+{
+    Command* cmd;
+
+    if (!buffer || !program || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!psy_shader_program_linked(program)) {
+        set_error(error, __func__, "the program isn't linked");
+        return SEE_INVALID_ARGUMENT;
+    }
+
+    cmd = push_command(buffer, OP_USE_PROGRAM, error);
+    if (!cmd)
+        return SEE_ERROR_RUNTIME;
+
+    cmd->ptr = see_object_ref(SEE_OBJECT(program));
+    cmd->value = psy_shader_program_generation(program);
+    buffer->program = program;
+    return SEE_SUCCESS;
+}
+
+int
+psy_command_buffer_bind_texture(
+    PsyCommandBuffer*   buffer,
+    GLuint              unit,
+    GLenum              target,
+    GLuint              texture,
+    SeeError**          error
+    )
+{
+    Command* cmd;
+
+    if (!buffer || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    cmd = push_command(buffer, OP_BIND_TEXTURE, error);
+    if (!cmd)
+        return SEE_ERROR_RUNTIME;
+
+    cmd->a = (GLint) unit;
+    cmd->e = target;
+    cmd->b = (GLint) texture;
+    return SEE_SUCCESS;
+}
+
+int
+psy_command_buffer_bind_vertex_array(
+    PsyCommandBuffer*   buffer,
+    GLuint              vao,
+    SeeError**          error
+    )
+{
+    Command* cmd;
+
+    if (!buffer || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    cmd = push_command(buffer, OP_BIND_VERTEX_ARRAY, error);
+    if (!cmd)
+        return SEE_ERROR_RUNTIME;
+
+    cmd->a = (GLint) vao;
+    return SEE_SUCCESS;
+}
+
+int
+psy_command_buffer_vertex_attribute(
+    PsyCommandBuffer*   buffer,
+    GLuint              location,
+    GLuint              vbo,
+    GLint               size,
+    GLenum              type,
+    GLsizei             stride,
+    size_t              offset,
+    SeeError**          error
+    )
+{
+    Command* cmd;
+
+    if (!buffer || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    cmd = push_command(buffer, OP_VERTEX_ATTRIBUTE, error);
+    if (!cmd)
+        return SEE_ERROR_RUNTIME;
+
+    cmd->a = (GLint) location;
+    cmd->b = (GLint) vbo;
+    cmd->c = size;
+    cmd->d = stride;
+    cmd->e = type;
+    cmd->value = offset;
+    return SEE_SUCCESS;
+}
+
+int
+psy_command_buffer_blend(
+    PsyCommandBuffer*   buffer,
+    int                 enabled,
+    GLenum              src,
+    GLenum              dst,
+    SeeError**          error
+    )
+{
+    Command* cmd;
+
+    if (!buffer || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    cmd = push_command(buffer, OP_BLEND, error);
+    if (!cmd)
+        return SEE_ERROR_RUNTIME;
+
+    cmd->a = enabled != 0;
+    cmd->b = (GLint) src;
+    cmd->c = (GLint) dst;
+    return SEE_SUCCESS;
+}
+
+int
+psy_command_buffer_uniform(
+    PsyCommandBuffer*   buffer,
+    GLint               location,
+    PsyUniformType      type,
+    GLsizei             count,
+    const void*         values,
+    size_t*             patch,
+    SeeError**          error
+    )
+{
+    size_t n = uniform_components(type) * (size_t) count;
+    Command* cmd;
+    size_t index;
+
+    if (!buffer || !values || n == 0 || count < 0 || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    // Reserve the values first, so a failure doesn't leave a command.
+    if (type == PSY_UNIFORM_INT) {
+        if (!grow((void**) &buffer->ints, &buffer->ints_capacity,
+                  buffer->num_ints + n, sizeof(GLint))) {
+            set_error(error, __func__, "out of memory");
+            return SEE_ERROR_RUNTIME;
+        }
+        index = buffer->num_ints;
+    }
+    else {
+        if (!grow((void**) &buffer->floats, &buffer->floats_capacity,
+                  buffer->num_floats + n, sizeof(GLfloat))) {
+            set_error(error, __func__, "out of memory");
+            return SEE_ERROR_RUNTIME;
+        }
+        index = buffer->num_floats;
+    }
+
+    cmd = push_command(buffer, OP_UNIFORM, error);
+    if (!cmd)
+        return SEE_ERROR_RUNTIME;
+
+    if (type == PSY_UNIFORM_INT) {
+        memcpy(buffer->ints + index, values, n * sizeof(GLint));
+        buffer->num_ints += n;
+    }
+    else {
+        memcpy(buffer->floats + index, values, n * sizeof(GLfloat));
+        buffer->num_floats += n;
+    }
+
+    cmd->a = location;
+    cmd->b = count;
+    cmd->c = record_uniform_name(buffer, location);
+    cmd->e = (GLenum) type;
+    cmd->value = index;
+
+    if (patch)
+        *patch = buffer->num_commands - 1;
+    return SEE_SUCCESS;
+}
+
+int
+psy_command_buffer_draw_arrays(
+    PsyCommandBuffer*   buffer,
+    GLenum              mode,
+    GLint               first,
+    GLsizei             count,
+    SeeError**          error
+    )
+{
+    Command* cmd;
+
+    if (!buffer || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    cmd = push_command(buffer, OP_DRAW_ARRAYS, error);
+    if (!cmd)
+        return SEE_ERROR_RUNTIME;
+
+    cmd->e = mode;
+    cmd->a = first;
+    cmd->b = count;
+    return SEE_SUCCESS;
+}
+
+int
+psy_command_buffer_draw_arrays_instanced(
+    PsyCommandBuffer*   buffer,
+    GLenum              mode,
+    GLint               first,
+    GLsizei             count,
+    GLsizei             instances,
+    SeeError**          error
+    )
+{
+    Command* cmd;
+
+    if (!buffer || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!psy_gl_has_instancing()) {
+        set_error(error, __func__, "instancing isn't available");
+        return SEE_ERROR_RUNTIME;
+    }
+
+    cmd = push_command(buffer, OP_DRAW_ARRAYS_INSTANCED, error);
+    if (!cmd)
+        return SEE_ERROR_RUNTIME;
+
+    cmd->e = mode;
+    cmd->a = first;
+    cmd->b = count;
+    cmd->c = instances;
+    return SEE_SUCCESS;
+}
+
+int
+psy_command_buffer_call(
+    PsyCommandBuffer*   buffer,
+    PsyDrawFunc         draw,
+    void*               stimulus,
+    SeeError**          error
+    )
+{
+    Command* cmd;
+
+    if (!buffer || !draw || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    cmd = push_command(buffer, OP_CALL, error);
+    if (!cmd)
+        return SEE_ERROR_RUNTIME;
+
+    cmd->draw = draw;
+    cmd->ptr = stimulus;
+    return SEE_SUCCESS;
+}
+
+int
+psy_command_buffer_set_uniform(
+    PsyCommandBuffer*   buffer,
+    size_t              patch,
+    const void*         values
+    )
+{
+    const Command* cmd;
+    size_t n;
+
+    if (!buffer || !values || patch >= buffer->num_commands)
+        return SEE_INVALID_ARGUMENT;
+
+    cmd = &buffer->commands[patch];
+    if (cmd->op != OP_UNIFORM)
+        return SEE_INVALID_ARGUMENT;
+
+    n = uniform_components((PsyUniformType) cmd->e) * (size_t) cmd->b;
+    if ((PsyUniformType) cmd->e == PSY_UNIFORM_INT)
+        memcpy(buffer->ints + cmd->value, values, n * sizeof(GLint));
+    else
+        memcpy(buffer->floats + cmd->value, values, n * sizeof(GLfloat));
+
+    return SEE_SUCCESS;
+}
+
+int
+psy_command_buffer_replay(
+    PsyCommandBuffer*   buffer,
+    const GLfloat*      transform,
+    SeeError**          error
+    )
+{
+    if (!buffer || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_COMMAND_BUFFER_GET_CLASS(buffer)->replay(
+        buffer, transform, error
+        );
+}
+
+size_t
+psy_command_buffer_size(const PsyCommandBuffer* buffer)
+{
+    return buffer ? buffer->num_commands : 0;
+}
+
+/* **** initialization of the class **** */
+
+PsyCommandBufferClass* g_PsyCommandBufferClass = NULL;
+
+static int psy_command_buffer_class_init(SeeObjectClass* new_cls) {
+    int ret = SEE_SUCCESS;
+
+    /* Override the functions on the parent here */
+    new_cls->init = init;
+    new_cls->name = "PsyCommandBuffer";
+    new_cls->destroy = destroy;
+
+    /* Set the function pointers of the own class here */
+    PsyCommandBufferClass* cls = (PsyCommandBufferClass*) new_cls;
+
+    cls->command_buffer_init    = command_buffer_init;
+    cls->clear                  = command_buffer_clear;
+    cls->replay                 = command_buffer_replay;
+
+    return ret;
+}
+
+/**
+ * \private
+ * \brief this class initializes PsyCommandBuffer(Class).
+ *
+ * You might want to call this from the library initialization func.
+ */
+int
+psy_command_buffer_init() {
+    int ret;
+    const SeeMetaClass* meta = see_meta_class_class();
+
+    ret = see_meta_class_new_class(
+        meta,
+        (SeeObjectClass**) &g_PsyCommandBufferClass,
+        sizeof(PsyCommandBufferClass),
+        sizeof(PsyCommandBuffer),
+        see_object_class(),
+        sizeof(SeeObjectClass),
+        psy_command_buffer_class_init
+        );
+
+    return ret;
+}
+
+void
+psy_command_buffer_deinit()
+{
+    if(!g_PsyCommandBufferClass)
+        return;
+
+    see_object_decref((SeeObject*) g_PsyCommandBufferClass);
+    g_PsyCommandBufferClass = NULL;
+}
+
+const PsyCommandBufferClass*
+psy_command_buffer_class()
+{
+    return g_PsyCommandBufferClass;
+}
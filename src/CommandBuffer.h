@@ -0,0 +1,367 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file CommandBuffer.h
+ * \brief Records the OpenGL commands of a display once and replays them.
+ *
+ * Many displays of a trial, e.g. a fixation cross or a static array of
+ * items, are the same on every frame. Building them again each frame goes
+ * through the functions of every stimulus, whereas the OpenGL calls that
+ * come out are the same each time. A PsyCommandBuffer stores those calls
+ * in one array while the display is recorded; psy_command_buffer_replay()
+ * then issues them in a loop without allocating anything.
+ *
+ * Uniforms that change between frames, e.g. the color of a fixation
+ * cross that gives feedback, can be patched: recording a uniform returns
+ * a handle, psy_command_buffer_set_uniform() changes the value that the
+ * next replay uses.
+ *
+ * \code
+ * size_t color;
+ * psy_command_buffer_use_program(buffer, program, &error);
+ * psy_command_buffer_uniform(
+ *     buffer, location, PSY_UNIFORM_VEC4, 1, red, &color, &error
+ *     );
+ * psy_command_buffer_bind_vertex_array(buffer, vao, &error);
+ * psy_command_buffer_draw_arrays(buffer, GL_TRIANGLES, 0, 12, &error);
+ *
+ * // every frame
+ * psy_command_buffer_set_uniform(buffer, color, feedback ? green : red);
+ * psy_command_buffer_replay(buffer, NULL, &error);
+ * \endcode
+ *
+ * Objects like vertex arrays, buffers and textures are recorded by name,
+ * they should outlive the recording. Programs are referenced by the
+ * buffer. When a program is reloaded after it was recorded, see
+ * psy_shader_program_generation(), the replay looks up the locations of
+ * its uniforms again by the names they had while recording.
+ */
+
+#ifndef PSY_COMMAND_BUFFER_H
+#define PSY_COMMAND_BUFFER_H
+
+#include <stddef.h>
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+
+#include "psy_export.h"
+#include "DisplayList.h"
+#include "ShaderProgram.h"
+#include "gl/includes_gl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _PsyCommandBuffer PsyCommandBuffer;
+typedef struct _PsyCommandBufferClass PsyCommandBufferClass;
+
+/**
+ * \brief The type of a recorded uniform.
+ */
+typedef enum {
+    PSY_UNIFORM_FLOAT,  ///< glUniform1fv
+    PSY_UNIFORM_VEC2,   ///< glUniform2fv
+    PSY_UNIFORM_VEC3,   ///< glUniform3fv
+    PSY_UNIFORM_VEC4,   ///< glUniform4fv
+    PSY_UNIFORM_INT,    ///< glUniform1iv, e.g. for samplers
+    PSY_UNIFORM_MAT4    ///< glUniformMatrix4fv, column major
+} PsyUniformType;
+
+/* A recorded command, these are private to CommandBuffer.c. */
+typedef struct Command Command;
+
+struct _PsyCommandBuffer {
+    SeeObject parent_obj;
+
+    /*expand PsyCommandBuffer data here*/
+
+    Command*        commands;
+    size_t          num_commands;
+    size_t          capacity;
+
+    GLfloat*        floats;     // the values of float uniforms
+    size_t          num_floats;
+    size_t          floats_capacity;
+
+    GLint*          ints;       // the values of int uniforms
+    size_t          num_ints;
+    size_t          ints_capacity;
+
+    char*           names;      // the names of the recorded uniforms
+    size_t          names_size;
+    size_t          names_capacity;
+
+    PsyShaderProgram* program;  // the program in use while recording
+};
+
+struct _PsyCommandBufferClass {
+    SeeObjectClass parent_cls;
+
+    int (*command_buffer_init)(
+        PsyCommandBuffer*               buffer,
+        const PsyCommandBufferClass*    buffer_cls,
+        SeeError**                      error
+        );
+
+    void (*clear)(PsyCommandBuffer* buffer);
+
+    int (*replay)(
+        PsyCommandBuffer*   buffer,
+        const GLfloat*      transform,
+        SeeError**          error
+        );
+};
+
+/* **** function style macro casts **** */
+
+/**
+ * \brief cast a pointer from a PsyCommandBuffer derived instance back to a
+ *        pointer to PsyCommandBuffer.
+ */
+#define PSY_COMMAND_BUFFER(obj)                      \
+    ((PsyCommandBuffer*) obj)
+
+/**
+ * \brief cast a pointer to PsyCommandBufferClass derived class back to a
+ *        pointer to PsyCommandBufferClass.
+ */
+#define PSY_COMMAND_BUFFER_CLASS(cls)                      \
+    ((const PsyCommandBufferClass*) cls)
+
+/**
+ * \brief obtain a pointer to PsyCommandBufferClass from a instance of
+ *        derived from PsyCommandBuffer.
+ */
+#define PSY_COMMAND_BUFFER_GET_CLASS(obj)                \
+    (PSY_COMMAND_BUFFER_CLASS(see_object_get_class(SEE_OBJECT(obj)) ) )
+
+/* **** public functions **** */
+
+/**
+ * \brief Create an empty command buffer.
+ *
+ * @param [out] buffer  The new buffer, should be NULL.
+ * @param [out] error   If an error occurs, it's returned here.
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_command_buffer_create(PsyCommandBuffer** buffer, SeeError** error);
+
+/**
+ * \brief Remove all commands, so a new display can be recorded.
+ *
+ * The memory is kept, recording a display of the same size again doesn't
+ * allocate.
+ */
+PSY_EXPORT void
+psy_command_buffer_clear(PsyCommandBuffer* buffer);
+
+/**
+ * \brief Record glUseProgram, the buffer holds a reference to program.
+ */
+PSY_EXPORT int
+psy_command_buffer_use_program(
+    PsyCommandBuffer*   buffer,
+    PsyShaderProgram*   program,
+    SeeError**          error
+    );
+
+/**
+ * \brief Record binding texture to target of texture unit unit.
+ */
+PSY_EXPORT int
+psy_command_buffer_bind_texture(
+    PsyCommandBuffer*   buffer,
+    GLuint              unit,
+    GLenum              target,
+    GLuint              texture,
+    SeeError**          error
+    );
+
+/**
+ * \brief Record binding a vertex array object.
+ */
+PSY_EXPORT int
+psy_command_buffer_bind_vertex_array(
+    PsyCommandBuffer*   buffer,
+    GLuint              vao,
+    SeeError**          error
+    );
+
+/**
+ * \brief Record enabling a vertex attribute that is read from vbo.
+ *
+ * Without vertex array objects, i.e. on OpenGL ES 2.0, the attributes
+ * have to be set on every draw, this records what glVertexAttribPointer
+ * needs for that. Arrays that are enabled while no vertex array object
+ * is bound are disabled again at the end of the replay.
+ */
+PSY_EXPORT int
+psy_command_buffer_vertex_attribute(
+    PsyCommandBuffer*   buffer,
+    GLuint              location,
+    GLuint              vbo,
+    GLint               size,
+    GLenum              type,
+    GLsizei             stride,
+    size_t              offset,
+    SeeError**          error
+    );
+
+/**
+ * \brief Record enabling or disabling blending and the blend function.
+ */
+PSY_EXPORT int
+psy_command_buffer_blend(
+    PsyCommandBuffer*   buffer,
+    int                 enabled,
+    GLenum              src,
+    GLenum              dst,
+    SeeError**          error
+    );
+
+/**
+ * \brief Record setting a uniform of the program in use.
+ *
+ * @param [in]  buffer
+ * @param [in]  location    The location of the uniform, -1 is ignored like
+ *                          OpenGL does.
+ * @param [in]  type        The type of the uniform.
+ * @param [in]  count       The number of elements when it's an array.
+ * @param [in]  values      count elements of type, they're copied.
+ * @param [out] patch       When not NULL, a handle that can be passed to
+ *                          psy_command_buffer_set_uniform().
+ * @param [out] error
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_command_buffer_uniform(
+    PsyCommandBuffer*   buffer,
+    GLint               location,
+    PsyUniformType      type,
+    GLsizei             count,
+    const void*         values,
+    size_t*             patch,
+    SeeError**          error
+    );
+
+/**
+ * \brief Record glDrawArrays.
+ */
+PSY_EXPORT int
+psy_command_buffer_draw_arrays(
+    PsyCommandBuffer*   buffer,
+    GLenum              mode,
+    GLint               first,
+    GLsizei             count,
+    SeeError**          error
+    );
+
+/**
+ * \brief Record glDrawArraysInstanced, this needs OpenGL 3.3.
+ */
+PSY_EXPORT int
+psy_command_buffer_draw_arrays_instanced(
+    PsyCommandBuffer*   buffer,
+    GLenum              mode,
+    GLint               first,
+    GLsizei             count,
+    GLsizei             instances,
+    SeeError**          error
+    );
+
+/**
+ * \brief Record a call of draw, e.g. to draw a psylib stimulus as part of
+ * the display.
+ *
+ * The call is made with the transform that is passed to
+ * psy_command_buffer_replay().
+ */
+PSY_EXPORT int
+psy_command_buffer_call(
+    PsyCommandBuffer*   buffer,
+    PsyDrawFunc         draw,
+    void*               stimulus,
+    SeeError**          error
+    );
+
+/**
+ * \brief Change the values of a recorded uniform.
+ *
+ * @param [in] buffer
+ * @param [in] patch    A handle from psy_command_buffer_uniform().
+ * @param [in] values   As many values as were recorded.
+ * @return SEE_SUCCESS or SEE_INVALID_ARGUMENT when patch isn't a uniform.
+ */
+PSY_EXPORT int
+psy_command_buffer_set_uniform(
+    PsyCommandBuffer*   buffer,
+    size_t              patch,
+    const void*         values
+    );
+
+/**
+ * \brief Issue the recorded commands.
+ *
+ * The state that the commands set, stays set afterwards.
+ *
+ * @param [in]  buffer
+ * @param [in]  transform   Passed to the recorded calls, may be NULL.
+ * @param [out] error
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_command_buffer_replay(
+    PsyCommandBuffer*   buffer,
+    const GLfloat*      transform,
+    SeeError**          error
+    );
+
+/**
+ * \brief The number of recorded commands.
+ */
+PSY_EXPORT size_t
+psy_command_buffer_size(const PsyCommandBuffer* buffer);
+
+/**
+ * Gets the pointer to the PsyCommandBufferClass table.
+ */
+PSY_EXPORT const PsyCommandBufferClass*
+psy_command_buffer_class();
+
+/* **** class initialization functions **** */
+
+/**
+ * Initialize PsyCommandBuffer; make it ready for use.
+ */
+PSY_EXPORT
+int psy_command_buffer_init();
+
+/**
+ * Deinitialize PsyCommandBuffer, after PsyCommandBuffer has been
+ * deinitialized, all functions in this header shouldn't be used anymore.
+ */
+PSY_EXPORT
+void psy_command_buffer_deinit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_COMMAND_BUFFER_H
@@ -0,0 +1,590 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "MetaClass.h"
+#include "Error.h"
+#include "DisplayList.h"
+#include "Trace.h"
+#include "gl/GLError.h"
+#include "gl/gl_util.h"
+
+struct DisplayEntry {
+    PsyDisplayItem  item;
+    int             used;
+    int             visible;
+    unsigned long   sequence;   // keeps the order of equal items stable
+    int             gpu_scope;  // of the gpu timer, -1 until it's looked up
+};
+
+static void
+set_error(SeeError** error, const char* func, const char* msg)
+{
+    PsyError* err = NULL;
+    psy_error_create(&err);
+    psy_error_printf(err, "%s: %s", func, msg);
+    *error = SEE_ERROR(err);
+}
+
+static GLuint
+program_id(const PsyDisplayItem* item)
+{
+    return item->program ? item->program->program_id : 0;
+}
+
+static int
+compare_entries(const void* lhs, const void* rhs)
+{
+    const DisplayEntry* a = *(const DisplayEntry* const*) lhs;
+    const DisplayEntry* b = *(const DisplayEntry* const*) rhs;
+    GLuint prog_a = program_id(&a->item), prog_b = program_id(&b->item);
+    int i;
+
+    if (a->item.layer != b->item.layer)
+        return a->item.layer < b->item.layer ? -1 : 1;
+    if (prog_a != prog_b)
+        return prog_a < prog_b ? -1 : 1;
+    if (a->item.texture_target != b->item.texture_target)
+        return a->item.texture_target < b->item.texture_target ? -1 : 1;
+    for (i = 0; i < PSY_DISPLAY_ITEM_TEXTURES; i++)
+        if (a->item.textures[i] != b->item.textures[i])
+            return a->item.textures[i] < b->item.textures[i] ? -1 : 1;
+    if (a->item.blend != b->item.blend)
+        return a->item.blend < b->item.blend ? -1 : 1;
+
+    return a->sequence < b->sequence ? -1 : a->sequence > b->sequence;
+}
+
+static void
+sort_entries(PsyDisplayList* list)
+{
+    size_t i;
+
+    list->num_order = 0;
+    for (i = 0; i < list->num_entries; i++)
+        if (list->entries[i].used)
+            list->order[list->num_order++] = &list->entries[i];
+
+    qsort(list->order, list->num_order, sizeof(DisplayEntry*), compare_entries);
+    list->dirty = 0;
+    list->stats.sorts++;
+}
+
+static void
+apply_blend(PsyBlendMode blend)
+{
+    switch (blend) {
+        case PSY_BLEND_NONE:
+            glDisable(GL_BLEND);
+            break;
+        case PSY_BLEND_ALPHA:
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            break;
+        case PSY_BLEND_ADDITIVE:
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+            break;
+    }
+}
+
+static void
+set_entry(DisplayEntry* entry, const PsyDisplayItem* item, unsigned long seq)
+{
+    if (item->program)
+        see_object_ref(SEE_OBJECT(item->program));
+    if (entry->used && entry->item.program)
+        see_object_decref(SEE_OBJECT(entry->item.program));
+
+    entry->item = *item;
+    entry->sequence = seq;
+    entry->gpu_scope = -1;
+}
+
+/* The scope of the item in the gpu timer, looked up on its first draw. */
+static int
+gpu_scope(PsyDisplayList* list, DisplayEntry* entry, SeeError** error)
+{
+    char name[32];
+    const char* scope_name = entry->item.name;
+
+    if (entry->gpu_scope >= 0)
+        return SEE_SUCCESS;
+
+    if (!scope_name) {
+        snprintf(name, sizeof(name), "item %zu", (size_t) (entry - list->entries));
+        scope_name = name;
+    }
+    return psy_gpu_timer_scope(list->gpu_timer, scope_name, &entry->gpu_scope, error);
+}
+
+static int
+valid_item(const PsyDisplayItem* item, SeeError** error, const char* func)
+{
+    if (!item->draw) {
+        set_error(error, func, "an item needs a draw function");
+        return 0;
+    }
+    if (item->program && !psy_shader_program_linked(item->program)) {
+        set_error(error, func, "the program of the item isn't linked");
+        return 0;
+    }
+    return 1;
+}
+
+static DisplayEntry*
+find_entry(const PsyDisplayList* list, size_t handle)
+{
+    if (handle >= list->num_entries || !list->entries[handle].used)
+        return NULL;
+    return &list->entries[handle];
+}
+
+/* **** functions that implement PsyDisplayList or override SeeObject **** */
+
+static int
+display_list_init(
+    PsyDisplayList*             list,
+    const PsyDisplayListClass*  list_cls,
+    SeeError**                  error
+    )
+{
+    const SeeObjectClass* parent_cls = SEE_OBJECT_CLASS(list_cls);
+    (void) error;
+
+    parent_cls->object_init(
+        SEE_OBJECT(list),
+        SEE_OBJECT_CLASS(list_cls)
+        );
+
+    return SEE_SUCCESS;
+}
+
+static int
+init(const SeeObjectClass* cls, SeeObject* obj, va_list args)
+{
+    const PsyDisplayListClass* list_cls = PSY_DISPLAY_LIST_CLASS(cls);
+    PsyDisplayList* list = PSY_DISPLAY_LIST(obj);
+
+    SeeError** error = va_arg(args, SeeError**);
+
+    return list_cls->display_list_init(list, list_cls, error);
+}
+
+static void
+destroy(SeeObject* obj)
+{
+    PsyDisplayList* list = PSY_DISPLAY_LIST(obj);
+    size_t i;
+
+    for (i = 0; i < list->num_entries; i++)
+        if (list->entries[i].used && list->entries[i].item.program)
+            see_object_decref(SEE_OBJECT(list->entries[i].item.program));
+    free(list->entries);
+    free(list->order);
+    if (list->gpu_timer)
+        see_object_decref(SEE_OBJECT(list->gpu_timer));
+
+    see_object_class()->destroy(obj);
+}
+
+static int
+display_list_add(
+    PsyDisplayList*         list,
+    const PsyDisplayItem*   item,
+    size_t*                 handle,
+    SeeError**              error
+    )
+{
+    size_t slot;
+
+    if (!valid_item(item, error, __func__))
+        return SEE_INVALID_ARGUMENT;
+
+    // Reuse the slot of a removed item, so the handles stay small.
+    for (slot = 0; slot < list->num_entries; slot++)
+        if (!list->entries[slot].used)
+            break;
+
+    if (slot == list->num_entries) {
+        if (list->num_entries == list->capacity) {
+            size_t capacity = list->capacity ? list->capacity * 2 : 16;
+            DisplayEntry* entries;
+            DisplayEntry** order;
+
+            entries = realloc(list->entries, capacity * sizeof(DisplayEntry));
+            if (!entries) {
+                set_error(error, __func__, "out of memory");
+                return SEE_ERROR_RUNTIME;
+            }
+            list->entries = entries;
+
+            order = realloc(list->order, capacity * sizeof(DisplayEntry*));
+            if (!order) {
+                set_error(error, __func__, "out of memory");
+                return SEE_ERROR_RUNTIME;
+            }
+            list->order = order;
+            list->capacity = capacity;
+        }
+        memset(&list->entries[slot], 0, sizeof(DisplayEntry));
+        list->num_entries++;
+    }
+
+    set_entry(&list->entries[slot], item, list->sequence++);
+    list->entries[slot].used = 1;
+    list->entries[slot].visible = 1;
+    list->num_items++;
+    // The order holds pointers into entries, which may have moved.
+    list->dirty = 1;
+
+    *handle = slot;
+    return SEE_SUCCESS;
+}
+
+static int
+display_list_update(
+    PsyDisplayList*         list,
+    size_t                  handle,
+    const PsyDisplayItem*   item,
+    SeeError**              error
+    )
+{
+    DisplayEntry* entry = find_entry(list, handle);
+
+    if (!entry) {
+        set_error(error, __func__, "there is no item with this handle");
+        return SEE_INVALID_ARGUMENT;
+    }
+    if (!valid_item(item, error, __func__))
+        return SEE_INVALID_ARGUMENT;
+
+    // Only a change of the sort key requires sorting again.
+    if (entry->item.layer != item->layer ||
+        program_id(&entry->item) != program_id(item) ||
+        entry->item.texture_target != item->texture_target ||
+        memcmp(entry->item.textures, item->textures, sizeof(item->textures)) ||
+        entry->item.blend != item->blend)
+        list->dirty = 1;
+
+    set_entry(entry, item, entry->sequence);
+    return SEE_SUCCESS;
+}
+
+static int
+display_list_remove(PsyDisplayList* list, size_t handle, SeeError** error)
+{
+    DisplayEntry* entry = find_entry(list, handle);
+
+    if (!entry) {
+        set_error(error, __func__, "there is no item with this handle");
+        return SEE_INVALID_ARGUMENT;
+    }
+
+    if (entry->item.program)
+        see_object_decref(SEE_OBJECT(entry->item.program));
+    memset(entry, 0, sizeof(DisplayEntry));
+    list->num_items--;
+    list->dirty = 1;
+
+    return SEE_SUCCESS;
+}
+
+static int
+display_list_draw(
+    PsyDisplayList*     list,
+    const GLfloat*      transform,
+    SeeError**          error
+    )
+{
+    PsyGLStateCounters before, after;
+    PsyBlendMode blend = PSY_BLEND_NONE;
+    int blend_known = 0;
+    GLboolean blend_enabled;
+    GLint blend_src, blend_dst;
+    int ret = SEE_SUCCESS;
+    size_t i;
+
+    if (list->dirty)
+        sort_entries(list);
+
+    list->stats.items_drawn = 0;
+    list->stats.blend_changes = 0;
+
+    blend_enabled = glIsEnabled(GL_BLEND);
+    glGetIntegerv(GL_BLEND_SRC_RGB, &blend_src);
+    glGetIntegerv(GL_BLEND_DST_RGB, &blend_dst);
+
+    psy_gl_state_counters(&before);
+    psy_gl_state_cache_begin();
+
+    for (i = 0; i < list->num_order; i++) {
+        DisplayEntry* entry = list->order[i];
+        const PsyDisplayItem* item = &entry->item;
+        GLuint unit;
+
+        if (!entry->visible)
+            continue;
+
+        if (item->program) {
+            ret = psy_shader_use_program(item->program, error);
+            if (ret)
+                break;
+        }
+        for (unit = 0; unit < PSY_DISPLAY_ITEM_TEXTURES; unit++)
+            if (item->textures[unit])
+                psy_gl_bind_texture(
+                    unit, item->texture_target, item->textures[unit]
+                    );
+        if (!blend_known || item->blend != blend) {
+            apply_blend(item->blend);
+            blend = item->blend;
+            blend_known = 1;
+            list->stats.blend_changes++;
+        }
+
+        if (list->gpu_timer) {
+            ret = gpu_scope(list, entry, error);
+            if (ret)
+                break;
+            psy_gpu_timer_begin(list->gpu_timer, entry->gpu_scope);
+        }
+        ret = item->draw(item->stimulus, transform, error);
+        if (list->gpu_timer)
+            psy_gpu_timer_end(list->gpu_timer, entry->gpu_scope);
+        if (ret)
+            break;
+        list->stats.items_drawn++;
+    }
+
+    psy_gl_state_cache_end();
+    psy_gl_state_counters(&after);
+    list->stats.program_changes =
+        after.program_changes - before.program_changes;
+    list->stats.texture_changes =
+        after.texture_changes - before.texture_changes;
+
+    if (blend_known) {
+        if (blend_enabled)
+            glEnable(GL_BLEND);
+        else
+            glDisable(GL_BLEND);
+        glBlendFunc((GLenum) blend_src, (GLenum) blend_dst);
+    }
+
+    return ret;
+}
+
+/* **** implementation of the public API **** */
+
+int
+psy_display_list_create(PsyDisplayList** list, SeeError** error)
+{
+    const PsyDisplayListClass* cls = psy_display_list_class();
+    const SeeObjectClass* see_cls = SEE_OBJECT_CLASS(cls);
+
+    if (!cls)
+        return SEE_NOT_INITIALIZED;
+
+    if (!list || *list)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return see_cls->new_obj(see_cls, 0, (SeeObject**) list, error);
+}
+
+int
+psy_display_list_add(
+    PsyDisplayList*         list,
+    const PsyDisplayItem*   item,
+    size_t*                 handle,
+    SeeError**              error
+    )
+{
+    if (!list || !item || !handle || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_DISPLAY_LIST_GET_CLASS(list)->add(list, item, handle, error);
+}
+
+int
+psy_display_list_update(
+    PsyDisplayList*         list,
+    size_t                  handle,
+    const PsyDisplayItem*   item,
+    SeeError**              error
+    )
+{
+    if (!list || !item || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_DISPLAY_LIST_GET_CLASS(list)->update(list, handle, item, error);
+}
+
+int
+psy_display_list_remove(
+    PsyDisplayList* list,
+    size_t          handle,
+    SeeError**      error
+    )
+{
+    if (!list || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_DISPLAY_LIST_GET_CLASS(list)->remove(list, handle, error);
+}
+
+int
+psy_display_list_set_visible(
+    PsyDisplayList* list,
+    size_t          handle,
+    int             visible
+    )
+{
+    DisplayEntry* entry;
+
+    if (!list)
+        return SEE_INVALID_ARGUMENT;
+
+    entry = find_entry(list, handle);
+    if (!entry)
+        return SEE_INVALID_ARGUMENT;
+
+    entry->visible = visible != 0;
+    return SEE_SUCCESS;
+}
+
+int
+psy_display_list_draw(
+    PsyDisplayList* list,
+    const GLfloat*  transform,
+    SeeError**      error
+    )
+{
+    int ret;
+
+    if (!list || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    PSY_TRACE_BEGIN(trace);
+    ret = PSY_DISPLAY_LIST_GET_CLASS(list)->draw(list, transform, error);
+    PSY_TRACE_END(trace, "psylib", "draw");
+    return ret;
+}
+
+size_t
+psy_display_list_size(const PsyDisplayList* list)
+{
+    return list ? list->num_items : 0;
+}
+
+void
+psy_display_list_set_gpu_timer(PsyDisplayList* list, PsyGpuTimer* timer)
+{
+    size_t i;
+
+    if (!list)
+        return;
+
+    if (timer)
+        see_object_ref(SEE_OBJECT(timer));
+    if (list->gpu_timer)
+        see_object_decref(SEE_OBJECT(list->gpu_timer));
+    list->gpu_timer = timer;
+
+    // The scopes belong to the previous timer.
+    for (i = 0; i < list->num_entries; i++)
+        list->entries[i].gpu_scope = -1;
+}
+
+void
+psy_display_list_stats(
+    const PsyDisplayList*   list,
+    PsyDisplayListStats*    stats
+    )
+{
+    if (list && stats)
+        *stats = list->stats;
+}
+
+/* **** initialization of the class **** */
+
+PsyDisplayListClass* g_PsyDisplayListClass = NULL;
+
+static int psy_display_list_class_init(SeeObjectClass* new_cls) {
+    int ret = SEE_SUCCESS;
+
+    /* Override the functions on the parent here */
+    new_cls->init = init;
+    new_cls->name = "PsyDisplayList";
+    new_cls->destroy = destroy;
+
+    /* Set the function pointers of the own class here */
+    PsyDisplayListClass* cls = (PsyDisplayListClass*) new_cls;
+
+    cls->display_list_init  = display_list_init;
+    cls->add                = display_list_add;
+    cls->update             = display_list_update;
+    cls->remove             = display_list_remove;
+    cls->draw               = display_list_draw;
+
+    return ret;
+}
+
+/**
+ * \private
+ * \brief this class initializes PsyDisplayList(Class).
+ *
+ * You might want to call this from the library initialization func.
+ */
+int
+psy_display_list_init() {
+    int ret;
+    const SeeMetaClass* meta = see_meta_class_class();
+
+    ret = see_meta_class_new_class(
+        meta,
+        (SeeObjectClass**) &g_PsyDisplayListClass,
+        sizeof(PsyDisplayListClass),
+        sizeof(PsyDisplayList),
+        see_object_class(),
+        sizeof(SeeObjectClass),
+        psy_display_list_class_init
+        );
+
+    return ret;
+}
+
+void
+psy_display_list_deinit()
+{
+    if(!g_PsyDisplayListClass)
+        return;
+
+    see_object_decref((SeeObject*) g_PsyDisplayListClass);
+    g_PsyDisplayListClass = NULL;
+}
+
+const PsyDisplayListClass*
+psy_display_list_class()
+{
+    return g_PsyDisplayListClass;
+}
@@ -0,0 +1,356 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file DisplayList.h
+ * \brief Draws the stimuli of a window sorted to minimize state changes.
+ *
+ * Drawing stimuli in the order of the experiment switches the program and
+ * the textures each time two conditions interleave. A PsyDisplayList
+ * holds the stimuli that are drawn each frame, each as a PsyDisplayItem
+ * that states its layer, program, textures and blending. The list sorts
+ * the items by layer, then by program and then by texture and draws
+ * them, so that items that share state are drawn after each other and
+ * the state is only changed when it differs from the previous item. The
+ * order is kept between frames, the list only sorts again after an item
+ * is added, updated or removed.
+ *
+ * The layer decides what is on top: items of a higher layer are drawn
+ * later. Within a layer, items that share their program and textures are
+ * drawn in the order they were added; otherwise their order is what
+ * suits the state changes best, so overlapping stimuli that must be
+ * drawn in a specific order should be in different layers.
+ *
+ * The draw function of an item typically wraps the draw function of a
+ * stimulus:
+ * \code
+ * static int
+ * draw_grating(void* stimulus, const GLfloat* transform, SeeError** error)
+ * {
+ *     return psy_grating_draw(stimulus, transform, error);
+ * }
+ *
+ * PsyDisplayItem item = {
+ *     .layer   = 1,
+ *     .program = grating->program,
+ *     .draw    = draw_grating,
+ *     .stimulus= grating
+ * };
+ * psy_display_list_add(list, &item, &handle, &error);
+ * \endcode
+ * The list binds the program and textures of an item before calling its
+ * draw function. While the list draws, psy_shader_use_program() and the
+ * bind functions of psylib skip binding what is bound already, so the
+ * stimuli don't undo what the sorting saves.
+ *
+ * Therefore a draw function must not call glUseProgram(), glActiveTexture()
+ * or glBindTexture() directly: the list wouldn't know the state changed
+ * and would skip binding the program or textures of the next item. Use
+ * psy_shader_use_program() and psy_gl_bind_texture(), or call
+ * psy_gl_state_forget() after binding with OpenGL directly.
+ */
+
+#ifndef PSY_DISPLAY_LIST_H
+#define PSY_DISPLAY_LIST_H
+
+#include <stddef.h>
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+
+#include "psy_export.h"
+#include "GpuTimer.h"
+#include "ShaderProgram.h"
+#include "gl/includes_gl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The number of texture units an item may bind. */
+#define PSY_DISPLAY_ITEM_TEXTURES 4
+
+typedef struct _PsyDisplayList PsyDisplayList;
+typedef struct _PsyDisplayListClass PsyDisplayListClass;
+
+/**
+ * \brief How the fragments of an item are combined with the background.
+ */
+typedef enum {
+    PSY_BLEND_NONE,     ///< The item replaces the background.
+    PSY_BLEND_ALPHA,    ///< Blended with the alpha of the item.
+    PSY_BLEND_ADDITIVE  ///< Added to the background, weighted by alpha.
+} PsyBlendMode;
+
+/**
+ * \brief Draws one item, the stimulus is the one of the item.
+ *
+ * It must bind programs and textures through psylib, see above.
+ */
+typedef int (*PsyDrawFunc)(
+    void*           stimulus,
+    const GLfloat*  transform,
+    SeeError**      error
+    );
+
+/**
+ * \brief A stimulus and the state it is drawn with.
+ */
+typedef struct PsyDisplayItem {
+    int                 layer;          ///< Higher layers are drawn later.
+    PsyShaderProgram*   program;        ///< May be NULL.
+    GLenum              texture_target; ///< E.g. GL_TEXTURE_2D.
+    GLuint              textures[PSY_DISPLAY_ITEM_TEXTURES]; ///< Per unit, 0 is unused.
+    PsyBlendMode        blend;
+    PsyDrawFunc         draw;
+    void*               stimulus;       ///< Passed to draw.
+    const char*         name;           ///< For GPU timing, may be NULL.
+} PsyDisplayItem;
+
+/**
+ * \brief What the last psy_display_list_draw() did.
+ */
+typedef struct PsyDisplayListStats {
+    size_t          items_drawn;
+    unsigned long   program_changes;    ///< glUseProgram calls.
+    unsigned long   texture_changes;    ///< glBindTexture calls.
+    unsigned long   blend_changes;
+    unsigned long   sorts;              ///< Sorts since the list was created.
+} PsyDisplayListStats;
+
+/* An item in the list, these are private to DisplayList.c. */
+typedef struct DisplayEntry DisplayEntry;
+
+struct _PsyDisplayList {
+    SeeObject parent_obj;
+
+    /*expand PsyDisplayList data here*/
+
+    DisplayEntry*       entries;    // indexed by handle
+    size_t              num_entries;
+    size_t              capacity;
+    size_t              num_items;
+
+    DisplayEntry**      order;      // the entries in the order of drawing
+    size_t              num_order;
+    int                 dirty;
+    unsigned long       sequence;
+
+    PsyDisplayListStats stats;
+
+    PsyGpuTimer*        gpu_timer;  // times the items when not NULL
+};
+
+struct _PsyDisplayListClass {
+    SeeObjectClass parent_cls;
+
+    int (*display_list_init)(
+        PsyDisplayList*             list,
+        const PsyDisplayListClass*  list_cls,
+        SeeError**                  error
+        );
+
+    int (*add)(
+        PsyDisplayList*         list,
+        const PsyDisplayItem*   item,
+        size_t*                 handle,
+        SeeError**              error
+        );
+
+    int (*update)(
+        PsyDisplayList*         list,
+        size_t                  handle,
+        const PsyDisplayItem*   item,
+        SeeError**              error
+        );
+
+    int (*remove)(PsyDisplayList* list, size_t handle, SeeError** error);
+
+    int (*draw)(
+        PsyDisplayList*     list,
+        const GLfloat*      transform,
+        SeeError**          error
+        );
+};
+
+/* **** function style macro casts **** */
+
+/**
+ * \brief cast a pointer from a PsyDisplayList derived instance back to a
+ *        pointer to PsyDisplayList.
+ */
+#define PSY_DISPLAY_LIST(obj)                      \
+    ((PsyDisplayList*) obj)
+
+/**
+ * \brief cast a pointer to PsyDisplayListClass derived class back to a
+ *        pointer to PsyDisplayListClass.
+ */
+#define PSY_DISPLAY_LIST_CLASS(cls)                      \
+    ((const PsyDisplayListClass*) cls)
+
+/**
+ * \brief obtain a pointer to PsyDisplayListClass from a instance of
+ *        derived from PsyDisplayList.
+ */
+#define PSY_DISPLAY_LIST_GET_CLASS(obj)                \
+    (PSY_DISPLAY_LIST_CLASS(see_object_get_class(SEE_OBJECT(obj)) ) )
+
+/* **** public functions **** */
+
+/**
+ * \brief Create an empty display list.
+ *
+ * Every PsyWindow has one, see psy_window_display_list(), but a list may
+ * be created for e.g. a part of the screen as well.
+ *
+ * @param [out] list    The new list, should be NULL.
+ * @param [out] error   If an error occurs, it's returned here.
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_display_list_create(PsyDisplayList** list, SeeError** error);
+
+/**
+ * \brief Add an item to the list.
+ *
+ * The item is copied, the list holds a reference to its program. The
+ * stimulus must outlive its item.
+ *
+ * @param [in]  list
+ * @param [in]  item    The item, its draw function may not be NULL.
+ * @param [out] handle  Identifies the item in the list.
+ * @param [out] error
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_display_list_add(
+    PsyDisplayList*         list,
+    const PsyDisplayItem*   item,
+    size_t*                 handle,
+    SeeError**              error
+    );
+
+/**
+ * \brief Replace the item with handle, e.g. because it uses another
+ * texture now.
+ */
+PSY_EXPORT int
+psy_display_list_update(
+    PsyDisplayList*         list,
+    size_t                  handle,
+    const PsyDisplayItem*   item,
+    SeeError**              error
+    );
+
+/**
+ * \brief Remove the item with handle, the handle may be reused by a later
+ * psy_display_list_add().
+ */
+PSY_EXPORT int
+psy_display_list_remove(
+    PsyDisplayList* list,
+    size_t          handle,
+    SeeError**      error
+    );
+
+/**
+ * \brief Show or hide an item without removing it.
+ *
+ * A hidden item keeps its place in the order, so hiding an item between
+ * trials doesn't cause sorting.
+ *
+ * @return SEE_SUCCESS or SEE_INVALID_ARGUMENT when there is no item with
+ *         handle.
+ */
+PSY_EXPORT int
+psy_display_list_set_visible(
+    PsyDisplayList* list,
+    size_t          handle,
+    int             visible
+    );
+
+/**
+ * \brief Draw the visible items.
+ *
+ * When the list has changed since the previous draw, it's sorted first.
+ * Blending is restored afterwards, the program and textures of the last
+ * item stay bound.
+ *
+ * @param [in]  list
+ * @param [in]  transform   A column major 4*4 matrix that is passed to the
+ *                          items, may be NULL.
+ * @param [out] error
+ * @return SEE_SUCCESS when all items are drawn.
+ */
+PSY_EXPORT int
+psy_display_list_draw(
+    PsyDisplayList* list,
+    const GLfloat*  transform,
+    SeeError**      error
+    );
+
+/**
+ * \brief The number of items in the list.
+ */
+PSY_EXPORT size_t
+psy_display_list_size(const PsyDisplayList* list);
+
+/**
+ * \brief Time the draws of the items on the GPU, NULL stops timing.
+ *
+ * Every item is a scope of the timer, named after the item or "item <n>",
+ * where n is its handle, when it doesn't have a name. The list holds a
+ * reference to the timer.
+ */
+PSY_EXPORT void
+psy_display_list_set_gpu_timer(PsyDisplayList* list, PsyGpuTimer* timer);
+
+/**
+ * \brief Obtain the statistics of the last draw.
+ */
+PSY_EXPORT void
+psy_display_list_stats(
+    const PsyDisplayList*   list,
+    PsyDisplayListStats*    stats
+    );
+
+/**
+ * Gets the pointer to the PsyDisplayListClass table.
+ */
+PSY_EXPORT const PsyDisplayListClass*
+psy_display_list_class();
+
+/* **** class initialization functions **** */
+
+/**
+ * Initialize PsyDisplayList; make it ready for use.
+ */
+PSY_EXPORT
+int psy_display_list_init();
+
+/**
+ * Deinitialize PsyDisplayList, after PsyDisplayList has been deinitialized,
+ * all functions in this header shouldn't be used anymore.
+ */
+PSY_EXPORT
+void psy_display_list_deinit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_DISPLAY_LIST_H
@@ -0,0 +1,717 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "psy_config.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#if defined(HAVE_SDL_TTF)
+#include <SDL2/SDL_ttf.h>
+#endif
+
+#include "MetaClass.h"
+#include "Error.h"
+#include "Font.h"
+#include "gl/GLError.h"
+#include "gl/gl_util.h"
+
+/* The width and height of the atlas texture. */
+#define ATLAS_SIZE 1024
+
+/* The number of slots of the layout cache. */
+#define CACHE_SIZE 256
+
+/* The replacement character is shown for invalid UTF-8. */
+#define REPLACEMENT_CHARACTER 0xFFFDu
+
+/*
+ * A glyph in the atlas. The quad is relative to the pen on the baseline,
+ * a glyph without ink, such as a space, has no quad.
+ */
+typedef struct _PsyGlyph {
+    uint32_t    codepoint;
+    int         has_quad;
+    GLfloat     quad[4];    // x0, y0, x1, y1
+    GLfloat     uv[4];      // u0, v0, u1, v1
+    GLfloat     advance;
+} Glyph;
+
+static void
+set_error(SeeError** error, const char* func, const char* msg, const char* arg)
+{
+    PsyError* err = NULL;
+    psy_error_create(&err);
+    psy_error_printf(err, "%s: %s%s", func, msg, arg ? arg : "");
+    *error = SEE_ERROR(err);
+}
+
+/*
+ * Decodes one code point and advances *s past it.
+ */
+static uint32_t
+next_codepoint(const unsigned char** s)
+{
+    const unsigned char* p = *s;
+    uint32_t cp;
+    int n, i;
+
+    if (p[0] < 0x80) {
+        *s = p + 1;
+        return p[0];
+    }
+    else if ((p[0] & 0xE0) == 0xC0) {
+        cp = p[0] & 0x1F;
+        n = 1;
+    }
+    else if ((p[0] & 0xF0) == 0xE0) {
+        cp = p[0] & 0x0F;
+        n = 2;
+    }
+    else if ((p[0] & 0xF8) == 0xF0) {
+        cp = p[0] & 0x07;
+        n = 3;
+    }
+    else {
+        *s = p + 1;
+        return REPLACEMENT_CHARACTER;
+    }
+
+    for (i = 1; i <= n; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            *s = p + i;
+            return REPLACEMENT_CHARACTER;
+        }
+        cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    *s = p + n + 1;
+    return cp;
+}
+
+static void
+encode_utf8(uint32_t cp, char out[5])
+{
+    if (cp < 0x80) {
+        out[0] = (char) cp;
+        out[1] = '\0';
+    }
+    else if (cp < 0x800) {
+        out[0] = (char) (0xC0 | (cp >> 6));
+        out[1] = (char) (0x80 | (cp & 0x3F));
+        out[2] = '\0';
+    }
+    else if (cp < 0x10000) {
+        out[0] = (char) (0xE0 | (cp >> 12));
+        out[1] = (char) (0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char) (0x80 | (cp & 0x3F));
+        out[3] = '\0';
+    }
+    else {
+        out[0] = (char) (0xF0 | (cp >> 18));
+        out[1] = (char) (0x80 | ((cp >> 12) & 0x3F));
+        out[2] = (char) (0x80 | ((cp >> 6) & 0x3F));
+        out[3] = (char) (0x80 | (cp & 0x3F));
+        out[4] = '\0';
+    }
+}
+
+static unsigned
+hash_string(const char* s)
+{
+    // FNV-1a
+    unsigned hash = 2166136261u;
+    while (*s) {
+        hash ^= (unsigned char) *s++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void
+free_layout(PsyTextLayout* layout)
+{
+    free(layout->key);
+    free(layout->vertices);
+    memset(layout, 0, sizeof(PsyTextLayout));
+}
+
+/*
+ * Returns the index at which codepoint is or should be inserted.
+ */
+static size_t
+find_glyph(const PsyFont* font, uint32_t codepoint)
+{
+    size_t low = 0, high = font->num_glyphs;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (font->glyphs[mid].codepoint < codepoint)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+/*
+ * Computes a signed distance field of width + 2 * spread by
+ * height + 2 * spread texels from the coverage of a glyph. The edge of the
+ * glyph is at 0.5, inside is above it, outside below it.
+ */
+static void
+make_distance_field(
+    const unsigned char*    coverage,
+    int                     pitch,
+    int                     width,
+    int                     height,
+    int                     spread,
+    unsigned char*          field
+    )
+{
+    int out_width = width + 2 * spread;
+    int out_height = height + 2 * spread;
+    int ox, oy, dx, dy;
+
+#define INSIDE(x, y) \
+    ((x) >= 0 && (y) >= 0 && (x) < width && (y) < height && \
+     coverage[(y) * pitch + (x)] >= 128)
+
+    for (oy = 0; oy < out_height; oy++) {
+        for (ox = 0; ox < out_width; ox++) {
+            int x = ox - spread, y = oy - spread;
+            int inside = INSIDE(x, y);
+            int best = (spread + 1) * (spread + 1);
+            float distance, value;
+
+            for (dy = -spread; dy <= spread; dy++) {
+                for (dx = -spread; dx <= spread; dx++) {
+                    int d2 = dx * dx + dy * dy;
+                    if (d2 < best && INSIDE(x + dx, y + dy) != inside)
+                        best = d2;
+                }
+            }
+
+            // The edge lies halfway between two texels.
+            distance = sqrtf((float) best) - 0.5f;
+            if (distance > (float) spread)
+                distance = (float) spread;
+            value = 0.5f + 0.5f * (inside ? distance : -distance) / (float) spread;
+            field[oy * out_width + ox] = (unsigned char) (value * 255.0f + 0.5f);
+        }
+    }
+#undef INSIDE
+}
+
+#if defined(HAVE_SDL_TTF)
+
+/*
+ * Copies a distance field into the atlas, a new shelf is started when the
+ * current one is full.
+ */
+static int
+pack_glyph(
+    PsyFont*                font,
+    const unsigned char*    field,
+    int                     width,
+    int                     height,
+    int*                    x,
+    int*                    y,
+    SeeError**              error
+    )
+{
+    if (font->shelf_x + width > font->atlas_size) {
+        font->shelf_x = 0;
+        font->shelf_y += font->shelf_height;
+        font->shelf_height = 0;
+    }
+    if (width > font->atlas_size || font->shelf_y + height > font->atlas_size) {
+        PsyGLError* glerror = NULL;
+        psy_glerror_create(&glerror);
+        psy_error_printf(
+            PSY_ERROR(glerror), "%s: the glyph atlas is full", __func__
+            );
+        *error = SEE_ERROR(glerror);
+        return SEE_ERROR_RUNTIME;
+    }
+
+    *x = font->shelf_x;
+    *y = font->shelf_y;
+    font->shelf_x += width;
+    if (height > font->shelf_height)
+        font->shelf_height = height;
+
+    psy_gl_bind_texture(0, GL_TEXTURE_2D, font->atlas);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(
+        GL_TEXTURE_2D, 0, *x, *y, width, height,
+        psy_gl_context_is_es() ? GL_LUMINANCE : GL_RED,
+        GL_UNSIGNED_BYTE, field
+        );
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    psy_gl_bind_texture(0, GL_TEXTURE_2D, 0);
+
+    return SEE_SUCCESS;
+}
+
+static int
+rasterize_glyph(PsyFont* font, uint32_t codepoint, Glyph* glyph, SeeError** error)
+{
+    const SDL_Color white = {255, 255, 255, 255};
+    const SDL_Color black = {0, 0, 0, 255};
+    SDL_Surface* surface;
+    unsigned char* field = NULL;
+    const unsigned char* pixels;
+    char text[5];
+    int width, height, field_width, field_height, x, y, ink = 0, ret;
+    int spread = font->spread;
+
+    memset(glyph, 0, sizeof(Glyph));
+    glyph->codepoint = codepoint;
+
+    encode_utf8(codepoint, text);
+    surface = TTF_RenderUTF8_Shaded(font->ttf, text, white, black);
+    if (!surface)
+        return SEE_SUCCESS; // the font has nothing to show for it.
+
+    // The shaded surface is 8 bits per pixel, the index is the coverage.
+    width = surface->w;
+    height = surface->h;
+    pixels = surface->pixels;
+    glyph->advance = (GLfloat) width;
+
+    for (y = 0; y < height && !ink; y++)
+        for (x = 0; x < width && !ink; x++)
+            ink = pixels[y * surface->pitch + x] >= 128;
+
+    if (!ink) {
+        SDL_FreeSurface(surface);
+        return SEE_SUCCESS;
+    }
+
+    field_width = width + 2 * spread;
+    field_height = height + 2 * spread;
+    field = malloc((size_t) field_width * (size_t) field_height);
+    if (!field) {
+        SDL_FreeSurface(surface);
+        set_error(error, __func__, "out of memory", NULL);
+        return SEE_ERROR_RUNTIME;
+    }
+    make_distance_field(pixels, surface->pitch, width, height, spread, field);
+    SDL_FreeSurface(surface);
+
+    ret = pack_glyph(font, field, field_width, field_height, &x, &y, error);
+    free(field);
+    if (ret)
+        return ret;
+
+    // The top row of the surface is at the ascent above the baseline.
+    glyph->has_quad = 1;
+    glyph->quad[0] = (GLfloat) -spread;
+    glyph->quad[1] = (GLfloat) (font->ascent - height - spread);
+    glyph->quad[2] = (GLfloat) (width + spread);
+    glyph->quad[3] = (GLfloat) (font->ascent + spread);
+    glyph->uv[0] = (GLfloat) x / (GLfloat) font->atlas_size;
+    glyph->uv[1] = (GLfloat) (y + field_height) / (GLfloat) font->atlas_size;
+    glyph->uv[2] = (GLfloat) (x + field_width) / (GLfloat) font->atlas_size;
+    glyph->uv[3] = (GLfloat) y / (GLfloat) font->atlas_size;
+
+    return SEE_SUCCESS;
+}
+
+#else
+
+static int
+rasterize_glyph(PsyFont* font, uint32_t codepoint, Glyph* glyph, SeeError** error)
+{
+    (void) font;
+    (void) codepoint;
+    (void) glyph;
+    set_error(error, __func__, "psylib was built without SDL_ttf", NULL);
+    return SEE_ERROR_RUNTIME;
+}
+
+#endif
+
+static int
+get_glyph(PsyFont* font, uint32_t codepoint, const Glyph** out, SeeError** error)
+{
+    size_t index = find_glyph(font, codepoint);
+    Glyph glyph;
+    int ret;
+
+    if (index < font->num_glyphs && font->glyphs[index].codepoint == codepoint) {
+        *out = &font->glyphs[index];
+        return SEE_SUCCESS;
+    }
+
+    ret = rasterize_glyph(font, codepoint, &glyph, error);
+    if (ret)
+        return ret;
+
+    if (font->num_glyphs == font->glyphs_capacity) {
+        size_t capacity = font->glyphs_capacity ? font->glyphs_capacity * 2 : 128;
+        Glyph* glyphs = realloc(font->glyphs, capacity * sizeof(Glyph));
+        if (!glyphs) {
+            set_error(error, __func__, "out of memory", NULL);
+            return SEE_ERROR_RUNTIME;
+        }
+        font->glyphs = glyphs;
+        font->glyphs_capacity = capacity;
+    }
+
+    memmove(
+        &font->glyphs[index + 1],
+        &font->glyphs[index],
+        (font->num_glyphs - index) * sizeof(Glyph)
+        );
+    font->glyphs[index] = glyph;
+    font->num_glyphs++;
+
+    *out = &font->glyphs[index];
+    return SEE_SUCCESS;
+}
+
+static int
+layout_string(PsyFont* font, const char* utf8, PsyTextLayout* layout, SeeError** error)
+{
+    const unsigned char* s = (const unsigned char*) utf8;
+    size_t max_vertices = 6 * strlen(utf8);
+    GLfloat pen_x = 0.0f, pen_y = 0.0f;
+    GLfloat* v;
+    int ret;
+
+    layout->key = malloc(strlen(utf8) + 1);
+    layout->vertices = malloc((max_vertices ? max_vertices : 1) * 4 * sizeof(GLfloat));
+    if (!layout->key || !layout->vertices) {
+        free_layout(layout);
+        set_error(error, __func__, "out of memory", NULL);
+        return SEE_ERROR_RUNTIME;
+    }
+    strcpy(layout->key, utf8);
+    layout->num_lines = 1;
+
+    v = layout->vertices;
+    while (*s) {
+        uint32_t cp = next_codepoint(&s);
+        const Glyph* glyph;
+
+        if (cp == '\n') {
+            pen_x = 0.0f;
+            pen_y -= (GLfloat) font->line_height;
+            layout->num_lines++;
+            continue;
+        }
+
+        ret = get_glyph(font, cp, &glyph, error);
+        if (ret) {
+            free_layout(layout);
+            return ret;
+        }
+
+        if (glyph->has_quad) {
+            GLfloat x0 = pen_x + glyph->quad[0], y0 = pen_y + glyph->quad[1];
+            GLfloat x1 = pen_x + glyph->quad[2], y1 = pen_y + glyph->quad[3];
+            const GLfloat corners[6][4] = {
+                {x0, y0, glyph->uv[0], glyph->uv[1]},
+                {x1, y0, glyph->uv[2], glyph->uv[1]},
+                {x1, y1, glyph->uv[2], glyph->uv[3]},
+                {x0, y0, glyph->uv[0], glyph->uv[1]},
+                {x1, y1, glyph->uv[2], glyph->uv[3]},
+                {x0, y1, glyph->uv[0], glyph->uv[3]}
+            };
+            memcpy(v, corners, sizeof(corners));
+            v += 6 * 4;
+            layout->num_vertices += 6;
+        }
+
+        pen_x += glyph->advance;
+        if (pen_x > layout->width)
+            layout->width = pen_x;
+    }
+
+    return SEE_SUCCESS;
+}
+
+/* **** functions that implement PsyFont or override SeeObject **** */
+
+static int
+font_init(
+    PsyFont*            font,
+    const PsyFontClass* font_cls,
+    const char*         path,
+    int                 pixel_size,
+    SeeError**          error
+    )
+{
+    const SeeObjectClass* parent_cls = SEE_OBJECT_CLASS(font_cls);
+    const Glyph* glyph;
+    uint32_t cp;
+    int ret;
+
+    parent_cls->object_init(
+        SEE_OBJECT(font),
+        SEE_OBJECT_CLASS(font_cls)
+        );
+
+    font->pixel_size = pixel_size;
+    // Enough to draw outlines and shadows of a few pixels.
+    font->spread = pixel_size / 8 > 2 ? pixel_size / 8 : 2;
+    font->atlas_size = ATLAS_SIZE;
+
+#if defined(HAVE_SDL_TTF)
+    font->ttf = TTF_OpenFont(path, pixel_size);
+    if (!font->ttf) {
+        set_error(error, __func__, "unable to open font: ", TTF_GetError());
+        return SEE_ERROR_RUNTIME;
+    }
+    font->ascent = TTF_FontAscent(font->ttf);
+    font->descent = TTF_FontDescent(font->ttf);
+    font->line_height = TTF_FontLineSkip(font->ttf);
+#else
+    (void) path;
+    set_error(error, __func__, "psylib was built without SDL_ttf", NULL);
+    return SEE_ERROR_RUNTIME;
+#endif
+
+    font->cache = calloc(CACHE_SIZE, sizeof(PsyTextLayout));
+    if (!font->cache) {
+        set_error(error, __func__, "out of memory", NULL);
+        return SEE_ERROR_RUNTIME;
+    }
+
+    glGenTextures(1, &font->atlas);
+    glBindTexture(GL_TEXTURE_2D, font->atlas);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(
+        GL_TEXTURE_2D, 0,
+        psy_gl_context_is_es() ? GL_LUMINANCE : GL_R8,
+        ATLAS_SIZE, ATLAS_SIZE, 0,
+        psy_gl_context_is_es() ? GL_LUMINANCE : GL_RED,
+        GL_UNSIGNED_BYTE, NULL
+        );
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Most text is ASCII, so rasterize it up front.
+    for (cp = ' '; cp <= '~'; cp++) {
+        ret = get_glyph(font, cp, &glyph, error);
+        if (ret)
+            return ret;
+    }
+
+    return SEE_SUCCESS;
+}
+
+static int
+init(const SeeObjectClass* cls, SeeObject* obj, va_list args)
+{
+    const PsyFontClass* font_cls = PSY_FONT_CLASS(cls);
+    PsyFont* font = PSY_FONT(obj);
+
+    const char* path = va_arg(args, const char*);
+    int pixel_size = va_arg(args, int);
+    SeeError** error = va_arg(args, SeeError**);
+
+    return font_cls->font_init(font, font_cls, path, pixel_size, error);
+}
+
+static void
+destroy(SeeObject* obj)
+{
+    PsyFont* font = PSY_FONT(obj);
+    size_t i;
+
+    if (font->cache) {
+        for (i = 0; i < CACHE_SIZE; i++)
+            free_layout(&font->cache[i]);
+        free(font->cache);
+    }
+    free(font->glyphs);
+
+    if (font->atlas)
+        glDeleteTextures(1, &font->atlas);
+
+#if defined(HAVE_SDL_TTF)
+    if (font->ttf)
+        TTF_CloseFont(font->ttf);
+#endif
+
+    see_object_class()->destroy(obj);
+}
+
+static int
+font_layout(
+    PsyFont*                font,
+    const char*             utf8,
+    const PsyTextLayout**   layout,
+    SeeError**              error
+    )
+{
+    PsyTextLayout* slot = &font->cache[hash_string(utf8) % CACHE_SIZE];
+    int ret;
+
+    if (!slot->key || strcmp(slot->key, utf8) != 0) {
+        free_layout(slot);
+        ret = layout_string(font, utf8, slot, error);
+        if (ret)
+            return ret;
+    }
+
+    *layout = slot;
+    return SEE_SUCCESS;
+}
+
+/* **** implementation of the public API **** */
+
+int
+psy_font_available(void)
+{
+#if defined(HAVE_SDL_TTF)
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+int
+psy_font_create(
+    PsyFont**   font,
+    const char* path,
+    int         pixel_size,
+    SeeError**  error
+    )
+{
+    const PsyFontClass* cls = psy_font_class();
+    const SeeObjectClass* see_cls = SEE_OBJECT_CLASS(cls);
+
+    if (!cls)
+        return SEE_NOT_INITIALIZED;
+
+    if (!font || *font || !path || pixel_size <= 0)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return see_cls->new_obj(
+        see_cls, 0, (SeeObject**) font, path, pixel_size, error
+        );
+}
+
+int
+psy_font_layout(
+    PsyFont*                font,
+    const char*             utf8,
+    const PsyTextLayout**   layout,
+    SeeError**              error
+    )
+{
+    if (!font || !utf8 || !layout || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_FONT_GET_CLASS(font)->layout(font, utf8, layout, error);
+}
+
+GLuint
+psy_font_atlas(const PsyFont* font)
+{
+    return font ? font->atlas : 0;
+}
+
+int
+psy_font_pixel_size(const PsyFont* font)
+{
+    return font ? font->pixel_size : 0;
+}
+
+int
+psy_font_line_height(const PsyFont* font)
+{
+    return font ? font->line_height : 0;
+}
+
+size_t
+psy_font_num_glyphs(const PsyFont* font)
+{
+    return font ? font->num_glyphs : 0;
+}
+
+/* **** initialization of the class **** */
+
+PsyFontClass* g_PsyFontClass = NULL;
+
+static int psy_font_class_init(SeeObjectClass* new_cls) {
+    int ret = SEE_SUCCESS;
+
+    /* Override the functions on the parent here */
+    new_cls->init = init;
+    new_cls->name = "PsyFont";
+    new_cls->destroy = destroy;
+
+    /* Set the function pointers of the own class here */
+    PsyFontClass* cls = (PsyFontClass*) new_cls;
+
+    cls->font_init  = font_init;
+    cls->layout     = font_layout;
+
+    return ret;
+}
+
+/**
+ * \private
+ * \brief this class initializes PsyFont(Class).
+ *
+ * You might want to call this from the library initialization func.
+ */
+int
+psy_font_init() {
+    int ret;
+    const SeeMetaClass* meta = see_meta_class_class();
+
+    ret = see_meta_class_new_class(
+        meta,
+        (SeeObjectClass**) &g_PsyFontClass,
+        sizeof(PsyFontClass),
+        sizeof(PsyFont),
+        see_object_class(),
+        sizeof(SeeObjectClass),
+        psy_font_class_init
+        );
+
+    return ret;
+}
+
+void
+psy_font_deinit()
+{
+    if(!g_PsyFontClass)
+        return;
+
+    see_object_decref((SeeObject*) g_PsyFontClass);
+    g_PsyFontClass = NULL;
+}
+
+const PsyFontClass*
+psy_font_class()
+{
+    return g_PsyFontClass;
+}
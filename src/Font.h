@@ -0,0 +1,231 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file Font.h
+ * \brief Fonts whose glyphs are kept as signed distance fields.
+ *
+ * A PsyFont rasterizes every glyph once, the first time it is used, with
+ * SDL_ttf. The glyph is converted to a signed distance field and stored
+ * in an atlas texture. The distance field can be drawn at any size
+ * without rasterizing the glyph again, see PsyText.
+ *
+ * Laying out a string produces the quads of its glyphs. The layouts are
+ * cached by string, so a word that has been laid out before costs a
+ * lookup. The cache is direct mapped, a string may push another one out.
+ *
+ * psylib needs to be built with SDL_ttf for fonts, without it
+ * psy_font_create() returns an error.
+ */
+
+#ifndef PSY_FONT_H
+#define PSY_FONT_H
+
+#include <stddef.h>
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+
+#include "psy_export.h"
+#include "gl/includes_gl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _PsyFont PsyFont;
+typedef struct _PsyFontClass PsyFontClass;
+
+/**
+ * \brief The quads of a laid out string.
+ *
+ * The coordinates are in pixels of the size the font was rasterized at,
+ * the origin is on the baseline at the left of the first line and y
+ * points up. Every glyph is two triangles, each vertex is x, y, u and v.
+ */
+typedef struct _PsyTextLayout {
+    char*       key;            ///< The string that was laid out.
+    GLfloat*    vertices;       ///< 4 floats per vertex, 6 vertices per glyph
+    size_t      num_vertices;
+    GLfloat     width;          ///< The advance of the longest line.
+    int         num_lines;
+} PsyTextLayout;
+
+struct _PsyFont {
+    SeeObject parent_obj;
+
+    /*expand PsyFont data here*/
+
+    void*                   ttf;        // TTF_Font*
+    int                     pixel_size;
+    int                     spread;
+    int                     ascent;
+    int                     descent;
+    int                     line_height;
+
+    GLuint                  atlas;
+    int                     atlas_size;
+    int                     shelf_x;
+    int                     shelf_y;
+    int                     shelf_height;
+
+    struct _PsyGlyph*       glyphs;
+    size_t                  num_glyphs;
+    size_t                  glyphs_capacity;
+
+    PsyTextLayout*          cache;
+};
+
+struct _PsyFontClass {
+    SeeObjectClass parent_cls;
+
+    int (*font_init)(
+        PsyFont*            font,
+        const PsyFontClass* font_cls,
+        const char*         path,
+        int                 pixel_size,
+        SeeError**          error
+        );
+
+    int (*layout)(
+        PsyFont*                font,
+        const char*             utf8,
+        const PsyTextLayout**   layout,
+        SeeError**              error
+        );
+};
+
+/* **** function style macro casts **** */
+
+/**
+ * \brief cast a pointer from a PsyFont derived instance back to a
+ *        pointer to PsyFont.
+ */
+#define PSY_FONT(obj)                      \
+    ((PsyFont*) obj)
+
+/**
+ * \brief cast a pointer to PsyFontClass derived class back to a
+ *        pointer to PsyFontClass.
+ */
+#define PSY_FONT_CLASS(cls)                      \
+    ((const PsyFontClass*) cls)
+
+/**
+ * \brief obtain a pointer to PsyFontClass from a instance of
+ *        derived from PsyFont.
+ */
+#define PSY_FONT_GET_CLASS(obj)                \
+    (PSY_FONT_CLASS(see_object_get_class(SEE_OBJECT(obj)) ) )
+
+/* **** public functions **** */
+
+/**
+ * \brief Returns non zero when psylib was built with SDL_ttf.
+ */
+PSY_EXPORT int
+psy_font_available(void);
+
+/**
+ * \brief Open a font and rasterize the printable ASCII characters.
+ *
+ * @param [out] font        The new font, should be NULL.
+ * @param [in]  path        A TrueType or OpenType font file.
+ * @param [in]  pixel_size  The size at which the glyphs are rasterized,
+ *                          32 to 64 pixels is plenty for the distance
+ *                          fields to look sharp at any size.
+ * @param [out] error       If an error occurs, it's returned here.
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_font_create(
+    PsyFont**   font,
+    const char* path,
+    int         pixel_size,
+    SeeError**  error
+    );
+
+/**
+ * \brief Lay out a UTF-8 string, or find its layout in the cache.
+ *
+ * Glyphs that haven't been used before are rasterized into the atlas.
+ * Newlines start a new line.
+ *
+ * @param [in]  font
+ * @param [in]  utf8    The string to lay out.
+ * @param [out] layout  The layout, it is owned by the font and valid until
+ *                      the next call to psy_font_layout().
+ * @param [out] error
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_font_layout(
+    PsyFont*                font,
+    const char*             utf8,
+    const PsyTextLayout**   layout,
+    SeeError**              error
+    );
+
+/**
+ * \brief The atlas texture with the distance fields of the glyphs.
+ */
+PSY_EXPORT GLuint
+psy_font_atlas(const PsyFont* font);
+
+/**
+ * \brief The size in pixels at which the glyphs were rasterized.
+ */
+PSY_EXPORT int
+psy_font_pixel_size(const PsyFont* font);
+
+/**
+ * \brief The distance between the baselines of two lines in pixels.
+ */
+PSY_EXPORT int
+psy_font_line_height(const PsyFont* font);
+
+/**
+ * \brief The number of glyphs in the atlas.
+ */
+PSY_EXPORT size_t
+psy_font_num_glyphs(const PsyFont* font);
+
+/**
+ * Gets the pointer to the PsyFontClass table.
+ */
+PSY_EXPORT const PsyFontClass*
+psy_font_class();
+
+/* **** class initialization functions **** */
+
+/**
+ * Initialize PsyFont; make it ready for use.
+ */
+PSY_EXPORT
+int psy_font_init();
+
+/**
+ * Deinitialize PsyFont, after PsyFont has been deinitialized,
+ * all functions in this header shouldn't be used anymore.
+ */
+PSY_EXPORT
+void psy_font_deinit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_FONT_H
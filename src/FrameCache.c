@@ -0,0 +1,489 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include "MetaClass.h"
+#include "Error.h"
+#include "FrameCache.h"
+#include "gl/GLError.h"
+#include "gl/gl_util.h"
+
+/* How long finish waits for a frame before giving up, 1 s. */
+#define WAIT_TIMEOUT_NS 1000000000ull
+
+struct CachedFrame {
+    unsigned        key;
+    int             valid;
+    PsyFramebuffer* fb;
+    GLsync          fence;
+    unsigned long   last_used;
+};
+
+static void
+set_glerror(SeeError** error, const char* func, const char* msg)
+{
+    PsyGLError* glerror = NULL;
+    psy_glerror_create(&glerror);
+    psy_error_printf(PSY_ERROR(glerror), "%s: %s", func, msg);
+    *error = SEE_ERROR(glerror);
+}
+
+static size_t
+frame_size(const PsyFrameCache* cache)
+{
+    return (size_t) cache->width * (size_t) cache->height * 4;
+}
+
+static CachedFrame*
+find_frame(const PsyFrameCache* cache, unsigned key)
+{
+    size_t i;
+
+    for (i = 0; i < cache->num_allocated; i++)
+        if (cache->frames[i].valid && cache->frames[i].key == key)
+            return &cache->frames[i];
+    return NULL;
+}
+
+static void
+delete_fence(CachedFrame* frame)
+{
+    if (frame->fence) {
+        glDeleteSync(frame->fence);
+        frame->fence = NULL;
+    }
+}
+
+/* Finds the frame to render key into, reusing the oldest when full. */
+static CachedFrame*
+frame_for_key(PsyFrameCache* cache, unsigned key, SeeError** error)
+{
+    CachedFrame* frame = find_frame(cache, key);
+    size_t i;
+
+    if (frame)
+        return frame;
+
+    for (i = 0; i < cache->num_allocated; i++)
+        if (!cache->frames[i].valid)
+            return &cache->frames[i];
+
+    if (cache->num_allocated < cache->max_frames) {
+        frame = &cache->frames[cache->num_allocated];
+        if (psy_framebuffer_create(
+                &frame->fb, cache->width, cache->height,
+                PSY_FRAMEBUFFER_RGBA8, 0, error
+                )) {
+            if (frame->fb)
+                see_object_decref(SEE_OBJECT(frame->fb));
+            frame->fb = NULL;
+            return NULL;
+        }
+        psy_framebuffer_set_filter(frame->fb, GL_NEAREST);
+        cache->num_allocated++;
+        return frame;
+    }
+
+    frame = &cache->frames[0];
+    for (i = 1; i < cache->num_allocated; i++)
+        if (cache->frames[i].last_used < frame->last_used)
+            frame = &cache->frames[i];
+    return frame;
+}
+
+/* **** functions that implement PsyFrameCache or override SeeObject **** */
+
+static int
+frame_cache_init(
+    PsyFrameCache*              cache,
+    const PsyFrameCacheClass*   cache_cls,
+    GLsizei                     width,
+    GLsizei                     height,
+    size_t                      budget,
+    SeeError**                  error
+    )
+{
+    const SeeObjectClass* parent_cls = SEE_OBJECT_CLASS(cache_cls);
+
+    parent_cls->object_init(
+        SEE_OBJECT(cache),
+        SEE_OBJECT_CLASS(cache_cls)
+        );
+
+    cache->width = width;
+    cache->height = height;
+    cache->budget = budget;
+    cache->max_frames = budget / frame_size(cache);
+
+    if (cache->max_frames == 0) {
+        PsyError* err = NULL;
+        psy_error_create(&err);
+        psy_error_printf(
+            err, "%s: a budget of %zu bytes doesn't fit a frame of %zu bytes",
+            __func__, budget, frame_size(cache)
+            );
+        *error = SEE_ERROR(err);
+        return SEE_INVALID_ARGUMENT;
+    }
+
+    cache->frames = calloc(cache->max_frames, sizeof(CachedFrame));
+    if (!cache->frames) {
+        set_glerror(error, __func__, "out of memory");
+        return SEE_ERROR_RUNTIME;
+    }
+
+    return SEE_SUCCESS;
+}
+
+static int
+init(const SeeObjectClass* cls, SeeObject* obj, va_list args)
+{
+    const PsyFrameCacheClass* cache_cls = PSY_FRAME_CACHE_CLASS(cls);
+    PsyFrameCache* cache = PSY_FRAME_CACHE(obj);
+
+    GLsizei width = va_arg(args, GLsizei);
+    GLsizei height = va_arg(args, GLsizei);
+    size_t budget = va_arg(args, size_t);
+    SeeError** error = va_arg(args, SeeError**);
+
+    return cache_cls->frame_cache_init(
+        cache, cache_cls, width, height, budget, error
+        );
+}
+
+static void
+destroy(SeeObject* obj)
+{
+    PsyFrameCache* cache = PSY_FRAME_CACHE(obj);
+    size_t i;
+
+    for (i = 0; i < cache->num_allocated; i++) {
+        CachedFrame* frame = &cache->frames[i];
+        delete_fence(frame);
+        if (frame->fb)
+            see_object_decref(SEE_OBJECT(frame->fb));
+    }
+    free(cache->frames);
+
+    see_object_class()->destroy(obj);
+}
+
+static int
+frame_cache_begin(PsyFrameCache* cache, unsigned key, SeeError** error)
+{
+    CachedFrame* frame;
+
+    if (cache->recording) {
+        set_glerror(error, __func__, "the previous frame hasn't ended");
+        return SEE_ERROR_RUNTIME;
+    }
+
+    frame = frame_for_key(cache, key, error);
+    if (!frame)
+        return SEE_ERROR_RUNTIME;
+
+    delete_fence(frame);
+    frame->key = key;
+    frame->valid = 0;
+    cache->recording = frame;
+
+    psy_framebuffer_bind(frame->fb);
+
+    return SEE_SUCCESS;
+}
+
+static int
+frame_cache_end(PsyFrameCache* cache, SeeError** error)
+{
+    CachedFrame* frame = cache->recording;
+
+    if (!frame) {
+        set_glerror(error, __func__, "no frame is being rendered");
+        return SEE_ERROR_RUNTIME;
+    }
+
+    if (psy_gl_has_pixel_buffers())
+        frame->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    // Let the GPU start on the frame now, rather than at the next swap.
+    glFlush();
+
+    psy_framebuffer_unbind(frame->fb);
+
+    frame->valid = 1;
+    frame->last_used = ++cache->tick;
+    cache->recording = NULL;
+
+    if (glGetError() != GL_NO_ERROR) {
+        set_glerror(error, __func__, "rendering the frame failed");
+        return SEE_ERROR_RUNTIME;
+    }
+    return SEE_SUCCESS;
+}
+
+static int
+frame_cache_present(PsyFrameCache* cache, unsigned key, SeeError** error)
+{
+    CachedFrame* frame = find_frame(cache, key);
+
+    if (!frame) {
+        PsyError* err = NULL;
+        psy_error_create(&err);
+        psy_error_printf(err, "%s: frame %u isn't cached", __func__, key);
+        *error = SEE_ERROR(err);
+        return SEE_INVALID_ARGUMENT;
+    }
+    frame->last_used = ++cache->tick;
+
+    return psy_framebuffer_blit(frame->fb, error);
+}
+
+/* **** implementation of the public API **** */
+
+int
+psy_frame_cache_create(
+    PsyFrameCache** cache,
+    GLsizei         width,
+    GLsizei         height,
+    size_t          budget,
+    SeeError**      error
+    )
+{
+    const PsyFrameCacheClass* cls = psy_frame_cache_class();
+    const SeeObjectClass* see_cls = SEE_OBJECT_CLASS(cls);
+
+    if (!cls)
+        return SEE_NOT_INITIALIZED;
+
+    if (!cache || *cache || width <= 0 || height <= 0)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return see_cls->new_obj(
+        see_cls, 0, (SeeObject**) cache, width, height, budget, error
+        );
+}
+
+int
+psy_frame_cache_begin(PsyFrameCache* cache, unsigned key, SeeError** error)
+{
+    if (!cache || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_FRAME_CACHE_GET_CLASS(cache)->begin(cache, key, error);
+}
+
+int
+psy_frame_cache_end(PsyFrameCache* cache, SeeError** error)
+{
+    if (!cache || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_FRAME_CACHE_GET_CLASS(cache)->end(cache, error);
+}
+
+int
+psy_frame_cache_finish(PsyFrameCache* cache, SeeError** error)
+{
+    size_t i;
+
+    if (!cache || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!psy_gl_has_pixel_buffers()) {
+        glFinish();
+        return SEE_SUCCESS;
+    }
+
+    for (i = 0; i < cache->num_allocated; i++) {
+        CachedFrame* frame = &cache->frames[i];
+        GLenum status;
+
+        if (!frame->fence)
+            continue;
+        status = glClientWaitSync(
+            frame->fence, GL_SYNC_FLUSH_COMMANDS_BIT, WAIT_TIMEOUT_NS
+            );
+        delete_fence(frame);
+        if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED) {
+            set_glerror(error, __func__, "waiting for the GPU failed");
+            return SEE_ERROR_RUNTIME;
+        }
+    }
+
+    return SEE_SUCCESS;
+}
+
+int
+psy_frame_cache_present(PsyFrameCache* cache, unsigned key, SeeError** error)
+{
+    if (!cache || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_FRAME_CACHE_GET_CLASS(cache)->present(cache, key, error);
+}
+
+int
+psy_frame_cache_contains(const PsyFrameCache* cache, unsigned key)
+{
+    return cache && find_frame(cache, key) != NULL;
+}
+
+int
+psy_frame_cache_ready(const PsyFrameCache* cache, unsigned key)
+{
+    CachedFrame* frame;
+    GLint status;
+
+    if (!cache)
+        return 0;
+    frame = find_frame(cache, key);
+    if (!frame)
+        return 0;
+    if (!frame->fence)
+        return 1;
+
+    glGetSynciv(frame->fence, GL_SYNC_STATUS, sizeof(status), NULL, &status);
+    if (status != GL_SIGNALED)
+        return 0;
+
+    delete_fence(frame);
+    return 1;
+}
+
+void
+psy_frame_cache_invalidate(PsyFrameCache* cache, unsigned key)
+{
+    CachedFrame* frame;
+
+    if (!cache)
+        return;
+    frame = find_frame(cache, key);
+    if (frame) {
+        delete_fence(frame);
+        frame->valid = 0;
+    }
+}
+
+void
+psy_frame_cache_clear(PsyFrameCache* cache)
+{
+    size_t i;
+
+    if (!cache)
+        return;
+    for (i = 0; i < cache->num_allocated; i++) {
+        delete_fence(&cache->frames[i]);
+        cache->frames[i].valid = 0;
+    }
+}
+
+GLuint
+psy_frame_cache_texture(const PsyFrameCache* cache, unsigned key)
+{
+    const CachedFrame* frame = cache ? find_frame(cache, key) : NULL;
+    return frame ? psy_framebuffer_texture(frame->fb) : 0;
+}
+
+size_t
+psy_frame_cache_size(const PsyFrameCache* cache)
+{
+    size_t i, n = 0;
+
+    if (!cache)
+        return 0;
+    for (i = 0; i < cache->num_allocated; i++)
+        if (cache->frames[i].valid)
+            n++;
+    return n;
+}
+
+size_t
+psy_frame_cache_capacity(const PsyFrameCache* cache)
+{
+    return cache ? cache->max_frames : 0;
+}
+
+size_t
+psy_frame_cache_memory_used(const PsyFrameCache* cache)
+{
+    return cache ? cache->num_allocated * frame_size(cache) : 0;
+}
+
+/* **** initialization of the class **** */
+
+PsyFrameCacheClass* g_PsyFrameCacheClass = NULL;
+
+static int psy_frame_cache_class_init(SeeObjectClass* new_cls) {
+    int ret = SEE_SUCCESS;
+
+    /* Override the functions on the parent here */
+    new_cls->init = init;
+    new_cls->name = "PsyFrameCache";
+    new_cls->destroy = destroy;
+
+    /* Set the function pointers of the own class here */
+    PsyFrameCacheClass* cls = (PsyFrameCacheClass*) new_cls;
+
+    cls->frame_cache_init   = frame_cache_init;
+    cls->begin              = frame_cache_begin;
+    cls->end                = frame_cache_end;
+    cls->present            = frame_cache_present;
+
+    return ret;
+}
+
+/**
+ * \private
+ * \brief this class initializes PsyFrameCache(Class).
+ *
+ * You might want to call this from the library initialization func.
+ */
+int
+psy_frame_cache_init() {
+    int ret;
+    const SeeMetaClass* meta = see_meta_class_class();
+
+    ret = see_meta_class_new_class(
+        meta,
+        (SeeObjectClass**) &g_PsyFrameCacheClass,
+        sizeof(PsyFrameCacheClass),
+        sizeof(PsyFrameCache),
+        see_object_class(),
+        sizeof(SeeObjectClass),
+        psy_frame_cache_class_init
+        );
+
+    return ret;
+}
+
+void
+psy_frame_cache_deinit()
+{
+    if(!g_PsyFrameCacheClass)
+        return;
+
+    see_object_decref((SeeObject*) g_PsyFrameCacheClass);
+    g_PsyFrameCacheClass = NULL;
+}
+
+const PsyFrameCacheClass*
+psy_frame_cache_class()
+{
+    return g_PsyFrameCacheClass;
+}
@@ -0,0 +1,270 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file FrameCache.h
+ * \brief Renders the critical frames of a trial ahead of time.
+ *
+ * The frames of a trial that must be on time, e.g. a prime of one frame
+ * followed by a mask, may be expensive to draw. A PsyFrameCache renders
+ * them during the interval between the trials into textures of offscreen
+ * framebuffers. At the onset of a frame, psy_frame_cache_present() only
+ * copies the texture to the screen, so the time to draw the stimulus no
+ * longer competes with the deadline of the frame.
+ *
+ * Frames are identified by a key that the experiment chooses, e.g. the
+ * number of the frame within a trial. The cache holds as many frames as
+ * fit in its memory budget. When a new frame doesn't fit, the framebuffer
+ * of the frame that was used longest ago is reused, so a cache that is
+ * large enough for the frames of one trial doesn't allocate after the
+ * first trial.
+ *
+ * \code
+ * // during the inter trial interval
+ * psy_frame_cache_begin(cache, PRIME, &error);
+ * draw_prime();
+ * psy_frame_cache_end(cache, &error);
+ * psy_frame_cache_begin(cache, MASK, &error);
+ * draw_mask();
+ * psy_frame_cache_end(cache, &error);
+ * psy_frame_cache_finish(cache, &error);
+ *
+ * // at the onsets
+ * psy_frame_cache_present(cache, PRIME, &error);
+ * psy_window_swap(window);
+ * psy_frame_cache_present(cache, MASK, &error);
+ * psy_window_swap(window);
+ * \endcode
+ */
+
+#ifndef PSY_FRAME_CACHE_H
+#define PSY_FRAME_CACHE_H
+
+#include <stddef.h>
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+
+#include "psy_export.h"
+#include "Framebuffer.h"
+#include "gl/includes_gl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _PsyFrameCache PsyFrameCache;
+typedef struct _PsyFrameCacheClass PsyFrameCacheClass;
+
+/* A frame in the cache, these are private to FrameCache.c. */
+typedef struct CachedFrame CachedFrame;
+
+struct _PsyFrameCache {
+    SeeObject parent_obj;
+
+    /*expand PsyFrameCache data here*/
+
+    GLsizei             width;
+    GLsizei             height;
+    size_t              budget;
+
+    CachedFrame*        frames;
+    size_t              max_frames; // as many as fit in the budget
+    size_t              num_allocated;
+    unsigned long       tick;
+
+    CachedFrame*        recording;  // the frame between begin and end
+};
+
+struct _PsyFrameCacheClass {
+    SeeObjectClass parent_cls;
+
+    int (*frame_cache_init)(
+        PsyFrameCache*              cache,
+        const PsyFrameCacheClass*   cache_cls,
+        GLsizei                     width,
+        GLsizei                     height,
+        size_t                      budget,
+        SeeError**                  error
+        );
+
+    int (*begin)(PsyFrameCache* cache, unsigned key, SeeError** error);
+
+    int (*end)(PsyFrameCache* cache, SeeError** error);
+
+    int (*present)(PsyFrameCache* cache, unsigned key, SeeError** error);
+};
+
+/* **** function style macro casts **** */
+
+/**
+ * \brief cast a pointer from a PsyFrameCache derived instance back to a
+ *        pointer to PsyFrameCache.
+ */
+#define PSY_FRAME_CACHE(obj)                      \
+    ((PsyFrameCache*) obj)
+
+/**
+ * \brief cast a pointer to PsyFrameCacheClass derived class back to a
+ *        pointer to PsyFrameCacheClass.
+ */
+#define PSY_FRAME_CACHE_CLASS(cls)                      \
+    ((const PsyFrameCacheClass*) cls)
+
+/**
+ * \brief obtain a pointer to PsyFrameCacheClass from a instance of
+ *        derived from PsyFrameCache.
+ */
+#define PSY_FRAME_CACHE_GET_CLASS(obj)                \
+    (PSY_FRAME_CACHE_CLASS(see_object_get_class(SEE_OBJECT(obj)) ) )
+
+/* **** public functions **** */
+
+/**
+ * \brief Create a frame cache.
+ *
+ * @param [out] cache   The new cache, should be NULL.
+ * @param [in]  width   The width of the frames in pixels, typically the
+ *                      width of the window.
+ * @param [in]  height  The height of the frames in pixels.
+ * @param [in]  budget  The number of bytes the frames may use, a frame
+ *                      uses 4 bytes per pixel.
+ * @param [out] error   If an error occurs, it's returned here.
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_frame_cache_create(
+    PsyFrameCache** cache,
+    GLsizei         width,
+    GLsizei         height,
+    size_t          budget,
+    SeeError**      error
+    );
+
+/**
+ * \brief Start rendering the frame with key.
+ *
+ * Until psy_frame_cache_end(), everything is drawn into the frame, the
+ * viewport covers the frame. A frame that was cached with key before is
+ * replaced. The frame starts with the contents it had, so clear it.
+ */
+PSY_EXPORT int
+psy_frame_cache_begin(PsyFrameCache* cache, unsigned key, SeeError** error);
+
+/**
+ * \brief Finish rendering a frame, the framebuffer and the viewport of
+ * before psy_frame_cache_begin() are restored.
+ */
+PSY_EXPORT int
+psy_frame_cache_end(PsyFrameCache* cache, SeeError** error);
+
+/**
+ * \brief Wait until the GPU has rendered all frames.
+ *
+ * Call this at the end of the inter trial interval, so that presenting
+ * the frames doesn't wait for them.
+ */
+PSY_EXPORT int
+psy_frame_cache_finish(PsyFrameCache* cache, SeeError** error);
+
+/**
+ * \brief Copy the frame with key to the bound framebuffer.
+ *
+ * The frame is copied to the rectangle from (0, 0) to (width, height),
+ * without blending.
+ *
+ * @return SEE_SUCCESS, or SEE_INVALID_ARGUMENT when the frame isn't
+ *         cached, e.g. because it was evicted.
+ */
+PSY_EXPORT int
+psy_frame_cache_present(PsyFrameCache* cache, unsigned key, SeeError** error);
+
+/**
+ * \brief Returns non zero when the frame with key is cached.
+ */
+PSY_EXPORT int
+psy_frame_cache_contains(const PsyFrameCache* cache, unsigned key);
+
+/**
+ * \brief Returns non zero when the frame with key is cached and the GPU
+ * has finished rendering it.
+ */
+PSY_EXPORT int
+psy_frame_cache_ready(const PsyFrameCache* cache, unsigned key);
+
+/**
+ * \brief Remove the frame with key, its framebuffer is kept for reuse.
+ */
+PSY_EXPORT void
+psy_frame_cache_invalidate(PsyFrameCache* cache, unsigned key);
+
+/**
+ * \brief Remove all frames, the framebuffers are kept for reuse.
+ */
+PSY_EXPORT void
+psy_frame_cache_clear(PsyFrameCache* cache);
+
+/**
+ * \brief The texture that holds the frame with key, 0 when it isn't
+ * cached.
+ */
+PSY_EXPORT GLuint
+psy_frame_cache_texture(const PsyFrameCache* cache, unsigned key);
+
+/**
+ * \brief The number of frames in the cache.
+ */
+PSY_EXPORT size_t
+psy_frame_cache_size(const PsyFrameCache* cache);
+
+/**
+ * \brief The number of frames that fit in the budget.
+ */
+PSY_EXPORT size_t
+psy_frame_cache_capacity(const PsyFrameCache* cache);
+
+/**
+ * \brief The number of bytes used by the framebuffers.
+ */
+PSY_EXPORT size_t
+psy_frame_cache_memory_used(const PsyFrameCache* cache);
+
+/**
+ * Gets the pointer to the PsyFrameCacheClass table.
+ */
+PSY_EXPORT const PsyFrameCacheClass*
+psy_frame_cache_class();
+
+/* **** class initialization functions **** */
+
+/**
+ * Initialize PsyFrameCache; make it ready for use.
+ */
+PSY_EXPORT
+int psy_frame_cache_init();
+
+/**
+ * Deinitialize PsyFrameCache, after PsyFrameCache has been deinitialized,
+ * all functions in this header shouldn't be used anymore.
+ */
+PSY_EXPORT
+void psy_frame_cache_deinit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_FRAME_CACHE_H
@@ -0,0 +1,506 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MetaClass.h"
+#include "Error.h"
+#include "Framebuffer.h"
+#include "gl/GLError.h"
+#include "gl/gl_util.h"
+
+static const GLfloat g_quad[4][2] = {
+    {-1.0f, -1.0f}, {1.0f, -1.0f}, {-1.0f, 1.0f}, {1.0f, 1.0f}
+};
+
+static void
+set_glerror(SeeError** error, const char* func, const char* msg)
+{
+    PsyGLError* glerror = NULL;
+    psy_glerror_create(&glerror);
+    psy_error_printf(PSY_ERROR(glerror), "%s: %s", func, msg);
+    *error = SEE_ERROR(glerror);
+}
+
+static int
+has_blit(void)
+{
+    return GLAD_GL_VERSION_3_0 && !psy_gl_context_is_es();
+}
+
+static size_t
+bytes_per_pixel(PsyFramebufferFormat format)
+{
+    switch (format) {
+        case PSY_FRAMEBUFFER_RGBA8:     return 4;
+        case PSY_FRAMEBUFFER_RGBA16F:   return 8;
+        case PSY_FRAMEBUFFER_RGBA32F:   return 16;
+    }
+    return 4;
+}
+
+/* (Re)allocates the attachments for the current size. */
+static int
+allocate_storage(PsyFramebuffer* fb, SeeError** error)
+{
+    GLint prev_texture, prev_fbo;
+    GLint internal_format = GL_RGBA;
+    GLenum type = GL_UNSIGNED_BYTE;
+    GLenum status;
+    int es = psy_gl_context_is_es();
+
+    switch (fb->format) {
+        case PSY_FRAMEBUFFER_RGBA8:
+            internal_format = es ? GL_RGBA : GL_RGBA8;
+            break;
+        case PSY_FRAMEBUFFER_RGBA16F:
+            internal_format = GL_RGBA16F;
+            type = GL_HALF_FLOAT;
+            break;
+        case PSY_FRAMEBUFFER_RGBA32F:
+            internal_format = GL_RGBA32F;
+            type = GL_FLOAT;
+            break;
+    }
+    if (type != GL_UNSIGNED_BYTE && (es || !GLAD_GL_VERSION_3_0)) {
+        set_glerror(error, __func__, "float framebuffers need OpenGL 3.0");
+        return SEE_INVALID_ARGUMENT;
+    }
+
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_texture);
+    glBindTexture(GL_TEXTURE_2D, fb->texture);
+    glTexImage2D(
+        GL_TEXTURE_2D, 0, internal_format, fb->width, fb->height, 0,
+        GL_RGBA, type, NULL
+        );
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (GLint) fb->filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (GLint) fb->filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, (GLuint) prev_texture);
+
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prev_fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fb->fbo);
+    glFramebufferTexture2D(
+        GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, fb->texture, 0
+        );
+    if (fb->has_depth) {
+        glBindRenderbuffer(GL_RENDERBUFFER, fb->depth);
+        glRenderbufferStorage(
+            GL_RENDERBUFFER,
+            es ? GL_DEPTH_COMPONENT16 : GL_DEPTH_COMPONENT24,
+            fb->width,
+            fb->height
+            );
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        glFramebufferRenderbuffer(
+            GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, fb->depth
+            );
+    }
+    status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint) prev_fbo);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        set_glerror(error, __func__, "the framebuffer is incomplete");
+        return SEE_ERROR_RUNTIME;
+    }
+    return SEE_SUCCESS;
+}
+
+/* **** functions that implement PsyFramebuffer or override SeeObject **** */
+
+static int
+framebuffer_init(
+    PsyFramebuffer*             fb,
+    const PsyFramebufferClass*  fb_cls,
+    GLsizei                     width,
+    GLsizei                     height,
+    PsyFramebufferFormat        format,
+    int                         depth,
+    SeeError**                  error
+    )
+{
+    const SeeObjectClass* parent_cls = SEE_OBJECT_CLASS(fb_cls);
+
+    parent_cls->object_init(
+        SEE_OBJECT(fb),
+        SEE_OBJECT_CLASS(fb_cls)
+        );
+
+    fb->width = width;
+    fb->height = height;
+    fb->format = format;
+    fb->has_depth = depth != 0;
+    fb->filter = GL_LINEAR;
+
+    glGenTextures(1, &fb->texture);
+    glGenFramebuffers(1, &fb->fbo);
+    if (fb->has_depth)
+        glGenRenderbuffers(1, &fb->depth);
+
+    return allocate_storage(fb, error);
+}
+
+static int
+init(const SeeObjectClass* cls, SeeObject* obj, va_list args)
+{
+    const PsyFramebufferClass* fb_cls = PSY_FRAMEBUFFER_CLASS(cls);
+    PsyFramebuffer* fb = PSY_FRAMEBUFFER(obj);
+
+    GLsizei width = va_arg(args, GLsizei);
+    GLsizei height = va_arg(args, GLsizei);
+    PsyFramebufferFormat format = va_arg(args, PsyFramebufferFormat);
+    int depth = va_arg(args, int);
+    SeeError** error = va_arg(args, SeeError**);
+
+    return fb_cls->framebuffer_init(
+        fb, fb_cls, width, height, format, depth, error
+        );
+}
+
+static void
+destroy(SeeObject* obj)
+{
+    PsyFramebuffer* fb = PSY_FRAMEBUFFER(obj);
+
+    if (fb->fbo)
+        glDeleteFramebuffers(1, &fb->fbo);
+    if (fb->texture)
+        glDeleteTextures(1, &fb->texture);
+    if (fb->depth)
+        glDeleteRenderbuffers(1, &fb->depth);
+    if (fb->quad_vbo)
+        glDeleteBuffers(1, &fb->quad_vbo);
+    if (fb->blit_program)
+        see_object_decref(SEE_OBJECT(fb->blit_program));
+
+    see_object_class()->destroy(obj);
+}
+
+static int
+framebuffer_resize(
+    PsyFramebuffer* fb,
+    GLsizei         width,
+    GLsizei         height,
+    SeeError**      error
+    )
+{
+    if (fb->bound) {
+        set_glerror(error, __func__, "the framebuffer is bound");
+        return SEE_ERROR_RUNTIME;
+    }
+    if (width == fb->width && height == fb->height)
+        return SEE_SUCCESS;
+
+    fb->width = width;
+    fb->height = height;
+    return allocate_storage(fb, error);
+}
+
+static void
+framebuffer_bind(PsyFramebuffer* fb)
+{
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &fb->prev_fbo);
+    glGetIntegerv(GL_VIEWPORT, fb->prev_viewport);
+    fb->bound = 1;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, fb->fbo);
+    glViewport(0, 0, fb->width, fb->height);
+}
+
+static void
+framebuffer_unbind(PsyFramebuffer* fb)
+{
+    if (!fb->bound)
+        return;
+    fb->bound = 0;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint) fb->prev_fbo);
+    glViewport(
+        fb->prev_viewport[0],
+        fb->prev_viewport[1],
+        fb->prev_viewport[2],
+        fb->prev_viewport[3]
+        );
+}
+
+static int
+framebuffer_blit(PsyFramebuffer* fb, SeeError** error)
+{
+    GLint location, viewport[4];
+    GLboolean blend;
+    int ret;
+
+    if (has_blit()) {
+        GLint read_fbo;
+
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &read_fbo);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fb->fbo);
+        glBlitFramebuffer(
+            0, 0, fb->width, fb->height,
+            0, 0, fb->width, fb->height,
+            GL_COLOR_BUFFER_BIT, GL_NEAREST
+            );
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, (GLuint) read_fbo);
+        return SEE_SUCCESS;
+    }
+
+    // Without glBlitFramebuffer the texture is drawn.
+    if (!fb->blit_program) {
+        ret = psy_shader_program_create_builtin(
+            &fb->blit_program, "blit", "blit", error
+            );
+        if (ret)
+            return ret;
+        glGenBuffers(1, &fb->quad_vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, fb->quad_vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(g_quad), g_quad, GL_STATIC_DRAW);
+    }
+
+    ret = psy_shader_use_program(fb->blit_program, error);
+    if (ret)
+        return ret;
+    glUniform1i(psy_shader_program_uniform_location(fb->blit_program, "u_texture"), 0);
+    psy_gl_bind_texture(0, GL_TEXTURE_2D, fb->texture);
+
+    location = psy_shader_program_attribute_location(fb->blit_program, "a_position");
+    glBindBuffer(GL_ARRAY_BUFFER, fb->quad_vbo);
+    if (location >= 0) {
+        glEnableVertexAttribArray((GLuint) location);
+        glVertexAttribPointer((GLuint) location, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    }
+
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    blend = glIsEnabled(GL_BLEND);
+    glViewport(0, 0, fb->width, fb->height);
+    glDisable(GL_BLEND);
+
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    psy_gl_disable_attributes(&location, 1);
+    if (blend)
+        glEnable(GL_BLEND);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return SEE_SUCCESS;
+}
+
+/* **** implementation of the public API **** */
+
+int
+psy_framebuffer_create(
+    PsyFramebuffer**        fb,
+    GLsizei                 width,
+    GLsizei                 height,
+    PsyFramebufferFormat    format,
+    int                     depth,
+    SeeError**              error
+    )
+{
+    const PsyFramebufferClass* cls = psy_framebuffer_class();
+    const SeeObjectClass* see_cls = SEE_OBJECT_CLASS(cls);
+
+    if (!cls)
+        return SEE_NOT_INITIALIZED;
+
+    if (!fb || *fb || width <= 0 || height <= 0)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return see_cls->new_obj(
+        see_cls, 0, (SeeObject**) fb, width, height, format, depth, error
+        );
+}
+
+int
+psy_framebuffer_resize(
+    PsyFramebuffer* fb,
+    GLsizei         width,
+    GLsizei         height,
+    SeeError**      error
+    )
+{
+    if (!fb || width <= 0 || height <= 0 || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_FRAMEBUFFER_GET_CLASS(fb)->resize(fb, width, height, error);
+}
+
+void
+psy_framebuffer_bind(PsyFramebuffer* fb)
+{
+    if (fb)
+        PSY_FRAMEBUFFER_GET_CLASS(fb)->bind(fb);
+}
+
+void
+psy_framebuffer_unbind(PsyFramebuffer* fb)
+{
+    if (fb)
+        PSY_FRAMEBUFFER_GET_CLASS(fb)->unbind(fb);
+}
+
+int
+psy_framebuffer_blit(PsyFramebuffer* fb, SeeError** error)
+{
+    if (!fb || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_FRAMEBUFFER_GET_CLASS(fb)->blit(fb, error);
+}
+
+int
+psy_framebuffer_read(PsyFramebuffer* fb, unsigned char* pixels, SeeError** error)
+{
+    GLint prev_fbo;
+
+    if (!fb || !pixels || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    // GL_RGBA and GL_UNSIGNED_BYTE are the format OpenGL ES always reads.
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prev_fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fb->fbo);
+    glReadPixels(0, 0, fb->width, fb->height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint) prev_fbo);
+
+    if (glGetError() != GL_NO_ERROR) {
+        set_glerror(error, __func__, "unable to read the framebuffer");
+        return SEE_ERROR_RUNTIME;
+    }
+    return SEE_SUCCESS;
+}
+
+GLuint
+psy_framebuffer_texture(const PsyFramebuffer* fb)
+{
+    return fb ? fb->texture : 0;
+}
+
+void
+psy_framebuffer_set_filter(PsyFramebuffer* fb, GLenum filter)
+{
+    GLint prev_texture;
+
+    if (!fb)
+        return;
+    fb->filter = filter;
+
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &prev_texture);
+    glBindTexture(GL_TEXTURE_2D, fb->texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (GLint) filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (GLint) filter);
+    glBindTexture(GL_TEXTURE_2D, (GLuint) prev_texture);
+}
+
+GLuint
+psy_framebuffer_id(const PsyFramebuffer* fb)
+{
+    return fb ? fb->fbo : 0;
+}
+
+void
+psy_framebuffer_size(const PsyFramebuffer* fb, int* width, int* height)
+{
+    if (!fb)
+        return;
+    if (width)
+        *width = fb->width;
+    if (height)
+        *height = fb->height;
+}
+
+PsyFramebufferFormat
+psy_framebuffer_format(const PsyFramebuffer* fb)
+{
+    return fb ? fb->format : PSY_FRAMEBUFFER_RGBA8;
+}
+
+size_t
+psy_framebuffer_memory_used(const PsyFramebuffer* fb)
+{
+    size_t pixels;
+
+    if (!fb)
+        return 0;
+    pixels = (size_t) fb->width * (size_t) fb->height;
+    return pixels * bytes_per_pixel(fb->format) + (fb->has_depth ? pixels * 4 : 0);
+}
+
+/* **** initialization of the class **** */
+
+PsyFramebufferClass* g_PsyFramebufferClass = NULL;
+
+static int psy_framebuffer_class_init(SeeObjectClass* new_cls) {
+    int ret = SEE_SUCCESS;
+
+    /* Override the functions on the parent here */
+    new_cls->init = init;
+    new_cls->name = "PsyFramebuffer";
+    new_cls->destroy = destroy;
+
+    /* Set the function pointers of the own class here */
+    PsyFramebufferClass* cls = (PsyFramebufferClass*) new_cls;
+
+    cls->framebuffer_init   = framebuffer_init;
+    cls->resize             = framebuffer_resize;
+    cls->bind               = framebuffer_bind;
+    cls->unbind             = framebuffer_unbind;
+    cls->blit               = framebuffer_blit;
+
+    return ret;
+}
+
+/**
+ * \private
+ * \brief this class initializes PsyFramebuffer(Class).
+ *
+ * You might want to call this from the library initialization func.
+ */
+int
+psy_framebuffer_init() {
+    int ret;
+    const SeeMetaClass* meta = see_meta_class_class();
+
+    ret = see_meta_class_new_class(
+        meta,
+        (SeeObjectClass**) &g_PsyFramebufferClass,
+        sizeof(PsyFramebufferClass),
+        sizeof(PsyFramebuffer),
+        see_object_class(),
+        sizeof(SeeObjectClass),
+        psy_framebuffer_class_init
+        );
+
+    return ret;
+}
+
+void
+psy_framebuffer_deinit()
+{
+    if(!g_PsyFramebufferClass)
+        return;
+
+    see_object_decref((SeeObject*) g_PsyFramebufferClass);
+    g_PsyFramebufferClass = NULL;
+}
+
+const PsyFramebufferClass*
+psy_framebuffer_class()
+{
+    return g_PsyFramebufferClass;
+}
@@ -0,0 +1,271 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file Framebuffer.h
+ * \brief A render target with a texture as color attachment.
+ *
+ * A PsyFramebuffer wraps an OpenGL framebuffer object whose color
+ * attachment is a texture, optionally with a depth attachment. Between
+ * psy_framebuffer_bind() and psy_framebuffer_unbind() everything is drawn
+ * into the texture; afterwards the texture can be used by a shader or the
+ * contents copied to the screen with psy_framebuffer_blit().
+ *
+ * \code
+ * psy_framebuffer_bind(fb);
+ * glClear(GL_COLOR_BUFFER_BIT);
+ * draw_stimulus();
+ * psy_framebuffer_unbind(fb);
+ * psy_framebuffer_blit(fb, &error);
+ * \endcode
+ */
+
+#ifndef PSY_FRAMEBUFFER_H
+#define PSY_FRAMEBUFFER_H
+
+#include <stddef.h>
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+
+#include "psy_export.h"
+#include "ShaderProgram.h"
+#include "gl/includes_gl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _PsyFramebuffer PsyFramebuffer;
+typedef struct _PsyFramebufferClass PsyFramebufferClass;
+
+/**
+ * \brief The format of the color attachment.
+ */
+typedef enum {
+    PSY_FRAMEBUFFER_RGBA8,      ///< 8 bits per channel, always available.
+    PSY_FRAMEBUFFER_RGBA16F,    ///< Half floats, not on OpenGL ES 2.0.
+    PSY_FRAMEBUFFER_RGBA32F     ///< Floats, not on OpenGL ES 2.0.
+} PsyFramebufferFormat;
+
+struct _PsyFramebuffer {
+    SeeObject parent_obj;
+
+    /*expand PsyFramebuffer data here*/
+
+    GLsizei                 width;
+    GLsizei                 height;
+    PsyFramebufferFormat    format;
+    int                     has_depth;
+    GLenum                  filter;
+
+    GLuint                  fbo;
+    GLuint                  texture;
+    GLuint                  depth;
+
+    int                     bound;
+    GLint                   prev_fbo;
+    GLint                   prev_viewport[4];
+
+    PsyShaderProgram*       blit_program;   // without glBlitFramebuffer
+    GLuint                  quad_vbo;
+};
+
+struct _PsyFramebufferClass {
+    SeeObjectClass parent_cls;
+
+    int (*framebuffer_init)(
+        PsyFramebuffer*             fb,
+        const PsyFramebufferClass*  fb_cls,
+        GLsizei                     width,
+        GLsizei                     height,
+        PsyFramebufferFormat        format,
+        int                         depth,
+        SeeError**                  error
+        );
+
+    int (*resize)(
+        PsyFramebuffer* fb,
+        GLsizei         width,
+        GLsizei         height,
+        SeeError**      error
+        );
+
+    void (*bind)(PsyFramebuffer* fb);
+
+    void (*unbind)(PsyFramebuffer* fb);
+
+    int (*blit)(PsyFramebuffer* fb, SeeError** error);
+};
+
+/* **** function style macro casts **** */
+
+/**
+ * \brief cast a pointer from a PsyFramebuffer derived instance back to a
+ *        pointer to PsyFramebuffer.
+ */
+#define PSY_FRAMEBUFFER(obj)                      \
+    ((PsyFramebuffer*) obj)
+
+/**
+ * \brief cast a pointer to PsyFramebufferClass derived class back to a
+ *        pointer to PsyFramebufferClass.
+ */
+#define PSY_FRAMEBUFFER_CLASS(cls)                      \
+    ((const PsyFramebufferClass*) cls)
+
+/**
+ * \brief obtain a pointer to PsyFramebufferClass from a instance of
+ *        derived from PsyFramebuffer.
+ */
+#define PSY_FRAMEBUFFER_GET_CLASS(obj)                \
+    (PSY_FRAMEBUFFER_CLASS(see_object_get_class(SEE_OBJECT(obj)) ) )
+
+/* **** public functions **** */
+
+/**
+ * \brief Create a framebuffer.
+ *
+ * @param [out] fb      The new framebuffer, should be NULL.
+ * @param [in]  width   The width in pixels.
+ * @param [in]  height  The height in pixels.
+ * @param [in]  format  The format of the color texture.
+ * @param [in]  depth   Non zero to add a depth buffer.
+ * @param [out] error   If an error occurs, it's returned here.
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_framebuffer_create(
+    PsyFramebuffer**        fb,
+    GLsizei                 width,
+    GLsizei                 height,
+    PsyFramebufferFormat    format,
+    int                     depth,
+    SeeError**              error
+    );
+
+/**
+ * \brief Change the size, the contents are lost.
+ */
+PSY_EXPORT int
+psy_framebuffer_resize(
+    PsyFramebuffer* fb,
+    GLsizei         width,
+    GLsizei         height,
+    SeeError**      error
+    );
+
+/**
+ * \brief Draw into the framebuffer, the viewport covers it.
+ *
+ * The framebuffer and viewport that were set, are remembered for
+ * psy_framebuffer_unbind().
+ */
+PSY_EXPORT void
+psy_framebuffer_bind(PsyFramebuffer* fb);
+
+/**
+ * \brief Restore the framebuffer and viewport of before
+ * psy_framebuffer_bind().
+ */
+PSY_EXPORT void
+psy_framebuffer_unbind(PsyFramebuffer* fb);
+
+/**
+ * \brief Copy the contents to the bound framebuffer.
+ *
+ * The contents are copied to the rectangle from (0, 0) to (width, height)
+ * without blending. OpenGL 3.0 uses glBlitFramebuffer, OpenGL ES 2.0 draws
+ * the texture.
+ */
+PSY_EXPORT int
+psy_framebuffer_blit(PsyFramebuffer* fb, SeeError** error);
+
+/**
+ * \brief Read the color attachment as RGBA bytes, rows from bottom to
+ * top.
+ *
+ * @param [in]  fb
+ * @param [out] pixels  width * height * 4 bytes.
+ * @param [out] error
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_framebuffer_read(PsyFramebuffer* fb, unsigned char* pixels, SeeError** error);
+
+/**
+ * \brief The name of the color texture.
+ */
+PSY_EXPORT GLuint
+psy_framebuffer_texture(const PsyFramebuffer* fb);
+
+/**
+ * \brief Set the minification and magnification filter of the color
+ * texture, GL_LINEAR by default.
+ */
+PSY_EXPORT void
+psy_framebuffer_set_filter(PsyFramebuffer* fb, GLenum filter);
+
+/**
+ * \brief The name of the framebuffer object.
+ */
+PSY_EXPORT GLuint
+psy_framebuffer_id(const PsyFramebuffer* fb);
+
+/**
+ * \brief Obtain the size in pixels.
+ */
+PSY_EXPORT void
+psy_framebuffer_size(const PsyFramebuffer* fb, int* width, int* height);
+
+/**
+ * \brief The format of the color texture.
+ */
+PSY_EXPORT PsyFramebufferFormat
+psy_framebuffer_format(const PsyFramebuffer* fb);
+
+/**
+ * \brief The number of bytes the attachments use.
+ */
+PSY_EXPORT size_t
+psy_framebuffer_memory_used(const PsyFramebuffer* fb);
+
+/**
+ * Gets the pointer to the PsyFramebufferClass table.
+ */
+PSY_EXPORT const PsyFramebufferClass*
+psy_framebuffer_class();
+
+/* **** class initialization functions **** */
+
+/**
+ * Initialize PsyFramebuffer; make it ready for use.
+ */
+PSY_EXPORT
+int psy_framebuffer_init();
+
+/**
+ * Deinitialize PsyFramebuffer, after PsyFramebuffer has been deinitialized,
+ * all functions in this header shouldn't be used anymore.
+ */
+PSY_EXPORT
+void psy_framebuffer_deinit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_FRAMEBUFFER_H
@@ -0,0 +1,432 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "MetaClass.h"
+#include "Error.h"
+#include "GpuTimer.h"
+#include "gl/gl_util.h"
+
+#define QUERIES_PER_FRAME (2 * PSY_GPU_TIMER_MAX_RECORDS)
+
+struct GpuRecord {
+    int     scope;
+    int     ended;
+};
+
+struct GpuFrame {
+    GpuRecord   records[PSY_GPU_TIMER_MAX_RECORDS];
+    size_t      num_records;
+};
+
+static void
+set_error(SeeError** error, const char* func, const char* msg)
+{
+    PsyError* err = NULL;
+    psy_error_create(&err);
+    psy_error_printf(err, "%s: %s", func, msg);
+    *error = SEE_ERROR(err);
+}
+
+static GLuint
+begin_query(const PsyGpuTimer* timer, unsigned frame, size_t record)
+{
+    return timer->queries[frame * QUERIES_PER_FRAME + 2 * record];
+}
+
+static GLuint
+end_query(const PsyGpuTimer* timer, unsigned frame, size_t record)
+{
+    return timer->queries[frame * QUERIES_PER_FRAME + 2 * record + 1];
+}
+
+/* Adds the durations of a frame whose queries the GPU should have done. */
+static void
+collect(PsyGpuTimer* timer, unsigned frame)
+{
+    GpuFrame* gpu_frame = &timer->frames[frame];
+    size_t i;
+
+    for (i = 0; i < gpu_frame->num_records; i++) {
+        const GpuRecord* record = &gpu_frame->records[i];
+        PsyGpuTimerStats* stats = &timer->scopes[record->scope];
+        GLuint64 begin, end;
+        GLint available = 0;
+        PsyTime duration;
+
+        if (!record->ended)
+            continue;
+
+        glGetQueryObjectiv(
+            end_query(timer, frame, i), GL_QUERY_RESULT_AVAILABLE, &available
+            );
+        if (!available) {
+            timer->dropped++;
+            continue;
+        }
+        glGetQueryObjectui64v(begin_query(timer, frame, i), GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(end_query(timer, frame, i), GL_QUERY_RESULT, &end);
+
+        duration = (PsyTime) (end - begin);
+        stats->count++;
+        stats->last = duration;
+        stats->total += duration;
+        if (duration > stats->max)
+            stats->max = duration;
+    }
+    gpu_frame->num_records = 0;
+}
+
+/* **** functions that implement PsyGpuTimer or override SeeObject **** */
+
+static int
+gpu_timer_init(
+    PsyGpuTimer*            timer,
+    const PsyGpuTimerClass* timer_cls,
+    SeeError**              error
+    )
+{
+    const SeeObjectClass* parent_cls = SEE_OBJECT_CLASS(timer_cls);
+    size_t num_queries = PSY_GPU_TIMER_FRAMES * QUERIES_PER_FRAME;
+
+    parent_cls->object_init(
+        SEE_OBJECT(timer),
+        SEE_OBJECT_CLASS(timer_cls)
+        );
+
+    timer->supported = psy_gl_has_timer_queries();
+    if (!timer->supported)
+        return SEE_SUCCESS;
+
+    timer->frames = calloc(PSY_GPU_TIMER_FRAMES, sizeof(GpuFrame));
+    timer->queries = calloc(num_queries, sizeof(GLuint));
+    if (!timer->frames || !timer->queries) {
+        set_error(error, __func__, "out of memory");
+        return SEE_ERROR_RUNTIME;
+    }
+    glGenQueries((GLsizei) num_queries, timer->queries);
+
+    return SEE_SUCCESS;
+}
+
+static int
+init(const SeeObjectClass* cls, SeeObject* obj, va_list args)
+{
+    const PsyGpuTimerClass* timer_cls = PSY_GPU_TIMER_CLASS(cls);
+    PsyGpuTimer* timer = PSY_GPU_TIMER(obj);
+
+    SeeError** error = va_arg(args, SeeError**);
+
+    return timer_cls->gpu_timer_init(timer, timer_cls, error);
+}
+
+static void
+destroy(SeeObject* obj)
+{
+    PsyGpuTimer* timer = PSY_GPU_TIMER(obj);
+    size_t i;
+
+    if (timer->queries) {
+        glDeleteQueries(
+            PSY_GPU_TIMER_FRAMES * QUERIES_PER_FRAME, timer->queries
+            );
+        free(timer->queries);
+    }
+    free(timer->frames);
+    for (i = 0; i < timer->num_scopes; i++)
+        free(timer->scopes[i].name);
+    free(timer->scopes);
+
+    see_object_class()->destroy(obj);
+}
+
+static void
+gpu_timer_begin(PsyGpuTimer* timer, int scope)
+{
+    GpuFrame* frame;
+    GpuRecord* record;
+
+    if (!timer->supported)
+        return;
+
+    frame = &timer->frames[timer->frame];
+    if (frame->num_records == PSY_GPU_TIMER_MAX_RECORDS) {
+        timer->dropped++;
+        return;
+    }
+
+    record = &frame->records[frame->num_records];
+    record->scope = scope;
+    record->ended = 0;
+    glQueryCounter(
+        begin_query(timer, timer->frame, frame->num_records), GL_TIMESTAMP
+        );
+    frame->num_records++;
+}
+
+static void
+gpu_timer_end(PsyGpuTimer* timer, int scope)
+{
+    GpuFrame* frame;
+    size_t i;
+
+    if (!timer->supported)
+        return;
+
+    // The innermost open record of the scope, scopes may nest.
+    frame = &timer->frames[timer->frame];
+    for (i = frame->num_records; i > 0; i--) {
+        GpuRecord* record = &frame->records[i - 1];
+        if (record->scope == scope && !record->ended) {
+            glQueryCounter(end_query(timer, timer->frame, i - 1), GL_TIMESTAMP);
+            record->ended = 1;
+            return;
+        }
+    }
+}
+
+static void
+gpu_timer_next_frame(PsyGpuTimer* timer)
+{
+    if (!timer->supported)
+        return;
+
+    // The oldest frame in the ring is reused, its results are read first.
+    timer->frame = (timer->frame + 1) % PSY_GPU_TIMER_FRAMES;
+    collect(timer, timer->frame);
+}
+
+/* **** implementation of the public API **** */
+
+int
+psy_gpu_timer_create(PsyGpuTimer** timer, SeeError** error)
+{
+    const PsyGpuTimerClass* cls = psy_gpu_timer_class();
+    const SeeObjectClass* see_cls = SEE_OBJECT_CLASS(cls);
+
+    if (!cls)
+        return SEE_NOT_INITIALIZED;
+
+    if (!timer || *timer)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return see_cls->new_obj(see_cls, 0, (SeeObject**) timer, error);
+}
+
+int
+psy_gpu_timer_supported(const PsyGpuTimer* timer)
+{
+    return timer ? timer->supported : 0;
+}
+
+int
+psy_gpu_timer_scope(
+    PsyGpuTimer*    timer,
+    const char*     name,
+    int*            scope,
+    SeeError**      error
+    )
+{
+    PsyGpuTimerStats* stats;
+    size_t i, size;
+
+    if (!timer || !name || !scope || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    for (i = 0; i < timer->num_scopes; i++) {
+        if (strcmp(timer->scopes[i].name, name) == 0) {
+            *scope = (int) i;
+            return SEE_SUCCESS;
+        }
+    }
+
+    if (timer->num_scopes == timer->capacity) {
+        size_t capacity = timer->capacity ? timer->capacity * 2 : 16;
+        stats = realloc(timer->scopes, capacity * sizeof(PsyGpuTimerStats));
+        if (!stats) {
+            set_error(error, __func__, "out of memory");
+            return SEE_ERROR_RUNTIME;
+        }
+        timer->scopes = stats;
+        timer->capacity = capacity;
+    }
+
+    stats = &timer->scopes[timer->num_scopes];
+    memset(stats, 0, sizeof(*stats));
+    size = strlen(name) + 1;
+    stats->name = malloc(size);
+    if (!stats->name) {
+        set_error(error, __func__, "out of memory");
+        return SEE_ERROR_RUNTIME;
+    }
+    memcpy(stats->name, name, size);
+
+    *scope = (int) timer->num_scopes++;
+    return SEE_SUCCESS;
+}
+
+void
+psy_gpu_timer_begin(PsyGpuTimer* timer, int scope)
+{
+    if (!timer || scope < 0 || (size_t) scope >= timer->num_scopes)
+        return;
+    PSY_GPU_TIMER_GET_CLASS(timer)->begin(timer, scope);
+}
+
+void
+psy_gpu_timer_end(PsyGpuTimer* timer, int scope)
+{
+    if (!timer || scope < 0 || (size_t) scope >= timer->num_scopes)
+        return;
+    PSY_GPU_TIMER_GET_CLASS(timer)->end(timer, scope);
+}
+
+void
+psy_gpu_timer_next_frame(PsyGpuTimer* timer)
+{
+    if (!timer)
+        return;
+    PSY_GPU_TIMER_GET_CLASS(timer)->next_frame(timer);
+}
+
+size_t
+psy_gpu_timer_num_scopes(const PsyGpuTimer* timer)
+{
+    return timer ? timer->num_scopes : 0;
+}
+
+const PsyGpuTimerStats*
+psy_gpu_timer_stats(const PsyGpuTimer* timer, int scope)
+{
+    if (!timer || scope < 0 || (size_t) scope >= timer->num_scopes)
+        return NULL;
+    return &timer->scopes[scope];
+}
+
+void
+psy_gpu_timer_reset_stats(PsyGpuTimer* timer)
+{
+    size_t i;
+
+    if (!timer)
+        return;
+    for (i = 0; i < timer->num_scopes; i++) {
+        PsyGpuTimerStats* stats = &timer->scopes[i];
+        stats->count = 0;
+        stats->last = stats->total = stats->max = 0;
+    }
+    timer->dropped = 0;
+}
+
+uint64_t
+psy_gpu_timer_dropped(const PsyGpuTimer* timer)
+{
+    return timer ? timer->dropped : 0;
+}
+
+void
+psy_gpu_timer_print_stats(const PsyGpuTimer* timer, FILE* out)
+{
+    size_t i;
+
+    if (!timer || !out)
+        return;
+
+    fprintf(out, "name,count,last_ms,mean_ms,max_ms\n");
+    for (i = 0; i < timer->num_scopes; i++) {
+        const PsyGpuTimerStats* stats = &timer->scopes[i];
+        double mean = stats->count ?
+            psy_time_seconds(stats->total) / (double) stats->count : 0.0;
+
+        fprintf(
+            out,
+            "%s,%llu,%.4f,%.4f,%.4f\n",
+            stats->name,
+            (unsigned long long) stats->count,
+            psy_time_seconds(stats->last) * 1000.0,
+            mean * 1000.0,
+            psy_time_seconds(stats->max) * 1000.0
+            );
+    }
+}
+
+/* **** initialization of the class **** */
+
+PsyGpuTimerClass* g_PsyGpuTimerClass = NULL;
+
+static int psy_gpu_timer_class_init(SeeObjectClass* new_cls) {
+    int ret = SEE_SUCCESS;
+
+    /* Override the functions on the parent here */
+    new_cls->init = init;
+    new_cls->name = "PsyGpuTimer";
+    new_cls->destroy = destroy;
+
+    /* Set the function pointers of the own class here */
+    PsyGpuTimerClass* cls = (PsyGpuTimerClass*) new_cls;
+
+    cls->gpu_timer_init = gpu_timer_init;
+    cls->begin          = gpu_timer_begin;
+    cls->end            = gpu_timer_end;
+    cls->next_frame     = gpu_timer_next_frame;
+
+    return ret;
+}
+
+/**
+ * \private
+ * \brief this class initializes PsyGpuTimer(Class).
+ *
+ * You might want to call this from the library initialization func.
+ */
+int
+psy_gpu_timer_init() {
+    int ret;
+    const SeeMetaClass* meta = see_meta_class_class();
+
+    ret = see_meta_class_new_class(
+        meta,
+        (SeeObjectClass**) &g_PsyGpuTimerClass,
+        sizeof(PsyGpuTimerClass),
+        sizeof(PsyGpuTimer),
+        see_object_class(),
+        sizeof(SeeObjectClass),
+        psy_gpu_timer_class_init
+        );
+
+    return ret;
+}
+
+void
+psy_gpu_timer_deinit()
+{
+    if(!g_PsyGpuTimerClass)
+        return;
+
+    see_object_decref((SeeObject*) g_PsyGpuTimerClass);
+    g_PsyGpuTimerClass = NULL;
+}
+
+const PsyGpuTimerClass*
+psy_gpu_timer_class()
+{
+    return g_PsyGpuTimerClass;
+}
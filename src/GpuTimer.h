@@ -0,0 +1,254 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file GpuTimer.h
+ * \brief Measures how long the GPU spends on stimuli and passes.
+ *
+ * A draw call returns long before the GPU has done the work, so timing it
+ * on the CPU says little. A PsyGpuTimer places GL_TIMESTAMP queries
+ * around the draws of a scope, e.g. a stimulus or a post processing pass,
+ * and reads them back a few frames later when the GPU has finished them,
+ * so measuring never makes the CPU wait for the GPU. The durations are
+ * gathered per scope, see psy_gpu_timer_stats().
+ *
+ * A PsyDisplayList and a PsyPostChain time their items and passes when
+ * they're given a timer, psy_window_set_gpu_timing() does this for the
+ * display list of a window.
+ *
+ * Timer queries need desktop OpenGL 3.3. Elsewhere, e.g. OpenGL ES on the
+ * Raspberry Pi, a timer can be created, but it doesn't measure anything,
+ * see psy_gpu_timer_supported().
+ */
+
+#ifndef PSY_GPU_TIMER_H
+#define PSY_GPU_TIMER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+
+#include "psy_export.h"
+#include "Time.h"
+#include "gl/includes_gl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The number of frames the results lag behind. */
+#define PSY_GPU_TIMER_FRAMES 4
+
+/** The number of scopes that can be timed per frame. */
+#define PSY_GPU_TIMER_MAX_RECORDS 256
+
+typedef struct _PsyGpuTimer PsyGpuTimer;
+typedef struct _PsyGpuTimerClass PsyGpuTimerClass;
+
+/**
+ * \brief The durations of a scope on the GPU in nanoseconds.
+ */
+typedef struct {
+    char*       name;
+    uint64_t    count;      ///< The number of durations measured.
+    PsyTime     last;
+    PsyTime     total;      ///< Divide by count for the mean.
+    PsyTime     max;
+} PsyGpuTimerStats;
+
+/* A begin and end query of a scope, these are private to GpuTimer.c. */
+typedef struct GpuRecord GpuRecord;
+
+/* The records of one frame, these are private to GpuTimer.c. */
+typedef struct GpuFrame GpuFrame;
+
+struct _PsyGpuTimer {
+    SeeObject parent_obj;
+
+    /*expand PsyGpuTimer data here*/
+
+    int                 supported;
+    GLuint*             queries;    // 2 per record per frame
+    GpuFrame*           frames;     // a ring of PSY_GPU_TIMER_FRAMES
+    unsigned            frame;      // the frame that's recorded now
+
+    PsyGpuTimerStats*   scopes;
+    size_t              num_scopes;
+    size_t              capacity;
+
+    uint64_t            dropped;    // frame full or result not in time
+};
+
+struct _PsyGpuTimerClass {
+    SeeObjectClass parent_cls;
+
+    int (*gpu_timer_init)(
+        PsyGpuTimer*            timer,
+        const PsyGpuTimerClass* timer_cls,
+        SeeError**              error
+        );
+
+    void (*begin)(PsyGpuTimer* timer, int scope);
+
+    void (*end)(PsyGpuTimer* timer, int scope);
+
+    void (*next_frame)(PsyGpuTimer* timer);
+};
+
+/* **** function style macro casts **** */
+
+/**
+ * \brief cast a pointer from a PsyGpuTimer derived instance back to a
+ *        pointer to PsyGpuTimer.
+ */
+#define PSY_GPU_TIMER(obj)                      \
+    ((PsyGpuTimer*) obj)
+
+/**
+ * \brief cast a pointer to PsyGpuTimerClass derived class back to a
+ *        pointer to PsyGpuTimerClass.
+ */
+#define PSY_GPU_TIMER_CLASS(cls)                      \
+    ((const PsyGpuTimerClass*) cls)
+
+/**
+ * \brief obtain a pointer to PsyGpuTimerClass from a instance of
+ *        derived from PsyGpuTimer.
+ */
+#define PSY_GPU_TIMER_GET_CLASS(obj)                \
+    (PSY_GPU_TIMER_CLASS(see_object_get_class(SEE_OBJECT(obj)) ) )
+
+/* **** public functions **** */
+
+/**
+ * \brief Create a timer, the queries belong to the current context.
+ */
+PSY_EXPORT int
+psy_gpu_timer_create(PsyGpuTimer** timer, SeeError** error);
+
+/**
+ * \brief Returns non zero when the timer measures.
+ */
+PSY_EXPORT int
+psy_gpu_timer_supported(const PsyGpuTimer* timer);
+
+/**
+ * \brief Obtain the id of the scope with name, it's added when it's new.
+ *
+ * Look the id up once and keep it, rather than every frame.
+ *
+ * @param [in]  timer
+ * @param [in]  name    The name of the scope, it's copied.
+ * @param [out] scope   The id of the scope.
+ * @param [out] error
+ */
+PSY_EXPORT int
+psy_gpu_timer_scope(
+    PsyGpuTimer*    timer,
+    const char*     name,
+    int*            scope,
+    SeeError**      error
+    );
+
+/**
+ * \brief Start timing the draws of scope.
+ *
+ * Scopes may be nested, each begin needs an end in the same frame.
+ */
+PSY_EXPORT void
+psy_gpu_timer_begin(PsyGpuTimer* timer, int scope);
+
+/**
+ * \brief Stop timing the draws of scope.
+ */
+PSY_EXPORT void
+psy_gpu_timer_end(PsyGpuTimer* timer, int scope);
+
+/**
+ * \brief Finish the frame.
+ *
+ * Call it once per frame, e.g. after swapping the buffers. The results of
+ * the frame PSY_GPU_TIMER_FRAMES - 1 frames ago are read back. The results
+ * that still aren't available then are dropped rather than waited for.
+ */
+PSY_EXPORT void
+psy_gpu_timer_next_frame(PsyGpuTimer* timer);
+
+/**
+ * \brief The number of scopes.
+ */
+PSY_EXPORT size_t
+psy_gpu_timer_num_scopes(const PsyGpuTimer* timer);
+
+/**
+ * \brief Obtain the durations of a scope.
+ *
+ * @return The statistics or NULL when there is no such scope.
+ */
+PSY_EXPORT const PsyGpuTimerStats*
+psy_gpu_timer_stats(const PsyGpuTimer* timer, int scope);
+
+/**
+ * \brief Clear the durations of all scopes, the scopes remain.
+ */
+PSY_EXPORT void
+psy_gpu_timer_reset_stats(PsyGpuTimer* timer);
+
+/**
+ * \brief The number of scopes that weren't measured, because there were
+ * too many in a frame or the GPU was too far behind.
+ */
+PSY_EXPORT uint64_t
+psy_gpu_timer_dropped(const PsyGpuTimer* timer);
+
+/**
+ * \brief Write the durations of the scopes as CSV.
+ *
+ * There is one line per scope with the name, the count and the last, mean
+ * and maximum duration in milliseconds.
+ */
+PSY_EXPORT void
+psy_gpu_timer_print_stats(const PsyGpuTimer* timer, FILE* out);
+
+/**
+ * Gets the pointer to the PsyGpuTimerClass table.
+ */
+PSY_EXPORT const PsyGpuTimerClass*
+psy_gpu_timer_class();
+
+/* **** class initialization functions **** */
+
+/**
+ * Initialize PsyGpuTimer; make it ready for use.
+ */
+PSY_EXPORT
+int psy_gpu_timer_init();
+
+/**
+ * Deinitialize PsyGpuTimer, after PsyGpuTimer has been deinitialized,
+ * all functions in this header shouldn't be used anymore.
+ */
+PSY_EXPORT
+void psy_gpu_timer_deinit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_GPU_TIMER_H
@@ -0,0 +1,567 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "MetaClass.h"
+#include "Grating.h"
+#include "gl/GLError.h"
+#include "gl/gl_util.h"
+
+/*
+ * The attributes of one stimulus as they are uploaded, see grating.vert.
+ */
+typedef struct _GratingInstance {
+    GLfloat geometry[4];    // x, y, size, orientation
+    GLfloat wave[4];        // frequency, phase, contrast, sigma
+    GLfloat extra[3];       // plaid angle, segments, kind
+} GratingInstance;
+
+/*
+ * Without instancing every corner of the quad carries the attributes of
+ * its stimulus.
+ */
+typedef struct _GratingVertex {
+    GLfloat         corner[2];
+    GratingInstance instance;
+} GratingVertex;
+
+#define VERTICES_PER_QUAD 6
+
+static const GLfloat g_quad[VERTICES_PER_QUAD][2] = {
+    {-0.5f, -0.5f}, { 0.5f, -0.5f}, { 0.5f,  0.5f},
+    {-0.5f, -0.5f}, { 0.5f,  0.5f}, {-0.5f,  0.5f}
+};
+
+static const GLfloat g_identity[16] = {
+    1.0f, 0.0f, 0.0f, 0.0f,
+    0.0f, 1.0f, 0.0f, 0.0f,
+    0.0f, 0.0f, 1.0f, 0.0f,
+    0.0f, 0.0f, 0.0f, 1.0f
+};
+
+static GLfloat
+radians(GLfloat degrees)
+{
+    return degrees * (GLfloat) (M_PI / 180.0);
+}
+
+static void
+set_out_of_memory(SeeError** error, const char* func)
+{
+    PsyGLError* glerror = NULL;
+    psy_glerror_create(&glerror);
+    psy_error_printf(PSY_ERROR(glerror), "%s: out of memory", func);
+    *error = SEE_ERROR(glerror);
+}
+
+static void
+set_attribute(
+    const PsyGrating*   grating,
+    const char*         name,
+    GLint               size,
+    GLsizei             stride,
+    size_t              offset,
+    int                 divisor
+    )
+{
+    GLint location = psy_shader_program_attribute_location(
+        grating->program, name
+        );
+    if (location < 0)
+        return;
+    glEnableVertexAttribArray((GLuint) location);
+    glVertexAttribPointer(
+        (GLuint) location,
+        size,
+        GL_FLOAT,
+        GL_FALSE,
+        stride,
+        (const void*) offset
+        );
+    if (divisor)
+        glVertexAttribDivisor((GLuint) location, (GLuint) divisor);
+}
+
+/*
+ * Points the per stimulus attributes into the bound GL_ARRAY_BUFFER.
+ */
+static void
+set_instance_attributes(
+    const PsyGrating*   grating,
+    GLsizei             stride,
+    size_t              offset,
+    int                 divisor
+    )
+{
+    set_attribute(
+        grating, "a_geometry", 4, stride,
+        offset + offsetof(GratingInstance, geometry), divisor
+        );
+    set_attribute(
+        grating, "a_wave", 4, stride,
+        offset + offsetof(GratingInstance, wave), divisor
+        );
+    set_attribute(
+        grating, "a_extra", 3, stride,
+        offset + offsetof(GratingInstance, extra), divisor
+        );
+}
+
+/* Disables the arrays upload_expanded() enabled, without a vao they leak. */
+static void
+disable_attributes(const PsyGrating* grating)
+{
+    const char* names[] = {"a_corner", "a_geometry", "a_wave", "a_extra"};
+    GLint locations[4];
+
+    for (size_t i = 0; i < 4; i++)
+        locations[i] = psy_shader_program_attribute_location(
+            grating->program, names[i]
+            );
+    psy_gl_disable_attributes(locations, 4);
+}
+
+/*
+ * Orphans the bound GL_ARRAY_BUFFER and makes sure it can hold size bytes.
+ */
+static void
+reserve_buffer(PsyGrating* grating, GLsizeiptr size)
+{
+    if (size > grating->instance_vbo_size)
+        grating->instance_vbo_size = size;
+    glBufferData(
+        GL_ARRAY_BUFFER, grating->instance_vbo_size, NULL, GL_STREAM_DRAW
+        );
+}
+
+/* **** functions that implement PsyGrating or override SeeObject **** */
+
+static int
+grating_init(
+    PsyGrating*             grating,
+    const PsyGratingClass*  grating_cls,
+    SeeError**              error
+    )
+{
+    int ret;
+    const SeeObjectClass* parent_cls = SEE_OBJECT_CLASS(grating_cls);
+
+    parent_cls->object_init(
+        SEE_OBJECT(grating),
+        SEE_OBJECT_CLASS(grating_cls)
+        );
+
+    for (int i = 0; i < 3; i++) {
+        grating->mean[i] = 0.5f;
+        grating->amplitude[i] = 0.5f;
+    }
+    grating->mean[3] = 1.0f;
+    grating->amplitude[3] = 0.0f;
+
+    grating->instanced = psy_gl_has_instancing();
+
+    ret = psy_shader_program_create_builtin(
+        &grating->program,
+        "grating",
+        "grating",
+        error
+        );
+    if (ret)
+        return ret;
+
+    if (psy_gl_has_vertex_arrays()) {
+        glGenVertexArrays(1, &grating->vao);
+        glBindVertexArray(grating->vao);
+    }
+
+    glGenBuffers(1, &grating->instance_vbo);
+
+    if (grating->instanced) {
+        glGenBuffers(1, &grating->quad_vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, grating->quad_vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(g_quad), g_quad, GL_STATIC_DRAW);
+        set_attribute(grating, "a_corner", 2, 0, 0, 0);
+
+        glBindBuffer(GL_ARRAY_BUFFER, grating->instance_vbo);
+        set_instance_attributes(grating, sizeof(GratingInstance), 0, 1);
+    }
+
+    if (grating->vao)
+        glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return SEE_SUCCESS;
+}
+
+static int
+init(const SeeObjectClass* cls, SeeObject* obj, va_list args)
+{
+    const PsyGratingClass* grating_cls = PSY_GRATING_CLASS(cls);
+    PsyGrating* grating = PSY_GRATING(obj);
+
+    SeeError** error = va_arg(args, SeeError**);
+
+    return grating_cls->grating_init(grating, grating_cls, error);
+}
+
+static void
+destroy(SeeObject* obj)
+{
+    PsyGrating* grating = PSY_GRATING(obj);
+
+    if (grating->vao)
+        glDeleteVertexArrays(1, &grating->vao);
+    if (grating->quad_vbo)
+        glDeleteBuffers(1, &grating->quad_vbo);
+    if (grating->instance_vbo)
+        glDeleteBuffers(1, &grating->instance_vbo);
+
+    free(grating->instances);
+    free(grating->vertices);
+
+    if (grating->program)
+        see_object_decref(SEE_OBJECT(grating->program));
+
+    see_object_class()->destroy(obj);
+}
+
+static int
+grating_add(
+    PsyGrating*                 grating,
+    const PsyGratingParameters* parameters,
+    size_t                      num_parameters,
+    SeeError**                  error
+    )
+{
+    size_t needed = grating->num_instances + num_parameters;
+    GratingInstance* instance;
+
+    if (needed > grating->capacity) {
+        size_t new_capacity = grating->capacity ? grating->capacity : 16;
+        void* new_instances;
+
+        while (new_capacity < needed)
+            new_capacity *= 2;
+
+        new_instances = realloc(
+            grating->instances,
+            new_capacity * sizeof(GratingInstance)
+            );
+        if (!new_instances) {
+            set_out_of_memory(error, __func__);
+            return SEE_ERROR_RUNTIME;
+        }
+        grating->instances = new_instances;
+        grating->capacity = new_capacity;
+    }
+
+    instance = (GratingInstance*) grating->instances + grating->num_instances;
+    for (size_t i = 0; i < num_parameters; i++, instance++) {
+        const PsyGratingParameters* p = &parameters[i];
+
+        instance->geometry[0] = p->x;
+        instance->geometry[1] = p->y;
+        instance->geometry[2] = p->size;
+        instance->geometry[3] = radians(p->orientation);
+        instance->wave[0]     = p->frequency;
+        instance->wave[1]     = radians(p->phase);
+        instance->wave[2]     = p->contrast;
+        instance->wave[3]     = p->sigma;
+        instance->extra[0]    = radians(p->plaid_angle);
+        instance->extra[1]    = p->segments;
+        instance->extra[2]    = (GLfloat) p->kind;
+    }
+    grating->num_instances = needed;
+
+    return SEE_SUCCESS;
+}
+
+static void
+grating_clear(PsyGrating* grating)
+{
+    grating->num_instances = 0;
+}
+
+/*
+ * Expands every stimulus into VERTICES_PER_QUAD vertices, this is used
+ * when instancing isn't available.
+ */
+static int
+upload_expanded(PsyGrating* grating, SeeError** error)
+{
+    size_t num_vertices = grating->num_instances * VERTICES_PER_QUAD;
+    const GratingInstance* instances = grating->instances;
+    GratingVertex* vertex;
+
+    if (num_vertices > grating->vertices_capacity) {
+        void* new_vertices = realloc(
+            grating->vertices,
+            num_vertices * sizeof(GratingVertex)
+            );
+        if (!new_vertices) {
+            set_out_of_memory(error, __func__);
+            return SEE_ERROR_RUNTIME;
+        }
+        grating->vertices = new_vertices;
+        grating->vertices_capacity = num_vertices;
+    }
+
+    vertex = grating->vertices;
+    for (size_t i = 0; i < grating->num_instances; i++) {
+        for (size_t c = 0; c < VERTICES_PER_QUAD; c++, vertex++) {
+            vertex->corner[0] = g_quad[c][0];
+            vertex->corner[1] = g_quad[c][1];
+            vertex->instance = instances[i];
+        }
+    }
+
+    reserve_buffer(grating, (GLsizeiptr) (num_vertices * sizeof(GratingVertex)));
+    glBufferSubData(
+        GL_ARRAY_BUFFER,
+        0,
+        (GLsizeiptr) (num_vertices * sizeof(GratingVertex)),
+        grating->vertices
+        );
+
+    set_attribute(
+        grating, "a_corner", 2, sizeof(GratingVertex),
+        offsetof(GratingVertex, corner), 0
+        );
+    set_instance_attributes(
+        grating, sizeof(GratingVertex), offsetof(GratingVertex, instance), 0
+        );
+
+    return SEE_SUCCESS;
+}
+
+static int
+grating_draw(
+    PsyGrating*     grating,
+    const GLfloat*  transform,
+    SeeError**      error
+    )
+{
+    const PsyShaderProgram* program = grating->program;
+    GLsizei count = (GLsizei) grating->num_instances;
+    int ret;
+
+    if (count == 0)
+        return SEE_SUCCESS;
+
+    ret = psy_shader_use_program(program, error);
+    if (ret)
+        return ret;
+
+    glUniformMatrix4fv(
+        psy_shader_program_uniform_location(program, "u_transform"),
+        1,
+        GL_FALSE,
+        transform ? transform : g_identity
+        );
+    glUniform4fv(
+        psy_shader_program_uniform_location(program, "u_mean"),
+        1,
+        grating->mean
+        );
+    glUniform4fv(
+        psy_shader_program_uniform_location(program, "u_amplitude"),
+        1,
+        grating->amplitude
+        );
+
+    if (grating->vao)
+        glBindVertexArray(grating->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, grating->instance_vbo);
+
+    if (grating->instanced) {
+        reserve_buffer(
+            grating, (GLsizeiptr) (count * sizeof(GratingInstance))
+            );
+        glBufferSubData(
+            GL_ARRAY_BUFFER,
+            0,
+            (GLsizeiptr) (count * sizeof(GratingInstance)),
+            grating->instances
+            );
+        glDrawArraysInstanced(GL_TRIANGLES, 0, VERTICES_PER_QUAD, count);
+    }
+    else {
+        ret = upload_expanded(grating, error);
+        if (ret == SEE_SUCCESS)
+            glDrawArrays(GL_TRIANGLES, 0, count * VERTICES_PER_QUAD);
+    }
+
+    if (!grating->vao)
+        disable_attributes(grating);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return ret;
+}
+
+/* **** implementation of the public API **** */
+
+int
+psy_grating_create(PsyGrating** grating, SeeError** error)
+{
+    const PsyGratingClass* cls = psy_grating_class();
+    const SeeObjectClass* see_cls = SEE_OBJECT_CLASS(cls);
+
+    if (!cls)
+        return SEE_NOT_INITIALIZED;
+
+    if (!grating || *grating)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return see_cls->new_obj(see_cls, 0, (SeeObject**) grating, error);
+}
+
+int
+psy_grating_add(
+    PsyGrating*                 grating,
+    const PsyGratingParameters* parameters,
+    size_t                      num_parameters,
+    SeeError**                  error
+    )
+{
+    if (!grating || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+    if (num_parameters && !parameters)
+        return SEE_INVALID_ARGUMENT;
+
+    for (size_t i = 0; i < num_parameters; i++) {
+        if (parameters[i].kind > PSY_GRATING_RADIAL_CHECKERBOARD)
+            return SEE_INVALID_ARGUMENT;
+    }
+
+    return PSY_GRATING_GET_CLASS(grating)->add(
+        grating,
+        parameters,
+        num_parameters,
+        error
+        );
+}
+
+void
+psy_grating_clear(PsyGrating* grating)
+{
+    if (!grating)
+        return;
+    PSY_GRATING_GET_CLASS(grating)->clear(grating);
+}
+
+size_t
+psy_grating_size(const PsyGrating* grating)
+{
+    return grating ? grating->num_instances : 0;
+}
+
+void
+psy_grating_set_colors(
+    PsyGrating*     grating,
+    const GLfloat   mean[4],
+    const GLfloat   amplitude[4]
+    )
+{
+    if (!grating)
+        return;
+    if (mean)
+        memcpy(grating->mean, mean, sizeof(grating->mean));
+    if (amplitude)
+        memcpy(grating->amplitude, amplitude, sizeof(grating->amplitude));
+}
+
+int
+psy_grating_draw(
+    PsyGrating*     grating,
+    const GLfloat*  transform,
+    SeeError**      error
+    )
+{
+    if (!grating || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_GRATING_GET_CLASS(grating)->draw(grating, transform, error);
+}
+
+/* **** initialization of the class **** */
+
+PsyGratingClass* g_PsyGratingClass = NULL;
+
+static int psy_grating_class_init(SeeObjectClass* new_cls) {
+    int ret = SEE_SUCCESS;
+
+    /* Override the functions on the parent here */
+    new_cls->init = init;
+    new_cls->name = "PsyGrating";
+    new_cls->destroy = destroy;
+
+    /* Set the function pointers of the own class here */
+    PsyGratingClass* cls = (PsyGratingClass*) new_cls;
+
+    cls->grating_init   = grating_init;
+    cls->add            = grating_add;
+    cls->clear          = grating_clear;
+    cls->draw           = grating_draw;
+
+    return ret;
+}
+
+/**
+ * \private
+ * \brief this class initializes PsyGrating(Class).
+ *
+ * You might want to call this from the library initialization func.
+ */
+int
+psy_grating_init() {
+    int ret;
+    const SeeMetaClass* meta = see_meta_class_class();
+
+    ret = see_meta_class_new_class(
+        meta,
+        (SeeObjectClass**) &g_PsyGratingClass,
+        sizeof(PsyGratingClass),
+        sizeof(PsyGrating),
+        see_object_class(),
+        sizeof(SeeObjectClass),
+        psy_grating_class_init
+        );
+
+    return ret;
+}
+
+void
+psy_grating_deinit()
+{
+    if(!g_PsyGratingClass)
+        return;
+
+    see_object_decref((SeeObject*) g_PsyGratingClass);
+    g_PsyGratingClass = NULL;
+}
+
+const PsyGratingClass*
+psy_grating_class()
+{
+    return g_PsyGratingClass;
+}
@@ -0,0 +1,258 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file Grating.h
+ * \brief Procedural gratings, Gabor patches, plaids and checkerboards.
+ *
+ * The stimuli of a PsyGrating are evaluated in a fragment shader on a
+ * single quad each, hence nothing has to be precomputed in textures.
+ * All stimuli that are added to a PsyGrating are drawn with one instanced
+ * draw call, which makes arrays of Gabor patches cheap. On OpenGL ES 2.0
+ * the instances are expanded on the CPU, and they're still drawn with one
+ * draw call.
+ */
+
+#ifndef PSY_GRATING_H
+#define PSY_GRATING_H
+
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+
+#include "ShaderProgram.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _PsyGrating PsyGrating;
+typedef struct _PsyGratingClass PsyGratingClass;
+
+/**
+ * \brief The kinds of procedural stimuli.
+ */
+typedef enum {
+    PSY_GRATING_SINE,               ///< A sine wave grating.
+    PSY_GRATING_SQUARE,             ///< A square wave grating.
+    PSY_GRATING_GABOR,              ///< A sine wave in a gaussian envelope.
+    PSY_GRATING_PLAID,              ///< The sum of two sine wave gratings.
+    PSY_GRATING_RADIAL_CHECKERBOARD ///< Rings times wedges, in a circle.
+} PsyGratingKind;
+
+/**
+ * \brief The parameters of one stimulus.
+ *
+ * The luminance of a grating varies along the x-axis of the stimulus, so
+ * with an orientation of 0 the bars are vertical. Distances are in the
+ * units of the coordinates that are mapped by the transform of
+ * psy_grating_draw().
+ */
+typedef struct _PsyGratingParameters {
+    PsyGratingKind  kind;           ///< The kind of stimulus.
+    GLfloat         x;              ///< The x-coordinate of the center.
+    GLfloat         y;              ///< The y-coordinate of the center.
+    GLfloat         size;           ///< The width and height of the quad.
+    GLfloat         orientation;    ///< Degrees counter clockwise.
+    GLfloat         frequency;      ///< Cycles per unit.
+    GLfloat         phase;          ///< The phase in degrees.
+    GLfloat         contrast;       ///< The Michelson contrast in [0, 1].
+    /**
+     * \brief The standard deviation of the gaussian envelope. A value
+     * <= 0 disables the envelope. A PSY_GRATING_GABOR needs a sigma > 0,
+     * for the other kinds the envelope is optional.
+     */
+    GLfloat         sigma;
+    GLfloat         plaid_angle;    ///< The angle between the components.
+    GLfloat         segments;       ///< The number of wedges of a checkerboard.
+} PsyGratingParameters;
+
+struct _PsyGrating {
+    SeeObject parent_obj;
+
+    /*expand PsyGrating data here*/
+
+    PsyShaderProgram*   program;
+    GLuint              vao;
+    GLuint              quad_vbo;
+    GLuint              instance_vbo;
+    GLsizeiptr          instance_vbo_size;
+    int                 instanced;
+    GLfloat             mean[4];
+    GLfloat             amplitude[4];
+
+    void*               instances;
+    size_t              num_instances;
+    size_t              capacity;
+
+    void*               vertices;   // the expanded instances without instancing
+    size_t              vertices_capacity;
+};
+
+struct _PsyGratingClass {
+    SeeObjectClass parent_cls;
+
+    int (*grating_init)(
+        PsyGrating*             grating,
+        const PsyGratingClass*  grating_cls,
+        SeeError**              error
+        );
+
+    int (*add)(
+        PsyGrating*                 grating,
+        const PsyGratingParameters* parameters,
+        size_t                      num_parameters,
+        SeeError**                  error
+        );
+
+    void (*clear)(PsyGrating* grating);
+
+    int (*draw)(
+        PsyGrating*     grating,
+        const GLfloat*  transform,
+        SeeError**      error
+        );
+};
+
+/* **** function style macro casts **** */
+
+/**
+ * \brief cast a pointer from a PsyGrating derived instance back to a
+ *        pointer to PsyGrating.
+ */
+#define PSY_GRATING(obj)                      \
+    ((PsyGrating*) obj)
+
+/**
+ * \brief cast a pointer to PsyGratingClass derived class back to a
+ *        pointer to PsyGratingClass.
+ */
+#define PSY_GRATING_CLASS(cls)                      \
+    ((const PsyGratingClass*) cls)
+
+/**
+ * \brief obtain a pointer to PsyGratingClass from a instance of
+ *        derived from PsyGrating.
+ */
+#define PSY_GRATING_GET_CLASS(obj)                \
+    (PSY_GRATING_CLASS(see_object_get_class(SEE_OBJECT(obj)) )  )
+
+/* **** public functions **** */
+
+/**
+ * \brief Create a new PsyGrating.
+ *
+ * This needs a current OpenGL context, e.g. create a PsyWindow first.
+ *
+ * @param [out] grating The new grating, *grating should be NULL.
+ * @param [out] error   If an error occurs it will be returned here.
+ *
+ * @return SEE_SUCCESS if the grating is created.
+ */
+PSY_EXPORT int
+psy_grating_create(PsyGrating** grating, SeeError** error);
+
+/**
+ * \brief Add stimuli to be drawn.
+ *
+ * @param [in]  grating
+ * @param [in]  parameters      An array with the parameters of the stimuli.
+ * @param [in]  num_parameters  The number of stimuli.
+ * @param [out] error           If an error occurs it will be returned here.
+ *
+ * @return SEE_SUCCESS, SEE_INVALID_ARGUMENT or SEE_ERROR_RUNTIME when out
+ *         of memory.
+ */
+PSY_EXPORT int
+psy_grating_add(
+    PsyGrating*                 grating,
+    const PsyGratingParameters* parameters,
+    size_t                      num_parameters,
+    SeeError**                  error
+    );
+
+/**
+ * \brief Remove all stimuli, the memory is kept for reuse.
+ */
+PSY_EXPORT void
+psy_grating_clear(PsyGrating* grating);
+
+/**
+ * \brief Returns the number of stimuli that are added.
+ */
+PSY_EXPORT size_t
+psy_grating_size(const PsyGrating* grating);
+
+/**
+ * \brief Set the colours of the stimuli.
+ *
+ * A stimulus is drawn as mean + contrast * value * amplitude, where value
+ * is in [-1, 1]. The default is a mean of 0.5 gray and an amplitude of 0.5,
+ * which yields a black to white grating at full contrast.
+ *
+ * @param [in] grating
+ * @param [in] mean         The rgba colour at value 0.
+ * @param [in] amplitude    The rgba amplitude around the mean.
+ */
+PSY_EXPORT void
+psy_grating_set_colors(
+    PsyGrating*     grating,
+    const GLfloat   mean[4],
+    const GLfloat   amplitude[4]
+    );
+
+/**
+ * \brief Draw all stimuli with one draw call.
+ *
+ * @param [in]  grating
+ * @param [in]  transform   A column major 4x4 matrix that maps the
+ *                          coordinates of the stimuli to clip space, NULL
+ *                          when they're in clip space already.
+ * @param [out] error       If an error occurs it will be returned here.
+ */
+PSY_EXPORT int
+psy_grating_draw(
+    PsyGrating*     grating,
+    const GLfloat*  transform,
+    SeeError**      error
+    );
+
+/**
+ * Gets the pointer to the PsyGratingClass table.
+ */
+PSY_EXPORT const PsyGratingClass*
+psy_grating_class();
+
+/* **** class initialization functions **** */
+
+/**
+ * Initialize PsyGrating; make it ready for use.
+ */
+PSY_EXPORT
+int psy_grating_init();
+
+/**
+ * Deinitialize PsyGrating, after PsyGrating has been deinitialized,
+ * all functions in this header shouldn't be used anymore.
+ */
+PSY_EXPORT
+void psy_grating_deinit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_GRATING_H
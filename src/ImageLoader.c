@@ -0,0 +1,349 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "psy_config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#if defined(HAVE_SDL_IMAGE)
+#include <SDL2/SDL_image.h>
+#endif
+
+#include "ImageLoader.h"
+#include "Time.h"
+#include "Trace.h"
+
+typedef enum {
+    JOB_QUEUED,
+    JOB_DECODING,
+    JOB_DONE
+} JobState;
+
+struct _PsyImageJob {
+    PsyImageJob*    next;       // the next job in the queue
+    char*           path;
+    JobState        state;
+    int             released;   // the owner isn't interested anymore
+    PsyImage        image;
+    char            error[256];
+};
+
+static SDL_Thread*  g_thread    = NULL;
+static SDL_mutex*   g_mutex     = NULL;
+static SDL_cond*    g_wake      = NULL;     // signals the worker
+static SDL_cond*    g_done      = NULL;     // signals the waiting owners
+static PsyImageJob* g_head      = NULL;
+static PsyImageJob* g_tail      = NULL;
+static int          g_stop      = 0;
+
+static void
+free_job(PsyImageJob* job)
+{
+    free(job->image.pixels);
+    free(job->path);
+    free(job);
+}
+
+/*
+ * Decodes the image, this runs on the worker without holding the mutex.
+ * OpenGL wants the bottom row first, so the rows are flipped.
+ */
+static void
+decode(PsyImageJob* job)
+{
+    SDL_Surface* loaded;
+    SDL_Surface* rgba;
+    size_t row_size;
+
+#if defined(HAVE_SDL_IMAGE)
+    loaded = IMG_Load(job->path);
+#else
+    loaded = SDL_LoadBMP(job->path);
+#endif
+    if (!loaded) {
+        snprintf(job->error, sizeof(job->error), "Unable to load \"%s\": %s",
+                 job->path, SDL_GetError()
+                 );
+        job->image.error = job->error;
+        return;
+    }
+
+    rgba = SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(loaded);
+    if (!rgba) {
+        snprintf(job->error, sizeof(job->error), "Unable to convert \"%s\": %s",
+                 job->path, SDL_GetError()
+                 );
+        job->image.error = job->error;
+        return;
+    }
+
+    row_size = (size_t) rgba->w * 4;
+    job->image.pixels = malloc(row_size * (size_t) rgba->h);
+    if (!job->image.pixels) {
+        snprintf(job->error, sizeof(job->error), "Out of memory for \"%s\"",
+                 job->path
+                 );
+        job->image.error = job->error;
+        SDL_FreeSurface(rgba);
+        return;
+    }
+
+    SDL_LockSurface(rgba);
+    for (int y = 0; y < rgba->h; y++) {
+        memcpy(
+            job->image.pixels + row_size * (size_t) (rgba->h - 1 - y),
+            (const unsigned char*) rgba->pixels + (size_t) rgba->pitch * y,
+            row_size
+            );
+    }
+    SDL_UnlockSurface(rgba);
+
+    job->image.width = rgba->w;
+    job->image.height = rgba->h;
+    SDL_FreeSurface(rgba);
+}
+
+/*
+ * Finishes the jobs that are still queued with an error, the owners that
+ * wait for them return instead of waiting for a worker that has stopped.
+ */
+static void
+cancel_queued(void)
+{
+    PsyImageJob* job = g_head;
+
+    while (job) {
+        PsyImageJob* next = job->next;
+
+        snprintf(job->error, sizeof(job->error),
+                 "Loading \"%s\" was cancelled, the loader stopped", job->path
+                 );
+        job->image.error = job->error;
+        job->next = NULL;
+        job->state = JOB_DONE;
+        job = next;
+    }
+    g_head = g_tail = NULL;
+}
+
+static int
+worker(void* data)
+{
+    (void) data;
+
+    psy_trace_set_thread_name("psy_image_loader");
+    SDL_LockMutex(g_mutex);
+    while (!g_stop) {
+        PsyImageJob* job = g_head;
+        if (!job) {
+            SDL_CondWait(g_wake, g_mutex);
+            continue;
+        }
+        g_head = job->next;
+        if (!g_head)
+            g_tail = NULL;
+        job->state = JOB_DECODING;
+        SDL_UnlockMutex(g_mutex);
+
+        PSY_TRACE_BEGIN(trace);
+        decode(job);
+        PSY_TRACE_END(trace, "psylib", "decode");
+
+        SDL_LockMutex(g_mutex);
+        job->state = JOB_DONE;
+        if (job->released)
+            free_job(job);
+        SDL_CondBroadcast(g_done);
+    }
+    SDL_UnlockMutex(g_mutex);
+
+    return 0;
+}
+
+static int
+start_worker(void)
+{
+    g_mutex = SDL_CreateMutex();
+    g_wake  = SDL_CreateCond();
+    g_done  = SDL_CreateCond();
+    if (!g_mutex || !g_wake || !g_done)
+        goto start_worker_error;
+
+    g_stop = 0;
+    g_thread = SDL_CreateThread(worker, "psy_image_loader", NULL);
+    if (!g_thread)
+        goto start_worker_error;
+
+    return 0;
+
+start_worker_error:
+    if (g_done)
+        SDL_DestroyCond(g_done);
+    if (g_wake)
+        SDL_DestroyCond(g_wake);
+    if (g_mutex)
+        SDL_DestroyMutex(g_mutex);
+    g_done = g_wake = NULL;
+    g_mutex = NULL;
+    return 1;
+}
+
+PsyImageJob*
+psy_image_loader_submit(const char* path)
+{
+    PsyImageJob* job;
+
+    if (!path)
+        return NULL;
+
+    if (!g_thread && start_worker())
+        return NULL;
+
+    job = calloc(1, sizeof(PsyImageJob));
+    if (!job)
+        return NULL;
+    job->path = malloc(strlen(path) + 1);
+    if (!job->path) {
+        free(job);
+        return NULL;
+    }
+    strcpy(job->path, path);
+    job->state = JOB_QUEUED;
+
+    SDL_LockMutex(g_mutex);
+    if (g_tail)
+        g_tail->next = job;
+    else
+        g_head = job;
+    g_tail = job;
+    SDL_CondSignal(g_wake);
+    SDL_UnlockMutex(g_mutex);
+
+    return job;
+}
+
+int
+psy_image_job_done(PsyImageJob* job)
+{
+    int done;
+
+    // Without the worker all jobs are done and nothing changes them.
+    if (!g_thread)
+        return job->state == JOB_DONE;
+
+    SDL_LockMutex(g_mutex);
+    done = job->state == JOB_DONE;
+    SDL_UnlockMutex(g_mutex);
+
+    return done;
+}
+
+int
+psy_image_job_wait(PsyImageJob* job, unsigned timeout_ms)
+{
+    PsyTime start = psy_time_now();
+    int done;
+
+    if (!g_thread)
+        return job->state == JOB_DONE;
+
+    SDL_LockMutex(g_mutex);
+    while (job->state != JOB_DONE) {
+        PsyTime elapsed_ms = (psy_time_now() - start) / PSY_TIME_NS_PER_MS;
+        if (elapsed_ms >= (PsyTime) timeout_ms)
+            break;
+        SDL_CondWaitTimeout(
+            g_done, g_mutex, timeout_ms - (Uint32) elapsed_ms
+            );
+    }
+    done = job->state == JOB_DONE;
+    SDL_UnlockMutex(g_mutex);
+
+    return done;
+}
+
+const PsyImage*
+psy_image_job_result(PsyImageJob* job)
+{
+    return psy_image_job_done(job) ? &job->image : NULL;
+}
+
+void
+psy_image_job_release(PsyImageJob* job)
+{
+    if (!job)
+        return;
+
+    if (!g_thread) {
+        free_job(job);
+        return;
+    }
+
+    SDL_LockMutex(g_mutex);
+    if (job->state == JOB_QUEUED) {
+        PsyImageJob* prev = NULL;
+        for (PsyImageJob* it = g_head; it; prev = it, it = it->next) {
+            if (it != job)
+                continue;
+            if (prev)
+                prev->next = job->next;
+            else
+                g_head = job->next;
+            if (g_tail == job)
+                g_tail = prev;
+            break;
+        }
+        free_job(job);
+    }
+    else if (job->state == JOB_DECODING) {
+        job->released = 1;
+    }
+    else {
+        free_job(job);
+    }
+    SDL_UnlockMutex(g_mutex);
+}
+
+void
+psy_image_loader_stop(void)
+{
+    if (!g_thread)
+        return;
+
+    SDL_LockMutex(g_mutex);
+    g_stop = 1;
+    SDL_CondSignal(g_wake);
+    SDL_UnlockMutex(g_mutex);
+
+    SDL_WaitThread(g_thread, NULL);
+
+    // The owners still have to release the queued jobs.
+    SDL_LockMutex(g_mutex);
+    cancel_queued();
+    SDL_CondBroadcast(g_done);
+    g_thread = NULL;
+    SDL_UnlockMutex(g_mutex);
+
+    SDL_DestroyCond(g_done);
+    SDL_DestroyCond(g_wake);
+    SDL_DestroyMutex(g_mutex);
+    g_done = g_wake = NULL;
+    g_mutex = NULL;
+}
@@ -0,0 +1,111 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file ImageLoader.h
+ * \brief Decodes images on a worker thread.
+ * \private
+ *
+ * Decoding an image takes milliseconds to tens of milliseconds, which we
+ * cannot afford on the thread that presents the frames. The loader has one
+ * worker thread, that is started when the first image is submitted. It
+ * decodes the images in the order they are submitted into tightly packed
+ * RGBA pixels. Without SDL_image only .bmp files can be loaded.
+ *
+ * The functions in this file don't touch OpenGL, uploading the pixels is
+ * up to the caller, see PsyTexture.
+ */
+
+#ifndef PSY_IMAGE_LOADER_H
+#define PSY_IMAGE_LOADER_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _PsyImageJob PsyImageJob;
+
+/**
+ * \brief The result of a finished job.
+ */
+typedef struct _PsyImage {
+    int             width;
+    int             height;
+    unsigned char*  pixels;     ///< width * height RGBA pixels, bottom row first
+    const char*     error;      ///< NULL on success, a description otherwise
+} PsyImage;
+
+/**
+ * \brief Queue the image at path for decoding.
+ *
+ * @return A job, that must be released with psy_image_job_release(), or
+ *         NULL when the job cannot be queued.
+ */
+PsyImageJob*
+psy_image_loader_submit(const char* path);
+
+/**
+ * \brief Returns non zero when the job has finished, it doesn't block.
+ */
+int
+psy_image_job_done(PsyImageJob* job);
+
+/**
+ * \brief Wait until the job has finished or timeout_ms has elapsed.
+ *
+ * @return non zero when the job has finished.
+ */
+int
+psy_image_job_wait(PsyImageJob* job, unsigned timeout_ms);
+
+/**
+ * \brief Obtain the result of a finished job.
+ *
+ * The image remains owned by the job and is valid until the job is
+ * released.
+ *
+ * @return NULL when the job hasn't finished.
+ */
+const PsyImage*
+psy_image_job_result(PsyImageJob* job);
+
+/**
+ * \brief Release a job, whether it has finished or not.
+ *
+ * A job that is still queued is cancelled, a job that is being decoded is
+ * freed by the worker once it has finished.
+ */
+void
+psy_image_job_release(PsyImageJob* job);
+
+/**
+ * \brief Stop the worker thread, jobs that are still queued are cancelled.
+ *
+ * The cancelled jobs are done, their result has an error. Afterwards the
+ * job functions return immediately, the jobs still have to be released.
+ * This is done by psylib_deinit().
+ */
+void
+psy_image_loader_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_IMAGE_LOADER_H
@@ -0,0 +1,780 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "MetaClass.h"
+#include "Error.h"
+#include "ImageLoader.h"
+#include "ImageSet.h"
+#include "Trace.h"
+#include "gl/GLError.h"
+#include "gl/gl_util.h"
+
+/*
+ * The most images that are packed into a single page when OpenGL doesn't
+ * tell the number of layers of a texture array, or has no texture arrays.
+ */
+#define PSY_IMAGE_SET_FALLBACK_LAYERS 16
+
+#define NO_ENTRY SIZE_MAX
+
+/* How long acquiring an image waits for its decoding before it fails. */
+#define ACQUIRE_TIMEOUT_MS 10000
+
+typedef enum {
+    ENTRY_UNLOADED,
+    ENTRY_DECODING,
+    ENTRY_RESIDENT,
+    ENTRY_FAILED
+} EntryState;
+
+typedef struct _PsyImageSetEntry {
+    char*               path;
+    PsyImageJob*        job;
+    EntryState          state;
+    size_t              page;
+    int                 slot;
+    unsigned long long  last_use;
+} ImageEntry;
+
+/*
+ * A page holds up to layers images of width * height pixels. A page whose
+ * texture is 0 has been freed and can be reused.
+ */
+typedef struct _PsyImageSetPage {
+    GLuint              texture;
+    int                 width;
+    int                 height;
+    int                 layers;
+    size_t*             slots;  // the entry in every slot or NO_ENTRY
+    unsigned long long  last_use;
+} ImagePage;
+
+static void
+set_out_of_memory(SeeError** error, const char* func)
+{
+    PsyError* err = NULL;
+    psy_error_create(&err);
+    psy_error_printf(err, "%s: out of memory", func);
+    *error = SEE_ERROR(err);
+}
+
+static size_t
+page_bytes(const ImagePage* page)
+{
+    return (size_t) page->width * (size_t) page->height * 4 *
+           (size_t) page->layers;
+}
+
+static GLenum
+page_target(void)
+{
+    return psy_gl_has_texture_arrays() ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+}
+
+static void
+touch(PsyImageSet* set, ImageEntry* entry)
+{
+    entry->last_use = ++set->tick;
+    set->pages[entry->page].last_use = entry->last_use;
+}
+
+static void
+evict_slot(PsyImageSet* set, ImagePage* page, int slot)
+{
+    ImageEntry* entry = &set->entries[page->slots[slot]];
+    entry->state = ENTRY_UNLOADED;
+    page->slots[slot] = NO_ENTRY;
+}
+
+static void
+free_page(PsyImageSet* set, ImagePage* page)
+{
+    int i;
+
+    for (i = 0; i < page->layers; i++)
+        if (page->slots[i] != NO_ENTRY)
+            evict_slot(set, page, i);
+
+    set->memory_used -= page_bytes(page);
+    glDeleteTextures(1, &page->texture);
+    page->texture = 0;
+    free(page->slots);
+    page->slots = NULL;
+}
+
+/*
+ * The number of images of width * height in a new page, it's limited by
+ * OpenGL and by the budget. With texture arrays a page has as many layers
+ * as OpenGL allows, so a large set is drawn from a few textures.
+ */
+static int
+layers_per_page(const PsyImageSet* set, int width, int height)
+{
+    size_t image_bytes = (size_t) width * (size_t) height * 4;
+    size_t layers = (size_t) set->max_layers;
+
+    if (!psy_gl_has_texture_arrays()) {
+        GLint max_size = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+        if (layers > (size_t) (max_size / height))
+            layers = (size_t) (max_size / height);
+    }
+    if (layers > set->budget / image_bytes)
+        layers = set->budget / image_bytes;
+
+    return layers > 0 ? (int) layers : 1;
+}
+
+static int
+new_page(
+    PsyImageSet*    set,
+    int             width,
+    int             height,
+    int             layers,
+    size_t*         page_out,
+    SeeError**      error
+    )
+{
+    ImagePage* page = NULL;
+    GLenum target = page_target();
+    size_t i;
+
+    for (i = 0; i < set->num_pages; i++) {
+        if (!set->pages[i].texture) {
+            page = &set->pages[i];
+            break;
+        }
+    }
+    if (!page) {
+        ImagePage* pages = realloc(
+            set->pages, sizeof(ImagePage) * (set->num_pages + 1)
+            );
+        if (!pages) {
+            set_out_of_memory(error, __func__);
+            return SEE_ERROR_RUNTIME;
+        }
+        set->pages = pages;
+        page = &set->pages[set->num_pages++];
+    }
+
+    memset(page, 0, sizeof(ImagePage));
+    page->slots = malloc(sizeof(size_t) * (size_t) layers);
+    if (!page->slots) {
+        set_out_of_memory(error, __func__);
+        return SEE_ERROR_RUNTIME;
+    }
+    for (i = 0; i < (size_t) layers; i++)
+        page->slots[i] = NO_ENTRY;
+    page->width = width;
+    page->height = height;
+    page->layers = layers;
+
+    glGenTextures(1, &page->texture);
+    psy_gl_bind_texture(0, target, page->texture);
+    glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    if (target == GL_TEXTURE_2D_ARRAY)
+        glTexImage3D(
+            target, 0, GL_RGBA8, width, height, layers, 0,
+            GL_RGBA, GL_UNSIGNED_BYTE, NULL
+            );
+    else
+        glTexImage2D(
+            target, 0, GL_RGBA, width, height * layers, 0,
+            GL_RGBA, GL_UNSIGNED_BYTE, NULL
+            );
+    psy_gl_bind_texture(0, target, 0);
+    set->memory_used += page_bytes(page);
+
+    if (glGetError() != GL_NO_ERROR) {
+        PsyGLError* glerror = NULL;
+        free_page(set, page);
+        psy_glerror_create(&glerror);
+        psy_error_printf(
+            PSY_ERROR(glerror),
+            "%s: unable to allocate a page of %d images of %dx%d",
+            __func__, layers, width, height
+            );
+        *error = SEE_ERROR(glerror);
+        return SEE_ERROR_RUNTIME;
+    }
+
+    *page_out = (size_t) (page - set->pages);
+    return SEE_SUCCESS;
+}
+
+/*
+ * Finds a slot for an image of width * height. First a free slot in a page
+ * of the right size is tried, then a new page if it fits in the budget,
+ * then the least recently used slot of the right size. When there is no
+ * page of the right size, the least recently used pages are freed until a
+ * new one fits.
+ */
+static int
+find_slot(
+    PsyImageSet*    set,
+    int             width,
+    int             height,
+    size_t*         page_out,
+    int*            slot_out,
+    SeeError**      error
+    )
+{
+    int layers = layers_per_page(set, width, height);
+    size_t needed = (size_t) width * (size_t) height * 4 * (size_t) layers;
+    size_t i, lru_page = NO_ENTRY;
+    int s, lru_slot = -1;
+    unsigned long long lru_use = 0;
+
+    for (i = 0; i < set->num_pages; i++) {
+        ImagePage* page = &set->pages[i];
+        if (!page->texture || page->width != width || page->height != height)
+            continue;
+        for (s = 0; s < page->layers; s++) {
+            if (page->slots[s] == NO_ENTRY) {
+                *page_out = i;
+                *slot_out = s;
+                return SEE_SUCCESS;
+            }
+            if (lru_page == NO_ENTRY ||
+                set->entries[page->slots[s]].last_use < lru_use) {
+                lru_page = i;
+                lru_slot = s;
+                lru_use = set->entries[page->slots[s]].last_use;
+            }
+        }
+    }
+
+    if (set->memory_used + needed <= set->budget) {
+        *slot_out = 0;
+        return new_page(set, width, height, layers, page_out, error);
+    }
+
+    if (lru_page != NO_ENTRY) {
+        evict_slot(set, &set->pages[lru_page], lru_slot);
+        *page_out = lru_page;
+        *slot_out = lru_slot;
+        return SEE_SUCCESS;
+    }
+
+    while (set->memory_used + needed > set->budget) {
+        ImagePage* oldest = NULL;
+        for (i = 0; i < set->num_pages; i++) {
+            ImagePage* page = &set->pages[i];
+            if (page->texture && (!oldest || page->last_use < oldest->last_use))
+                oldest = page;
+        }
+        if (!oldest) {
+            PsyError* err = NULL;
+            psy_error_create(&err);
+            psy_error_printf(
+                err,
+                "%s: an image of %dx%d doesn't fit in the budget of %zu bytes",
+                __func__, width, height, set->budget
+                );
+            *error = SEE_ERROR(err);
+            return SEE_ERROR_RUNTIME;
+        }
+        free_page(set, oldest);
+    }
+
+    *slot_out = 0;
+    return new_page(set, width, height, layers, page_out, error);
+}
+
+static int
+upload(PsyImageSet* set, size_t index, const PsyImage* image, SeeError** error)
+{
+    ImageEntry* entry = &set->entries[index];
+    ImagePage* page;
+    size_t page_index;
+    int slot, ret;
+    GLenum target = page_target();
+
+    ret = find_slot(set, image->width, image->height, &page_index, &slot, error);
+    if (ret)
+        return ret;
+
+    page = &set->pages[page_index];
+    PSY_TRACE_BEGIN(trace);
+    psy_gl_bind_texture(0, target, page->texture);
+    if (target == GL_TEXTURE_2D_ARRAY)
+        glTexSubImage3D(
+            target, 0, 0, 0, slot, image->width, image->height, 1,
+            GL_RGBA, GL_UNSIGNED_BYTE, image->pixels
+            );
+    else
+        glTexSubImage2D(
+            target, 0, 0, slot * image->height, image->width, image->height,
+            GL_RGBA, GL_UNSIGNED_BYTE, image->pixels
+            );
+    psy_gl_bind_texture(0, target, 0);
+    PSY_TRACE_END(trace, "psylib", "upload");
+
+    page->slots[slot] = index;
+    entry->page = page_index;
+    entry->slot = slot;
+    entry->state = ENTRY_RESIDENT;
+    touch(set, entry);
+    return SEE_SUCCESS;
+}
+
+/*
+ * Uploads the image of a finished job and releases the job.
+ */
+static int
+finish_decode(PsyImageSet* set, size_t index, SeeError** error)
+{
+    ImageEntry* entry = &set->entries[index];
+    const PsyImage* image = psy_image_job_result(entry->job);
+    int ret;
+
+    if (image->error) {
+        PsyError* err = NULL;
+        psy_error_create(&err);
+        psy_error_printf(err, "%s", image->error);
+        *error = SEE_ERROR(err);
+        entry->state = ENTRY_FAILED;
+        ret = SEE_ERROR_RUNTIME;
+    }
+    else {
+        ret = upload(set, index, image, error);
+        if (ret)
+            entry->state = ENTRY_FAILED;
+    }
+
+    psy_image_job_release(entry->job);
+    entry->job = NULL;
+    return ret;
+}
+
+static int
+start_decode(PsyImageSet* set, size_t index, SeeError** error)
+{
+    ImageEntry* entry = &set->entries[index];
+
+    if (set->num_pending == set->pending_capacity) {
+        size_t capacity = set->pending_capacity ? set->pending_capacity * 2 : 16;
+        size_t* pending = realloc(set->pending, sizeof(size_t) * capacity);
+        if (!pending) {
+            set_out_of_memory(error, __func__);
+            return SEE_ERROR_RUNTIME;
+        }
+        set->pending = pending;
+        set->pending_capacity = capacity;
+    }
+
+    entry->job = psy_image_loader_submit(entry->path);
+    if (!entry->job) {
+        PsyError* err = NULL;
+        psy_error_create(&err);
+        psy_error_printf(err, "Unable to queue \"%s\" for decoding", entry->path);
+        *error = SEE_ERROR(err);
+        return SEE_ERROR_RUNTIME;
+    }
+    entry->state = ENTRY_DECODING;
+    set->pending[set->num_pending++] = index;
+    return SEE_SUCCESS;
+}
+
+/* **** functions that implement PsyImageSet or override SeeObject **** */
+
+static int
+image_set_init(
+    PsyImageSet*            set,
+    const PsyImageSetClass* set_cls,
+    size_t                  budget,
+    SeeError**              error
+    )
+{
+    const SeeObjectClass* parent_cls = SEE_OBJECT_CLASS(set_cls);
+    (void) error;
+
+    parent_cls->object_init(
+        SEE_OBJECT(set),
+        SEE_OBJECT_CLASS(set_cls)
+        );
+
+    set->budget = budget;
+    set->max_layers = 0;
+    if (psy_gl_has_texture_arrays())
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &set->max_layers);
+    if (set->max_layers <= 0)
+        set->max_layers = PSY_IMAGE_SET_FALLBACK_LAYERS;
+
+    return SEE_SUCCESS;
+}
+
+static int
+init(const SeeObjectClass* cls, SeeObject* obj, va_list args)
+{
+    const PsyImageSetClass* set_cls = PSY_IMAGE_SET_CLASS(cls);
+    PsyImageSet* set = PSY_IMAGE_SET(obj);
+
+    size_t budget = va_arg(args, size_t);
+    SeeError** error = va_arg(args, SeeError**);
+
+    return set_cls->image_set_init(set, set_cls, budget, error);
+}
+
+static void
+destroy(SeeObject* obj)
+{
+    PsyImageSet* set = PSY_IMAGE_SET(obj);
+    size_t i;
+
+    for (i = 0; i < set->num_pages; i++)
+        if (set->pages[i].texture)
+            free_page(set, &set->pages[i]);
+    free(set->pages);
+
+    for (i = 0; i < set->num_entries; i++) {
+        psy_image_job_release(set->entries[i].job);
+        free(set->entries[i].path);
+    }
+    free(set->entries);
+    free(set->pending);
+
+    see_object_class()->destroy(obj);
+}
+
+static int
+image_set_add(
+    PsyImageSet*    set,
+    const char*     path,
+    size_t*         index,
+    SeeError**      error
+    )
+{
+    ImageEntry* entry;
+
+    if (set->num_entries == set->entries_capacity) {
+        size_t capacity = set->entries_capacity ? set->entries_capacity * 2 : 64;
+        ImageEntry* entries = realloc(set->entries, sizeof(ImageEntry) * capacity);
+        if (!entries) {
+            set_out_of_memory(error, __func__);
+            return SEE_ERROR_RUNTIME;
+        }
+        set->entries = entries;
+        set->entries_capacity = capacity;
+    }
+
+    entry = &set->entries[set->num_entries];
+    memset(entry, 0, sizeof(ImageEntry));
+    entry->path = malloc(strlen(path) + 1);
+    if (!entry->path) {
+        set_out_of_memory(error, __func__);
+        return SEE_ERROR_RUNTIME;
+    }
+    strcpy(entry->path, path);
+    entry->state = ENTRY_UNLOADED;
+
+    if (index)
+        *index = set->num_entries;
+    set->num_entries++;
+    return SEE_SUCCESS;
+}
+
+static int
+image_set_prefetch(
+    PsyImageSet*    set,
+    const size_t*   indices,
+    size_t          n,
+    SeeError**      error
+    )
+{
+    size_t i;
+    int ret;
+
+    for (i = 0; i < n; i++) {
+        ImageEntry* entry = &set->entries[indices[i]];
+        if (entry->state == ENTRY_UNLOADED) {
+            ret = start_decode(set, indices[i], error);
+            if (ret)
+                return ret;
+        }
+        else if (entry->state == ENTRY_RESIDENT) {
+            touch(set, entry);
+        }
+    }
+    return SEE_SUCCESS;
+}
+
+static int
+image_set_update(PsyImageSet* set, SeeError** error)
+{
+    size_t i, n = 0;
+    int ret = SEE_SUCCESS;
+
+    for (i = 0; i < set->num_pending; i++) {
+        size_t index = set->pending[i];
+        ImageEntry* entry = &set->entries[index];
+
+        if (entry->state != ENTRY_DECODING)
+            continue;
+        if (!psy_image_job_done(entry->job) || ret) {
+            set->pending[n++] = index;
+            continue;
+        }
+        // Stop uploading after the first error, but keep the rest pending.
+        ret = finish_decode(set, index, error);
+    }
+    set->num_pending = n;
+
+    return ret;
+}
+
+static int
+image_set_acquire(
+    PsyImageSet*        set,
+    size_t              index,
+    PsyImageLocation*   location,
+    SeeError**          error
+    )
+{
+    ImageEntry* entry = &set->entries[index];
+    const ImagePage* page;
+    int ret;
+
+    if (entry->state == ENTRY_UNLOADED) {
+        ret = start_decode(set, index, error);
+        if (ret)
+            return ret;
+    }
+    if (entry->state == ENTRY_DECODING) {
+        if (!psy_image_job_wait(entry->job, ACQUIRE_TIMEOUT_MS)) {
+            PsyError* err = NULL;
+            psy_image_job_release(entry->job);
+            entry->job = NULL;
+            entry->state = ENTRY_FAILED;
+            psy_error_create(&err);
+            psy_error_printf(
+                err, "%s: decoding \"%s\" timed out", __func__, entry->path
+                );
+            *error = SEE_ERROR(err);
+            return SEE_ERROR_RUNTIME;
+        }
+        ret = finish_decode(set, index, error);
+        if (ret)
+            return ret;
+    }
+    if (entry->state == ENTRY_FAILED) {
+        PsyError* err = NULL;
+        psy_error_create(&err);
+        psy_error_printf(err, "%s: \"%s\" couldn't be loaded", __func__, entry->path);
+        *error = SEE_ERROR(err);
+        return SEE_ERROR_RUNTIME;
+    }
+
+    touch(set, entry);
+    page = &set->pages[entry->page];
+
+    location->target = page_target();
+    location->texture = page->texture;
+    location->width = page->width;
+    location->height = page->height;
+    location->uv[0] = 0.0f;
+    location->uv[2] = 1.0f;
+    if (location->target == GL_TEXTURE_2D_ARRAY) {
+        location->layer = entry->slot;
+        location->uv[1] = 0.0f;
+        location->uv[3] = 1.0f;
+    }
+    else {
+        // Stay half a texel away from the neighbouring images, or linear
+        // filtering blends them in.
+        float texels = (float) (page->height * page->layers);
+        location->layer = 0;
+        location->uv[1] = ((float) (entry->slot * page->height) + 0.5f) / texels;
+        location->uv[3] = ((float) ((entry->slot + 1) * page->height) - 0.5f) / texels;
+    }
+
+    return SEE_SUCCESS;
+}
+
+/* **** implementation of the public API **** */
+
+int
+psy_image_set_create(PsyImageSet** set, size_t budget, SeeError** error)
+{
+    const PsyImageSetClass* cls = psy_image_set_class();
+    const SeeObjectClass* see_cls = SEE_OBJECT_CLASS(cls);
+
+    if (!cls)
+        return SEE_NOT_INITIALIZED;
+
+    if (!set || *set)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return see_cls->new_obj(see_cls, 0, (SeeObject**) set, budget, error);
+}
+
+int
+psy_image_set_add(
+    PsyImageSet*    set,
+    const char*     path,
+    size_t*         index,
+    SeeError**      error
+    )
+{
+    if (!set || !path || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_IMAGE_SET_GET_CLASS(set)->add(set, path, index, error);
+}
+
+int
+psy_image_set_prefetch(
+    PsyImageSet*    set,
+    const size_t*   indices,
+    size_t          n,
+    SeeError**      error
+    )
+{
+    size_t i;
+
+    if (!set || (n && !indices) || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+    for (i = 0; i < n; i++)
+        if (indices[i] >= set->num_entries)
+            return SEE_INVALID_ARGUMENT;
+
+    return PSY_IMAGE_SET_GET_CLASS(set)->prefetch(set, indices, n, error);
+}
+
+int
+psy_image_set_update(PsyImageSet* set, SeeError** error)
+{
+    if (!set || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_IMAGE_SET_GET_CLASS(set)->update(set, error);
+}
+
+int
+psy_image_set_acquire(
+    PsyImageSet*        set,
+    size_t              index,
+    PsyImageLocation*   location,
+    SeeError**          error
+    )
+{
+    if (!set || !location || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+    if (index >= set->num_entries)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_IMAGE_SET_GET_CLASS(set)->acquire(set, index, location, error);
+}
+
+int
+psy_image_set_is_resident(const PsyImageSet* set, size_t index)
+{
+    if (!set || index >= set->num_entries)
+        return 0;
+    return set->entries[index].state == ENTRY_RESIDENT;
+}
+
+size_t
+psy_image_set_size(const PsyImageSet* set)
+{
+    return set ? set->num_entries : 0;
+}
+
+size_t
+psy_image_set_memory_used(const PsyImageSet* set)
+{
+    return set ? set->memory_used : 0;
+}
+
+size_t
+psy_image_set_budget(const PsyImageSet* set)
+{
+    return set ? set->budget : 0;
+}
+
+/* **** initialization of the class **** */
+
+PsyImageSetClass* g_PsyImageSetClass = NULL;
+
+static int psy_image_set_class_init(SeeObjectClass* new_cls) {
+    int ret = SEE_SUCCESS;
+
+    /* Override the functions on the parent here */
+    new_cls->init = init;
+    new_cls->name = "PsyImageSet";
+    new_cls->destroy = destroy;
+
+    /* Set the function pointers of the own class here */
+    PsyImageSetClass* cls = (PsyImageSetClass*) new_cls;
+
+    cls->image_set_init = image_set_init;
+    cls->add            = image_set_add;
+    cls->prefetch       = image_set_prefetch;
+    cls->update         = image_set_update;
+    cls->acquire        = image_set_acquire;
+
+    return ret;
+}
+
+/**
+ * \private
+ * \brief this class initializes PsyImageSet(Class).
+ *
+ * You might want to call this from the library initialization func.
+ */
+int
+psy_image_set_init() {
+    int ret;
+    const SeeMetaClass* meta = see_meta_class_class();
+
+    ret = see_meta_class_new_class(
+        meta,
+        (SeeObjectClass**) &g_PsyImageSetClass,
+        sizeof(PsyImageSetClass),
+        sizeof(PsyImageSet),
+        see_object_class(),
+        sizeof(SeeObjectClass),
+        psy_image_set_class_init
+        );
+
+    return ret;
+}
+
+void
+psy_image_set_deinit()
+{
+    if(!g_PsyImageSetClass)
+        return;
+
+    see_object_decref((SeeObject*) g_PsyImageSetClass);
+    g_PsyImageSetClass = NULL;
+}
+
+const PsyImageSetClass*
+psy_image_set_class()
+{
+    return g_PsyImageSetClass;
+}
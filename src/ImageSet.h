@@ -0,0 +1,287 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file ImageSet.h
+ * \brief A large set of images that is kept under a GPU memory budget.
+ *
+ * Experiments that cycle through thousands of images cannot keep all of
+ * them on the GPU, on the Raspberry Pi the GPU shares its memory with the
+ * CPU. A PsyImageSet knows the paths of all the images, but only keeps the
+ * images that were used most recently on the GPU, as long as they fit in
+ * the budget. When an image has to be uploaded and the budget is full, the
+ * least recently used image is evicted.
+ *
+ * Images of the same size are packed into pages. A page is a texture array
+ * where each layer holds one image, so a whole block of stimuli is drawn
+ * with one texture bound. A page has as many layers as OpenGL allows
+ * (GL_MAX_ARRAY_TEXTURE_LAYERS) and the budget holds. OpenGL ES 2.0 has no
+ * texture arrays, there a page is a 2D texture in which the images are
+ * stacked on top of each other, use the uv coordinates in PsyImageLocation
+ * to draw one of them.
+ *
+ * A typical trial loop calls psy_image_set_prefetch() with the images of
+ * the next few trials, psy_image_set_update() once every frame and
+ * psy_image_set_acquire() when an image is drawn. Prefetched images are
+ * decoded on a background thread, so acquiring them doesn't stall. Don't
+ * prefetch more images than fit in the budget, or they'll evict each
+ * other before they are used.
+ */
+
+#ifndef PSY_IMAGE_SET_H
+#define PSY_IMAGE_SET_H
+
+#include <stddef.h>
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+
+#include "psy_export.h"
+#include "gl/includes_gl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _PsyImageSet PsyImageSet;
+typedef struct _PsyImageSetClass PsyImageSetClass;
+
+/**
+ * \brief Where an image of the set resides on the GPU.
+ *
+ * The location remains valid until the image is evicted, which may
+ * happen with the next call to psy_image_set_update() or
+ * psy_image_set_acquire().
+ */
+typedef struct _PsyImageLocation {
+    GLenum  target;     ///< GL_TEXTURE_2D_ARRAY or GL_TEXTURE_2D on ES 2.0
+    GLuint  texture;    ///< The texture to bind to target
+    int     layer;      ///< The layer in the texture array, 0 on ES 2.0
+    float   uv[4];      ///< u0, v0, u1, v1 of the image in the texture
+    int     width;      ///< The width of the image in pixels
+    int     height;     ///< The height of the image in pixels
+} PsyImageLocation;
+
+struct _PsyImageSet {
+    SeeObject parent_obj;
+
+    /*expand PsyImageSet data here*/
+
+    struct _PsyImageSetEntry*   entries;
+    size_t                      num_entries;
+    size_t                      entries_capacity;
+
+    struct _PsyImageSetPage*    pages;
+    size_t                      num_pages;
+
+    size_t*                     pending;
+    size_t                      num_pending;
+    size_t                      pending_capacity;
+
+    size_t                      budget;
+    size_t                      memory_used;
+    unsigned long long          tick;
+    GLint                       max_layers; // the most images per page
+};
+
+struct _PsyImageSetClass {
+    SeeObjectClass parent_cls;
+
+    int (*image_set_init)(
+        PsyImageSet*            set,
+        const PsyImageSetClass* set_cls,
+        size_t                  budget,
+        SeeError**              error
+        );
+
+    int (*add)(
+        PsyImageSet*    set,
+        const char*     path,
+        size_t*         index,
+        SeeError**      error
+        );
+
+    int (*prefetch)(
+        PsyImageSet*    set,
+        const size_t*   indices,
+        size_t          n,
+        SeeError**      error
+        );
+
+    int (*update)(PsyImageSet* set, SeeError** error);
+
+    int (*acquire)(
+        PsyImageSet*        set,
+        size_t              index,
+        PsyImageLocation*   location,
+        SeeError**          error
+        );
+};
+
+/* **** function style macro casts **** */
+
+/**
+ * \brief cast a pointer from a PsyImageSet derived instance back to a
+ *        pointer to PsyImageSet.
+ */
+#define PSY_IMAGE_SET(obj)                      \
+    ((PsyImageSet*) obj)
+
+/**
+ * \brief cast a pointer to PsyImageSetClass derived class back to a
+ *        pointer to PsyImageSetClass.
+ */
+#define PSY_IMAGE_SET_CLASS(cls)                      \
+    ((const PsyImageSetClass*) cls)
+
+/**
+ * \brief obtain a pointer to PsyImageSetClass from a instance of
+ *        derived from PsyImageSet.
+ */
+#define PSY_IMAGE_SET_GET_CLASS(obj)                \
+    (PSY_IMAGE_SET_CLASS(see_object_get_class(SEE_OBJECT(obj)) ) )
+
+/* **** public functions **** */
+
+/**
+ * \brief Create a new image set.
+ *
+ * @param [out] set     The set, should be NULL.
+ * @param [in]  budget  The number of bytes the set may use on the GPU.
+ * @param [out] error   If an error occurs, it's returned here.
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_image_set_create(PsyImageSet** set, size_t budget, SeeError** error);
+
+/**
+ * \brief Add an image file to the set, the file is not loaded yet.
+ *
+ * @param [in]  set
+ * @param [in]  path    The file to load, .bmp or any format SDL_image knows
+ * @param [out] index   The index of the image in the set, may be NULL.
+ * @param [out] error
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_image_set_add(
+    PsyImageSet*    set,
+    const char*     path,
+    size_t*         index,
+    SeeError**      error
+    );
+
+/**
+ * \brief Start decoding the images that will be used soon.
+ *
+ * The decoded images are uploaded by psy_image_set_update(). Images that
+ * are already resident only count as recently used.
+ *
+ * @param [in]  set
+ * @param [in]  indices The images in the order they'll be used.
+ * @param [in]  n       The number of indices.
+ * @param [out] error
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_image_set_prefetch(
+    PsyImageSet*    set,
+    const size_t*   indices,
+    size_t          n,
+    SeeError**      error
+    );
+
+/**
+ * \brief Upload the images that have been decoded, it doesn't block.
+ *
+ * Call this once per frame, after the buffers have been swapped.
+ *
+ * @return SEE_SUCCESS, or an error when an image could not be loaded.
+ */
+PSY_EXPORT int
+psy_image_set_update(PsyImageSet* set, SeeError** error);
+
+/**
+ * \brief Obtain the location of an image and mark it as recently used.
+ *
+ * When the image hasn't been prefetched, this blocks until it has been
+ * decoded and uploaded. When decoding takes more than 10 seconds or the
+ * loader has stopped, the image fails to load.
+ *
+ * @param [in]  set
+ * @param [in]  index       The index returned by psy_image_set_add().
+ * @param [out] location    Where the image resides on the GPU.
+ * @param [out] error
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_image_set_acquire(
+    PsyImageSet*        set,
+    size_t              index,
+    PsyImageLocation*   location,
+    SeeError**          error
+    );
+
+/**
+ * \brief Returns non zero when the image at index is on the GPU.
+ */
+PSY_EXPORT int
+psy_image_set_is_resident(const PsyImageSet* set, size_t index);
+
+/**
+ * \brief Returns the number of images in the set.
+ */
+PSY_EXPORT size_t
+psy_image_set_size(const PsyImageSet* set);
+
+/**
+ * \brief Returns the number of bytes the pages of the set use on the GPU.
+ */
+PSY_EXPORT size_t
+psy_image_set_memory_used(const PsyImageSet* set);
+
+/**
+ * \brief Returns the budget the set was created with.
+ */
+PSY_EXPORT size_t
+psy_image_set_budget(const PsyImageSet* set);
+
+/**
+ * Gets the pointer to the PsyImageSetClass table.
+ */
+PSY_EXPORT const PsyImageSetClass*
+psy_image_set_class();
+
+/* **** class initialization functions **** */
+
+/**
+ * Initialize PsyImageSet; make it ready for use.
+ */
+PSY_EXPORT
+int psy_image_set_init();
+
+/**
+ * Deinitialize PsyImageSet, after PsyImageSet has been deinitialized,
+ * all functions in this header shouldn't be used anymore.
+ */
+PSY_EXPORT
+void psy_image_set_deinit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_IMAGE_SET_H
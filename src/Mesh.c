@@ -0,0 +1,402 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include "MetaClass.h"
+#include "Error.h"
+#include "Mesh.h"
+#include "gl/GLError.h"
+#include "gl/gl_util.h"
+
+#define TWO_PI 6.283185307179586
+
+static void
+set_error(SeeError** error, const char* func, const char* msg)
+{
+    PsyError* err = NULL;
+    psy_error_create(&err);
+    psy_error_printf(err, "%s: %s", func, msg);
+    *error = SEE_ERROR(err);
+}
+
+/* Writes the two triangles of a rectangle, 6 vertices. */
+static GLfloat*
+add_quad(GLfloat* v, GLfloat x0, GLfloat y0, GLfloat x1, GLfloat y1)
+{
+    const GLfloat quad[12] = {
+        x0, y0,  x1, y0,  x0, y1,
+        x0, y1,  x1, y0,  x1, y1
+    };
+    size_t i;
+
+    for (i = 0; i < 12; i++)
+        *v++ = quad[i];
+    return v;
+}
+
+/* Returns the vertices of the primitive, which the caller frees. */
+static GLfloat*
+tessellate(const PsyPrimitive* primitive, GLenum* mode, GLsizei* count)
+{
+    unsigned i, segments = primitive->segments;
+    GLfloat ratio = primitive->ratio;
+    GLfloat* vertices;
+    GLfloat* v;
+
+    switch (primitive->shape) {
+        case PSY_MESH_CIRCLE:
+            *mode = GL_TRIANGLE_FAN;
+            *count = (GLsizei) segments + 2;
+            break;
+        case PSY_MESH_ANNULUS:
+            *mode = GL_TRIANGLE_STRIP;
+            *count = 2 * ((GLsizei) segments + 1);
+            break;
+        case PSY_MESH_RECTANGLE:
+            *mode = GL_TRIANGLE_STRIP;
+            *count = 4;
+            break;
+        case PSY_MESH_CROSS:
+            *mode = GL_TRIANGLES;
+            *count = 18;
+            break;
+        default:
+            return NULL;
+    }
+
+    vertices = malloc((size_t) *count * 2 * sizeof(GLfloat));
+    if (!vertices)
+        return NULL;
+    v = vertices;
+
+    switch (primitive->shape) {
+        case PSY_MESH_CIRCLE:
+            *v++ = 0.0f;
+            *v++ = 0.0f;
+            for (i = 0; i <= segments; i++) {
+                double angle = TWO_PI * (i % segments) / segments;
+                *v++ = (GLfloat) (0.5 * cos(angle));
+                *v++ = (GLfloat) (0.5 * sin(angle));
+            }
+            break;
+        case PSY_MESH_ANNULUS:
+            for (i = 0; i <= segments; i++) {
+                double angle = TWO_PI * (i % segments) / segments;
+                *v++ = (GLfloat) (0.5 * cos(angle));
+                *v++ = (GLfloat) (0.5 * sin(angle));
+                *v++ = (GLfloat) (0.5 * ratio * cos(angle));
+                *v++ = (GLfloat) (0.5 * ratio * sin(angle));
+            }
+            break;
+        case PSY_MESH_RECTANGLE:
+            *v++ = -0.5f; *v++ = -0.5f;
+            *v++ =  0.5f; *v++ = -0.5f;
+            *v++ = -0.5f; *v++ =  0.5f;
+            *v++ =  0.5f; *v++ =  0.5f;
+            break;
+        case PSY_MESH_CROSS:
+            // The horizontal bar and the arms above and below it, so the
+            // center isn't covered twice when blending.
+            v = add_quad(v, -0.5f, -0.5f * ratio, 0.5f, 0.5f * ratio);
+            v = add_quad(v, -0.5f * ratio, 0.5f * ratio, 0.5f * ratio, 0.5f);
+            v = add_quad(v, -0.5f * ratio, -0.5f, 0.5f * ratio, -0.5f * ratio);
+            break;
+    }
+
+    return vertices;
+}
+
+static int
+check_primitive(const PsyPrimitive* primitive, SeeError** error)
+{
+    switch (primitive->shape) {
+        case PSY_MESH_ANNULUS:
+            if (!(primitive->ratio > 0.0f && primitive->ratio < 1.0f)) {
+                set_error(error, __func__, "the ratio should be within (0, 1)");
+                return SEE_INVALID_ARGUMENT;
+            }
+            // fall through
+        case PSY_MESH_CIRCLE:
+            if (primitive->segments < 3) {
+                set_error(error, __func__, "at least 3 segments are needed");
+                return SEE_INVALID_ARGUMENT;
+            }
+            return SEE_SUCCESS;
+        case PSY_MESH_RECTANGLE:
+            return SEE_SUCCESS;
+        case PSY_MESH_CROSS:
+            if (!(primitive->ratio > 0.0f && primitive->ratio < 1.0f)) {
+                set_error(error, __func__, "the ratio should be within (0, 1)");
+                return SEE_INVALID_ARGUMENT;
+            }
+            return SEE_SUCCESS;
+    }
+
+    set_error(error, __func__, "unknown shape");
+    return SEE_INVALID_ARGUMENT;
+}
+
+/* **** functions that implement PsyMesh or override SeeObject **** */
+
+static int
+mesh_init(
+    PsyMesh*            mesh,
+    const PsyMeshClass* mesh_cls,
+    GLenum              mode,
+    const GLfloat*      vertices,
+    GLsizei             num_vertices,
+    SeeError**          error
+    )
+{
+    const SeeObjectClass* parent_cls = SEE_OBJECT_CLASS(mesh_cls);
+
+    parent_cls->object_init(
+        SEE_OBJECT(mesh),
+        SEE_OBJECT_CLASS(mesh_cls)
+        );
+
+    mesh->mode = mode;
+    mesh->num_vertices = num_vertices;
+
+    glGenBuffers(1, &mesh->vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
+    glBufferData(
+        GL_ARRAY_BUFFER,
+        (GLsizeiptr) ((size_t) num_vertices * 2 * sizeof(GLfloat)),
+        vertices,
+        GL_STATIC_DRAW
+        );
+
+    if (psy_gl_has_vertex_arrays()) {
+        glGenVertexArrays(1, &mesh->vao);
+        glBindVertexArray(mesh->vao);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
+        glBindVertexArray(0);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (glGetError() != GL_NO_ERROR) {
+        PsyGLError* glerror = NULL;
+        psy_glerror_create(&glerror);
+        psy_error_printf(
+            PSY_ERROR(glerror), "%s: %s", __func__, "unable to create the buffers"
+            );
+        *error = SEE_ERROR(glerror);
+        return SEE_ERROR_RUNTIME;
+    }
+    return SEE_SUCCESS;
+}
+
+static int
+init(const SeeObjectClass* cls, SeeObject* obj, va_list args)
+{
+    const PsyMeshClass* mesh_cls = PSY_MESH_CLASS(cls);
+    PsyMesh* mesh = PSY_MESH(obj);
+
+    GLenum mode = va_arg(args, GLenum);
+    const GLfloat* vertices = va_arg(args, const GLfloat*);
+    GLsizei num_vertices = va_arg(args, GLsizei);
+    SeeError** error = va_arg(args, SeeError**);
+
+    return mesh_cls->mesh_init(
+        mesh, mesh_cls, mode, vertices, num_vertices, error
+        );
+}
+
+static void
+destroy(SeeObject* obj)
+{
+    PsyMesh* mesh = PSY_MESH(obj);
+
+    if (mesh->vao)
+        glDeleteVertexArrays(1, &mesh->vao);
+    if (mesh->vbo)
+        glDeleteBuffers(1, &mesh->vbo);
+
+    see_object_class()->destroy(obj);
+}
+
+static int
+mesh_draw(PsyMesh* mesh, const PsyShaderProgram* program, SeeError** error)
+{
+    int ret;
+
+    ret = psy_shader_use_program(program, error);
+    if (ret)
+        return ret;
+
+    if (mesh->vao) {
+        glBindVertexArray(mesh->vao);
+        glDrawArrays(mesh->mode, 0, mesh->num_vertices);
+        glBindVertexArray(0);
+    }
+    else {
+        GLint location = psy_shader_program_attribute_location(program, "a_position");
+        glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
+        if (location >= 0) {
+            glEnableVertexAttribArray((GLuint) location);
+            glVertexAttribPointer((GLuint) location, 2, GL_FLOAT, GL_FALSE, 0, 0);
+        }
+        glDrawArrays(mesh->mode, 0, mesh->num_vertices);
+        psy_gl_disable_attributes(&location, 1);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    return SEE_SUCCESS;
+}
+
+/* **** implementation of the public API **** */
+
+int
+psy_mesh_create(
+    PsyMesh**       mesh,
+    GLenum          mode,
+    const GLfloat*  vertices,
+    GLsizei         num_vertices,
+    SeeError**      error
+    )
+{
+    const PsyMeshClass* cls = psy_mesh_class();
+    const SeeObjectClass* see_cls = SEE_OBJECT_CLASS(cls);
+
+    if (!cls)
+        return SEE_NOT_INITIALIZED;
+
+    if (!mesh || *mesh || !vertices || num_vertices <= 0)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return see_cls->new_obj(
+        see_cls, 0, (SeeObject**) mesh, mode, vertices, num_vertices, error
+        );
+}
+
+int
+psy_mesh_create_primitive(
+    PsyMesh**           mesh,
+    const PsyPrimitive* primitive,
+    SeeError**          error
+    )
+{
+    GLfloat* vertices;
+    GLenum mode;
+    GLsizei count;
+    int ret;
+
+    if (!mesh || *mesh || !primitive || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    ret = check_primitive(primitive, error);
+    if (ret)
+        return ret;
+
+    vertices = tessellate(primitive, &mode, &count);
+    if (!vertices) {
+        set_error(error, __func__, "out of memory");
+        return SEE_ERROR_RUNTIME;
+    }
+
+    ret = psy_mesh_create(mesh, mode, vertices, count, error);
+    free(vertices);
+    return ret;
+}
+
+int
+psy_mesh_draw(PsyMesh* mesh, const PsyShaderProgram* program, SeeError** error)
+{
+    if (!mesh || !program || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_MESH_GET_CLASS(mesh)->draw(mesh, program, error);
+}
+
+GLsizei
+psy_mesh_num_vertices(const PsyMesh* mesh)
+{
+    return mesh ? mesh->num_vertices : 0;
+}
+
+GLenum
+psy_mesh_mode(const PsyMesh* mesh)
+{
+    return mesh ? mesh->mode : GL_TRIANGLES;
+}
+
+/* **** initialization of the class **** */
+
+PsyMeshClass* g_PsyMeshClass = NULL;
+
+static int psy_mesh_class_init(SeeObjectClass* new_cls) {
+    int ret = SEE_SUCCESS;
+
+    /* Override the functions on the parent here */
+    new_cls->init = init;
+    new_cls->name = "PsyMesh";
+    new_cls->destroy = destroy;
+
+    /* Set the function pointers of the own class here */
+    PsyMeshClass* cls = (PsyMeshClass*) new_cls;
+
+    cls->mesh_init  = mesh_init;
+    cls->draw       = mesh_draw;
+
+    return ret;
+}
+
+/**
+ * \private
+ * \brief this class initializes PsyMesh(Class).
+ *
+ * You might want to call this from the library initialization func.
+ */
+int
+psy_mesh_init() {
+    int ret;
+    const SeeMetaClass* meta = see_meta_class_class();
+
+    ret = see_meta_class_new_class(
+        meta,
+        (SeeObjectClass**) &g_PsyMeshClass,
+        sizeof(PsyMeshClass),
+        sizeof(PsyMesh),
+        see_object_class(),
+        sizeof(SeeObjectClass),
+        psy_mesh_class_init
+        );
+
+    return ret;
+}
+
+void
+psy_mesh_deinit()
+{
+    if(!g_PsyMeshClass)
+        return;
+
+    see_object_decref((SeeObject*) g_PsyMeshClass);
+    g_PsyMeshClass = NULL;
+}
+
+const PsyMeshClass*
+psy_mesh_class()
+{
+    return g_PsyMeshClass;
+}
@@ -0,0 +1,204 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file Mesh.h
+ * \brief Static 2D geometry in a vertex buffer.
+ *
+ * A PsyMesh holds vertices that don't change in a buffer on the GPU, with
+ * a vertex array object when the context has them. The common primitives
+ * (circles, annuli, rectangles and crosses) are tessellated once by
+ * psy_mesh_create_primitive(); they fit the square from (-0.5, -0.5) to
+ * (0.5, 0.5), so the transform they're drawn with gives them their
+ * position and size. See PsyMeshCache to share them between stimuli.
+ */
+
+#ifndef PSY_MESH_H
+#define PSY_MESH_H
+
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+
+#include "psy_export.h"
+#include "ShaderProgram.h"
+#include "gl/includes_gl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _PsyMesh PsyMesh;
+typedef struct _PsyMeshClass PsyMeshClass;
+
+/**
+ * \brief The primitives that psy_mesh_create_primitive() tessellates.
+ */
+typedef enum {
+    PSY_MESH_CIRCLE,    ///< A filled circle.
+    PSY_MESH_ANNULUS,   ///< A ring, ratio is the inner / outer radius.
+    PSY_MESH_RECTANGLE, ///< A filled square.
+    PSY_MESH_CROSS      ///< A plus sign, ratio is the width of the arms.
+} PsyMeshShape;
+
+/**
+ * \brief A primitive with its tessellation.
+ *
+ * Fields that don't apply to the shape are ignored, so e.g. rectangles
+ * with different segments are the same primitive.
+ */
+typedef struct {
+    PsyMeshShape    shape;
+    unsigned        segments;   ///< Of circles and annuli, at least 3.
+    GLfloat         ratio;      ///< Of annuli and crosses, in (0, 1).
+} PsyPrimitive;
+
+struct _PsyMesh {
+    SeeObject parent_obj;
+
+    /*expand PsyMesh data here*/
+
+    GLenum      mode;
+    GLsizei     num_vertices;
+    GLuint      vbo;
+    GLuint      vao;    // 0 without vertex array objects
+};
+
+struct _PsyMeshClass {
+    SeeObjectClass parent_cls;
+
+    int (*mesh_init)(
+        PsyMesh*            mesh,
+        const PsyMeshClass* mesh_cls,
+        GLenum              mode,
+        const GLfloat*      vertices,
+        GLsizei             num_vertices,
+        SeeError**          error
+        );
+
+    int (*draw)(
+        PsyMesh*                mesh,
+        const PsyShaderProgram* program,
+        SeeError**              error
+        );
+};
+
+/* **** function style macro casts **** */
+
+/**
+ * \brief cast a pointer from a PsyMesh derived instance back to a
+ *        pointer to PsyMesh.
+ */
+#define PSY_MESH(obj)                      \
+    ((PsyMesh*) obj)
+
+/**
+ * \brief cast a pointer to PsyMeshClass derived class back to a
+ *        pointer to PsyMeshClass.
+ */
+#define PSY_MESH_CLASS(cls)                      \
+    ((const PsyMeshClass*) cls)
+
+/**
+ * \brief obtain a pointer to PsyMeshClass from a instance of
+ *        derived from PsyMesh.
+ */
+#define PSY_MESH_GET_CLASS(obj)                \
+    (PSY_MESH_CLASS(see_object_get_class(SEE_OBJECT(obj)) ) )
+
+/* **** public functions **** */
+
+/**
+ * \brief Create a mesh from vertices.
+ *
+ * @param [out] mesh            The new mesh, should be NULL.
+ * @param [in]  mode            How the vertices are assembled, e.g.
+ *                              GL_TRIANGLES or GL_TRIANGLE_STRIP.
+ * @param [in]  vertices        x, y pairs, they are copied to the GPU.
+ * @param [in]  num_vertices    The number of pairs.
+ * @param [out] error           If an error occurs, it's returned here.
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_mesh_create(
+    PsyMesh**       mesh,
+    GLenum          mode,
+    const GLfloat*  vertices,
+    GLsizei         num_vertices,
+    SeeError**      error
+    );
+
+/**
+ * \brief Tessellate a primitive into a new mesh.
+ *
+ * @return SEE_SUCCESS, or SEE_INVALID_ARGUMENT with an error when the
+ *         segments or ratio don't make a primitive.
+ */
+PSY_EXPORT int
+psy_mesh_create_primitive(
+    PsyMesh**           mesh,
+    const PsyPrimitive* primitive,
+    SeeError**          error
+    );
+
+/**
+ * \brief Draw the mesh with a program that's set up by the caller.
+ *
+ * The program is made current, its uniforms are left to the caller. The
+ * vertices are the attribute a_position, which the vertex array object
+ * binds to location 0, as the builtin shaders declare it.
+ */
+PSY_EXPORT int
+psy_mesh_draw(PsyMesh* mesh, const PsyShaderProgram* program, SeeError** error);
+
+/**
+ * \brief The number of vertices of the mesh.
+ */
+PSY_EXPORT GLsizei
+psy_mesh_num_vertices(const PsyMesh* mesh);
+
+/**
+ * \brief The mode the vertices are drawn with.
+ */
+PSY_EXPORT GLenum
+psy_mesh_mode(const PsyMesh* mesh);
+
+/**
+ * Gets the pointer to the PsyMeshClass table.
+ */
+PSY_EXPORT const PsyMeshClass*
+psy_mesh_class();
+
+/* **** class initialization functions **** */
+
+/**
+ * Initialize PsyMesh; make it ready for use.
+ */
+PSY_EXPORT
+int psy_mesh_init();
+
+/**
+ * Deinitialize PsyMesh, after PsyMesh has been deinitialized,
+ * all functions in this header shouldn't be used anymore.
+ */
+PSY_EXPORT
+void psy_mesh_deinit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_MESH_H
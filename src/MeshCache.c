@@ -0,0 +1,320 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include "MetaClass.h"
+#include "Error.h"
+#include "MeshCache.h"
+
+struct CachedMesh {
+    PsyPrimitive    key;
+    PsyMesh*        mesh;
+};
+
+static const GLfloat g_identity[16] = {
+    1.0f, 0.0f, 0.0f, 0.0f,
+    0.0f, 1.0f, 0.0f, 0.0f,
+    0.0f, 0.0f, 1.0f, 0.0f,
+    0.0f, 0.0f, 0.0f, 1.0f
+};
+
+/* Clears the fields that don't apply to the shape, so they don't count. */
+static PsyPrimitive
+make_key(const PsyPrimitive* primitive)
+{
+    PsyPrimitive key = *primitive;
+
+    if (key.shape == PSY_MESH_RECTANGLE || key.shape == PSY_MESH_CROSS)
+        key.segments = 0;
+    if (key.shape == PSY_MESH_RECTANGLE || key.shape == PSY_MESH_CIRCLE)
+        key.ratio = 0.0f;
+    return key;
+}
+
+static PsyMesh*
+find_mesh(const PsyMeshCache* cache, const PsyPrimitive* key)
+{
+    size_t i;
+
+    for (i = 0; i < cache->num_meshes; i++) {
+        const PsyPrimitive* other = &cache->meshes[i].key;
+        if (other->shape == key->shape &&
+            other->segments == key->segments &&
+            other->ratio == key->ratio)
+            return cache->meshes[i].mesh;
+    }
+    return NULL;
+}
+
+/* **** functions that implement PsyMeshCache or override SeeObject **** */
+
+static int
+mesh_cache_init(
+    PsyMeshCache*               cache,
+    const PsyMeshCacheClass*    cache_cls,
+    SeeError**                  error
+    )
+{
+    const SeeObjectClass* parent_cls = SEE_OBJECT_CLASS(cache_cls);
+    (void) error;
+
+    parent_cls->object_init(
+        SEE_OBJECT(cache),
+        SEE_OBJECT_CLASS(cache_cls)
+        );
+
+    return SEE_SUCCESS;
+}
+
+static int
+init(const SeeObjectClass* cls, SeeObject* obj, va_list args)
+{
+    const PsyMeshCacheClass* cache_cls = PSY_MESH_CACHE_CLASS(cls);
+    PsyMeshCache* cache = PSY_MESH_CACHE(obj);
+
+    SeeError** error = va_arg(args, SeeError**);
+
+    return cache_cls->mesh_cache_init(cache, cache_cls, error);
+}
+
+static void
+destroy(SeeObject* obj)
+{
+    PsyMeshCache* cache = PSY_MESH_CACHE(obj);
+
+    psy_mesh_cache_clear(cache);
+    free(cache->meshes);
+    if (cache->program)
+        see_object_decref(SEE_OBJECT(cache->program));
+
+    see_object_class()->destroy(obj);
+}
+
+static int
+mesh_cache_get(
+    PsyMeshCache*       cache,
+    const PsyPrimitive* primitive,
+    PsyMesh**           mesh,
+    SeeError**          error
+    )
+{
+    PsyPrimitive key = make_key(primitive);
+    CachedMesh* entry;
+    int ret;
+
+    *mesh = find_mesh(cache, &key);
+    if (*mesh)
+        return SEE_SUCCESS;
+
+    if (cache->num_meshes == cache->capacity) {
+        size_t capacity = cache->capacity ? cache->capacity * 2 : 8;
+        CachedMesh* meshes = realloc(cache->meshes, capacity * sizeof(CachedMesh));
+        if (!meshes) {
+            PsyError* err = NULL;
+            psy_error_create(&err);
+            psy_error_printf(err, "%s: out of memory", __func__);
+            *error = SEE_ERROR(err);
+            return SEE_ERROR_RUNTIME;
+        }
+        cache->meshes = meshes;
+        cache->capacity = capacity;
+    }
+
+    entry = &cache->meshes[cache->num_meshes];
+    entry->key = key;
+    entry->mesh = NULL;
+    ret = psy_mesh_create_primitive(&entry->mesh, &key, error);
+    if (ret)
+        return ret;
+
+    cache->num_meshes++;
+    *mesh = entry->mesh;
+    return SEE_SUCCESS;
+}
+
+static int
+mesh_cache_draw(
+    PsyMeshCache*       cache,
+    const PsyPrimitive* primitive,
+    const GLfloat*      transform,
+    const GLfloat*      color,
+    SeeError**          error
+    )
+{
+    PsyMesh* mesh = NULL;
+    int ret;
+
+    ret = PSY_MESH_CACHE_GET_CLASS(cache)->get(cache, primitive, &mesh, error);
+    if (ret)
+        return ret;
+
+    if (!cache->program) {
+        ret = psy_shader_program_create_builtin(
+            &cache->program, "uniform_color", "uniform_color", error
+            );
+        if (ret)
+            return ret;
+    }
+
+    ret = psy_shader_use_program(cache->program, error);
+    if (ret)
+        return ret;
+    glUniformMatrix4fv(
+        psy_shader_program_uniform_location(cache->program, "u_transform"),
+        1,
+        GL_FALSE,
+        transform ? transform : g_identity
+        );
+    glUniform4fv(
+        psy_shader_program_uniform_location(cache->program, "u_color"),
+        1,
+        color
+        );
+
+    return psy_mesh_draw(mesh, cache->program, error);
+}
+
+/* **** implementation of the public API **** */
+
+int
+psy_mesh_cache_create(PsyMeshCache** cache, SeeError** error)
+{
+    const PsyMeshCacheClass* cls = psy_mesh_cache_class();
+    const SeeObjectClass* see_cls = SEE_OBJECT_CLASS(cls);
+
+    if (!cls)
+        return SEE_NOT_INITIALIZED;
+
+    if (!cache || *cache)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return see_cls->new_obj(see_cls, 0, (SeeObject**) cache, error);
+}
+
+int
+psy_mesh_cache_get(
+    PsyMeshCache*       cache,
+    const PsyPrimitive* primitive,
+    PsyMesh**           mesh,
+    SeeError**          error
+    )
+{
+    if (!cache || !primitive || !mesh || *mesh || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_MESH_CACHE_GET_CLASS(cache)->get(cache, primitive, mesh, error);
+}
+
+int
+psy_mesh_cache_draw(
+    PsyMeshCache*       cache,
+    const PsyPrimitive* primitive,
+    const GLfloat*      transform,
+    const GLfloat*      color,
+    SeeError**          error
+    )
+{
+    if (!cache || !primitive || !color || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_MESH_CACHE_GET_CLASS(cache)->draw(
+        cache, primitive, transform, color, error
+        );
+}
+
+void
+psy_mesh_cache_clear(PsyMeshCache* cache)
+{
+    size_t i;
+
+    if (!cache)
+        return;
+    for (i = 0; i < cache->num_meshes; i++)
+        see_object_decref(SEE_OBJECT(cache->meshes[i].mesh));
+    cache->num_meshes = 0;
+}
+
+size_t
+psy_mesh_cache_size(const PsyMeshCache* cache)
+{
+    return cache ? cache->num_meshes : 0;
+}
+
+/* **** initialization of the class **** */
+
+PsyMeshCacheClass* g_PsyMeshCacheClass = NULL;
+
+static int psy_mesh_cache_class_init(SeeObjectClass* new_cls) {
+    int ret = SEE_SUCCESS;
+
+    /* Override the functions on the parent here */
+    new_cls->init = init;
+    new_cls->name = "PsyMeshCache";
+    new_cls->destroy = destroy;
+
+    /* Set the function pointers of the own class here */
+    PsyMeshCacheClass* cls = (PsyMeshCacheClass*) new_cls;
+
+    cls->mesh_cache_init    = mesh_cache_init;
+    cls->get                = mesh_cache_get;
+    cls->draw               = mesh_cache_draw;
+
+    return ret;
+}
+
+/**
+ * \private
+ * \brief this class initializes PsyMeshCache(Class).
+ *
+ * You might want to call this from the library initialization func.
+ */
+int
+psy_mesh_cache_init() {
+    int ret;
+    const SeeMetaClass* meta = see_meta_class_class();
+
+    ret = see_meta_class_new_class(
+        meta,
+        (SeeObjectClass**) &g_PsyMeshCacheClass,
+        sizeof(PsyMeshCacheClass),
+        sizeof(PsyMeshCache),
+        see_object_class(),
+        sizeof(SeeObjectClass),
+        psy_mesh_cache_class_init
+        );
+
+    return ret;
+}
+
+void
+psy_mesh_cache_deinit()
+{
+    if(!g_PsyMeshCacheClass)
+        return;
+
+    see_object_decref((SeeObject*) g_PsyMeshCacheClass);
+    g_PsyMeshCacheClass = NULL;
+}
+
+const PsyMeshCacheClass*
+psy_mesh_cache_class()
+{
+    return g_PsyMeshCacheClass;
+}
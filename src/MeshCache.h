@@ -0,0 +1,198 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file MeshCache.h
+ * \brief Shares the meshes of primitives between stimuli.
+ *
+ * Tessellating a circle and creating its buffers in every frame, or for
+ * every stimulus, costs far more than drawing it. A PsyMeshCache creates
+ * the mesh of a primitive the first time it's asked for and returns the
+ * same mesh for the same shape, tessellation and ratio afterwards. The
+ * stimuli position and size the shared mesh with their transform.
+ *
+ * Vertex array objects aren't shared between OpenGL contexts, so every
+ * window has a cache of its own, see psy_window_mesh_cache().
+ */
+
+#ifndef PSY_MESH_CACHE_H
+#define PSY_MESH_CACHE_H
+
+#include <stddef.h>
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+
+#include "psy_export.h"
+#include "Mesh.h"
+#include "ShaderProgram.h"
+#include "gl/includes_gl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _PsyMeshCache PsyMeshCache;
+typedef struct _PsyMeshCacheClass PsyMeshCacheClass;
+
+/* A mesh and its primitive, these are private to MeshCache.c. */
+typedef struct CachedMesh CachedMesh;
+
+struct _PsyMeshCache {
+    SeeObject parent_obj;
+
+    /*expand PsyMeshCache data here*/
+
+    CachedMesh*         meshes;
+    size_t              num_meshes;
+    size_t              capacity;
+
+    PsyShaderProgram*   program;    // uniform_color, for psy_mesh_cache_draw
+};
+
+struct _PsyMeshCacheClass {
+    SeeObjectClass parent_cls;
+
+    int (*mesh_cache_init)(
+        PsyMeshCache*               cache,
+        const PsyMeshCacheClass*    cache_cls,
+        SeeError**                  error
+        );
+
+    int (*get)(
+        PsyMeshCache*       cache,
+        const PsyPrimitive* primitive,
+        PsyMesh**           mesh,
+        SeeError**          error
+        );
+
+    int (*draw)(
+        PsyMeshCache*       cache,
+        const PsyPrimitive* primitive,
+        const GLfloat*      transform,
+        const GLfloat*      color,
+        SeeError**          error
+        );
+};
+
+/* **** function style macro casts **** */
+
+/**
+ * \brief cast a pointer from a PsyMeshCache derived instance back to a
+ *        pointer to PsyMeshCache.
+ */
+#define PSY_MESH_CACHE(obj)                      \
+    ((PsyMeshCache*) obj)
+
+/**
+ * \brief cast a pointer to PsyMeshCacheClass derived class back to a
+ *        pointer to PsyMeshCacheClass.
+ */
+#define PSY_MESH_CACHE_CLASS(cls)                      \
+    ((const PsyMeshCacheClass*) cls)
+
+/**
+ * \brief obtain a pointer to PsyMeshCacheClass from a instance of
+ *        derived from PsyMeshCache.
+ */
+#define PSY_MESH_CACHE_GET_CLASS(obj)                \
+    (PSY_MESH_CACHE_CLASS(see_object_get_class(SEE_OBJECT(obj)) ) )
+
+/* **** public functions **** */
+
+/**
+ * \brief Create an empty cache.
+ */
+PSY_EXPORT int
+psy_mesh_cache_create(PsyMeshCache** cache, SeeError** error);
+
+/**
+ * \brief Obtain the mesh of a primitive, tessellating it the first time.
+ *
+ * @param [in]  cache
+ * @param [in]  primitive
+ * @param [out] mesh    The mesh, should be NULL. It belongs to the cache,
+ *                      take a reference to keep it after
+ *                      psy_mesh_cache_clear().
+ * @param [out] error
+ * @return SEE_SUCCESS, or SEE_INVALID_ARGUMENT when the primitive isn't
+ *         valid, see psy_mesh_create_primitive().
+ */
+PSY_EXPORT int
+psy_mesh_cache_get(
+    PsyMeshCache*       cache,
+    const PsyPrimitive* primitive,
+    PsyMesh**           mesh,
+    SeeError**          error
+    );
+
+/**
+ * \brief Draw a primitive in one color.
+ *
+ * @param [in]  cache
+ * @param [in]  primitive
+ * @param [in]  transform   A column major 4x4 matrix that places the unit
+ *                          primitive, may be NULL.
+ * @param [in]  color       The rgba color in the range [0, 1].
+ * @param [out] error
+ */
+PSY_EXPORT int
+psy_mesh_cache_draw(
+    PsyMeshCache*       cache,
+    const PsyPrimitive* primitive,
+    const GLfloat*      transform,
+    const GLfloat*      color,
+    SeeError**          error
+    );
+
+/**
+ * \brief Release all meshes.
+ */
+PSY_EXPORT void
+psy_mesh_cache_clear(PsyMeshCache* cache);
+
+/**
+ * \brief The number of meshes in the cache.
+ */
+PSY_EXPORT size_t
+psy_mesh_cache_size(const PsyMeshCache* cache);
+
+/**
+ * Gets the pointer to the PsyMeshCacheClass table.
+ */
+PSY_EXPORT const PsyMeshCacheClass*
+psy_mesh_cache_class();
+
+/* **** class initialization functions **** */
+
+/**
+ * Initialize PsyMeshCache; make it ready for use.
+ */
+PSY_EXPORT
+int psy_mesh_cache_init();
+
+/**
+ * Deinitialize PsyMeshCache, after PsyMeshCache has been deinitialized,
+ * all functions in this header shouldn't be used anymore.
+ */
+PSY_EXPORT
+void psy_mesh_cache_deinit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_MESH_CACHE_H
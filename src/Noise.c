@@ -0,0 +1,415 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include "MetaClass.h"
+#include "Error.h"
+#include "Noise.h"
+#include "gl/GLError.h"
+#include "gl/gl_util.h"
+
+/* The number of octaves the shaders sum at most, as in noise.frag. */
+#define MAX_OCTAVES 13
+
+static const GLfloat g_quad[4][2] = {
+    {-1.0f, -1.0f}, {1.0f, -1.0f}, {-1.0f, 1.0f}, {1.0f, 1.0f}
+};
+
+static void
+set_glerror(SeeError** error, const char* func, const char* msg)
+{
+    PsyGLError* glerror = NULL;
+    psy_glerror_create(&glerror);
+    psy_error_printf(PSY_ERROR(glerror), "%s: %s", func, msg);
+    *error = SEE_ERROR(glerror);
+}
+
+static int
+clamp_octave(double octave)
+{
+    if (octave < 0)
+        return 0;
+    if (octave > MAX_OCTAVES - 1)
+        return MAX_OCTAVES - 1;
+    return (int) octave;
+}
+
+/* The octave with a lattice of 2^k pixels holds up to 0.5 / 2^k cycles. */
+static int
+octave_of_frequency(GLfloat frequency)
+{
+    return clamp_octave(floor(log2(0.5 / frequency) + 0.5));
+}
+
+static int
+octave_range(
+    const PsyNoise*             noise,
+    const PsyNoiseParameters*   params,
+    GLint                       octaves[2],
+    SeeError**                  error
+    )
+{
+    GLsizei size = noise->width > noise->height ? noise->width : noise->height;
+
+    switch (params->kind) {
+        case PSY_NOISE_WHITE:
+        case PSY_NOISE_BINARY:
+            octaves[0] = octaves[1] = 0;
+            break;
+        case PSY_NOISE_PINK:
+            octaves[0] = 0;
+            octaves[1] = clamp_octave(ceil(log2((double) size)));
+            break;
+        case PSY_NOISE_BANDPASS:
+            if (params->low_frequency <= 0.0f ||
+                params->high_frequency > 0.5f ||
+                params->low_frequency >= params->high_frequency) {
+                PsyError* err = NULL;
+                psy_error_create(&err);
+                psy_error_printf(
+                    err,
+                    "%s: the band %f - %f isn't within (0, 0.5] cycles per pixel",
+                    __func__, params->low_frequency, params->high_frequency
+                    );
+                *error = SEE_ERROR(err);
+                return SEE_INVALID_ARGUMENT;
+            }
+            octaves[0] = octave_of_frequency(params->high_frequency);
+            octaves[1] = octave_of_frequency(params->low_frequency);
+            break;
+    }
+    return SEE_SUCCESS;
+}
+
+/* **** functions that implement PsyNoise or override SeeObject **** */
+
+static int
+noise_init(
+    PsyNoise*               noise,
+    const PsyNoiseClass*    noise_cls,
+    GLsizei                 width,
+    GLsizei                 height,
+    SeeError**              error
+    )
+{
+    const SeeObjectClass* parent_cls = SEE_OBJECT_CLASS(noise_cls);
+    int ret;
+
+    parent_cls->object_init(
+        SEE_OBJECT(noise),
+        SEE_OBJECT_CLASS(noise_cls)
+        );
+
+    noise->width = width;
+    noise->height = height;
+
+    ret = psy_shader_program_create_builtin(
+        &noise->program, "noise", "noise", error
+        );
+    if (ret)
+        return ret;
+
+    ret = psy_framebuffer_create(
+        &noise->fb, width, height, PSY_FRAMEBUFFER_RGBA8, 0, error
+        );
+    if (ret)
+        return ret;
+    // Every pixel is a sample, don't let them blend when magnified.
+    psy_framebuffer_set_filter(noise->fb, GL_NEAREST);
+
+    glGenBuffers(1, &noise->quad_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, noise->quad_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(g_quad), g_quad, GL_STATIC_DRAW);
+
+    if (psy_gl_has_vertex_arrays()) {
+        GLint location = psy_shader_program_attribute_location(
+            noise->program, "a_position"
+            );
+        glGenVertexArrays(1, &noise->vao);
+        glBindVertexArray(noise->vao);
+        glEnableVertexAttribArray((GLuint) location);
+        glVertexAttribPointer((GLuint) location, 2, GL_FLOAT, GL_FALSE, 0, 0);
+        glBindVertexArray(0);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (glGetError() != GL_NO_ERROR) {
+        set_glerror(error, __func__, "unable to create the noise texture");
+        return SEE_ERROR_RUNTIME;
+    }
+    return SEE_SUCCESS;
+}
+
+static int
+init(const SeeObjectClass* cls, SeeObject* obj, va_list args)
+{
+    const PsyNoiseClass* noise_cls = PSY_NOISE_CLASS(cls);
+    PsyNoise* noise = PSY_NOISE(obj);
+
+    GLsizei width = va_arg(args, GLsizei);
+    GLsizei height = va_arg(args, GLsizei);
+    SeeError** error = va_arg(args, SeeError**);
+
+    return noise_cls->noise_init(noise, noise_cls, width, height, error);
+}
+
+static void
+destroy(SeeObject* obj)
+{
+    PsyNoise* noise = PSY_NOISE(obj);
+
+    if (noise->vao)
+        glDeleteVertexArrays(1, &noise->vao);
+    if (noise->quad_vbo)
+        glDeleteBuffers(1, &noise->quad_vbo);
+    if (noise->fb)
+        see_object_decref(SEE_OBJECT(noise->fb));
+    if (noise->program)
+        see_object_decref(SEE_OBJECT(noise->program));
+
+    see_object_class()->destroy(obj);
+}
+
+static int
+noise_generate(
+    PsyNoise*                   noise,
+    const PsyNoiseParameters*   params,
+    SeeError**                  error
+    )
+{
+    const PsyShaderProgram* program = noise->program;
+    GLint octaves[2], location;
+    GLboolean blend;
+    int ret;
+
+    ret = octave_range(noise, params, octaves, error);
+    if (ret)
+        return ret;
+
+    ret = psy_shader_use_program(program, error);
+    if (ret)
+        return ret;
+
+    glUniform1i(
+        psy_shader_program_uniform_location(program, "u_kind"),
+        params->kind == PSY_NOISE_BANDPASS ? 2 : (GLint) params->kind
+        );
+    if (psy_gl_context_is_es())
+        glUniform1f(
+            psy_shader_program_uniform_location(program, "u_seed"),
+            (GLfloat) (params->seed % 65536u)
+            );
+    else
+        glUniform1ui(
+            psy_shader_program_uniform_location(program, "u_seed"),
+            params->seed
+            );
+    glUniform2iv(psy_shader_program_uniform_location(program, "u_octaves"), 1, octaves);
+    glUniform1f(psy_shader_program_uniform_location(program, "u_mean"), params->mean);
+    glUniform1f(
+        psy_shader_program_uniform_location(program, "u_contrast"),
+        params->contrast
+        );
+
+    blend = glIsEnabled(GL_BLEND);
+    psy_framebuffer_bind(noise->fb);
+    glDisable(GL_BLEND);
+
+    location = psy_shader_program_attribute_location(program, "a_position");
+    if (noise->vao) {
+        glBindVertexArray(noise->vao);
+    }
+    else if (location >= 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, noise->quad_vbo);
+        glEnableVertexAttribArray((GLuint) location);
+        glVertexAttribPointer((GLuint) location, 2, GL_FLOAT, GL_FALSE, 0, 0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    if (noise->vao)
+        glBindVertexArray(0);
+    else
+        psy_gl_disable_attributes(&location, 1);
+    if (blend)
+        glEnable(GL_BLEND);
+    psy_framebuffer_unbind(noise->fb);
+
+    if (glGetError() != GL_NO_ERROR) {
+        set_glerror(error, __func__, "unable to render the noise");
+        return SEE_ERROR_RUNTIME;
+    }
+    noise->generated = 1;
+    return SEE_SUCCESS;
+}
+
+static int
+noise_read(PsyNoise* noise, unsigned char* pixels, SeeError** error)
+{
+    size_t i, n = (size_t) noise->width * (size_t) noise->height;
+    unsigned char* rgba;
+    int ret;
+
+    if (!noise->generated) {
+        set_glerror(error, __func__, "no noise has been generated");
+        return SEE_ERROR_RUNTIME;
+    }
+
+    rgba = malloc(n * 4);
+    if (!rgba) {
+        set_glerror(error, __func__, "out of memory");
+        return SEE_ERROR_RUNTIME;
+    }
+
+    ret = psy_framebuffer_read(noise->fb, rgba, error);
+    if (ret == SEE_SUCCESS)
+        for (i = 0; i < n; i++)
+            pixels[i] = rgba[i * 4];
+    free(rgba);
+
+    return ret;
+}
+
+/* **** implementation of the public API **** */
+
+int
+psy_noise_create(
+    PsyNoise**  noise,
+    GLsizei     width,
+    GLsizei     height,
+    SeeError**  error
+    )
+{
+    const PsyNoiseClass* cls = psy_noise_class();
+    const SeeObjectClass* see_cls = SEE_OBJECT_CLASS(cls);
+
+    if (!cls)
+        return SEE_NOT_INITIALIZED;
+
+    if (!noise || *noise || width <= 0 || height <= 0)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return see_cls->new_obj(
+        see_cls, 0, (SeeObject**) noise, width, height, error
+        );
+}
+
+int
+psy_noise_generate(
+    PsyNoise*                   noise,
+    const PsyNoiseParameters*   params,
+    SeeError**                  error
+    )
+{
+    if (!noise || !params || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_NOISE_GET_CLASS(noise)->generate(noise, params, error);
+}
+
+int
+psy_noise_read(PsyNoise* noise, unsigned char* pixels, SeeError** error)
+{
+    if (!noise || !pixels || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_NOISE_GET_CLASS(noise)->read(noise, pixels, error);
+}
+
+GLuint
+psy_noise_texture(const PsyNoise* noise)
+{
+    return noise ? psy_framebuffer_texture(noise->fb) : 0;
+}
+
+void
+psy_noise_size(const PsyNoise* noise, int* width, int* height)
+{
+    if (!noise)
+        return;
+    if (width)
+        *width = noise->width;
+    if (height)
+        *height = noise->height;
+}
+
+/* **** initialization of the class **** */
+
+PsyNoiseClass* g_PsyNoiseClass = NULL;
+
+static int psy_noise_class_init(SeeObjectClass* new_cls) {
+    int ret = SEE_SUCCESS;
+
+    /* Override the functions on the parent here */
+    new_cls->init = init;
+    new_cls->name = "PsyNoise";
+    new_cls->destroy = destroy;
+
+    /* Set the function pointers of the own class here */
+    PsyNoiseClass* cls = (PsyNoiseClass*) new_cls;
+
+    cls->noise_init = noise_init;
+    cls->generate   = noise_generate;
+    cls->read       = noise_read;
+
+    return ret;
+}
+
+/**
+ * \private
+ * \brief this class initializes PsyNoise(Class).
+ *
+ * You might want to call this from the library initialization func.
+ */
+int
+psy_noise_init() {
+    int ret;
+    const SeeMetaClass* meta = see_meta_class_class();
+
+    ret = see_meta_class_new_class(
+        meta,
+        (SeeObjectClass**) &g_PsyNoiseClass,
+        sizeof(PsyNoiseClass),
+        sizeof(PsyNoise),
+        see_object_class(),
+        sizeof(SeeObjectClass),
+        psy_noise_class_init
+        );
+
+    return ret;
+}
+
+void
+psy_noise_deinit()
+{
+    if(!g_PsyNoiseClass)
+        return;
+
+    see_object_decref((SeeObject*) g_PsyNoiseClass);
+    g_PsyNoiseClass = NULL;
+}
+
+const PsyNoiseClass*
+psy_noise_class()
+{
+    return g_PsyNoiseClass;
+}
@@ -0,0 +1,219 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file Noise.h
+ * \brief Generates noise textures on the GPU.
+ *
+ * Noise masks and backgrounds are often as large as the screen; computing
+ * them on the CPU and uploading them takes far longer than a frame. A
+ * PsyNoise renders the noise into the texture of a framebuffer with a
+ * fragment shader instead, which takes a fraction of a frame.
+ *
+ * The noise is seeded: the value of a pixel is computed by hashing its
+ * position, the seed and the octave, so the same seed gives the same
+ * noise again. The pixels can be read back with psy_noise_read(), e.g. to
+ * log the exact noise of a trial. Note that OpenGL ES 2.0 has no integer
+ * arithmetic in its shaders, there the hash is different and a seed gives
+ * other noise than with desktop OpenGL.
+ *
+ * Pink and band-pass noise are made of octaves: gaussian noise on a
+ * lattice of 2^k pixels that is interpolated smoothly. Summing octaves of
+ * equal variance gives an amplitude spectrum that falls off with 1/f
+ * over the frequencies of the octaves. Band-pass noise only sums the
+ * octaves between two frequencies, so the band is approximated by whole
+ * octaves.
+ */
+
+#ifndef PSY_NOISE_H
+#define PSY_NOISE_H
+
+#include <stdint.h>
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+
+#include "psy_export.h"
+#include "Framebuffer.h"
+#include "ShaderProgram.h"
+#include "gl/includes_gl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _PsyNoise PsyNoise;
+typedef struct _PsyNoiseClass PsyNoiseClass;
+
+/**
+ * \brief The spectrum of the noise.
+ */
+typedef enum {
+    PSY_NOISE_WHITE,    ///< Independent gaussian values per pixel.
+    PSY_NOISE_BINARY,   ///< Independent pixels of mean +/- contrast.
+    PSY_NOISE_PINK,     ///< A 1/f amplitude spectrum.
+    PSY_NOISE_BANDPASS  ///< 1/f noise between two frequencies.
+} PsyNoiseKind;
+
+/**
+ * \brief Describes the noise that is generated.
+ */
+typedef struct _PsyNoiseParameters {
+    PsyNoiseKind    kind;
+    uint32_t        seed;           ///< The same seed gives the same noise.
+    GLfloat         mean;           ///< The mean luminance in [0, 1].
+    GLfloat         contrast;       ///< The standard deviation around mean.
+    GLfloat         low_frequency;  ///< Band-pass: cycles per pixel.
+    GLfloat         high_frequency; ///< Band-pass: at most 0.5 cycles per pixel.
+} PsyNoiseParameters;
+
+struct _PsyNoise {
+    SeeObject parent_obj;
+
+    /*expand PsyNoise data here*/
+
+    GLsizei             width;
+    GLsizei             height;
+    PsyFramebuffer*     fb;
+    GLuint              vao;
+    GLuint              quad_vbo;
+    PsyShaderProgram*   program;
+    int                 generated;
+};
+
+struct _PsyNoiseClass {
+    SeeObjectClass parent_cls;
+
+    int (*noise_init)(
+        PsyNoise*               noise,
+        const PsyNoiseClass*    noise_cls,
+        GLsizei                 width,
+        GLsizei                 height,
+        SeeError**              error
+        );
+
+    int (*generate)(
+        PsyNoise*                   noise,
+        const PsyNoiseParameters*   params,
+        SeeError**                  error
+        );
+
+    int (*read)(PsyNoise* noise, unsigned char* pixels, SeeError** error);
+};
+
+/* **** function style macro casts **** */
+
+/**
+ * \brief cast a pointer from a PsyNoise derived instance back to a
+ *        pointer to PsyNoise.
+ */
+#define PSY_NOISE(obj)                      \
+    ((PsyNoise*) obj)
+
+/**
+ * \brief cast a pointer to PsyNoiseClass derived class back to a
+ *        pointer to PsyNoiseClass.
+ */
+#define PSY_NOISE_CLASS(cls)                      \
+    ((const PsyNoiseClass*) cls)
+
+/**
+ * \brief obtain a pointer to PsyNoiseClass from a instance of
+ *        derived from PsyNoise.
+ */
+#define PSY_NOISE_GET_CLASS(obj)                \
+    (PSY_NOISE_CLASS(see_object_get_class(SEE_OBJECT(obj)) ) )
+
+/* **** public functions **** */
+
+/**
+ * \brief Create a noise generator with a texture of width by height
+ * pixels.
+ *
+ * @param [out] noise   The new generator, should be NULL.
+ * @param [in]  width   The width of the texture.
+ * @param [in]  height  The height of the texture.
+ * @param [out] error   If an error occurs, it's returned here.
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_noise_create(
+    PsyNoise**  noise,
+    GLsizei     width,
+    GLsizei     height,
+    SeeError**  error
+    );
+
+/**
+ * \brief Render noise into the texture, replacing the previous noise.
+ */
+PSY_EXPORT int
+psy_noise_generate(
+    PsyNoise*                   noise,
+    const PsyNoiseParameters*   params,
+    SeeError**                  error
+    );
+
+/**
+ * \brief Read the generated noise back.
+ *
+ * @param [in]  noise
+ * @param [out] pixels  width * height bytes, the rows from bottom to top.
+ * @param [out] error
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_noise_read(PsyNoise* noise, unsigned char* pixels, SeeError** error);
+
+/**
+ * \brief The texture with the noise, it's GL_RGBA with equal red, green
+ * and blue.
+ */
+PSY_EXPORT GLuint
+psy_noise_texture(const PsyNoise* noise);
+
+/**
+ * \brief Obtain the size in pixels of the texture.
+ */
+PSY_EXPORT void
+psy_noise_size(const PsyNoise* noise, int* width, int* height);
+
+/**
+ * Gets the pointer to the PsyNoiseClass table.
+ */
+PSY_EXPORT const PsyNoiseClass*
+psy_noise_class();
+
+/* **** class initialization functions **** */
+
+/**
+ * Initialize PsyNoise; make it ready for use.
+ */
+PSY_EXPORT
+int psy_noise_init();
+
+/**
+ * Deinitialize PsyNoise, after PsyNoise has been deinitialized,
+ * all functions in this header shouldn't be used anymore.
+ */
+PSY_EXPORT
+void psy_noise_deinit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_NOISE_H
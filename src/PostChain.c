@@ -0,0 +1,828 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "MetaClass.h"
+#include "Error.h"
+#include "PostChain.h"
+#include "Trace.h"
+#include "gl/GLError.h"
+#include "gl/gl_util.h"
+
+/* The widest blur, its kernel has 2 * 30 + 1 samples. */
+#define MAX_BLUR_SIGMA 10.0f
+
+typedef enum {
+    PASS_BLUR_H,
+    PASS_BLUR_V,
+    PASS_WARP,
+    PASS_GAMMA,
+    PASS_ENCODE_MONO
+} PassKind;
+
+struct PostPass {
+    PassKind    kind;
+    GLfloat     a;          // uploaded as u_pass<n>.x
+    GLfloat     b;          // uploaded as u_pass<n>.y
+    int         radius;     // of a blur, it's a loop bound in the shader
+};
+
+/* Passes that are drawn with one program. */
+struct PostGroup {
+    size_t              first;
+    size_t              count;
+    PsyShaderProgram*   program;
+    int                 gpu_scope;  // of the gpu timer, -1 until it's looked up
+};
+
+/* A growing string for the generated shaders. */
+typedef struct {
+    char*   data;
+    size_t  length;
+    size_t  capacity;
+} Source;
+
+static const GLfloat g_quad[4][2] = {
+    {-1.0f, -1.0f}, {1.0f, -1.0f}, {-1.0f, 1.0f}, {1.0f, 1.0f}
+};
+
+static const char* g_prelude =
+    "#version 330 core\n"
+    "\n"
+    "uniform sampler2D u_texture;\n"
+    "uniform vec2 u_texel;\n"
+    "\n"
+    "in vec2 v_texcoord;\n"
+    "\n"
+    "out vec4 frag_color;\n"
+    "\n"
+    "#define SAMPLE(uv) texture(u_texture, uv)\n";
+
+static const char* g_prelude_es =
+    "#version 100\n"
+    "\n"
+    "#ifdef GL_FRAGMENT_PRECISION_HIGH\n"
+    "precision highp float;\n"
+    "#else\n"
+    "precision mediump float;\n"
+    "#endif\n"
+    "\n"
+    "uniform sampler2D u_texture;\n"
+    "uniform vec2 u_texel;\n"
+    "\n"
+    "varying vec2 v_texcoord;\n"
+    "\n"
+    "#define SAMPLE(uv) texture2D(u_texture, uv)\n"
+    "#define frag_color gl_FragColor\n";
+
+static void
+set_error(SeeError** error, const char* func, const char* msg)
+{
+    PsyError* err = NULL;
+    psy_error_create(&err);
+    psy_error_printf(err, "%s: %s", func, msg);
+    *error = SEE_ERROR(err);
+}
+
+static int
+samples_neighbours(PassKind kind)
+{
+    return kind == PASS_BLUR_H || kind == PASS_BLUR_V || kind == PASS_WARP;
+}
+
+static int
+source_append(Source* src, const char* fmt, ...)
+{
+    va_list args;
+    int n;
+
+    for (;;) {
+        size_t room = src->capacity - src->length;
+        char* data;
+
+        va_start(args, fmt);
+        n = vsnprintf(src->data + src->length, room, fmt, args);
+        va_end(args);
+        if (n < 0)
+            return -1;
+        if ((size_t) n < room) {
+            src->length += (size_t) n;
+            return 0;
+        }
+
+        data = realloc(src->data, (src->capacity + (size_t) n + 1) * 2);
+        if (!data)
+            return -1;
+        src->data = data;
+        src->capacity = (src->capacity + (size_t) n + 1) * 2;
+    }
+}
+
+static int
+append_pass(Source* src, const PostPass* pass, size_t n)
+{
+    switch (pass->kind) {
+        case PASS_BLUR_H:
+        case PASS_BLUR_V:
+            return source_append(
+                src,
+                "    {\n"
+                "        float total = 0.0;\n"
+                "        color = vec4(0.0);\n"
+                "        for (int i = -%d; i <= %d; i++) {\n"
+                "            float w = exp(-float(i * i) / (2.0 * u_pass%zu.x * u_pass%zu.x));\n"
+                "            color += w * SAMPLE(v_texcoord + float(i) * vec2(%s));\n"
+                "            total += w;\n"
+                "        }\n"
+                "        color /= total;\n"
+                "    }\n",
+                pass->radius, pass->radius, n, n,
+                pass->kind == PASS_BLUR_H ? "u_texel.x, 0.0" : "0.0, u_texel.y"
+                );
+        case PASS_WARP:
+            return source_append(
+                src,
+                "    {\n"
+                "        vec2 d = v_texcoord * 2.0 - 1.0;\n"
+                "        float r2 = dot(d, d);\n"
+                "        vec2 uv = d * (1.0 + u_pass%zu.x * r2 + u_pass%zu.y * r2 * r2) * 0.5 + 0.5;\n"
+                "        if (any(lessThan(uv, vec2(0.0))) || any(greaterThan(uv, vec2(1.0))))\n"
+                "            color = vec4(0.0, 0.0, 0.0, 1.0);\n"
+                "        else\n"
+                "            color = SAMPLE(uv);\n"
+                "    }\n",
+                n, n
+                );
+        case PASS_GAMMA:
+            return source_append(
+                src,
+                "    color.rgb = pow(max(color.rgb, vec3(0.0)), vec3(1.0 / u_pass%zu.x));\n",
+                n
+                );
+        case PASS_ENCODE_MONO:
+            return source_append(
+                src,
+                "    {\n"
+                "        float l = clamp(dot(color.rgb, vec3(0.2126, 0.7152, 0.0722)), 0.0, 1.0);\n"
+                "        float v = floor(l * 65535.0 + 0.5);\n"
+                "        float high = floor(v / 256.0);\n"
+                "        color = vec4(high, v - high * 256.0, 0.0, 255.0) / 255.0;\n"
+                "    }\n"
+                );
+    }
+    return -1;
+}
+
+/*
+ * Generates the fragment shader of a group: the first pass may sample its
+ * neighbours, the others work on the color that's computed before them.
+ */
+static char*
+generate_source(const PsyPostChain* chain, const PostGroup* group)
+{
+    const PostPass* passes = &chain->passes[group->first];
+    Source src = {NULL, 0, 0};
+    size_t i;
+    int ret;
+
+    src.data = malloc(4096);
+    if (!src.data)
+        return NULL;
+    src.capacity = 4096;
+    src.data[0] = '\0';
+
+    ret = source_append(
+        &src, "%s\n", psy_gl_context_is_es() ? g_prelude_es : g_prelude
+        );
+    for (i = 0; i < group->count && !ret; i++)
+        ret = source_append(&src, "uniform vec2 u_pass%zu;\n", i);
+
+    if (!ret)
+        ret = source_append(&src, "\nvoid main()\n{\n    vec4 color;\n");
+    if (!ret && (group->count == 0 || !samples_neighbours(passes[0].kind)))
+        ret = source_append(&src, "    color = SAMPLE(v_texcoord);\n");
+    for (i = 0; i < group->count && !ret; i++)
+        ret = append_pass(&src, &passes[i], i);
+    if (!ret)
+        ret = source_append(&src, "    frag_color = color;\n}\n");
+
+    if (ret) {
+        free(src.data);
+        return NULL;
+    }
+    return src.data;
+}
+
+static int
+compile_group(const PsyPostChain* chain, PostGroup* group, SeeError** error)
+{
+    PsyShader* vertex_shader = NULL;
+    PsyShader* fragment_shader = NULL;
+    char* source;
+    int ret;
+
+    source = generate_source(chain, group);
+    if (!source) {
+        set_error(error, __func__, "out of memory");
+        return SEE_ERROR_RUNTIME;
+    }
+
+    ret = psy_shader_create(&vertex_shader, PSY_SHADER_VERTEX, error);
+    if (ret)
+        goto compile_error;
+    ret = psy_shader_compile_builtin(vertex_shader, "blit", error);
+    if (ret)
+        goto compile_error;
+
+    ret = psy_shader_create(&fragment_shader, PSY_SHADER_FRAGMENT, error);
+    if (ret)
+        goto compile_error;
+    ret = psy_shader_compile(fragment_shader, source, error);
+    if (ret)
+        goto compile_error;
+
+    ret = psy_shader_program_create(
+        &group->program, vertex_shader, fragment_shader, error
+        );
+    if (ret)
+        goto compile_error;
+    ret = psy_shader_program_link(group->program, error);
+    if (ret) {
+        see_object_decref(SEE_OBJECT(group->program));
+        group->program = NULL;
+    }
+
+compile_error:
+    see_object_decref(SEE_OBJECT(vertex_shader));
+    see_object_decref(SEE_OBJECT(fragment_shader));
+    free(source);
+    return ret;
+}
+
+static void
+forget_groups(PsyPostChain* chain)
+{
+    size_t i;
+
+    for (i = 0; i < chain->num_groups; i++)
+        if (chain->groups[i].program)
+            see_object_decref(SEE_OBJECT(chain->groups[i].program));
+    free(chain->groups);
+    chain->groups = NULL;
+    chain->num_groups = 0;
+}
+
+static int
+add_pass(
+    PsyPostChain*   chain,
+    PassKind        kind,
+    GLfloat         a,
+    GLfloat         b,
+    int             radius,
+    SeeError**      error
+    )
+{
+    PostPass* pass;
+
+    if (chain->num_passes == chain->capacity) {
+        size_t capacity = chain->capacity ? chain->capacity * 2 : 4;
+        PostPass* passes = realloc(chain->passes, capacity * sizeof(PostPass));
+        if (!passes) {
+            set_error(error, __func__, "out of memory");
+            return SEE_ERROR_RUNTIME;
+        }
+        chain->passes = passes;
+        chain->capacity = capacity;
+    }
+
+    forget_groups(chain);
+
+    pass = &chain->passes[chain->num_passes++];
+    pass->kind = kind;
+    pass->a = a;
+    pass->b = b;
+    pass->radius = radius;
+    return SEE_SUCCESS;
+}
+
+static int
+draw_group(
+    const PsyPostChain* chain,
+    const PostGroup*    group,
+    PsyFramebuffer*     source,
+    SeeError**          error
+    )
+{
+    const PsyShaderProgram* program = group->program;
+    char name[32];
+    GLint location;
+    size_t i;
+    int ret;
+
+    ret = psy_shader_use_program(program, error);
+    if (ret)
+        return ret;
+
+    glUniform1i(psy_shader_program_uniform_location(program, "u_texture"), 0);
+    glUniform2f(
+        psy_shader_program_uniform_location(program, "u_texel"),
+        1.0f / (GLfloat) chain->width,
+        1.0f / (GLfloat) chain->height
+        );
+    for (i = 0; i < group->count; i++) {
+        const PostPass* pass = &chain->passes[group->first + i];
+        snprintf(name, sizeof(name), "u_pass%zu", i);
+        glUniform2f(
+            psy_shader_program_uniform_location(program, name), pass->a, pass->b
+            );
+    }
+    psy_gl_bind_texture(0, GL_TEXTURE_2D, psy_framebuffer_texture(source));
+
+    location = psy_shader_program_attribute_location(program, "a_position");
+    if (!chain->vao && location >= 0) {
+        glEnableVertexAttribArray((GLuint) location);
+        glVertexAttribPointer((GLuint) location, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    }
+
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    if (!chain->vao)
+        psy_gl_disable_attributes(&location, 1);
+    return SEE_SUCCESS;
+}
+
+/* **** functions that implement PsyPostChain or override SeeObject **** */
+
+static int
+post_chain_init(
+    PsyPostChain*               chain,
+    const PsyPostChainClass*    chain_cls,
+    GLsizei                     width,
+    GLsizei                     height,
+    PsyFramebufferFormat        format,
+    SeeError**                  error
+    )
+{
+    const SeeObjectClass* parent_cls = SEE_OBJECT_CLASS(chain_cls);
+    int ret;
+
+    parent_cls->object_init(
+        SEE_OBJECT(chain),
+        SEE_OBJECT_CLASS(chain_cls)
+        );
+
+    chain->width = width;
+    chain->height = height;
+    chain->format = format;
+
+    ret = psy_framebuffer_create(&chain->input, width, height, format, 0, error);
+    if (ret)
+        return ret;
+
+    glGenBuffers(1, &chain->quad_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, chain->quad_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(g_quad), g_quad, GL_STATIC_DRAW);
+
+    // blit.vert puts a_position at location 0 on desktop OpenGL.
+    if (psy_gl_has_vertex_arrays()) {
+        glGenVertexArrays(1, &chain->vao);
+        glBindVertexArray(chain->vao);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
+        glBindVertexArray(0);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return SEE_SUCCESS;
+}
+
+static int
+init(const SeeObjectClass* cls, SeeObject* obj, va_list args)
+{
+    const PsyPostChainClass* chain_cls = PSY_POST_CHAIN_CLASS(cls);
+    PsyPostChain* chain = PSY_POST_CHAIN(obj);
+
+    GLsizei width = va_arg(args, GLsizei);
+    GLsizei height = va_arg(args, GLsizei);
+    PsyFramebufferFormat format = va_arg(args, PsyFramebufferFormat);
+    SeeError** error = va_arg(args, SeeError**);
+
+    return chain_cls->post_chain_init(
+        chain, chain_cls, width, height, format, error
+        );
+}
+
+static void
+destroy(SeeObject* obj)
+{
+    PsyPostChain* chain = PSY_POST_CHAIN(obj);
+
+    forget_groups(chain);
+    free(chain->passes);
+
+    if (chain->input)
+        see_object_decref(SEE_OBJECT(chain->input));
+    if (chain->targets[0])
+        see_object_decref(SEE_OBJECT(chain->targets[0]));
+    if (chain->targets[1])
+        see_object_decref(SEE_OBJECT(chain->targets[1]));
+    if (chain->vao)
+        glDeleteVertexArrays(1, &chain->vao);
+    if (chain->quad_vbo)
+        glDeleteBuffers(1, &chain->quad_vbo);
+    if (chain->gpu_timer)
+        see_object_decref(SEE_OBJECT(chain->gpu_timer));
+
+    see_object_class()->destroy(obj);
+}
+
+static int
+post_chain_build(PsyPostChain* chain, SeeError** error)
+{
+    PostGroup* group = NULL;
+    size_t i, num_targets;
+    int ret;
+
+    forget_groups(chain);
+
+    chain->groups = calloc(chain->num_passes ? chain->num_passes : 1, sizeof(PostGroup));
+    if (!chain->groups) {
+        set_error(error, __func__, "out of memory");
+        return SEE_ERROR_RUNTIME;
+    }
+
+    // A pass that samples its neighbours needs all of the previous output,
+    // so it starts a new group, the other passes join the current group.
+    group = &chain->groups[0];
+    chain->num_groups = 1;
+    for (i = 0; i < chain->num_passes; i++) {
+        if (samples_neighbours(chain->passes[i].kind) && group->count > 0) {
+            group = &chain->groups[chain->num_groups++];
+            group->first = i;
+        }
+        group->count++;
+    }
+
+    for (i = 0; i < chain->num_groups; i++) {
+        chain->groups[i].gpu_scope = -1;
+        ret = compile_group(chain, &chain->groups[i], error);
+        if (ret) {
+            forget_groups(chain);
+            return ret;
+        }
+    }
+
+    // The last group draws to the bound framebuffer, the others ping-pong.
+    num_targets = chain->num_groups - 1 < 2 ? chain->num_groups - 1 : 2;
+    for (i = 0; i < num_targets; i++) {
+        if (chain->targets[i])
+            continue;
+        ret = psy_framebuffer_create(
+            &chain->targets[i],
+            chain->width,
+            chain->height,
+            chain->format,
+            0,
+            error
+            );
+        if (ret) {
+            if (chain->targets[i])
+                see_object_decref(SEE_OBJECT(chain->targets[i]));
+            chain->targets[i] = NULL;
+            forget_groups(chain);
+            return ret;
+        }
+    }
+
+    return SEE_SUCCESS;
+}
+
+/* The scope of a group in the gpu timer, looked up on its first draw. */
+static int
+gpu_scope(PsyPostChain* chain, size_t index, SeeError** error)
+{
+    char name[32];
+    PostGroup* group = &chain->groups[index];
+
+    if (group->gpu_scope >= 0)
+        return SEE_SUCCESS;
+
+    snprintf(name, sizeof(name), "post chain %zu", index);
+    return psy_gpu_timer_scope(chain->gpu_timer, name, &group->gpu_scope, error);
+}
+
+static int
+post_chain_apply(PsyPostChain* chain, SeeError** error)
+{
+    PsyFramebuffer* source = chain->input;
+    GLint viewport[4];
+    GLboolean blend;
+    size_t i;
+    int ret = SEE_SUCCESS;
+
+    if (!chain->groups) {
+        ret = PSY_POST_CHAIN_GET_CLASS(chain)->build(chain, error);
+        if (ret)
+            return ret;
+    }
+
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_BLEND);
+    if (chain->vao)
+        glBindVertexArray(chain->vao);
+    else
+        glBindBuffer(GL_ARRAY_BUFFER, chain->quad_vbo);
+
+    for (i = 0; i < chain->num_groups && !ret; i++) {
+        PsyFramebuffer* target = NULL;
+
+        if (i + 1 < chain->num_groups) {
+            target = chain->targets[i % 2];
+            psy_framebuffer_bind(target);
+        }
+        else {
+            glViewport(0, 0, chain->width, chain->height);
+        }
+
+        if (chain->gpu_timer) {
+            ret = gpu_scope(chain, i, error);
+            if (ret)
+                break;
+            psy_gpu_timer_begin(chain->gpu_timer, chain->groups[i].gpu_scope);
+        }
+        ret = draw_group(chain, &chain->groups[i], source, error);
+        if (chain->gpu_timer)
+            psy_gpu_timer_end(chain->gpu_timer, chain->groups[i].gpu_scope);
+
+        if (target) {
+            psy_framebuffer_unbind(target);
+            source = target;
+        }
+    }
+
+    if (chain->vao)
+        glBindVertexArray(0);
+    else
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (blend)
+        glEnable(GL_BLEND);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+    if (!ret && glGetError() != GL_NO_ERROR) {
+        PsyGLError* glerror = NULL;
+        psy_glerror_create(&glerror);
+        psy_error_printf(
+            PSY_ERROR(glerror), "%s: %s", __func__, "drawing the passes failed"
+            );
+        *error = SEE_ERROR(glerror);
+        return SEE_ERROR_RUNTIME;
+    }
+    return ret;
+}
+
+/* **** implementation of the public API **** */
+
+int
+psy_post_chain_create(
+    PsyPostChain**          chain,
+    GLsizei                 width,
+    GLsizei                 height,
+    PsyFramebufferFormat    format,
+    SeeError**              error
+    )
+{
+    const PsyPostChainClass* cls = psy_post_chain_class();
+    const SeeObjectClass* see_cls = SEE_OBJECT_CLASS(cls);
+
+    if (!cls)
+        return SEE_NOT_INITIALIZED;
+
+    if (!chain || *chain || width <= 0 || height <= 0)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return see_cls->new_obj(
+        see_cls, 0, (SeeObject**) chain, width, height, format, error
+        );
+}
+
+int
+psy_post_chain_add_blur(PsyPostChain* chain, GLfloat sigma, SeeError** error)
+{
+    int ret, radius;
+
+    if (!chain || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!(sigma > 0.0f && sigma <= MAX_BLUR_SIGMA)) {
+        set_error(error, __func__, "sigma should be within (0, 10]");
+        return SEE_INVALID_ARGUMENT;
+    }
+    radius = (int) ceil(3.0 * sigma);
+
+    ret = add_pass(chain, PASS_BLUR_H, sigma, 0.0f, radius, error);
+    if (ret)
+        return ret;
+    return add_pass(chain, PASS_BLUR_V, sigma, 0.0f, radius, error);
+}
+
+int
+psy_post_chain_add_gamma(PsyPostChain* chain, GLfloat gamma, SeeError** error)
+{
+    if (!chain || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!(gamma > 0.0f)) {
+        set_error(error, __func__, "gamma should be larger than 0");
+        return SEE_INVALID_ARGUMENT;
+    }
+    return add_pass(chain, PASS_GAMMA, gamma, 0.0f, 0, error);
+}
+
+int
+psy_post_chain_add_warp(
+    PsyPostChain*   chain,
+    GLfloat         k1,
+    GLfloat         k2,
+    SeeError**      error
+    )
+{
+    if (!chain || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return add_pass(chain, PASS_WARP, k1, k2, 0, error);
+}
+
+int
+psy_post_chain_add_encode_mono(PsyPostChain* chain, SeeError** error)
+{
+    if (!chain || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return add_pass(chain, PASS_ENCODE_MONO, 0.0f, 0.0f, 0, error);
+}
+
+void
+psy_post_chain_clear(PsyPostChain* chain)
+{
+    if (!chain)
+        return;
+    forget_groups(chain);
+    chain->num_passes = 0;
+}
+
+int
+psy_post_chain_build(PsyPostChain* chain, SeeError** error)
+{
+    if (!chain || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_POST_CHAIN_GET_CLASS(chain)->build(chain, error);
+}
+
+void
+psy_post_chain_begin(PsyPostChain* chain)
+{
+    if (chain)
+        psy_framebuffer_bind(chain->input);
+}
+
+void
+psy_post_chain_end(PsyPostChain* chain)
+{
+    if (chain)
+        psy_framebuffer_unbind(chain->input);
+}
+
+int
+psy_post_chain_apply(PsyPostChain* chain, SeeError** error)
+{
+    int ret;
+
+    if (!chain || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    PSY_TRACE_BEGIN(trace);
+    ret = PSY_POST_CHAIN_GET_CLASS(chain)->apply(chain, error);
+    PSY_TRACE_END(trace, "psylib", "post chain");
+    return ret;
+}
+
+PsyFramebuffer*
+psy_post_chain_input(PsyPostChain* chain)
+{
+    return chain ? chain->input : NULL;
+}
+
+size_t
+psy_post_chain_num_passes(const PsyPostChain* chain)
+{
+    return chain ? chain->num_passes : 0;
+}
+
+size_t
+psy_post_chain_num_programs(const PsyPostChain* chain)
+{
+    return chain ? chain->num_groups : 0;
+}
+
+void
+psy_post_chain_set_gpu_timer(PsyPostChain* chain, PsyGpuTimer* timer)
+{
+    size_t i;
+
+    if (!chain)
+        return;
+
+    if (timer)
+        see_object_ref(SEE_OBJECT(timer));
+    if (chain->gpu_timer)
+        see_object_decref(SEE_OBJECT(chain->gpu_timer));
+    chain->gpu_timer = timer;
+
+    // The scopes belong to the previous timer.
+    for (i = 0; chain->groups && i < chain->num_groups; i++)
+        chain->groups[i].gpu_scope = -1;
+}
+
+/* **** initialization of the class **** */
+
+PsyPostChainClass* g_PsyPostChainClass = NULL;
+
+static int psy_post_chain_class_init(SeeObjectClass* new_cls) {
+    int ret = SEE_SUCCESS;
+
+    /* Override the functions on the parent here */
+    new_cls->init = init;
+    new_cls->name = "PsyPostChain";
+    new_cls->destroy = destroy;
+
+    /* Set the function pointers of the own class here */
+    PsyPostChainClass* cls = (PsyPostChainClass*) new_cls;
+
+    cls->post_chain_init    = post_chain_init;
+    cls->build              = post_chain_build;
+    cls->apply              = post_chain_apply;
+
+    return ret;
+}
+
+/**
+ * \private
+ * \brief this class initializes PsyPostChain(Class).
+ *
+ * You might want to call this from the library initialization func.
+ */
+int
+psy_post_chain_init() {
+    int ret;
+    const SeeMetaClass* meta = see_meta_class_class();
+
+    ret = see_meta_class_new_class(
+        meta,
+        (SeeObjectClass**) &g_PsyPostChainClass,
+        sizeof(PsyPostChainClass),
+        sizeof(PsyPostChain),
+        see_object_class(),
+        sizeof(SeeObjectClass),
+        psy_post_chain_class_init
+        );
+
+    return ret;
+}
+
+void
+psy_post_chain_deinit()
+{
+    if(!g_PsyPostChainClass)
+        return;
+
+    see_object_decref((SeeObject*) g_PsyPostChainClass);
+    g_PsyPostChainClass = NULL;
+}
+
+const PsyPostChainClass*
+psy_post_chain_class()
+{
+    return g_PsyPostChainClass;
+}
@@ -0,0 +1,297 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file PostChain.h
+ * \brief Full screen passes over a rendered frame, fused into few shaders.
+ *
+ * Display corrections such as a gamma correction, the barrel warp for a
+ * lens or the encoding for a high bit depth monitor are applied to the
+ * whole frame. A PsyPostChain renders the frame into a PsyFramebuffer and
+ * applies the passes that were added to it, in order, on the GPU.
+ *
+ * Passes that only change a pixel by its own value (gamma, encoding) are
+ * fused into the shader of the pass before them, so a warp followed by a
+ * gamma correction and an encoding costs one pass. Passes that sample
+ * their neighbours (blur, warp) need the output of the previous pass
+ * complete and start a new shader. The intermediate results go to two
+ * framebuffers that are used in turns, the last shader draws into the
+ * framebuffer that was bound when psy_post_chain_apply() was called.
+ *
+ * \code
+ * psy_post_chain_create(&chain, width, height, PSY_FRAMEBUFFER_RGBA16F, &error);
+ * psy_post_chain_add_warp(chain, 0.1f, 0.0f, &error);
+ * psy_post_chain_add_gamma(chain, 2.2f, &error);
+ *
+ * // every frame
+ * psy_post_chain_begin(chain);
+ * draw_stimuli();
+ * psy_post_chain_end(chain);
+ * psy_post_chain_apply(chain, &error);
+ * psy_window_swap(window);
+ * \endcode
+ */
+
+#ifndef PSY_POST_CHAIN_H
+#define PSY_POST_CHAIN_H
+
+#include <stddef.h>
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+
+#include "psy_export.h"
+#include "Framebuffer.h"
+#include "GpuTimer.h"
+#include "ShaderProgram.h"
+#include "gl/includes_gl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _PsyPostChain PsyPostChain;
+typedef struct _PsyPostChainClass PsyPostChainClass;
+
+/* A pass and the shaders of fused passes, these are private to PostChain.c */
+typedef struct PostPass PostPass;
+typedef struct PostGroup PostGroup;
+
+struct _PsyPostChain {
+    SeeObject parent_obj;
+
+    /*expand PsyPostChain data here*/
+
+    GLsizei                 width;
+    GLsizei                 height;
+    PsyFramebufferFormat    format;
+
+    PsyFramebuffer*         input;      // the frame is drawn in here
+    PsyFramebuffer*         targets[2]; // ping-pong between the groups
+
+    PostPass*               passes;
+    size_t                  num_passes;
+    size_t                  capacity;
+
+    PostGroup*              groups;     // NULL until the chain is built
+    size_t                  num_groups;
+
+    GLuint                  quad_vbo;
+    GLuint                  vao;
+
+    PsyGpuTimer*            gpu_timer;  // NULL when the groups aren't timed
+};
+
+struct _PsyPostChainClass {
+    SeeObjectClass parent_cls;
+
+    int (*post_chain_init)(
+        PsyPostChain*               chain,
+        const PsyPostChainClass*    chain_cls,
+        GLsizei                     width,
+        GLsizei                     height,
+        PsyFramebufferFormat        format,
+        SeeError**                  error
+        );
+
+    int (*build)(PsyPostChain* chain, SeeError** error);
+
+    int (*apply)(PsyPostChain* chain, SeeError** error);
+};
+
+/* **** function style macro casts **** */
+
+/**
+ * \brief cast a pointer from a PsyPostChain derived instance back to a
+ *        pointer to PsyPostChain.
+ */
+#define PSY_POST_CHAIN(obj)                      \
+    ((PsyPostChain*) obj)
+
+/**
+ * \brief cast a pointer to PsyPostChainClass derived class back to a
+ *        pointer to PsyPostChainClass.
+ */
+#define PSY_POST_CHAIN_CLASS(cls)                      \
+    ((const PsyPostChainClass*) cls)
+
+/**
+ * \brief obtain a pointer to PsyPostChainClass from a instance of
+ *        derived from PsyPostChain.
+ */
+#define PSY_POST_CHAIN_GET_CLASS(obj)                \
+    (PSY_POST_CHAIN_CLASS(see_object_get_class(SEE_OBJECT(obj)) ) )
+
+/* **** public functions **** */
+
+/**
+ * \brief Create a chain without passes.
+ *
+ * @param [out] chain   The new chain, should be NULL.
+ * @param [in]  width   The width of the frame in pixels.
+ * @param [in]  height  The height of the frame in pixels.
+ * @param [in]  format  The format of the framebuffers, a float format keeps
+ *                      the precision between the passes.
+ * @param [out] error   If an error occurs, it's returned here.
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_post_chain_create(
+    PsyPostChain**          chain,
+    GLsizei                 width,
+    GLsizei                 height,
+    PsyFramebufferFormat    format,
+    SeeError**              error
+    );
+
+/**
+ * \brief Add a gaussian blur.
+ *
+ * The blur is separable, it's a horizontal and a vertical pass of
+ * 2 * ceil(3 * sigma) + 1 samples each.
+ *
+ * @param [in]  chain
+ * @param [in]  sigma   The standard deviation in pixels, 0 < sigma <= 10.
+ * @param [out] error
+ */
+PSY_EXPORT int
+psy_post_chain_add_blur(PsyPostChain* chain, GLfloat sigma, SeeError** error);
+
+/**
+ * \brief Add a gamma correction, the color c becomes pow(c, 1 / gamma).
+ */
+PSY_EXPORT int
+psy_post_chain_add_gamma(PsyPostChain* chain, GLfloat gamma, SeeError** error);
+
+/**
+ * \brief Add a radial warp around the center.
+ *
+ * A pixel at distance r from the center, where r is 1 halfway the edges,
+ * shows the frame at distance r * (1 + k1 * r^2 + k2 * r^4). A positive k1
+ * compensates the pincushion distortion of a lens. What falls outside of
+ * the frame is black.
+ */
+PSY_EXPORT int
+psy_post_chain_add_warp(
+    PsyPostChain*   chain,
+    GLfloat         k1,
+    GLfloat         k2,
+    SeeError**      error
+    );
+
+/**
+ * \brief Encode the luminance in 16 bits for a high bit depth monitor.
+ *
+ * The luminance of the color is written with the 8 most significant bits
+ * in red and the 8 least significant bits in green, as the Mono++ mode of
+ * the Bits# and Display++ expects. It should be the last pass and the
+ * window should present the pixels unchanged.
+ */
+PSY_EXPORT int
+psy_post_chain_add_encode_mono(PsyPostChain* chain, SeeError** error);
+
+/**
+ * \brief Remove all passes, the chain only copies the frame then.
+ */
+PSY_EXPORT void
+psy_post_chain_clear(PsyPostChain* chain);
+
+/**
+ * \brief Compile the shaders for the passes now.
+ *
+ * psy_post_chain_apply() builds the chain when passes were added since the
+ * previous build, calling this beforehand keeps compiling out of the
+ * presentation of the stimuli.
+ */
+PSY_EXPORT int
+psy_post_chain_build(PsyPostChain* chain, SeeError** error);
+
+/**
+ * \brief Start drawing the frame, the input framebuffer is bound.
+ */
+PSY_EXPORT void
+psy_post_chain_begin(PsyPostChain* chain);
+
+/**
+ * \brief Stop drawing the frame, the previous framebuffer is bound again.
+ */
+PSY_EXPORT void
+psy_post_chain_end(PsyPostChain* chain);
+
+/**
+ * \brief Apply the passes to the frame and draw the result in the
+ * framebuffer that is bound now, at (0, 0) with the size of the chain.
+ */
+PSY_EXPORT int
+psy_post_chain_apply(PsyPostChain* chain, SeeError** error);
+
+/**
+ * \brief The framebuffer the frame is drawn in.
+ */
+PSY_EXPORT PsyFramebuffer*
+psy_post_chain_input(PsyPostChain* chain);
+
+/**
+ * \brief The number of passes that were added, a blur counts as two.
+ */
+PSY_EXPORT size_t
+psy_post_chain_num_passes(const PsyPostChain* chain);
+
+/**
+ * \brief The number of shaders the passes were fused into, 0 when the
+ * chain isn't built.
+ */
+PSY_EXPORT size_t
+psy_post_chain_num_programs(const PsyPostChain* chain);
+
+/**
+ * \brief Time the shaders of the chain on the gpu.
+ *
+ * Every fused shader gets a scope "post chain <n>" in the timer. The chain
+ * holds a reference to the timer, pass NULL to stop timing.
+ *
+ * @param [in] chain
+ * @param [in] timer may be NULL
+ */
+PSY_EXPORT void
+psy_post_chain_set_gpu_timer(PsyPostChain* chain, PsyGpuTimer* timer);
+
+/**
+ * Gets the pointer to the PsyPostChainClass table.
+ */
+PSY_EXPORT const PsyPostChainClass*
+psy_post_chain_class();
+
+/* **** class initialization functions **** */
+
+/**
+ * Initialize PsyPostChain; make it ready for use.
+ */
+PSY_EXPORT
+int psy_post_chain_init();
+
+/**
+ * Deinitialize PsyPostChain, after PsyPostChain has been deinitialized,
+ * all functions in this header shouldn't be used anymore.
+ */
+PSY_EXPORT
+void psy_post_chain_deinit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_POST_CHAIN_H
@@ -0,0 +1,479 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include "MetaClass.h"
+#include "Rdk.h"
+#include "gl/GLError.h"
+#include "gl/gl_util.h"
+
+/*
+ * The state of one dot, this matches the inputs and the captured outputs of
+ * rdk_update.vert.
+ */
+typedef struct _RdkDot {
+    GLfloat position[2];
+    GLfloat age;
+    GLfloat select;
+    GLfloat noise_direction;
+} RdkDot;
+
+static const char* const g_feedback_varyings[] = {
+    "o_position",
+    "o_age",
+    "o_select",
+    "o_noise_direction"
+};
+
+static const GLfloat g_identity[16] = {
+    1.0f, 0.0f, 0.0f, 0.0f,
+    0.0f, 1.0f, 0.0f, 0.0f,
+    0.0f, 0.0f, 1.0f, 0.0f,
+    0.0f, 0.0f, 0.0f, 1.0f
+};
+
+static GLfloat
+radians(GLfloat degrees)
+{
+    return degrees * (GLfloat) (M_PI / 180.0);
+}
+
+/*
+ * Compiles the builtin shaders name and links them, the update program
+ * needs its feedback varyings before it is linked, so
+ * psy_shader_program_create_builtin() doesn't do.
+ */
+static int
+create_program(
+    PsyShaderProgram**  out,
+    const char*         name,
+    const char* const*  varyings,
+    size_t              num_varyings,
+    SeeError**          error
+    )
+{
+    int ret;
+    PsyShader* vertex   = NULL;
+    PsyShader* fragment = NULL;
+
+    ret = psy_shader_create(&vertex, PSY_SHADER_VERTEX, error);
+    if (ret)
+        goto create_program_error;
+    ret = psy_shader_compile_builtin(vertex, name, error);
+    if (ret)
+        goto create_program_error;
+    ret = psy_shader_create(&fragment, PSY_SHADER_FRAGMENT, error);
+    if (ret)
+        goto create_program_error;
+    ret = psy_shader_compile_builtin(fragment, name, error);
+    if (ret)
+        goto create_program_error;
+
+    ret = psy_shader_program_create(out, vertex, fragment, error);
+    if (ret)
+        goto create_program_error;
+    ret = psy_shader_program_set_feedback_varyings(
+        *out, varyings, num_varyings, error
+        );
+    if (ret == SEE_SUCCESS)
+        ret = psy_shader_program_link(*out, error);
+    if (ret) {
+        see_object_decref(SEE_OBJECT(*out));
+        *out = NULL;
+    }
+
+create_program_error:
+    see_object_decref(SEE_OBJECT(vertex));
+    see_object_decref(SEE_OBJECT(fragment));
+    return ret;
+}
+
+static void
+set_dot_attributes(void)
+{
+    const GLsizei stride = sizeof(RdkDot);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(
+        0, 2, GL_FLOAT, GL_FALSE, stride,
+        (const void*) offsetof(RdkDot, position)
+        );
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(
+        1, 1, GL_FLOAT, GL_FALSE, stride,
+        (const void*) offsetof(RdkDot, age)
+        );
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(
+        2, 1, GL_FLOAT, GL_FALSE, stride,
+        (const void*) offsetof(RdkDot, select)
+        );
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(
+        3, 1, GL_FLOAT, GL_FALSE, stride,
+        (const void*) offsetof(RdkDot, noise_direction)
+        );
+}
+
+/* **** functions that implement PsyRdk or override SeeObject **** */
+
+static int
+rdk_init(
+    PsyRdk*                 rdk,
+    const PsyRdkClass*      rdk_cls,
+    const PsyRdkParameters* parameters,
+    SeeError**              error
+    )
+{
+    int ret;
+    const SeeObjectClass* parent_cls = SEE_OBJECT_CLASS(rdk_cls);
+
+    parent_cls->object_init(SEE_OBJECT(rdk), SEE_OBJECT_CLASS(rdk_cls));
+
+    rdk->parameters = *parameters;
+    rdk->reset      = 1;
+
+    if (psy_gl_context_is_es() || !GLAD_GL_VERSION_3_3) {
+        PsyGLError* glerror = NULL;
+        psy_glerror_create(&glerror);
+        psy_error_printf(
+            PSY_ERROR(glerror),
+            "%s: a PsyRdk requires OpenGL 3.3 for transform feedback",
+            __func__
+            );
+        *error = SEE_ERROR(glerror);
+        return SEE_ERROR_RUNTIME;
+    }
+
+    ret = create_program(
+        &rdk->update_program,
+        "rdk_update",
+        g_feedback_varyings,
+        sizeof(g_feedback_varyings) / sizeof(g_feedback_varyings[0]),
+        error
+        );
+    if (ret)
+        return ret;
+    ret = create_program(&rdk->draw_program, "rdk", NULL, 0, error);
+    if (ret)
+        return ret;
+
+    // Both buffers are filled on the GPU by the first step.
+    glGenBuffers(2, rdk->vbo);
+    glGenVertexArrays(2, rdk->vao);
+    for (int i = 0; i < 2; i++) {
+        glBindVertexArray(rdk->vao[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, rdk->vbo[i]);
+        glBufferData(
+            GL_ARRAY_BUFFER,
+            (GLsizeiptr) (parameters->num_dots * sizeof(RdkDot)),
+            NULL,
+            GL_DYNAMIC_COPY
+            );
+        set_dot_attributes();
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return SEE_SUCCESS;
+}
+
+static int
+init(const SeeObjectClass* cls, SeeObject* obj, va_list args)
+{
+    const PsyRdkClass* rdk_cls = PSY_RDK_CLASS(cls);
+    PsyRdk* rdk = PSY_RDK(obj);
+
+    const PsyRdkParameters* parameters = va_arg(args, const PsyRdkParameters*);
+    SeeError** error = va_arg(args, SeeError**);
+
+    return rdk_cls->rdk_init(rdk, rdk_cls, parameters, error);
+}
+
+static void
+destroy(SeeObject* obj)
+{
+    PsyRdk* rdk = PSY_RDK(obj);
+
+    if (rdk->vao[0])
+        glDeleteVertexArrays(2, rdk->vao);
+    if (rdk->vbo[0])
+        glDeleteBuffers(2, rdk->vbo);
+    if (rdk->update_program)
+        see_object_decref(SEE_OBJECT(rdk->update_program));
+    if (rdk->draw_program)
+        see_object_decref(SEE_OBJECT(rdk->draw_program));
+
+    see_object_class()->destroy(obj);
+}
+
+/*
+ * Reads the dots from the current buffer and captures the next state in
+ * the other one. Nothing is rasterized.
+ */
+static int
+rdk_step(PsyRdk* rdk, SeeError** error)
+{
+    const PsyShaderProgram* program = rdk->update_program;
+    const PsyRdkParameters* p = &rdk->parameters;
+    int next = 1 - rdk->current;
+    int ret;
+
+    if (rdk->reset)
+        rdk->frame = 0;
+
+    ret = psy_shader_use_program(program, error);
+    if (ret)
+        return ret;
+
+    glUniform1ui(
+        psy_shader_program_uniform_location(program, "u_seed"), p->seed
+        );
+    glUniform1ui(
+        psy_shader_program_uniform_location(program, "u_frame"), rdk->frame
+        );
+    glUniform1i(
+        psy_shader_program_uniform_location(program, "u_reset"), rdk->reset
+        );
+    glUniform1f(
+        psy_shader_program_uniform_location(program, "u_coherence"),
+        p->coherence
+        );
+    glUniform1f(
+        psy_shader_program_uniform_location(program, "u_direction"),
+        radians(p->direction)
+        );
+    glUniform1f(
+        psy_shader_program_uniform_location(program, "u_speed"), p->speed
+        );
+    glUniform1f(
+        psy_shader_program_uniform_location(program, "u_lifetime"),
+        p->lifetime
+        );
+
+    glBindVertexArray(rdk->vao[rdk->current]);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, rdk->vbo[next]);
+    glEnable(GL_RASTERIZER_DISCARD);
+
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, (GLsizei) p->num_dots);
+    glEndTransformFeedback();
+
+    glDisable(GL_RASTERIZER_DISCARD);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glBindVertexArray(0);
+
+    rdk->current = next;
+    rdk->reset = 0;
+    rdk->frame++;
+
+    return SEE_SUCCESS;
+}
+
+static int
+rdk_draw(PsyRdk* rdk, const GLfloat* transform, SeeError** error)
+{
+    const PsyShaderProgram* program = rdk->draw_program;
+    const PsyRdkParameters* p = &rdk->parameters;
+    GLboolean point_size;
+    int ret;
+
+    // Make sure there are dots to draw.
+    if (rdk->reset) {
+        ret = PSY_RDK_GET_CLASS(rdk)->step(rdk, error);
+        if (ret)
+            return ret;
+    }
+
+    ret = psy_shader_use_program(program, error);
+    if (ret)
+        return ret;
+
+    glUniformMatrix4fv(
+        psy_shader_program_uniform_location(program, "u_transform"),
+        1,
+        GL_FALSE,
+        transform ? transform : g_identity
+        );
+    glUniform2fv(
+        psy_shader_program_uniform_location(program, "u_center"),
+        1,
+        p->center
+        );
+    glUniform1f(
+        psy_shader_program_uniform_location(program, "u_radius"), p->radius
+        );
+    glUniform1f(
+        psy_shader_program_uniform_location(program, "u_dot_size"),
+        p->dot_size
+        );
+    glUniform4fv(
+        psy_shader_program_uniform_location(program, "u_color"), 1, p->color
+        );
+
+    point_size = glIsEnabled(GL_PROGRAM_POINT_SIZE);
+    glEnable(GL_PROGRAM_POINT_SIZE);
+    glBindVertexArray(rdk->vao[rdk->current]);
+    glDrawArrays(GL_POINTS, 0, (GLsizei) p->num_dots);
+    glBindVertexArray(0);
+    if (!point_size)
+        glDisable(GL_PROGRAM_POINT_SIZE);
+
+    return SEE_SUCCESS;
+}
+
+static void
+rdk_reset(PsyRdk* rdk)
+{
+    rdk->reset = 1;
+    rdk->frame = 0;
+}
+
+/* **** implementation of the public API **** */
+
+int
+psy_rdk_create(
+    PsyRdk**                rdk,
+    const PsyRdkParameters* parameters,
+    SeeError**              error
+    )
+{
+    const PsyRdkClass* cls = psy_rdk_class();
+    const SeeObjectClass* see_cls = SEE_OBJECT_CLASS(cls);
+
+    if (!cls)
+        return SEE_NOT_INITIALIZED;
+
+    if (!rdk || *rdk || !parameters)
+        return SEE_INVALID_ARGUMENT;
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+    if (parameters->num_dots == 0 || parameters->lifetime < 1.0f)
+        return SEE_INVALID_ARGUMENT;
+
+    return see_cls->new_obj(see_cls, 0, (SeeObject**) rdk, parameters, error);
+}
+
+int
+psy_rdk_step(PsyRdk* rdk, SeeError** error)
+{
+    if (!rdk || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+    return PSY_RDK_GET_CLASS(rdk)->step(rdk, error);
+}
+
+int
+psy_rdk_draw(PsyRdk* rdk, const GLfloat* transform, SeeError** error)
+{
+    if (!rdk || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+    return PSY_RDK_GET_CLASS(rdk)->draw(rdk, transform, error);
+}
+
+void
+psy_rdk_reset(PsyRdk* rdk)
+{
+    if (!rdk)
+        return;
+    PSY_RDK_GET_CLASS(rdk)->reset(rdk);
+}
+
+uint32_t
+psy_rdk_frame(const PsyRdk* rdk)
+{
+    return rdk ? rdk->frame : 0;
+}
+
+void
+psy_rdk_set_coherence(PsyRdk* rdk, GLfloat coherence)
+{
+    if (!rdk || coherence < 0.0f || coherence > 1.0f)
+        return;
+    rdk->parameters.coherence = coherence;
+}
+
+void
+psy_rdk_set_direction(PsyRdk* rdk, GLfloat direction)
+{
+    if (!rdk)
+        return;
+    rdk->parameters.direction = direction;
+}
+
+/* **** initialization of the class **** */
+
+PsyRdkClass* g_PsyRdkClass = NULL;
+
+static int psy_rdk_class_init(SeeObjectClass* new_cls) {
+    int ret = SEE_SUCCESS;
+
+    /* Override the functions on the parent here */
+    new_cls->init = init;
+    new_cls->name = "PsyRdk";
+    new_cls->destroy = destroy;
+
+    /* Set the function pointers of the own class here */
+    PsyRdkClass* cls = (PsyRdkClass*) new_cls;
+
+    cls->rdk_init   = rdk_init;
+    cls->step       = rdk_step;
+    cls->draw       = rdk_draw;
+    cls->reset      = rdk_reset;
+
+    return ret;
+}
+
+/**
+ * \private
+ * \brief this class initializes PsyRdk(Class).
+ *
+ * You might want to call this from the library initialization func.
+ */
+int
+psy_rdk_init() {
+    int ret;
+    const SeeMetaClass* meta = see_meta_class_class();
+
+    ret = see_meta_class_new_class(
+        meta,
+        (SeeObjectClass**) &g_PsyRdkClass,
+        sizeof(PsyRdkClass),
+        sizeof(PsyRdk),
+        see_object_class(),
+        sizeof(SeeObjectClass),
+        psy_rdk_class_init
+        );
+
+    return ret;
+}
+
+void
+psy_rdk_deinit()
+{
+    if(!g_PsyRdkClass)
+        return;
+
+    see_object_decref((SeeObject*) g_PsyRdkClass);
+    g_PsyRdkClass = NULL;
+}
+
+const PsyRdkClass*
+psy_rdk_class()
+{
+    return g_PsyRdkClass;
+}
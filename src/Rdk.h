@@ -0,0 +1,214 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file Rdk.h
+ * \brief A random dot kinematogram that lives on the GPU.
+ *
+ * The state of the dots of a PsyRdk is kept in two buffers on the GPU.
+ * psy_rdk_step() advances the dots one frame with transform feedback from
+ * one buffer into the other, psy_rdk_draw() draws the dots as point sprites.
+ * After creation no dot data is uploaded from the CPU.
+ *
+ * The dots live in a circular aperture with radius 1. A dot moves in the
+ * direction of the signal when the random number it got at birth is smaller
+ * than the coherence, otherwise it moves in its own random direction. Dots
+ * die after their lifetime and are reborn at a random location. Dots that
+ * leave the aperture reenter at the opposite side. The random numbers are
+ * a hash of the seed, the frame and the dot, so with the same seed and
+ * parameters the same frames are produced.
+ *
+ * A PsyRdk requires OpenGL 3.3, it isn't available on OpenGL ES 2.0.
+ */
+
+#ifndef PSY_RDK_H
+#define PSY_RDK_H
+
+#include <stdint.h>
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+
+#include "ShaderProgram.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _PsyRdk PsyRdk;
+typedef struct _PsyRdkClass PsyRdkClass;
+
+/**
+ * \brief The parameters of a random dot kinematogram.
+ */
+typedef struct _PsyRdkParameters {
+    size_t      num_dots;   ///< The number of dots.
+    uint32_t    seed;       ///< Seeds the random numbers.
+    GLfloat     coherence;  ///< The proportion of signal dots in [0, 1].
+    GLfloat     direction;  ///< The direction of the signal in degrees.
+    GLfloat     speed;      ///< The speed in aperture radii per frame.
+    GLfloat     lifetime;   ///< The lifetime of a dot in frames.
+    GLfloat     dot_size;   ///< The diameter of a dot in pixels.
+    GLfloat     center[2];  ///< The center of the aperture.
+    GLfloat     radius;     ///< The radius of the aperture.
+    GLfloat     color[4];   ///< The rgba colour of the dots.
+} PsyRdkParameters;
+
+struct _PsyRdk {
+    SeeObject parent_obj;
+
+    /*expand PsyRdk data here*/
+
+    PsyRdkParameters    parameters;
+    PsyShaderProgram*   update_program;
+    PsyShaderProgram*   draw_program;
+    GLuint              vbo[2];
+    GLuint              vao[2];
+    int                 current;    // the buffer with the current dots
+    uint32_t            frame;
+    int                 reset;
+};
+
+struct _PsyRdkClass {
+    SeeObjectClass parent_cls;
+
+    int (*rdk_init)(
+        PsyRdk*                 rdk,
+        const PsyRdkClass*      rdk_cls,
+        const PsyRdkParameters* parameters,
+        SeeError**              error
+        );
+
+    int (*step)(PsyRdk* rdk, SeeError** error);
+
+    int (*draw)(PsyRdk* rdk, const GLfloat* transform, SeeError** error);
+
+    void (*reset)(PsyRdk* rdk);
+};
+
+/* **** function style macro casts **** */
+
+/**
+ * \brief cast a pointer from a PsyRdk derived instance back to a
+ *        pointer to PsyRdk.
+ */
+#define PSY_RDK(obj)                      \
+    ((PsyRdk*) obj)
+
+/**
+ * \brief cast a pointer to PsyRdkClass derived class back to a
+ *        pointer to PsyRdkClass.
+ */
+#define PSY_RDK_CLASS(cls)                      \
+    ((const PsyRdkClass*) cls)
+
+/**
+ * \brief obtain a pointer to PsyRdkClass from a instance of
+ *        derived from PsyRdk.
+ */
+#define PSY_RDK_GET_CLASS(obj)                \
+    (PSY_RDK_CLASS(see_object_get_class(SEE_OBJECT(obj)) )  )
+
+/* **** public functions **** */
+
+/**
+ * \brief Create a random dot kinematogram.
+ *
+ * This needs a current OpenGL context of version 3.3 or higher.
+ *
+ * @param [out] rdk         The new rdk, *rdk should be NULL.
+ * @param [in]  parameters  The parameters of the dots, these are copied.
+ * @param [out] error       If an error occurs it will be returned here.
+ *
+ * @return SEE_SUCCESS, SEE_INVALID_ARGUMENT or SEE_ERROR_RUNTIME when the
+ *         context doesn't support transform feedback.
+ */
+PSY_EXPORT int
+psy_rdk_create(
+    PsyRdk**                rdk,
+    const PsyRdkParameters* parameters,
+    SeeError**              error
+    );
+
+/**
+ * \brief Advance all dots by one frame.
+ *
+ * The first step after creation or psy_rdk_reset() places all dots.
+ */
+PSY_EXPORT int
+psy_rdk_step(PsyRdk* rdk, SeeError** error);
+
+/**
+ * \brief Draw the dots.
+ *
+ * @param [in]  rdk
+ * @param [in]  transform   A column major 4x4 matrix that maps the
+ *                          aperture to clip space, NULL for identity.
+ * @param [out] error       If an error occurs it will be returned here.
+ */
+PSY_EXPORT int
+psy_rdk_draw(PsyRdk* rdk, const GLfloat* transform, SeeError** error);
+
+/**
+ * \brief Start over at frame 0, the next step replaces all dots.
+ */
+PSY_EXPORT void
+psy_rdk_reset(PsyRdk* rdk);
+
+/**
+ * \brief Returns the number of steps since creation or the last reset.
+ */
+PSY_EXPORT uint32_t
+psy_rdk_frame(const PsyRdk* rdk);
+
+/**
+ * \brief Change the coherence, this takes effect at the next step.
+ */
+PSY_EXPORT void
+psy_rdk_set_coherence(PsyRdk* rdk, GLfloat coherence);
+
+/**
+ * \brief Change the direction in degrees, this takes effect at the next step.
+ */
+PSY_EXPORT void
+psy_rdk_set_direction(PsyRdk* rdk, GLfloat direction);
+
+/**
+ * Gets the pointer to the PsyRdkClass table.
+ */
+PSY_EXPORT const PsyRdkClass*
+psy_rdk_class();
+
+/* **** class initialization functions **** */
+
+/**
+ * Initialize PsyRdk; make it ready for use.
+ */
+PSY_EXPORT
+int psy_rdk_init();
+
+/**
+ * Deinitialize PsyRdk, after PsyRdk has been deinitialized,
+ * all functions in this header shouldn't be used anymore.
+ */
+PSY_EXPORT
+void psy_rdk_deinit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_RDK_H
@@ -0,0 +1,254 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file Realtime.c
+ * \brief Implements the real-time steps for Linux.
+ */
+
+// For CPU_SET and sched_setaffinity().
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "psy_config.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sched.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "Error.h"
+#include "Realtime.h"
+
+#define DEFAULT_PRIORITY 50
+
+// Holds the DMA latency request, it's withdrawn when it's closed.
+static int g_dma_fd = -1;
+static int g_memory_locked = 0;
+
+/* Appends the failure of a step to the message in buf. */
+static void
+add_failure(char* buf, size_t size, const char* step, int errnum)
+{
+    size_t len = strlen(buf);
+
+    snprintf(
+        buf + len,
+        size - len,
+        "%s%s: %s",
+        len ? ", " : "",
+        step,
+        strerror(errnum)
+        );
+}
+
+#if defined(__linux__)
+
+static int
+set_scheduler(const PsyRealtimeOptions* options)
+{
+    struct sched_param param;
+    int policy = options->policy == PSY_REALTIME_RR ? SCHED_RR : SCHED_FIFO;
+
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = options->priority;
+
+    // On Linux pid 0 is the calling thread, not the whole process.
+    return sched_setscheduler(0, policy, &param) == 0 ? 0 : errno;
+}
+
+static int
+set_affinity(const PsyRealtimeOptions* options)
+{
+    cpu_set_t set;
+
+    if (options->cpu >= CPU_SETSIZE)
+        return EINVAL;
+
+    CPU_ZERO(&set);
+    CPU_SET(options->cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0 ? 0 : errno;
+}
+
+static int
+lock_memory(void)
+{
+    if (g_memory_locked)
+        return 0;
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+        return errno;
+    g_memory_locked = 1;
+    return 0;
+}
+
+static int
+request_dma_latency(const PsyRealtimeOptions* options)
+{
+    int32_t latency = options->dma_latency;
+
+    if (g_dma_fd < 0) {
+        g_dma_fd = open("/dev/cpu_dma_latency", O_WRONLY | O_CLOEXEC);
+        if (g_dma_fd < 0)
+            return errno;
+    }
+
+    // The kernel keeps the request as long as the file is open.
+    if (write(g_dma_fd, &latency, sizeof(latency)) != sizeof(latency)) {
+        int errnum = errno;
+        close(g_dma_fd);
+        g_dma_fd = -1;
+        return errnum;
+    }
+    return 0;
+}
+
+#else
+
+static int
+set_scheduler(const PsyRealtimeOptions* options)
+{
+    (void) options;
+    return ENOSYS;
+}
+
+static int
+set_affinity(const PsyRealtimeOptions* options)
+{
+    (void) options;
+    return ENOSYS;
+}
+
+static int
+lock_memory(void)
+{
+    return ENOSYS;
+}
+
+static int
+request_dma_latency(const PsyRealtimeOptions* options)
+{
+    (void) options;
+    return ENOSYS;
+}
+
+#endif
+
+void
+psy_realtime_options_init(PsyRealtimeOptions* options)
+{
+    if (!options)
+        return;
+
+    options->steps = PSY_REALTIME_SCHEDULER |
+                     PSY_REALTIME_MEMORY_LOCK |
+                     PSY_REALTIME_DMA_LATENCY;
+    options->policy = PSY_REALTIME_FIFO;
+    options->priority = DEFAULT_PRIORITY;
+    options->cpu = -1;
+    options->dma_latency = 0;
+}
+
+int
+psy_realtime_enable(
+    const PsyRealtimeOptions*   options,
+    unsigned*                   achieved,
+    SeeError**                  error
+    )
+{
+    PsyRealtimeOptions defaults;
+    char failures[512] = "";
+    unsigned done = 0;
+    int errnum;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!options) {
+        psy_realtime_options_init(&defaults);
+        options = &defaults;
+    }
+    if (options->steps & ~(unsigned) PSY_REALTIME_ALL)
+        return SEE_INVALID_ARGUMENT;
+    if ((options->steps & PSY_REALTIME_SCHEDULER) &&
+        (options->priority < 1 || options->priority > 99))
+        return SEE_INVALID_ARGUMENT;
+    if ((options->steps & PSY_REALTIME_AFFINITY) && options->cpu < 0)
+        return SEE_INVALID_ARGUMENT;
+    if ((options->steps & PSY_REALTIME_DMA_LATENCY) && options->dma_latency < 0)
+        return SEE_INVALID_ARGUMENT;
+
+    if (options->steps & PSY_REALTIME_SCHEDULER) {
+        if ((errnum = set_scheduler(options)) == 0)
+            done |= PSY_REALTIME_SCHEDULER;
+        else
+            add_failure(failures, sizeof(failures), "scheduler", errnum);
+    }
+    if (options->steps & PSY_REALTIME_AFFINITY) {
+        if ((errnum = set_affinity(options)) == 0)
+            done |= PSY_REALTIME_AFFINITY;
+        else
+            add_failure(failures, sizeof(failures), "affinity", errnum);
+    }
+    if (options->steps & PSY_REALTIME_MEMORY_LOCK) {
+        if ((errnum = lock_memory()) == 0)
+            done |= PSY_REALTIME_MEMORY_LOCK;
+        else
+            add_failure(failures, sizeof(failures), "mlockall", errnum);
+    }
+    if (options->steps & PSY_REALTIME_DMA_LATENCY) {
+        if ((errnum = request_dma_latency(options)) == 0)
+            done |= PSY_REALTIME_DMA_LATENCY;
+        else
+            add_failure(failures, sizeof(failures), "cpu_dma_latency", errnum);
+    }
+
+    if (achieved)
+        *achieved = done;
+
+    if (done != options->steps) {
+        PsyError* err = NULL;
+        psy_error_create(&err);
+        psy_error_printf(err, "%s: %s", __func__, failures);
+        *error = SEE_ERROR(err);
+        return SEE_ERROR_RUNTIME;
+    }
+
+    return SEE_SUCCESS;
+}
+
+void
+psy_realtime_disable(void)
+{
+#if defined(__linux__)
+    if (g_dma_fd >= 0) {
+        close(g_dma_fd);
+        g_dma_fd = -1;
+    }
+    if (g_memory_locked) {
+        munlockall();
+        g_memory_locked = 0;
+    }
+#endif
+}
@@ -0,0 +1,124 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file Realtime.h
+ * \brief Make a timing critical thread less likely to be interrupted.
+ *
+ * A frame that's presented late is mostly caused by the presenting thread
+ * being scheduled out, or by a page fault, just before the swap.
+ * psy_realtime_enable() takes the steps against this that the system
+ * allows:
+ *
+ *  - the calling thread gets a real-time policy (SCHED_FIFO or SCHED_RR),
+ *  - the calling thread is pinned to one CPU,
+ *  - the memory of the process is locked, so it's never paged out,
+ *  - a low CPU DMA latency is requested, so the CPU stays out of deep
+ *    sleep states.
+ *
+ * Most steps need root, or limits that allow them (RLIMIT_RTPRIO and
+ * RLIMIT_MEMLOCK, see limits.conf), pinning doesn't. The steps that fail
+ * are reported, the others stay in effect. Call it from the thread that
+ * presents the frames, typically the main thread right after
+ * psylib_init(). The steps are only available on Linux.
+ */
+
+#ifndef PSY_REALTIME_H
+#define PSY_REALTIME_H
+
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+#include "psy_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief The steps psy_realtime_enable() can take, these are bit flags.
+ */
+typedef enum {
+    PSY_REALTIME_SCHEDULER      = 1 << 0,   ///< A real-time policy.
+    PSY_REALTIME_AFFINITY       = 1 << 1,   ///< Pin the thread to a CPU.
+    PSY_REALTIME_MEMORY_LOCK    = 1 << 2,   ///< mlockall() the process.
+    PSY_REALTIME_DMA_LATENCY    = 1 << 3,   ///< Request a CPU DMA latency.
+    PSY_REALTIME_ALL            = 0xf       ///< All of the above.
+} PsyRealtimeStep;
+
+/**
+ * \brief The real-time scheduling policies.
+ */
+typedef enum {
+    PSY_REALTIME_FIFO,  ///< Runs until it blocks or yields.
+    PSY_REALTIME_RR     ///< Like FIFO, but shares with equal priorities.
+} PsyRealtimePolicy;
+
+/**
+ * \brief What psy_realtime_enable() should do.
+ */
+typedef struct {
+    unsigned            steps;          ///< The PsyRealtimeSteps to take.
+    PsyRealtimePolicy   policy;         ///< The scheduling policy.
+    int                 priority;       ///< The priority in [1, 99].
+    int                 cpu;            ///< The CPU to pin to.
+    int                 dma_latency;    ///< The latency in microseconds.
+} PsyRealtimeOptions;
+
+/**
+ * \brief Fill in the defaults.
+ *
+ * The defaults are all steps except pinning, SCHED_FIFO with priority 50,
+ * and a DMA latency of 0, the lowest the CPU supports. To pin the thread,
+ * set cpu and add PSY_REALTIME_AFFINITY to steps.
+ */
+PSY_EXPORT void
+psy_realtime_options_init(PsyRealtimeOptions* options);
+
+/**
+ * \brief Take the steps in options for the calling thread.
+ *
+ * @param [in]  options     What to do, NULL for the defaults.
+ * @param [out] achieved    The PsyRealtimeSteps that succeeded, may be NULL.
+ * @param [out] error       When a step fails, the reasons of all steps
+ *                          that failed are returned here.
+ *
+ * @return SEE_SUCCESS when all steps succeeded, SEE_ERROR_RUNTIME when one
+ *         or more failed, SEE_INVALID_ARGUMENT when the options are
+ *         invalid.
+ */
+PSY_EXPORT int
+psy_realtime_enable(
+    const PsyRealtimeOptions*   options,
+    unsigned*                   achieved,
+    SeeError**                  error
+    );
+
+/**
+ * \brief Undo the steps that hold for the whole process.
+ *
+ * The DMA latency request is withdrawn and the memory is unlocked. The
+ * scheduling and affinity of a thread end with the thread. This is also
+ * done by psylib_deinit().
+ */
+PSY_EXPORT void
+psy_realtime_disable(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_REALTIME_H
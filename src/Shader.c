@@ -20,14 +20,57 @@
  * \brief implements OpenGL shaders
  */
 
+#include "psy_config.h"
+
 #include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(HAVE_UNISTD_H)
+#include <unistd.h>
+#endif
 #include <DynamicArray.h>
 #include <SeeObject-0.0/MetaClass.h>
 #include "Shader.h"
+#include "Trace.h"
+#include "BuiltinShaders.h"
 #include <SeeObject-0.0/Error.h>
 #include <SeeObject-0.0/IndexError.h>
 #include "gl/GLError.h"
 
+/*
+ * Find out which file is opened as file. Returns a newly allocated absolute
+ * path or NULL when it cannot be determined.
+ */
+static char*
+path_of_file(FILE* file)
+{
+#if defined(HAVE_UNISTD_H) && defined(__linux__)
+    char link[64];
+    char path[PATH_MAX];
+    ssize_t n;
+    char* out;
+
+    snprintf(link, sizeof(link), "/proc/self/fd/%d", fileno(file));
+    n = readlink(link, path, sizeof(path) - 1);
+    if (n <= 0)
+        return NULL;
+    path[n] = '\0';
+
+    // e.g. pipes don't have a path.
+    if (path[0] != '/')
+        return NULL;
+
+    out = malloc((size_t) n + 1);
+    if (out)
+        memcpy(out, path, (size_t) n + 1);
+    return out;
+#else
+    (void) file;
+    return NULL;
+#endif
+}
+
 /* **** functions that implement PsyShader or override SeeObject **** */
 
 static int
@@ -46,6 +89,7 @@ shader_init(
 
     shader->shader_id   = 0;
     shader->shader_type = type;
+    shader->file_path   = NULL;
     
     return ret;
 }
@@ -56,6 +100,7 @@ shader_destroy(SeeObject* shader)
     assert(shader);
     if (PSY_SHADER(shader)->shader_id)
         glDeleteShader(PSY_SHADER(shader)->shader_id);
+    free(PSY_SHADER(shader)->file_path);
     see_object_class()->destroy(shader);
 }
 
@@ -120,12 +165,16 @@ shader_compile(PsyShader* shader, const char* src, SeeError** error)
     }
     shader->shader_id = glCreateShader(shader_type);
     shader->compiled = 0;
+    free(shader->file_path);
+    shader->file_path = NULL;
 
     glShaderSource(shader->shader_id, 1, &src, NULL);
+    PSY_TRACE_BEGIN(trace);
     glCompileShader(shader->shader_id);
 
     /* Check whether compilation succeeded. */
     glGetShaderiv(shader->shader_id, GL_COMPILE_STATUS, &success);
+    PSY_TRACE_END(trace, "psylib", "compile");
     if (!success) {
         glGetShaderInfoLog(shader->shader_id, sizeof(log), NULL, log);
         int status = psy_glerror_create((PsyGLError**)(&err));
@@ -183,6 +232,8 @@ shader_compile_file(PsyShader* shader, FILE* file, SeeError** error)
 
     string = see_dynamic_array_data(array);
     ret = cls->shader_compile(shader, string, error);
+    if (ret == SEE_SUCCESS)
+        shader->file_path = path_of_file(file);
 
     //cleanup and exit
     shader_compile_file_error:
@@ -190,6 +241,35 @@ shader_compile_file(PsyShader* shader, FILE* file, SeeError** error)
     return ret;
 }
 
+static int
+shader_compile_builtin(PsyShader* shader, const char* name, SeeError** error)
+{
+    const PsyShaderClass* cls = PSY_SHADER_GET_CLASS(shader);
+    const PsyBuiltinShader* builtin = psy_builtin_shader_find(
+        psy_builtin_shaders,
+        psy_builtin_shaders_size,
+        name,
+        shader->shader_type
+        );
+
+    if (!builtin) {
+        PsyGLError* err = NULL;
+        int status = psy_glerror_create(&err);
+        assert(status == SEE_SUCCESS);
+        (void) status;
+        psy_error_printf(
+            PSY_ERROR(err),
+            "There is no builtin %s shader named \"%s\"",
+            shader->shader_type == PSY_SHADER_VERTEX ? "vertex" : "fragment",
+            name
+            );
+        *error = SEE_ERROR(err);
+        return SEE_INVALID_ARGUMENT;
+    }
+
+    return cls->shader_compile(shader, builtin->source, error);
+}
+
 static int
 shader_compiled(const PsyShader* shader)
 {
@@ -197,6 +277,12 @@ shader_compiled(const PsyShader* shader)
     return shader->compiled;
 }
 
+static const char*
+shader_file_path(const PsyShader* shader)
+{
+    return shader->file_path;
+}
+
 static int
 shader_size(const PsyShader* shader, size_t* out)
 {
@@ -293,6 +379,20 @@ int psy_shader_compile_file(PsyShader* shader, FILE* file, SeeError** error)
     return cls->shader_compile_file(shader, file, error);
 }
 
+int
+psy_shader_compile_builtin(PsyShader* shader, const char* name, SeeError** error)
+{
+    const PsyShaderClass* cls;
+    if (!shader || !name)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    cls = PSY_SHADER_GET_CLASS(shader);
+    return cls->shader_compile_builtin(shader, name, error);
+}
+
 int psy_shader_compiled(const PsyShader* shader)
 {
     const PsyShaderClass* cls;
@@ -304,6 +404,16 @@ int psy_shader_compiled(const PsyShader* shader)
     return cls->shader_compiled(shader);
 }
 
+const char*
+psy_shader_file_path(const PsyShader* shader)
+{
+    if (!shader)
+        return NULL;
+
+    const PsyShaderClass* cls = PSY_SHADER_GET_CLASS(shader);
+    return cls->file_path(shader);
+}
+
 int
 psy_shader_size(const PsyShader* shader, size_t *out)
 {
@@ -350,7 +460,9 @@ static int psy_shader_class_init(SeeObjectClass* new_cls) {
     cls->id                  = shader_id;
     cls->shader_compile      = shader_compile;
     cls->shader_compile_file = shader_compile_file;
+    cls->shader_compile_builtin = shader_compile_builtin;
     cls->shader_compiled     = shader_compiled;
+    cls->file_path           = shader_file_path;
     cls->shader_size         = shader_size;
     cls->shader_source       = shader_source;
     
@@ -67,6 +67,12 @@ struct _PsyShader {
      * if non-zero the shader is compiled
      */
     int             compiled;
+
+    /**
+     * \private
+     * The absolute path of the file the shader was compiled from or NULL.
+     */
+    char*           file_path;
 };
 
 /**
@@ -100,8 +106,15 @@ struct _PsyShaderClass {
                                 SeeError** error
                                 );
 
+    int (*shader_compile_builtin)( PsyShader*  shader,
+                                   const char* name,
+                                   SeeError**  error
+                                   );
+
     int (*shader_compiled)      (const PsyShader* shader);
 
+    const char* (*file_path)    (const PsyShader* shader);
+
     int (*shader_size)          (const PsyShader* shader, size_t* size);
     int (*shader_source)        (const PsyShader* shader,
                                  char* buffer,
@@ -218,6 +231,27 @@ PSY_EXPORT int
 psy_shader_compile_file(PsyShader* shader, FILE* file, SeeError** error);
 
 
+/**
+ * \brief compile a shader that is embedded in psylib.
+ *
+ * The shaders in src/shaders are compiled into psylib at build time, so no
+ * files have to be found and read in order to use them. A shader is known
+ * by its file name without extension, the type of the shader selects
+ * the .vert or .frag file. When the current context is an OpenGL ES context,
+ * the variant with the "_es" suffix is used when available. The
+ * notes from psy_shader_compile about the OpenGL context apply here as well.
+ *
+ * @param [in,out]  shader An initialized PsyShader pointer
+ * @param [in]      name   The name of the builtin shader e.g.
+ *                         "uniform_color".
+ * @param [out]     error  If an error occurs it can be returned here.
+ * @return SEE_SUCCESS if the shader compiled, SEE_INVALID_ARGUMENT if there
+ *                     is no such builtin shader or another error if it
+ *                     did not compile.
+ */
+PSY_EXPORT int
+psy_shader_compile_builtin(PsyShader* shader, const char* name, SeeError** error);
+
 /**
  * \brief Checks whether the shader is compiled.
  *
@@ -229,6 +263,21 @@ psy_shader_compile_file(PsyShader* shader, FILE* file, SeeError** error);
 PSY_EXPORT int
 psy_shader_compiled(const PsyShader* shader);
 
+/**
+ * \brief Obtain the path of the file the shader was compiled from.
+ *
+ * When the shader is compiled with psy_shader_compile_file(), psylib tries
+ * to find out which file it was compiled from. This is used to reload
+ * shaders once their file changes, see ShaderReload.h.
+ *
+ * @param [in] shader
+ *
+ * @return The absolute path of the file or NULL when the shader wasn't
+ *         compiled from a file or the path is unknown.
+ */
+PSY_EXPORT const char*
+psy_shader_file_path(const PsyShader* shader);
+
 /**
  * \brief Gets the pointer to the PsyShaderClass table.
  * \private
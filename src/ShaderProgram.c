@@ -17,11 +17,337 @@
 
 
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 #include "MetaClass.h"
 #include "ShaderProgram.h"
+#include "ShaderReload.h"
 #include "Shader.h"
+#include "Time.h"
+#include "Trace.h"
 #include "gl/GLError.h"
+#include "gl/gl_util.h"
 
+/* **** registry of the linked programs **** */
+
+/*
+ * All programs that are successfully linked are registered here, so they can
+ * be warmed up in one go. A program removes itself when it is invalidated.
+ */
+static PsyShaderProgram**   g_linked_programs   = NULL;
+static size_t               g_num_linked        = 0;
+static size_t               g_linked_capacity   = 0;
+
+static int
+register_linked(PsyShaderProgram* program)
+{
+    if (g_num_linked == g_linked_capacity) {
+        size_t new_capacity = g_linked_capacity ? g_linked_capacity * 2 : 16;
+        PsyShaderProgram** new_programs = realloc(
+            g_linked_programs,
+            new_capacity * sizeof(PsyShaderProgram*)
+            );
+        if (!new_programs)
+            return SEE_ERROR_RUNTIME;
+        g_linked_programs = new_programs;
+        g_linked_capacity = new_capacity;
+    }
+    g_linked_programs[g_num_linked++] = program;
+    return SEE_SUCCESS;
+}
+
+static void
+unregister_linked(PsyShaderProgram* program)
+{
+    for (size_t i = 0; i < g_num_linked; i++) {
+        if (g_linked_programs[i] == program) {
+            // keep the order in which the programs were linked
+            for (size_t j = i + 1; j < g_num_linked; j++)
+                g_linked_programs[j - 1] = g_linked_programs[j];
+            g_num_linked--;
+            break;
+        }
+    }
+    if (g_num_linked == 0) {
+        free(g_linked_programs);
+        g_linked_programs = NULL;
+        g_linked_capacity = 0;
+    }
+}
+
+/* **** reflection of the active resources of a linked program **** */
+
+typedef struct _Reflection {
+    PsyProgramResource* resources;
+    size_t              num_resources;
+    char*               names;
+} Reflection;
+
+static int
+compare_resources(const void* lhs, const void* rhs)
+{
+    const PsyProgramResource* a = lhs;
+    const PsyProgramResource* b = rhs;
+
+    if (a->kind != b->kind)
+        return a->kind < b->kind ? -1 : 1;
+    return strcmp(a->name, b->name);
+}
+
+/*
+ * OpenGL reports arrays as "name[0]", we store them as "name".
+ */
+static void
+strip_array_suffix(char* name, GLsizei* length)
+{
+    if (*length > 3 && strcmp(name + *length - 3, "[0]") == 0) {
+        *length -= 3;
+        name[*length] = '\0';
+    }
+}
+
+static void
+free_reflection(PsyShaderProgram* program)
+{
+    free(program->resources);
+    free(program->resource_names);
+    program->resources      = NULL;
+    program->resource_names = NULL;
+    program->num_resources  = 0;
+}
+
+static void
+set_reflection(PsyShaderProgram* program, Reflection* reflection)
+{
+    free_reflection(program);
+    program->resources      = reflection->resources;
+    program->num_resources  = reflection->num_resources;
+    program->resource_names = reflection->names;
+}
+
+/*
+ * Queries all active resources of the program with id. All names are stored
+ * in one buffer, so the table is two allocations.
+ */
+static int
+reflect_program(GLuint id, Reflection* out, SeeError** error)
+{
+    GLint num_attributes = 0, num_uniforms = 0, num_blocks = 0;
+    GLint max_attribute = 0, max_uniform = 0, max_block = 0;
+    size_t num, names_size, n = 0;
+    char* name;
+
+    memset(out, 0, sizeof(Reflection));
+
+    glGetProgramiv(id, GL_ACTIVE_ATTRIBUTES, &num_attributes);
+    glGetProgramiv(id, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &max_attribute);
+    glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &num_uniforms);
+    glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_uniform);
+    if (GLAD_GL_VERSION_3_1) {
+        glGetProgramiv(id, GL_ACTIVE_UNIFORM_BLOCKS, &num_blocks);
+        glGetProgramiv(
+            id, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &max_block
+            );
+    }
+
+    num = (size_t) (num_attributes + num_uniforms + num_blocks);
+    if (num == 0)
+        return SEE_SUCCESS;
+
+    names_size = (size_t) num_attributes * (size_t) max_attribute +
+                 (size_t) num_uniforms * (size_t) max_uniform +
+                 (size_t) num_blocks * (size_t) max_block;
+
+    out->resources = calloc(num, sizeof(PsyProgramResource));
+    out->names = malloc(names_size);
+    if (!out->resources || !out->names) {
+        PsyGLError* glerror = NULL;
+        free(out->resources);
+        free(out->names);
+        memset(out, 0, sizeof(Reflection));
+        psy_glerror_create(&glerror);
+        psy_error_printf(
+            PSY_ERROR(glerror),
+            "%s: out of memory",
+            __func__
+            );
+        *error = SEE_ERROR(glerror);
+        return SEE_ERROR_RUNTIME;
+    }
+
+    name = out->names;
+    for (GLint i = 0; i < num_attributes; i++) {
+        PsyProgramResource* r = &out->resources[n++];
+        GLsizei length = 0;
+        glGetActiveAttrib(
+            id, (GLuint) i, max_attribute, &length, &r->size, &r->type, name
+            );
+        strip_array_suffix(name, &length);
+        r->name     = name;
+        r->kind     = PSY_PROGRAM_ATTRIBUTE;
+        r->location = glGetAttribLocation(id, name);
+        name += length + 1;
+    }
+    for (GLint i = 0; i < num_uniforms; i++) {
+        PsyProgramResource* r = &out->resources[n++];
+        GLsizei length = 0;
+        glGetActiveUniform(
+            id, (GLuint) i, max_uniform, &length, &r->size, &r->type, name
+            );
+        strip_array_suffix(name, &length);
+        r->name     = name;
+        r->kind     = PSY_PROGRAM_UNIFORM;
+        r->location = glGetUniformLocation(id, name);
+        name += length + 1;
+    }
+    for (GLint i = 0; i < num_blocks; i++) {
+        PsyProgramResource* r = &out->resources[n++];
+        GLsizei length = 0;
+        glGetActiveUniformBlockName(id, (GLuint) i, max_block, &length, name);
+        glGetActiveUniformBlockiv(
+            id, (GLuint) i, GL_UNIFORM_BLOCK_DATA_SIZE, &r->size
+            );
+        r->name     = name;
+        r->kind     = PSY_PROGRAM_UNIFORM_BLOCK;
+        r->type     = 0;
+        r->location = i;
+        name += length + 1;
+    }
+    out->num_resources = n;
+
+    qsort(out->resources, n, sizeof(PsyProgramResource), compare_resources);
+
+    return SEE_SUCCESS;
+}
+
+/* **** the offscreen target used to warm up programs **** */
+
+#define WARM_UP_TARGET_SIZE 4
+
+/* A triangle in clip space that covers the whole target. */
+static const GLfloat g_warm_up_triangle[] = {-1.0f, -1.0f, 3.0f, -1.0f, -1.0f, 3.0f};
+
+typedef struct _WarmUpTarget {
+    GLuint      fbo;
+    GLuint      texture;
+    GLuint      vao;
+    GLuint      vbo;
+    GLint       prev_fbo;
+    GLint       prev_array_buffer;
+    GLint       prev_viewport[4];
+    GLint       prev_program;
+    GLint       prev_vao;
+    GLint       prev_texture;
+    GLboolean   prev_blend;
+} WarmUpTarget;
+
+static void
+warm_up_target_end(WarmUpTarget* target)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, (GLuint) target->prev_fbo);
+    glViewport(
+        target->prev_viewport[0],
+        target->prev_viewport[1],
+        target->prev_viewport[2],
+        target->prev_viewport[3]
+        );
+    glUseProgram((GLuint) target->prev_program);
+    glBindTexture(GL_TEXTURE_2D, (GLuint) target->prev_texture);
+    if (target->prev_blend)
+        glEnable(GL_BLEND);
+    else
+        glDisable(GL_BLEND);
+    psy_gl_state_forget();
+
+    if (target->vao) {
+        glBindVertexArray((GLuint) target->prev_vao);
+        glDeleteVertexArrays(1, &target->vao);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, (GLuint) target->prev_array_buffer);
+    if (target->vbo)
+        glDeleteBuffers(1, &target->vbo);
+    if (target->fbo)
+        glDeleteFramebuffers(1, &target->fbo);
+    if (target->texture)
+        glDeleteTextures(1, &target->texture);
+}
+
+static int
+warm_up_target_begin(WarmUpTarget* target, SeeError** error)
+{
+    memset(target, 0, sizeof(WarmUpTarget));
+
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &target->prev_fbo);
+    glGetIntegerv(GL_VIEWPORT, target->prev_viewport);
+    glGetIntegerv(GL_CURRENT_PROGRAM, &target->prev_program);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &target->prev_texture);
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &target->prev_array_buffer);
+    target->prev_blend = glIsEnabled(GL_BLEND);
+
+    glGenTextures(1, &target->texture);
+    glBindTexture(GL_TEXTURE_2D, target->texture);
+    glTexImage2D(
+        GL_TEXTURE_2D,
+        0,
+        GL_RGBA,
+        WARM_UP_TARGET_SIZE,
+        WARM_UP_TARGET_SIZE,
+        0,
+        GL_RGBA,
+        GL_UNSIGNED_BYTE,
+        NULL
+        );
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, (GLuint) target->prev_texture);
+
+    glGenFramebuffers(1, &target->fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, target->fbo);
+    glFramebufferTexture2D(
+        GL_FRAMEBUFFER,
+        GL_COLOR_ATTACHMENT0,
+        GL_TEXTURE_2D,
+        target->texture,
+        0
+        );
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        PsyGLError* glerror = NULL;
+        psy_glerror_create(&glerror);
+        psy_error_printf(
+            PSY_ERROR(glerror),
+            "%s: the offscreen target to warm up programs is incomplete",
+            __func__
+            );
+        *error = SEE_ERROR(glerror);
+        warm_up_target_end(target);
+        return SEE_ERROR_RUNTIME;
+    }
+
+    // A core profile context refuses to draw without a vertex array object.
+    if (GLAD_GL_VERSION_3_0) {
+        glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &target->prev_vao);
+        glGenVertexArrays(1, &target->vao);
+        glBindVertexArray(target->vao);
+    }
+
+    // The programs draw the triangle from the bound GL_ARRAY_BUFFER.
+    glGenBuffers(1, &target->vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, target->vbo);
+    glBufferData(
+        GL_ARRAY_BUFFER,
+        sizeof(g_warm_up_triangle),
+        g_warm_up_triangle,
+        GL_STATIC_DRAW
+        );
+
+    // Representative state for stimuli: blended on top of the background.
+    glViewport(0, 0, WARM_UP_TARGET_SIZE, WARM_UP_TARGET_SIZE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    return SEE_SUCCESS;
+}
 
 static void
 invalidate_program(PsyShaderProgram* program)
@@ -29,6 +355,9 @@ invalidate_program(PsyShaderProgram* program)
     if (!program)
         return;
 
+    unregister_linked(program);
+    free_reflection(program);
+
     if(program->program_id) {
         glDeleteProgram(program->program_id);
         program->program_id = 0;
@@ -61,6 +390,16 @@ static void invalidate_fragment_shader(PsyShaderProgram* program)
     invalidate_program(program);
 }
 
+static void
+free_feedback_varyings(PsyShaderProgram* program)
+{
+    for (size_t i = 0; i < program->num_feedback_varyings; i++)
+        free(program->feedback_varyings[i]);
+    free(program->feedback_varyings);
+    program->feedback_varyings = NULL;
+    program->num_feedback_varyings = 0;
+}
+
 /* **** functions that implement PsyShaderProgram or override SeeObject **** */
 
 static int
@@ -136,6 +475,7 @@ static void
 destroy(SeeObject* object)
 {
     PsyShaderProgram* program = PSY_SHADER_PROGRAM(object);
+    free_feedback_varyings(program);
     invalidate_vertex_shader(program);
     invalidate_fragment_shader(program);
     invalidate_program(program);
@@ -306,13 +646,51 @@ shader_program_get_fragment_shader(const PsyShaderProgram* program)
     return program->fragment_shader;
 }
 
+/*
+ * Links the program with id and returns an error containing the info log
+ * when it fails. The transform feedback varyings of program are applied
+ * first, since they only take effect when linking.
+ */
 static int
-shader_program_link(PsyShaderProgram* program, SeeError** error)
+link_program_id(const PsyShaderProgram* program, GLuint id, SeeError** error)
 {
     int success;
     PsyGLError* glerror = NULL;
     char log[BUFSIZ];
 
+    if (program->num_feedback_varyings > 0) {
+        glTransformFeedbackVaryings(
+            id,
+            (GLsizei) program->num_feedback_varyings,
+            (const GLchar* const*) program->feedback_varyings,
+            GL_INTERLEAVED_ATTRIBS
+            );
+    }
+
+    PSY_TRACE_BEGIN(trace);
+    glLinkProgram(id);
+    glGetProgramiv(id, GL_LINK_STATUS, &success);
+    PSY_TRACE_END(trace, "psylib", "link");
+
+    if (!success) {
+        glGetProgramInfoLog(id, sizeof(log), NULL, log);
+        int status = psy_glerror_create(&glerror);
+        assert(status == SEE_SUCCESS);
+        (void) status;
+        psy_error_printf(PSY_ERROR(glerror),"Unable to link program:\n%s", log);
+        *error = SEE_ERROR(glerror);
+        return SEE_ERROR_RUNTIME;
+    }
+    return SEE_SUCCESS;
+}
+
+static int
+shader_program_link(PsyShaderProgram* program, SeeError** error)
+{
+    int ret;
+    PsyGLError* glerror = NULL;
+    Reflection reflection;
+
     if (program->program_id)
         invalidate_program(program);
 
@@ -366,29 +744,366 @@ shader_program_link(PsyShaderProgram* program, SeeError** error)
         return SEE_ERROR_RUNTIME;
     }
 
-    glLinkProgram(program->program_id);
-    glGetProgramiv(program->program_id, GL_LINK_STATUS, &success);
+    ret = link_program_id(program, program->program_id, error);
+    if (ret)
+        return ret;
 
-    if (!success) {
-        glGetProgramInfoLog(program->program_id, sizeof(log), NULL, log);
-        int status = psy_glerror_create(&glerror);
-        assert(status == SEE_SUCCESS);
-        psy_error_printf(PSY_ERROR(glerror),"Unable to link program:\n%s", log);
+    ret = reflect_program(program->program_id, &reflection, error);
+    if (ret)
+        return ret;
+    set_reflection(program, &reflection);
+
+    if (psy_shader_reload_enabled()) {
+        /* Keep the shaders, the unchanged one is needed to relink. */
+        psy_shader_reload_watch(psy_shader_file_path(program->vertex_shader));
+        psy_shader_reload_watch(psy_shader_file_path(program->fragment_shader));
+    }
+    else {
+        /* Free resources as they are contained in the program. */
+        if (program->vertex_shader) {
+            see_object_decref(SEE_OBJECT(program->vertex_shader));
+            program->vertex_shader = NULL;
+        }
+        if (program->fragment_shader) {
+            see_object_decref(SEE_OBJECT(program->fragment_shader));
+            program->fragment_shader = NULL;
+        }
+    }
+
+    if (register_linked(program) != SEE_SUCCESS) {
+        psy_glerror_create(&glerror);
+        psy_error_printf(
+            PSY_ERROR(glerror),
+            "%s: unable to register the linked program",
+            __func__
+            );
         *error = SEE_ERROR(glerror);
         return SEE_ERROR_RUNTIME;
     }
+    program->linked = 1;
 
-    /* Free resources as they are contained in the program. */
-    if (program->vertex_shader) {
-        see_object_decref(SEE_OBJECT(program->vertex_shader));
-        program->vertex_shader = NULL;
+    return SEE_SUCCESS;
+}
+
+static int
+same_path(const char* shader_path, const char* path)
+{
+    return shader_path && strcmp(shader_path, path) == 0;
+}
+
+static int
+recompile_file(
+    PsyShader**     out,
+    psy_shader_t    type,
+    const char*     path,
+    SeeError**      error
+    )
+{
+    int ret;
+    FILE* file;
+
+    ret = psy_shader_create(out, type, error);
+    if (ret)
+        return ret;
+
+    file = fopen(path, "r");
+    if (!file) {
+        PsyGLError* glerror = NULL;
+        psy_glerror_create(&glerror);
+        psy_error_printf(
+            PSY_ERROR(glerror),
+            "Unable to open \"%s\" to reload it",
+            path
+            );
+        *error = SEE_ERROR(glerror);
+        return SEE_ERROR_RUNTIME;
     }
-    if (program->fragment_shader) {
-        see_object_decref(SEE_OBJECT(program->fragment_shader));
-        program->fragment_shader = NULL;
+
+    ret = psy_shader_compile_file(*out, file, error);
+    fclose(file);
+    return ret;
+}
+
+/*
+ * Obtains the shader of type compiled from path, it's compiled for the
+ * first program that needs it. When compiling failed before, *out stays
+ * NULL, that error has been reported.
+ */
+static int
+reloaded_shader(
+    PsyReloadedShaders* shaders,
+    psy_shader_t        type,
+    const char*         path,
+    PsyShader**         out,
+    SeeError**          error
+    )
+{
+    int is_vertex = type == PSY_SHADER_VERTEX;
+    PsyShader** shader = is_vertex ? &shaders->vertex : &shaders->fragment;
+    int* failed = is_vertex ? &shaders->vertex_failed : &shaders->fragment_failed;
+    int ret;
+
+    if (!*shader && !*failed) {
+        ret = recompile_file(shader, type, path, error);
+        if (ret) {
+            if (*shader)
+                see_object_decref(SEE_OBJECT(*shader));
+            *shader = NULL;
+            *failed = 1;
+            return ret;
+        }
     }
+    *out = *shader;
+    return SEE_SUCCESS;
+}
 
-    program->linked = 1;
+/*
+ * The number of components of a uniform of type, 0 for the types whose
+ * values aren't copied to a relinked program.
+ */
+static GLint
+uniform_components(GLenum type, int* is_int)
+{
+    *is_int = 0;
+    switch (type) {
+        case GL_FLOAT:          return 1;
+        case GL_FLOAT_VEC2:     return 2;
+        case GL_FLOAT_VEC3:     return 3;
+        case GL_FLOAT_VEC4:     return 4;
+        case GL_FLOAT_MAT2:     return 4;
+        case GL_FLOAT_MAT3:     return 9;
+        case GL_FLOAT_MAT4:     return 16;
+        default:                break;
+    }
+    *is_int = 1;
+    switch (type) {
+        case GL_INT:
+        case GL_BOOL:
+        case GL_SAMPLER_2D:
+        case GL_SAMPLER_3D:
+        case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_2D_ARRAY:
+            return 1;
+        case GL_INT_VEC2:
+        case GL_BOOL_VEC2:
+            return 2;
+        case GL_INT_VEC3:
+        case GL_BOOL_VEC3:
+            return 3;
+        case GL_INT_VEC4:
+        case GL_BOOL_VEC4:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+static void
+set_uniform_value(
+    GLenum          type,
+    GLint           location,
+    const GLfloat*  f,
+    const GLint*    i
+    )
+{
+    GLint components;
+    int is_int;
+
+    switch (type) {
+        case GL_FLOAT_MAT2:
+            glUniformMatrix2fv(location, 1, GL_FALSE, f);
+            return;
+        case GL_FLOAT_MAT3:
+            glUniformMatrix3fv(location, 1, GL_FALSE, f);
+            return;
+        case GL_FLOAT_MAT4:
+            glUniformMatrix4fv(location, 1, GL_FALSE, f);
+            return;
+        default:
+            break;
+    }
+    components = uniform_components(type, &is_int);
+    if (is_int) {
+        switch (components) {
+            case 1: glUniform1iv(location, 1, i); break;
+            case 2: glUniform2iv(location, 1, i); break;
+            case 3: glUniform3iv(location, 1, i); break;
+            case 4: glUniform4iv(location, 1, i); break;
+            default: break;
+        }
+    }
+    else {
+        switch (components) {
+            case 1: glUniform1fv(location, 1, f); break;
+            case 2: glUniform2fv(location, 1, f); break;
+            case 3: glUniform3fv(location, 1, f); break;
+            case 4: glUniform4fv(location, 1, f); break;
+            default: break;
+        }
+    }
+}
+
+/*
+ * The location of element index of the uniform r in the program with id.
+ */
+static GLint
+element_location(GLuint id, const PsyProgramResource* r, GLint index)
+{
+    char name[BUFSIZ];
+
+    if (index == 0)
+        return r->location;
+    if (snprintf(name, sizeof(name), "%s[%d]", r->name, index) >= (int) sizeof(name))
+        return -1;
+    return glGetUniformLocation(id, name);
+}
+
+/*
+ * Sets the uniforms of the program with new_id to the values they have in
+ * program, the ones with the same name and type. Uniform blocks keep their
+ * binding point. new_id is the program in use afterwards.
+ */
+static void
+copy_uniforms(
+    const PsyShaderProgram* program,
+    GLuint                  new_id,
+    const Reflection*       reflection
+    )
+{
+    GLfloat f[16];
+    GLint i[4];
+    int is_int;
+
+    psy_gl_use_program(new_id);
+
+    for (size_t n = 0; n < reflection->num_resources; n++) {
+        const PsyProgramResource* r = &reflection->resources[n];
+        const PsyProgramResource* old = bsearch(
+            r,
+            program->resources,
+            program->num_resources,
+            sizeof(PsyProgramResource),
+            compare_resources
+            );
+
+        if (!old)
+            continue;
+
+        if (r->kind == PSY_PROGRAM_UNIFORM_BLOCK) {
+            GLint binding = 0;
+            glGetActiveUniformBlockiv(
+                program->program_id,
+                (GLuint) old->location,
+                GL_UNIFORM_BLOCK_BINDING,
+                &binding
+                );
+            glUniformBlockBinding(
+                new_id, (GLuint) r->location, (GLuint) binding
+                );
+            continue;
+        }
+        if (r->kind != PSY_PROGRAM_UNIFORM || r->type != old->type ||
+            uniform_components(r->type, &is_int) == 0)
+            continue;
+
+        for (GLint e = 0; e < r->size && e < old->size; e++) {
+            GLint from = element_location(program->program_id, old, e);
+            GLint to = element_location(new_id, r, e);
+
+            if (from < 0 || to < 0)
+                continue;
+            if (is_int)
+                glGetUniformiv(program->program_id, from, i);
+            else
+                glGetUniformfv(program->program_id, from, f);
+            set_uniform_value(r->type, to, f, i);
+        }
+    }
+}
+
+/*
+ * Swaps the shader(s) recompiled from path into program and relinks the
+ * program with a new program id. The old program remains in use until
+ * everything succeeded. The attributes keep their locations and the
+ * uniforms their values, the locations of the uniforms may change, so the
+ * generation of the program is incremented.
+ */
+static int
+shader_program_reload(
+    PsyShaderProgram*   program,
+    const char*         path,
+    PsyReloadedShaders* shaders,
+    int*                reloaded,
+    SeeError**          error
+    )
+{
+    PsyShader* vertex       = program->vertex_shader;
+    PsyShader* fragment     = program->fragment_shader;
+    PsyShader* new_vertex   = NULL;
+    PsyShader* new_fragment = NULL;
+    GLuint     new_id       = 0;
+    int        ret          = SEE_SUCCESS;
+    Reflection reflection;
+
+    *reloaded = 0;
+
+    // Without the shaders we cannot relink the program.
+    if (!program->linked || !vertex || !fragment)
+        return SEE_SUCCESS;
+
+    if (same_path(psy_shader_file_path(vertex), path)) {
+        ret = reloaded_shader(
+            shaders, PSY_SHADER_VERTEX, path, &new_vertex, error
+            );
+        if (ret)
+            return ret;
+    }
+    if (same_path(psy_shader_file_path(fragment), path)) {
+        ret = reloaded_shader(
+            shaders, PSY_SHADER_FRAGMENT, path, &new_fragment, error
+            );
+        if (ret)
+            return ret;
+    }
+    if (!new_vertex && !new_fragment)
+        return SEE_SUCCESS;
+
+    new_id = glCreateProgram();
+    glAttachShader(new_id, (new_vertex ? new_vertex : vertex)->shader_id);
+    glAttachShader(new_id, (new_fragment ? new_fragment : fragment)->shader_id);
+
+    // Vertex array objects and recorded commands keep working.
+    for (size_t i = 0; i < program->num_resources; i++) {
+        const PsyProgramResource* r = &program->resources[i];
+        if (r->kind == PSY_PROGRAM_ATTRIBUTE && r->location >= 0)
+            glBindAttribLocation(new_id, (GLuint) r->location, r->name);
+    }
+
+    ret = link_program_id(program, new_id, error);
+    if (ret == SEE_SUCCESS)
+        ret = reflect_program(new_id, &reflection, error);
+    if (ret) {
+        glDeleteProgram(new_id);
+        return ret;
+    }
+
+    // Swap the new program in, the uniform locations may have changed.
+    copy_uniforms(program, new_id, &reflection);
+    glDeleteProgram(program->program_id);
+    program->program_id = new_id;
+    program->generation++;
+    set_reflection(program, &reflection);
+    if (new_vertex) {
+        see_object_ref(SEE_OBJECT(new_vertex));
+        see_object_decref(SEE_OBJECT(vertex));
+        program->vertex_shader = new_vertex;
+    }
+    if (new_fragment) {
+        see_object_ref(SEE_OBJECT(new_fragment));
+        see_object_decref(SEE_OBJECT(fragment));
+        program->fragment_shader = new_fragment;
+    }
+    *reloaded = 1;
 
     return SEE_SUCCESS;
 }
@@ -399,6 +1114,154 @@ shader_program_linked(const PsyShaderProgram* program)
     return program->linked;
 }
 
+static int
+shader_program_use(const PsyShaderProgram* program)
+{
+    if (!program->linked)
+        return SEE_ERROR_RUNTIME;
+
+    psy_gl_use_program(program->program_id);
+    return SEE_SUCCESS;
+}
+
+static int
+shader_program_set_feedback_varyings(
+    PsyShaderProgram*   program,
+    const char* const*  names,
+    size_t              num_names,
+    SeeError**          error
+    )
+{
+    char** copies = NULL;
+
+    if (num_names > 0) {
+        copies = calloc(num_names, sizeof(char*));
+        if (!copies)
+            goto set_feedback_varyings_error;
+        for (size_t i = 0; i < num_names; i++) {
+            copies[i] = malloc(strlen(names[i]) + 1);
+            if (!copies[i])
+                goto set_feedback_varyings_error;
+            strcpy(copies[i], names[i]);
+        }
+    }
+
+    free_feedback_varyings(program);
+    program->feedback_varyings = copies;
+    program->num_feedback_varyings = num_names;
+    return SEE_SUCCESS;
+
+set_feedback_varyings_error:
+    if (copies) {
+        for (size_t i = 0; i < num_names; i++)
+            free(copies[i]);
+        free(copies);
+    }
+    PsyGLError* glerror = NULL;
+    psy_glerror_create(&glerror);
+    psy_error_printf(PSY_ERROR(glerror), "%s: out of memory", __func__);
+    *error = SEE_ERROR(glerror);
+    return SEE_ERROR_RUNTIME;
+}
+
+static const PsyProgramResource*
+shader_program_resources(
+    const PsyShaderProgram* program,
+    size_t*                 num_resources
+    )
+{
+    *num_resources = program->linked ? program->num_resources : 0;
+    return program->linked ? program->resources : NULL;
+}
+
+static const PsyProgramResource*
+shader_program_find_resource(
+    const PsyShaderProgram* program,
+    PsyProgramResourceKind  kind,
+    const char*             name
+    )
+{
+    char buffer[BUFSIZ];
+    size_t length = strlen(name);
+    PsyProgramResource key;
+
+    if (!program->linked || program->num_resources == 0)
+        return NULL;
+
+    // The table stores arrays without "[0]".
+    if (length > 3 && strcmp(name + length - 3, "[0]") == 0) {
+        if (length - 3 >= sizeof(buffer))
+            return NULL;
+        memcpy(buffer, name, length - 3);
+        buffer[length - 3] = '\0';
+        name = buffer;
+    }
+
+    key.kind = kind;
+    key.name = name;
+
+    return bsearch(
+        &key,
+        program->resources,
+        program->num_resources,
+        sizeof(PsyProgramResource),
+        compare_resources
+        );
+}
+
+/*
+ * Draws a triangle that covers the target that is currently bound, so
+ * every pixel of it runs the fragment shader. The corners are read from
+ * the bound GL_ARRAY_BUFFER at a_position, or a_corner for the programs
+ * of instanced quads. glFinish makes sure the driver has really done the
+ * work before we stop the timer.
+ */
+static int
+shader_program_warm_up(
+    const PsyShaderProgram* program,
+    double*                 duration,
+    SeeError**              error
+    )
+{
+    PsyGLError* glerror = NULL;
+    PsyTime start, stop;
+    GLint location;
+
+    if (!program->linked) {
+        psy_glerror_create(&glerror);
+        psy_error_printf(
+            PSY_ERROR(glerror),
+            "%s: the program isn't linked",
+            __func__
+            );
+        *error = SEE_ERROR(glerror);
+        return SEE_ERROR_RUNTIME;
+    }
+
+    location = psy_shader_program_attribute_location(program, "a_position");
+    if (location < 0)
+        location = psy_shader_program_attribute_location(program, "a_corner");
+
+    start = psy_time_now();
+
+    psy_gl_use_program(program->program_id);
+    if (location >= 0) {
+        glEnableVertexAttribArray((GLuint) location);
+        glVertexAttribPointer((GLuint) location, 2, GL_FLOAT, GL_FALSE, 0, 0);
+    }
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glFinish();
+
+    stop = psy_time_now();
+
+    psy_gl_disable_attributes(&location, 1);
+
+    if (duration)
+        *duration = psy_time_seconds(stop - start);
+
+    return SEE_SUCCESS;
+}
+
 /* **** implementation of the public API **** */
 
 int
@@ -424,6 +1287,53 @@ psy_shader_program_create(
     return see_cls->new_obj(see_cls, 0, (SeeObject**) out, vertex, fragment, error);
 }
 
+int
+psy_shader_program_create_builtin(
+    PsyShaderProgram**  out,
+    const char*         vertex,
+    const char*         fragment,
+    SeeError**          error
+    )
+{
+    int ret;
+    PsyShader* vertex_shader    = NULL;
+    PsyShader* fragment_shader  = NULL;
+
+    if (!out || *out || !vertex || !fragment)
+        return SEE_INVALID_ARGUMENT;
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    ret = psy_shader_create(&vertex_shader, PSY_SHADER_VERTEX, error);
+    if (ret)
+        goto create_builtin_error;
+    ret = psy_shader_compile_builtin(vertex_shader, vertex, error);
+    if (ret)
+        goto create_builtin_error;
+
+    ret = psy_shader_create(&fragment_shader, PSY_SHADER_FRAGMENT, error);
+    if (ret)
+        goto create_builtin_error;
+    ret = psy_shader_compile_builtin(fragment_shader, fragment, error);
+    if (ret)
+        goto create_builtin_error;
+
+    ret = psy_shader_program_create(out, vertex_shader, fragment_shader, error);
+    if (ret)
+        goto create_builtin_error;
+
+    ret = psy_shader_program_link(*out, error);
+    if (ret) {
+        see_object_decref(SEE_OBJECT(*out));
+        *out = NULL;
+    }
+
+create_builtin_error:
+    see_object_decref(SEE_OBJECT(vertex_shader));
+    see_object_decref(SEE_OBJECT(fragment_shader));
+    return ret;
+}
+
 int psy_shader_program_add_shader(
     PsyShaderProgram*   program,
     PsyShader*          shader,
@@ -550,6 +1460,175 @@ psy_shader_program_linked(const PsyShaderProgram* program)
     return cls->linked(program);
 }
 
+unsigned
+psy_shader_program_generation(const PsyShaderProgram* program)
+{
+    return program ? program->generation : 0;
+}
+
+int
+psy_shader_use_program(const PsyShaderProgram* program, SeeError** error)
+{
+    const PsyShaderProgramClass* cls = PSY_SHADER_PROGRAM_GET_CLASS(program);
+    PsyGLError* glerror = NULL;
+    int ret;
+
+    if (!program)
+        return SEE_INVALID_ARGUMENT;
+    if (error && *error)
+        return SEE_INVALID_ARGUMENT;
+
+    ret = cls->use_program(program);
+    if (ret && error) {
+        psy_glerror_create(&glerror);
+        psy_error_printf(
+            PSY_ERROR(glerror),
+            "%s: the program isn't linked",
+            __func__
+            );
+        *error = SEE_ERROR(glerror);
+    }
+    return ret;
+}
+
+int
+psy_shader_program_warm_up(
+    const PsyShaderProgram* program,
+    double*                 duration,
+    SeeError**              error
+    )
+{
+    const PsyShaderProgramClass* cls = PSY_SHADER_PROGRAM_GET_CLASS(program);
+    WarmUpTarget target;
+    int ret;
+
+    if (!program)
+        return SEE_INVALID_ARGUMENT;
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    ret = warm_up_target_begin(&target, error);
+    if (ret)
+        return ret;
+
+    ret = cls->warm_up(program, duration, error);
+
+    warm_up_target_end(&target);
+    return ret;
+}
+
+int
+psy_shader_program_warm_up_all(
+    PsyWarmUpResult*    results,
+    size_t              size,
+    size_t*             num_warmed,
+    SeeError**          error
+    )
+{
+    WarmUpTarget target;
+    size_t i, n = 0;
+    int ret = SEE_SUCCESS;
+
+    if (!results && size)
+        return SEE_INVALID_ARGUMENT;
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    if (num_warmed)
+        *num_warmed = 0;
+
+    if (g_num_linked == 0)
+        return SEE_SUCCESS;
+
+    ret = warm_up_target_begin(&target, error);
+    if (ret)
+        return ret;
+
+    for (i = 0; i < g_num_linked; i++) {
+        const PsyShaderProgram* program = g_linked_programs[i];
+        const PsyShaderProgramClass* cls = PSY_SHADER_PROGRAM_GET_CLASS(
+            program
+            );
+        double duration = 0.0;
+
+        // A shader has been added since the program was linked.
+        if (!program->linked)
+            continue;
+
+        ret = cls->warm_up(program, &duration, error);
+        if (ret)
+            break;
+
+        if (n < size) {
+            results[n].program  = program;
+            results[n].duration = duration;
+        }
+        n++;
+    }
+
+    if (num_warmed)
+        *num_warmed = n;
+
+    warm_up_target_end(&target);
+    return ret;
+}
+
+size_t
+psy_shader_program_num_linked()
+{
+    return g_num_linked;
+}
+
+int
+psy_shader_program_reload_file(
+    const char* path,
+    size_t*     num_reloaded,
+    SeeError**  error
+    )
+{
+    int ret = SEE_SUCCESS;
+    size_t n = 0;
+    PsyReloadedShaders shaders = {0};
+
+    if (!path || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    for (size_t i = 0; i < g_num_linked; i++) {
+        PsyShaderProgram* program = g_linked_programs[i];
+        const PsyShaderProgramClass* cls = PSY_SHADER_PROGRAM_GET_CLASS(
+            program
+            );
+        SeeError* reload_error = NULL;
+        int reloaded = 0;
+
+        int status = cls->reload(
+            program, path, &shaders, &reloaded, &reload_error
+            );
+        if (status) {
+            // Report the first failure, the other programs are tried anyway.
+            if (ret == SEE_SUCCESS) {
+                ret = status;
+                *error = reload_error;
+            }
+            else {
+                see_object_decref(SEE_OBJECT(reload_error));
+            }
+        }
+        n += reloaded ? 1 : 0;
+    }
+
+    // The programs that use them hold their own reference.
+    if (shaders.vertex)
+        see_object_decref(SEE_OBJECT(shaders.vertex));
+    if (shaders.fragment)
+        see_object_decref(SEE_OBJECT(shaders.fragment));
+
+    if (num_reloaded)
+        *num_reloaded = n;
+
+    return ret;
+}
+
 const PsyShader*
 psy_shader_program_get_vertex_shader(const PsyShaderProgram* program)
 {
@@ -577,6 +1656,96 @@ psy_shader_program_get_fragment_shader(const PsyShaderProgram* program)
 }
 
 
+int
+psy_shader_program_set_feedback_varyings(
+    PsyShaderProgram*   program,
+    const char* const*  names,
+    size_t              num_names,
+    SeeError**          error
+    )
+{
+    const PsyShaderProgramClass* cls = PSY_SHADER_PROGRAM_GET_CLASS(program);
+
+    if (!program || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+    if (num_names > 0 && !names)
+        return SEE_INVALID_ARGUMENT;
+    for (size_t i = 0; i < num_names; i++)
+        if (!names[i])
+            return SEE_INVALID_ARGUMENT;
+
+    if (num_names > 0 && (!GLAD_GL_VERSION_3_0 || psy_gl_context_is_es())) {
+        PsyGLError* glerror = NULL;
+        psy_glerror_create(&glerror);
+        psy_error_printf(
+            PSY_ERROR(glerror),
+            "%s: transform feedback requires OpenGL 3.0",
+            __func__
+            );
+        *error = SEE_ERROR(glerror);
+        return SEE_ERROR_RUNTIME;
+    }
+
+    return cls->set_feedback_varyings(program, names, num_names, error);
+}
+
+const PsyProgramResource*
+psy_shader_program_resources(
+    const PsyShaderProgram* program,
+    size_t*                 num_resources
+    )
+{
+    const PsyShaderProgramClass* cls = PSY_SHADER_PROGRAM_GET_CLASS(program);
+    size_t n;
+
+    if (!program)
+        return NULL;
+
+    const PsyProgramResource* resources = cls->resources(program, &n);
+    if (num_resources)
+        *num_resources = n;
+    return resources;
+}
+
+const PsyProgramResource*
+psy_shader_program_find_resource(
+    const PsyShaderProgram* program,
+    PsyProgramResourceKind  kind,
+    const char*             name
+    )
+{
+    const PsyShaderProgramClass* cls = PSY_SHADER_PROGRAM_GET_CLASS(program);
+
+    if (!program || !name)
+        return NULL;
+
+    return cls->find_resource(program, kind, name);
+}
+
+GLint
+psy_shader_program_uniform_location(
+    const PsyShaderProgram* program,
+    const char*             name
+    )
+{
+    const PsyProgramResource* r = psy_shader_program_find_resource(
+        program, PSY_PROGRAM_UNIFORM, name
+        );
+    return r ? r->location : -1;
+}
+
+GLint
+psy_shader_program_attribute_location(
+    const PsyShaderProgram* program,
+    const char*             name
+    )
+{
+    const PsyProgramResource* r = psy_shader_program_find_resource(
+        program, PSY_PROGRAM_ATTRIBUTE, name
+        );
+    return r ? r->location : -1;
+}
+
 /* **** initialization of the class **** */
 
 PsyShaderProgramClass* g_PsyShaderProgramClass = NULL;
@@ -600,6 +1769,12 @@ static int psy_shader_program_class_init(SeeObjectClass* new_cls) {
     cls->add_fragment_src       = add_fragment_src;
     cls->link                   = shader_program_link;
     cls->linked                 = shader_program_linked;
+    cls->use_program            = shader_program_use;
+    cls->warm_up                = shader_program_warm_up;
+    cls->reload                 = shader_program_reload;
+    cls->set_feedback_varyings  = shader_program_set_feedback_varyings;
+    cls->resources              = shader_program_resources;
+    cls->find_resource          = shader_program_find_resource;
     cls->get_fragment_shader    = shader_program_get_fragment_shader;
     cls->get_vertex_shader      = shader_program_get_vertex_shader;
     
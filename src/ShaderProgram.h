@@ -35,6 +35,80 @@ extern "C" {
 typedef struct _PsyShaderProgram PsyShaderProgram;
 typedef struct _PsyShaderProgramClass PsyShaderProgramClass;
 
+/**
+ * \brief The outcome of warming up one shader program.
+ *
+ * \see psy_shader_program_warm_up_all
+ */
+typedef struct _PsyWarmUpResult {
+    /**
+     * \brief The program that has been warmed up.
+     */
+    const PsyShaderProgram* program;
+    /**
+     * \brief The time in seconds it took to draw with the program and
+     * to finish the draw call.
+     */
+    double                  duration;
+} PsyWarmUpResult;
+
+/**
+ * \brief The kinds of active resources of a linked program.
+ *
+ * The resources in the reflection table are sorted by kind first, in the
+ * order of this enum, and by name thereafter.
+ */
+typedef enum {
+    PSY_PROGRAM_ATTRIBUTE,      ///< an active vertex attribute
+    PSY_PROGRAM_UNIFORM,        ///< an active uniform
+    PSY_PROGRAM_UNIFORM_BLOCK   ///< an active uniform block (OpenGL 3.1+)
+} PsyProgramResourceKind;
+
+/**
+ * \brief Describes one active resource of a linked program.
+ *
+ * \see psy_shader_program_find_resource
+ */
+typedef struct _PsyProgramResource {
+    /**
+     * \brief The name of the resource. For arrays the "[0]" suffix
+     * that OpenGL reports is removed.
+     */
+    const char*             name;
+    /**
+     * \brief What kind of resource this is.
+     */
+    PsyProgramResourceKind  kind;
+    /**
+     * \brief The GL type e.g. GL_FLOAT_VEC4, 0 for uniform blocks.
+     */
+    GLenum                  type;
+    /**
+     * \brief The location of an attribute or uniform or the index of a
+     * uniform block. Uniforms that are a member of a uniform block have
+     * location -1.
+     */
+    GLint                   location;
+    /**
+     * \brief The number of array elements, 1 for non arrays. For uniform
+     * blocks this is the size of the block in bytes.
+     */
+    GLint                   size;
+} PsyProgramResource;
+
+/**
+ * \brief The shaders recompiled from a changed file.
+ *
+ * psy_shader_program_reload_file() compiles the file once per type and
+ * the programs that use it share the result.
+ */
+typedef struct _PsyReloadedShaders {
+    PsyShader*  vertex;             ///< NULL until a program needs it.
+    PsyShader*  fragment;           ///< NULL until a program needs it.
+    int         vertex_failed;      ///< The error was reported already.
+    int         fragment_failed;    ///< The error was reported already.
+} PsyReloadedShaders;
+
 struct _PsyShaderProgram {
     SeeObject parent_obj;
 
@@ -44,6 +118,16 @@ struct _PsyShaderProgram {
     PsyShader*      vertex_shader;
     PsyShader*      fragment_shader;
     int             linked;
+    unsigned        generation;     // incremented when it's reloaded
+
+    /* The reflection table, built when the program is linked. */
+    PsyProgramResource* resources;
+    size_t              num_resources;
+    char*               resource_names;
+
+    /* The outputs captured with transform feedback. */
+    char**              feedback_varyings;
+    size_t              num_feedback_varyings;
 };
 
 struct _PsyShaderProgramClass {
@@ -103,6 +187,37 @@ struct _PsyShaderProgramClass {
 
     int (*use_program)(const PsyShaderProgram* program);
 
+    int (*warm_up)(
+        const PsyShaderProgram* program,
+        double*                 duration,
+        SeeError**              error
+        );
+
+    int (*reload)(
+        PsyShaderProgram*   program,
+        const char*         path,
+        PsyReloadedShaders* shaders,
+        int*                reloaded,
+        SeeError**          error
+        );
+
+    int (*set_feedback_varyings)(
+        PsyShaderProgram*   program,
+        const char* const*  names,
+        size_t              num_names,
+        SeeError**          error
+        );
+
+    const PsyProgramResource* (*resources)(
+        const PsyShaderProgram* program,
+        size_t*                 num_resources
+        );
+
+    const PsyProgramResource* (*find_resource)(
+        const PsyShaderProgram* program,
+        PsyProgramResourceKind  kind,
+        const char*             name
+        );
 };
 
 /* **** function style macro casts **** */
@@ -151,6 +266,27 @@ psy_shader_program_create(
     SeeError**         error
     );
 
+/**
+ * \brief Create and link a program from shaders that are embedded in psylib.
+ *
+ * This compiles the builtin shaders vertex and fragment, see
+ * psy_shader_compile_builtin(), and links them into a new program.
+ *
+ * @param [out] out      The newly created program, *out should be NULL.
+ * @param [in]  vertex   The name of the builtin vertex shader.
+ * @param [in]  fragment The name of the builtin fragment shader.
+ * @param [out] error    If an error occurs it will be returned here.
+ *
+ * @return SEE_SUCCESS if the program is linked.
+ */
+PSY_EXPORT int
+psy_shader_program_create_builtin(
+    PsyShaderProgram**  out,
+    const char*         vertex,
+    const char*         fragment,
+    SeeError**          error
+    );
+
 /**
  * \brief add a shader to the program.
  *
@@ -221,7 +357,9 @@ psy_shader_program_add_fragment_shader(
  * The program is linked. Make sure you have added at least a valid Fragment and
  * Vertex shader. Once a program is linked, the program erases/decrements the
  * reference count on the internal shaders. This makes sure that minimal
- * resources are used.
+ * resources are used. When reloading of shaders is enabled, see
+ * psy_shader_reload_enable(), the program keeps its shaders, because they
+ * are needed to relink the program once one of them changes.
  *
  * @param [in] program
  * @param [out]error
@@ -242,6 +380,21 @@ psy_shader_program_link(
 PSY_EXPORT int
 psy_shader_program_linked(const PsyShaderProgram* program);
 
+/**
+ * \brief The number of times the program has been reloaded.
+ *
+ * A program that is reloaded, see psy_shader_reload_enable(), is relinked
+ * with a new program id. Its attributes keep their locations and its
+ * uniforms keep their values, but the uniforms may get other locations.
+ * Code that caches uniform locations compares the generation with the one
+ * it saw when it looked them up and looks them up again when it differs.
+ *
+ * @param program a previously create PsyShaderProgram.
+ * @return 0 until the program is reloaded for the first time.
+ */
+PSY_EXPORT unsigned
+psy_shader_program_generation(const PsyShaderProgram* program);
+
 
 /**
  * \brief make the current program ready for action.
@@ -312,7 +465,180 @@ psy_shader_program_add_fragment_src(
     SeeError** error
     );
 
+/**
+ * \brief Draw once with the program in order to get it ready for use.
+ *
+ * Many drivers postpone the real compilation of a program, or recompile it
+ * for the state it is used with, until the first draw call that uses the
+ * program. So the first frame that uses a fresh program may be late even
+ * though psy_shader_program_link() succeeded. This function draws a single
+ * triangle with the program into a tiny offscreen target with blending
+ * enabled and waits until the draw has finished. The triangle covers the
+ * target when the vertex shader passes a_position (or a_corner) on as a
+ * clip space position, so the fragment shader runs too. The OpenGL state that is
+ * touched, is restored afterwards. Call this during the setup of your
+ * experiment, not during a timed part of it.
+ *
+ * @param [in]  program  A linked program.
+ * @param [out] duration The time in seconds the warm-up took, may be NULL.
+ * @param [out] error    If an error occurs it will be returned here.
+ *
+ * @return SEE_SUCCESS if the program has been warmed up.
+ */
+PSY_EXPORT int
+psy_shader_program_warm_up(
+    const PsyShaderProgram* program,
+    double*                 duration,
+    SeeError**              error
+    );
 
+/**
+ * \brief Warm up every program that is currently linked.
+ *
+ * Every PsyShaderProgram that has been linked successfully and is still
+ * alive is registered by psylib. This function warms up all of them in one
+ * go, see psy_shader_program_warm_up(). The offscreen target is shared by all
+ * programs.
+ *
+ * @param [out] results  An array of size elements, the time it took to warm
+ *                       up each program is reported here, may be NULL when
+ *                       size is 0.
+ * @param [in]  size     The number of elements in results. Programs that
+ *                       don't fit in results are warmed up as well.
+ * @param [out] num_warmed The number of programs that has been warmed up,
+ *                       may be NULL.
+ * @param [out] error    If an error occurs it will be returned here.
+ *
+ * @return SEE_SUCCESS when all programs are warmed up.
+ */
+PSY_EXPORT int
+psy_shader_program_warm_up_all(
+    PsyWarmUpResult*    results,
+    size_t              size,
+    size_t*             num_warmed,
+    SeeError**          error
+    );
+
+/**
+ * \brief Obtain the number of programs that are currently linked.
+ *
+ * This is the number of programs psy_shader_program_warm_up_all() will
+ * warm up.
+ */
+PSY_EXPORT size_t
+psy_shader_program_num_linked();
+
+/**
+ * \brief Capture outputs of the vertex shader with transform feedback.
+ *
+ * The outputs named in names are written interleaved, in the given
+ * order, to the buffer bound to GL_TRANSFORM_FEEDBACK_BUFFER binding 0.
+ * This takes effect the next time the program is linked, hence call this
+ * before psy_shader_program_link(). The names are copied.
+ *
+ * @param [in]  program
+ * @param [in]  names       The names of the outputs of the vertex shader.
+ * @param [in]  num_names   The number of names, 0 disables capturing.
+ * @param [out] error       If an error occurs it will be returned here.
+ *
+ * @return SEE_SUCCESS, or SEE_ERROR_RUNTIME when transform feedback isn't
+ *         available, as on OpenGL ES 2.0.
+ */
+PSY_EXPORT int
+psy_shader_program_set_feedback_varyings(
+    PsyShaderProgram*   program,
+    const char* const*  names,
+    size_t              num_names,
+    SeeError**          error
+    );
+
+/**
+ * \brief Obtain the reflection table of a linked program.
+ *
+ * When a program is linked, its active attributes, uniforms and uniform
+ * blocks are queried once and stored in a table on the program. Looking
+ * things up in this table doesn't call into OpenGL, hence it doesn't
+ * stall the pipeline. The table is sorted by kind and name and
+ * remains valid until the program is modified, relinked or reloaded.
+ *
+ * @param [in]  program         A linked program.
+ * @param [out] num_resources   The number of entries in the table.
+ *
+ * @return The table or NULL if the program isn't linked or has no active
+ *         resources.
+ */
+PSY_EXPORT const PsyProgramResource*
+psy_shader_program_resources(
+    const PsyShaderProgram* program,
+    size_t*                 num_resources
+    );
+
+/**
+ * \brief Find an active resource of a linked program by name.
+ *
+ * @param [in] program  A linked program.
+ * @param [in] kind     The kind of resource to look for.
+ * @param [in] name     The name of the resource, for arrays the name may
+ *                      be given with or without "[0]".
+ *
+ * @return The resource or NULL when the program has no such active
+ *         resource.
+ */
+PSY_EXPORT const PsyProgramResource*
+psy_shader_program_find_resource(
+    const PsyShaderProgram* program,
+    PsyProgramResourceKind  kind,
+    const char*             name
+    );
+
+/**
+ * \brief Get the location of a uniform without asking OpenGL.
+ *
+ * @return The location or -1 when the uniform isn't active.
+ */
+PSY_EXPORT GLint
+psy_shader_program_uniform_location(
+    const PsyShaderProgram* program,
+    const char*             name
+    );
+
+/**
+ * \brief Get the location of a vertex attribute without asking OpenGL.
+ *
+ * @return The location or -1 when the attribute isn't active.
+ */
+PSY_EXPORT GLint
+psy_shader_program_attribute_location(
+    const PsyShaderProgram* program,
+    const char*             name
+    );
+
+/**
+ * \brief Reload the shaders compiled from path in all linked programs.
+ *
+ * The file is compiled once for each type of shader it's used as, every
+ * linked program that has a shader compiled from path gets the new shader
+ * and is relinked with a new program id. When compiling or linking fails,
+ * the program keeps using its old program id. A relinked program keeps the
+ * locations of its attributes and the values of its uniforms, its
+ * generation is incremented as its uniform locations may have changed,
+ * see psy_shader_program_generation().
+ *
+ * \private This is used by psy_shader_reload_poll().
+ *
+ * @param [in]  path          The absolute path of the file that changed.
+ * @param [out] num_reloaded  The number of programs that are relinked.
+ * @param [out] error         The first error that occurred, with the
+ *                            compile or link log.
+ *
+ * @return SEE_SUCCESS when none of the programs failed to reload.
+ */
+PSY_EXPORT int
+psy_shader_program_reload_file(
+    const char* path,
+    size_t*     num_reloaded,
+    SeeError**  error
+    );
 
 /**
  * Gets the pointer to the PsyShaderProgramClass table.
@@ -0,0 +1,305 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file ShaderReload.c
+ * \brief Implements reloading of shaders with inotify.
+ */
+
+#include "psy_config.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(HAVE_SYS_INOTIFY_H)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "Error.h"
+#include "ShaderReload.h"
+#include "ShaderProgram.h"
+
+typedef struct _WatchedDir {
+    int     wd;
+    char*   path;
+} WatchedDir;
+
+static int          g_fd            = -1;
+static WatchedDir*  g_dirs          = NULL;
+static size_t       g_num_dirs      = 0;
+static size_t       g_dirs_capacity = 0;
+
+static void
+set_error(SeeError** error, const char* msg, int errnum)
+{
+    PsyError* err = NULL;
+    if (psy_error_create(&err) != SEE_SUCCESS)
+        return;
+    if (errnum)
+        psy_error_printf(err, "%s: %s", msg, strerror(errnum));
+    else
+        psy_error_printf(err, "%s", msg);
+    *error = SEE_ERROR(err);
+}
+
+static const WatchedDir*
+find_dir_by_wd(int wd)
+{
+    for (size_t i = 0; i < g_num_dirs; i++)
+        if (g_dirs[i].wd == wd)
+            return &g_dirs[i];
+    return NULL;
+}
+
+int
+psy_shader_reload_enable(SeeError** error)
+{
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    if (g_fd >= 0)
+        return SEE_SUCCESS;
+
+#if defined(HAVE_SYS_INOTIFY_H)
+    g_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (g_fd < 0) {
+        set_error(error, "Unable to initialize inotify", errno);
+        return SEE_ERROR_RUNTIME;
+    }
+    return SEE_SUCCESS;
+#else
+    set_error(error, "Reloading shaders isn't supported on this platform", 0);
+    return SEE_ERROR_RUNTIME;
+#endif
+}
+
+void
+psy_shader_reload_disable(void)
+{
+    for (size_t i = 0; i < g_num_dirs; i++)
+        free(g_dirs[i].path);
+    free(g_dirs);
+    g_dirs = NULL;
+    g_num_dirs = g_dirs_capacity = 0;
+
+#if defined(HAVE_SYS_INOTIFY_H)
+    if (g_fd >= 0)
+        close(g_fd); // removes the watches as well
+#endif
+    g_fd = -1;
+}
+
+int
+psy_shader_reload_enabled(void)
+{
+    return g_fd >= 0;
+}
+
+int
+psy_shader_reload_watch(const char* path)
+{
+#if defined(HAVE_SYS_INOTIFY_H)
+    const char* slash;
+    size_t dir_len;
+    char* dir;
+    int wd;
+
+    if (!path || g_fd < 0)
+        return SEE_SUCCESS;
+
+    slash = strrchr(path, '/');
+    if (!slash)
+        return SEE_INVALID_ARGUMENT;
+    dir_len = slash == path ? 1 : (size_t)(slash - path);
+
+    dir = malloc(dir_len + 1);
+    if (!dir)
+        return SEE_ERROR_RUNTIME;
+    memcpy(dir, path, dir_len);
+    dir[dir_len] = '\0';
+
+    /*
+     * Editors often write a new file and rename it, so we watch the directory
+     * instead of the file itself. Adding the same directory twice returns
+     * the same watch descriptor.
+     */
+    wd = inotify_add_watch(g_fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd < 0 || find_dir_by_wd(wd)) {
+        free(dir);
+        return wd < 0 ? SEE_ERROR_RUNTIME : SEE_SUCCESS;
+    }
+
+    if (g_num_dirs == g_dirs_capacity) {
+        size_t new_capacity = g_dirs_capacity ? g_dirs_capacity * 2 : 8;
+        WatchedDir* new_dirs = realloc(g_dirs, new_capacity * sizeof(WatchedDir));
+        if (!new_dirs) {
+            inotify_rm_watch(g_fd, wd);
+            free(dir);
+            return SEE_ERROR_RUNTIME;
+        }
+        g_dirs = new_dirs;
+        g_dirs_capacity = new_capacity;
+    }
+    g_dirs[g_num_dirs].wd   = wd;
+    g_dirs[g_num_dirs].path = dir;
+    g_num_dirs++;
+
+    return SEE_SUCCESS;
+#else
+    (void) path;
+    return SEE_SUCCESS;
+#endif
+}
+
+#if defined(HAVE_SYS_INOTIFY_H)
+
+/* The files that changed since the last poll, each path occurs once. */
+typedef struct _ChangedFiles {
+    char**  paths;
+    size_t  num_paths;
+    size_t  capacity;
+} ChangedFiles;
+
+/*
+ * Adds dir/name to the changed files, unless it's in there already. An
+ * editor saving a file often yields more than one event.
+ */
+static int
+add_changed(ChangedFiles* changed, const WatchedDir* dir, const char* name)
+{
+    char path[BUFSIZ];
+    int ret;
+
+    ret = snprintf(path, sizeof(path), "%s/%s",
+                   strcmp(dir->path, "/") == 0 ? "" : dir->path,
+                   name
+                   );
+    if (ret < 0 || (size_t) ret >= sizeof(path))
+        return SEE_SUCCESS;
+
+    for (size_t i = 0; i < changed->num_paths; i++)
+        if (strcmp(changed->paths[i], path) == 0)
+            return SEE_SUCCESS;
+
+    if (changed->num_paths == changed->capacity) {
+        size_t new_capacity = changed->capacity ? changed->capacity * 2 : 8;
+        char** new_paths = realloc(
+            changed->paths, new_capacity * sizeof(char*)
+            );
+        if (!new_paths)
+            return SEE_ERROR_RUNTIME;
+        changed->paths = new_paths;
+        changed->capacity = new_capacity;
+    }
+    changed->paths[changed->num_paths] = malloc((size_t) ret + 1);
+    if (!changed->paths[changed->num_paths])
+        return SEE_ERROR_RUNTIME;
+    memcpy(changed->paths[changed->num_paths], path, (size_t) ret + 1);
+    changed->num_paths++;
+
+    return SEE_SUCCESS;
+}
+
+/*
+ * Reloads the file at path, failures are reported via error, but only
+ * the first one.
+ */
+static int
+reload_changed(const char* path, size_t* num_reloaded, SeeError** error)
+{
+    SeeError* reload_error = NULL;
+    size_t n = 0;
+    int ret;
+
+    ret = psy_shader_program_reload_file(path, &n, &reload_error);
+    *num_reloaded += n;
+    if (ret) {
+        if (*error)
+            see_object_decref(SEE_OBJECT(reload_error));
+        else
+            *error = reload_error;
+    }
+    return ret;
+}
+
+#endif
+
+int
+psy_shader_reload_poll(size_t* num_reloaded, SeeError** error)
+{
+    size_t n = 0;
+    int ret = SEE_SUCCESS;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    if (num_reloaded)
+        *num_reloaded = 0;
+
+    if (g_fd < 0)
+        return SEE_SUCCESS;
+
+#if defined(HAVE_SYS_INOTIFY_H)
+    union {
+        struct inotify_event    event;
+        char                    buffer[BUFSIZ];
+    } events;
+    ChangedFiles changed = {0};
+
+    for (;;) {
+        ssize_t len = read(g_fd, events.buffer, sizeof(events.buffer));
+        if (len <= 0) {
+            if (len < 0 && errno != EAGAIN && errno != EINTR && !*error) {
+                set_error(error, "Unable to read from inotify", errno);
+                ret = SEE_ERROR_RUNTIME;
+            }
+            break;
+        }
+
+        for (char* p = events.buffer; p < events.buffer + len;) {
+            const struct inotify_event* event = (struct inotify_event*) p;
+            const WatchedDir* dir = find_dir_by_wd(event->wd);
+
+            if (dir && event->len > 0) {
+                int status = add_changed(&changed, dir, event->name);
+                if (status && !*error) {
+                    set_error(error, "Unable to remember a changed shader", 0);
+                    ret = status;
+                }
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+    // Every changed file is compiled once, however many events it had.
+    for (size_t i = 0; i < changed.num_paths; i++) {
+        int status = reload_changed(changed.paths[i], &n, error);
+        if (status && ret == SEE_SUCCESS)
+            ret = status;
+        free(changed.paths[i]);
+    }
+    free(changed.paths);
+#endif
+
+    if (num_reloaded)
+        *num_reloaded = n;
+
+    return ret;
+}
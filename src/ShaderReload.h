@@ -0,0 +1,115 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file ShaderReload.h
+ * \brief Reload shaders once the files they were compiled from change.
+ *
+ * While developing a stimulus it is convenient to edit a shader and to see
+ * the result without restarting the experiment. Once reloading is enabled,
+ * PsyShaderPrograms keep the shaders they are linked with and the
+ * directories of the files the shaders were compiled from (see
+ * psy_shader_compile_file()) are watched. psy_shader_reload_poll() should be
+ * called between two frames. Only the shader that changed is recompiled
+ * and only the programs that use it are relinked. A program that fails to
+ * compile or link keeps using the old version.
+ *
+ * A relinked program gets a new program id. It keeps the locations of its
+ * attributes and the values of its uniforms, but its uniforms may move to
+ * other locations. Uniform locations that are looked up once should be
+ * looked up again when psy_shader_program_generation() changed; the
+ * PsyShapeBatch and PsyCommandBuffer of psylib do so.
+ *
+ * Reloading is only available on platforms that have inotify (Linux).
+ */
+
+#ifndef PSY_SHADER_RELOAD_H
+#define PSY_SHADER_RELOAD_H
+
+#include <stddef.h>
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+#include "psy_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Start watching shader files for changes.
+ *
+ * Programs that are linked after this call are watched, so enable
+ * reloading before the programs are linked.
+ *
+ * @param [out] error If an error occurs it will be returned here.
+ *
+ * @return SEE_SUCCESS, or SEE_ERROR_RUNTIME when reloading isn't supported
+ *         or inotify cannot be initialized.
+ */
+PSY_EXPORT int
+psy_shader_reload_enable(SeeError** error);
+
+/**
+ * \brief Stop watching shader files.
+ *
+ * This is also done by psylib_deinit().
+ */
+PSY_EXPORT void
+psy_shader_reload_disable(void);
+
+/**
+ * \brief Returns non zero when reloading shaders is enabled.
+ */
+PSY_EXPORT int
+psy_shader_reload_enabled(void);
+
+/**
+ * \brief Reload the shaders whose files have changed.
+ *
+ * This function doesn't block. Call it between frames, on the thread that
+ * owns the OpenGL context. The programs are swapped to their new version
+ * before this function returns.
+ *
+ * @param [out] num_reloaded The number of programs that are relinked, may
+ *                           be NULL.
+ * @param [out] error        When a shader fails to compile or a program fails
+ *                           to link, the compile or link log is returned
+ *                           here.
+ *
+ * @return SEE_SUCCESS when all changed shaders have been reloaded.
+ */
+PSY_EXPORT int
+psy_shader_reload_poll(size_t* num_reloaded, SeeError** error);
+
+/**
+ * \brief Watch the directory of the file at path.
+ *
+ * \private This is used by PsyShaderProgram when it is linked.
+ *
+ * @param [in] path An absolute path to a file, may be NULL in which case
+ *                  nothing is done.
+ *
+ * @return SEE_SUCCESS if the file is watched.
+ */
+PSY_EXPORT int
+psy_shader_reload_watch(const char* path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_SHADER_RELOAD_H
@@ -0,0 +1,759 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "MetaClass.h"
+#include "ShapeBatch.h"
+#include "gl/GLError.h"
+#include "gl/gl_util.h"
+
+#define DEFAULT_LINE_WIDTH 0.2f
+
+/*
+ * Without instancing every corner of the quad carries the attributes of
+ * its shape.
+ */
+typedef struct _ShapeVertex {
+    GLfloat             corner[2];
+    PsyShapeInstance    instance;
+} ShapeVertex;
+
+#define VERTICES_PER_SHAPE 6
+
+static const GLfloat g_quad[VERTICES_PER_SHAPE][2] = {
+    {-0.5f, -0.5f}, { 0.5f, -0.5f}, { 0.5f,  0.5f},
+    {-0.5f, -0.5f}, { 0.5f,  0.5f}, {-0.5f,  0.5f}
+};
+
+static const GLfloat g_identity[16] = {
+    1.0f, 0.0f, 0.0f, 0.0f,
+    0.0f, 1.0f, 0.0f, 0.0f,
+    0.0f, 0.0f, 1.0f, 0.0f,
+    0.0f, 0.0f, 0.0f, 1.0f
+};
+
+static void
+set_out_of_memory(SeeError** error, const char* func)
+{
+    PsyGLError* glerror = NULL;
+    psy_glerror_create(&glerror);
+    psy_error_printf(PSY_ERROR(glerror), "%s: out of memory", func);
+    *error = SEE_ERROR(glerror);
+}
+
+static void
+set_attribute(GLint location, GLint size, GLsizei stride, size_t offset)
+{
+    if (location < 0)
+        return;
+    glEnableVertexAttribArray((GLuint) location);
+    glVertexAttribPointer(
+        (GLuint) location,
+        size,
+        GL_FLOAT,
+        GL_FALSE,
+        stride,
+        (const void*) offset
+        );
+}
+
+/*
+ * Points the per shape attributes to the shapes that start at offset in the
+ * currently bound GL_ARRAY_BUFFER.
+ */
+static void
+set_instance_attributes(
+    const PsyShapeBatch*    batch,
+    GLsizei                 stride,
+    size_t                  offset
+    )
+{
+    set_attribute(
+        batch->a_position, 2, stride, offset + offsetof(PsyShapeInstance, x)
+        );
+    set_attribute(
+        batch->a_size, 2, stride, offset + offsetof(PsyShapeInstance, width)
+        );
+    set_attribute(
+        batch->a_orientation,
+        1,
+        stride,
+        offset + offsetof(PsyShapeInstance, orientation)
+        );
+    set_attribute(
+        batch->a_color, 4, stride, offset + offsetof(PsyShapeInstance, color)
+        );
+    set_attribute(
+        batch->a_disparity,
+        1,
+        stride,
+        offset + offsetof(PsyShapeInstance, disparity)
+        );
+}
+
+/* Disables the arrays set_attribute() enabled, without a vao they leak. */
+static void
+disable_attributes(const PsyShapeBatch* batch)
+{
+    const GLint locations[] = {
+        batch->a_corner,
+        batch->a_position,
+        batch->a_size,
+        batch->a_orientation,
+        batch->a_color,
+        batch->a_disparity
+    };
+    psy_gl_disable_attributes(
+        locations, sizeof(locations) / sizeof(locations[0])
+        );
+}
+
+/*
+ * The per shape attributes advance every divisor instances, 2 when both
+ * eyes are drawn.
+ */
+static void
+set_instance_divisors(const PsyShapeBatch* batch, GLuint divisor)
+{
+    const GLint locations[] = {
+        batch->a_position,
+        batch->a_size,
+        batch->a_orientation,
+        batch->a_color,
+        batch->a_disparity
+    };
+    for (size_t i = 0; i < sizeof(locations) / sizeof(locations[0]); i++)
+        if (locations[i] >= 0)
+            glVertexAttribDivisor((GLuint) locations[i], divisor);
+}
+
+/*
+ * Makes sure the bound GL_ARRAY_BUFFER can hold size bytes. The buffer is
+ * orphaned every frame, so the driver doesn't have to wait until the
+ * previous frame has been drawn.
+ */
+static void
+reserve_buffer(PsyShapeBatch* batch, GLsizeiptr size)
+{
+    if (size > batch->instance_vbo_size)
+        batch->instance_vbo_size = size;
+    glBufferData(
+        GL_ARRAY_BUFFER, batch->instance_vbo_size, NULL, GL_STREAM_DRAW
+        );
+}
+
+/*
+ * The locations are known from the reflection of the program, they're
+ * looked up again after the program has been reloaded.
+ */
+static void
+find_locations(PsyShapeBatch* batch)
+{
+    batch->a_corner = psy_shader_program_attribute_location(
+        batch->program, "a_corner"
+        );
+    batch->a_position = psy_shader_program_attribute_location(
+        batch->program, "a_position"
+        );
+    batch->a_size = psy_shader_program_attribute_location(
+        batch->program, "a_size"
+        );
+    batch->a_orientation = psy_shader_program_attribute_location(
+        batch->program, "a_orientation"
+        );
+    batch->a_color = psy_shader_program_attribute_location(
+        batch->program, "a_color"
+        );
+    batch->a_disparity = psy_shader_program_attribute_location(
+        batch->program, "a_disparity"
+        );
+    batch->u_transform = psy_shader_program_uniform_location(
+        batch->program, "u_transform"
+        );
+    batch->u_shape = psy_shader_program_uniform_location(
+        batch->program, "u_shape"
+        );
+    batch->u_line_width = psy_shader_program_uniform_location(
+        batch->program, "u_line_width"
+        );
+    batch->u_disparity_sign = psy_shader_program_uniform_location(
+        batch->program, "u_disparity_sign"
+        );
+    batch->u_stereo = psy_shader_program_uniform_location(
+        batch->program, "u_stereo"
+        );
+    batch->u_eye_transforms = psy_shader_program_uniform_location(
+        batch->program, "u_eye_transforms"
+        );
+    batch->u_clip_planes = psy_shader_program_uniform_location(
+        batch->program, "u_clip_planes"
+        );
+    batch->program_generation = psy_shader_program_generation(
+        batch->program
+        );
+}
+
+/* **** functions that implement PsyShapeBatch or override SeeObject **** */
+
+static int
+shape_batch_init(
+    PsyShapeBatch*              batch,
+    const PsyShapeBatchClass*   batch_cls,
+    SeeError**                  error
+    )
+{
+    int ret;
+    const SeeObjectClass* parent_cls = SEE_OBJECT_CLASS(batch_cls);
+
+    parent_cls->object_init(SEE_OBJECT(batch), SEE_OBJECT_CLASS(batch_cls));
+
+    batch->line_width = DEFAULT_LINE_WIDTH;
+    batch->instanced = psy_gl_has_instancing();
+
+    ret = psy_shader_program_create_builtin(
+        &batch->program,
+        "shape",
+        "shape",
+        error
+        );
+    if (ret)
+        return ret;
+
+    find_locations(batch);
+
+    if (psy_gl_has_vertex_arrays()) {
+        glGenVertexArrays(1, &batch->vao);
+        glBindVertexArray(batch->vao);
+    }
+
+    glGenBuffers(1, &batch->instance_vbo);
+
+    if (batch->instanced) {
+        // The corners of the quad are shared by all instances.
+        glGenBuffers(1, &batch->quad_vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, batch->quad_vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(g_quad), g_quad, GL_STATIC_DRAW);
+        set_attribute(batch->a_corner, 2, 0, 0);
+
+        glBindBuffer(GL_ARRAY_BUFFER, batch->instance_vbo);
+        set_instance_divisors(batch, 1);
+    }
+
+    if (batch->vao)
+        glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return SEE_SUCCESS;
+}
+
+static int
+init(const SeeObjectClass* cls, SeeObject* obj, va_list args)
+{
+    const PsyShapeBatchClass* batch_cls = PSY_SHAPE_BATCH_CLASS(cls);
+    PsyShapeBatch* batch = PSY_SHAPE_BATCH(obj);
+
+    SeeError** error = va_arg(args, SeeError**);
+
+    return batch_cls->shape_batch_init(batch, batch_cls, error);
+}
+
+static void
+destroy(SeeObject* obj)
+{
+    PsyShapeBatch* batch = PSY_SHAPE_BATCH(obj);
+
+    if (batch->vao)
+        glDeleteVertexArrays(1, &batch->vao);
+    if (batch->quad_vbo)
+        glDeleteBuffers(1, &batch->quad_vbo);
+    if (batch->instance_vbo)
+        glDeleteBuffers(1, &batch->instance_vbo);
+
+    for (size_t i = 0; i < PSY_SHAPE_NUM_KINDS; i++)
+        free(batch->instances[i]);
+    free(batch->vertices);
+
+    if (batch->program)
+        see_object_decref(SEE_OBJECT(batch->program));
+
+    see_object_class()->destroy(obj);
+}
+
+static int
+shape_batch_add(
+    PsyShapeBatch*          batch,
+    PsyShapeKind            kind,
+    const PsyShapeInstance* instances,
+    size_t                  num_instances,
+    SeeError**              error
+    )
+{
+    size_t needed = batch->num_instances[kind] + num_instances;
+
+    if (needed > batch->capacity[kind]) {
+        size_t new_capacity = batch->capacity[kind] ? batch->capacity[kind] : 64;
+        PsyShapeInstance* new_instances;
+
+        while (new_capacity < needed)
+            new_capacity *= 2;
+
+        new_instances = realloc(
+            batch->instances[kind],
+            new_capacity * sizeof(PsyShapeInstance)
+            );
+        if (!new_instances) {
+            set_out_of_memory(error, __func__);
+            return SEE_ERROR_RUNTIME;
+        }
+        batch->instances[kind] = new_instances;
+        batch->capacity[kind] = new_capacity;
+    }
+
+    memcpy(
+        batch->instances[kind] + batch->num_instances[kind],
+        instances,
+        num_instances * sizeof(PsyShapeInstance)
+        );
+    batch->num_instances[kind] = needed;
+
+    return SEE_SUCCESS;
+}
+
+static void
+shape_batch_clear(PsyShapeBatch* batch)
+{
+    for (size_t i = 0; i < PSY_SHAPE_NUM_KINDS; i++)
+        batch->num_instances[i] = 0;
+}
+
+/*
+ * Uploads all instances in one go and draws every kind with one instanced
+ * call, only the offset of the instance attributes differs per kind. Every
+ * shape is drawn as num_eyes instances.
+ */
+static void
+draw_instanced(PsyShapeBatch* batch, size_t total, GLsizei num_eyes)
+{
+    size_t offset = 0;
+
+    glBindBuffer(GL_ARRAY_BUFFER, batch->instance_vbo);
+    reserve_buffer(batch, (GLsizeiptr) (total * sizeof(PsyShapeInstance)));
+
+    for (size_t kind = 0; kind < PSY_SHAPE_NUM_KINDS; kind++) {
+        size_t n = batch->num_instances[kind];
+        if (n == 0)
+            continue;
+        glBufferSubData(
+            GL_ARRAY_BUFFER,
+            (GLintptr) offset,
+            (GLsizeiptr) (n * sizeof(PsyShapeInstance)),
+            batch->instances[kind]
+            );
+        set_instance_attributes(batch, sizeof(PsyShapeInstance), offset);
+        glUniform1i(batch->u_shape, (GLint) kind);
+        glDrawArraysInstanced(
+            GL_TRIANGLES, 0, VERTICES_PER_SHAPE, (GLsizei) n * num_eyes
+            );
+        offset += n * sizeof(PsyShapeInstance);
+    }
+}
+
+/*
+ * Expands every shape into VERTICES_PER_SHAPE vertices and uploads them,
+ * this is used when instancing isn't available.
+ */
+static int
+upload_expanded(PsyShapeBatch* batch, size_t total, SeeError** error)
+{
+    size_t num_vertices = total * VERTICES_PER_SHAPE;
+    ShapeVertex* vertex;
+
+    if (num_vertices > batch->vertices_capacity) {
+        void* new_vertices = realloc(
+            batch->vertices,
+            num_vertices * sizeof(ShapeVertex)
+            );
+        if (!new_vertices) {
+            set_out_of_memory(error, __func__);
+            return SEE_ERROR_RUNTIME;
+        }
+        batch->vertices = new_vertices;
+        batch->vertices_capacity = num_vertices;
+    }
+
+    vertex = batch->vertices;
+    for (size_t kind = 0; kind < PSY_SHAPE_NUM_KINDS; kind++) {
+        for (size_t i = 0; i < batch->num_instances[kind]; i++) {
+            for (size_t c = 0; c < VERTICES_PER_SHAPE; c++, vertex++) {
+                vertex->corner[0] = g_quad[c][0];
+                vertex->corner[1] = g_quad[c][1];
+                vertex->instance = batch->instances[kind][i];
+            }
+        }
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, batch->instance_vbo);
+    reserve_buffer(batch, (GLsizeiptr) (num_vertices * sizeof(ShapeVertex)));
+    glBufferSubData(
+        GL_ARRAY_BUFFER,
+        0,
+        (GLsizeiptr) (num_vertices * sizeof(ShapeVertex)),
+        batch->vertices
+        );
+
+    set_attribute(
+        batch->a_corner,
+        2,
+        sizeof(ShapeVertex),
+        offsetof(ShapeVertex, corner)
+        );
+    set_instance_attributes(
+        batch,
+        sizeof(ShapeVertex),
+        offsetof(ShapeVertex, instance)
+        );
+
+    return SEE_SUCCESS;
+}
+
+/* Draws the shapes that upload_expanded() uploaded. */
+static void
+draw_expanded(PsyShapeBatch* batch)
+{
+    GLint first = 0;
+
+    for (size_t kind = 0; kind < PSY_SHAPE_NUM_KINDS; kind++) {
+        GLsizei count = (GLsizei) (batch->num_instances[kind] *
+                                   VERTICES_PER_SHAPE);
+        if (count == 0)
+            continue;
+        glUniform1i(batch->u_shape, (GLint) kind);
+        glDrawArrays(GL_TRIANGLES, first, count);
+        first += count;
+    }
+}
+
+static int
+shape_batch_draw(
+    PsyShapeBatch*  batch,
+    const GLfloat*  transform,
+    SeeError**      error
+    )
+{
+    size_t total = 0;
+    int ret;
+
+    for (size_t i = 0; i < PSY_SHAPE_NUM_KINDS; i++)
+        total += batch->num_instances[i];
+    if (total == 0)
+        return SEE_SUCCESS;
+
+    ret = psy_shader_use_program(batch->program, error);
+    if (ret)
+        return ret;
+    if (psy_shader_program_generation(batch->program) !=
+        batch->program_generation)
+        find_locations(batch);
+
+    glUniformMatrix4fv(
+        batch->u_transform, 1, GL_FALSE, transform ? transform : g_identity
+        );
+    glUniform1f(batch->u_line_width, batch->line_width);
+
+    if (batch->vao)
+        glBindVertexArray(batch->vao);
+
+    if (batch->instanced) {
+        draw_instanced(batch, total, 1);
+    }
+    else {
+        ret = upload_expanded(batch, total, error);
+        if (ret == SEE_SUCCESS)
+            draw_expanded(batch);
+    }
+
+    if (!batch->vao)
+        disable_attributes(batch);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return ret;
+}
+
+/*
+ * Draws the eyes one after the other, each inside a scissor around its
+ * part of the viewport, as clip distances need the instanced shader.
+ */
+static int
+draw_eyes_in_turn(
+    PsyShapeBatch*          batch,
+    const PsyStereoEyes*    eyes,
+    size_t                  total,
+    SeeError**              error
+    )
+{
+    GLint viewport[4], box[4];
+    GLboolean scissor;
+    int ret;
+
+    ret = upload_expanded(batch, total, error);
+    if (ret)
+        return ret;
+
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetIntegerv(GL_SCISSOR_BOX, box);
+    scissor = glIsEnabled(GL_SCISSOR_TEST);
+    glEnable(GL_SCISSOR_TEST);
+
+    for (int eye = PSY_EYE_LEFT; eye <= PSY_EYE_RIGHT; eye++) {
+        const GLfloat* region = eyes->regions[eye];
+        glScissor(
+            viewport[0] + (GLint) (region[0] * (GLfloat) viewport[2]),
+            viewport[1] + (GLint) (region[1] * (GLfloat) viewport[3]),
+            (GLsizei) (region[2] * (GLfloat) viewport[2]),
+            (GLsizei) (region[3] * (GLfloat) viewport[3])
+            );
+        glUniformMatrix4fv(batch->u_transform, 1, GL_FALSE, eyes->transforms[eye]);
+        glUniform1f(batch->u_disparity_sign, eye == PSY_EYE_LEFT ? 0.5f : -0.5f);
+        draw_expanded(batch);
+    }
+
+    glUniform1f(batch->u_disparity_sign, 0.0f);
+    glScissor(box[0], box[1], box[2], box[3]);
+    if (!scissor)
+        glDisable(GL_SCISSOR_TEST);
+
+    return SEE_SUCCESS;
+}
+
+static int
+shape_batch_draw_stereo(
+    PsyShapeBatch*          batch,
+    const PsyStereoEyes*    eyes,
+    SeeError**              error
+    )
+{
+    size_t total = 0;
+    int ret;
+
+    for (size_t i = 0; i < PSY_SHAPE_NUM_KINDS; i++)
+        total += batch->num_instances[i];
+    if (total == 0)
+        return SEE_SUCCESS;
+
+    ret = psy_shader_use_program(batch->program, error);
+    if (ret)
+        return ret;
+    if (psy_shader_program_generation(batch->program) !=
+        batch->program_generation)
+        find_locations(batch);
+
+    glUniform1f(batch->u_line_width, batch->line_width);
+
+    if (batch->vao)
+        glBindVertexArray(batch->vao);
+
+    if (batch->instanced) {
+        glUniformMatrix4fv(
+            batch->u_eye_transforms, 2, GL_FALSE, &eyes->transforms[0][0]
+            );
+        glUniform4fv(batch->u_clip_planes, 2, &eyes->clip_planes[0][0]);
+        glUniform1i(batch->u_stereo, 1);
+        glEnable(GL_CLIP_DISTANCE0);
+
+        // Instance 2i is shape i for the left eye, 2i + 1 for the right.
+        set_instance_divisors(batch, 2);
+        draw_instanced(batch, total, 2);
+        set_instance_divisors(batch, 1);
+
+        glDisable(GL_CLIP_DISTANCE0);
+        glUniform1i(batch->u_stereo, 0);
+    }
+    else {
+        ret = draw_eyes_in_turn(batch, eyes, total, error);
+    }
+
+    if (!batch->vao)
+        disable_attributes(batch);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return ret;
+}
+
+/* **** implementation of the public API **** */
+
+int
+psy_shape_batch_create(PsyShapeBatch** batch, SeeError** error)
+{
+    const PsyShapeBatchClass* cls = psy_shape_batch_class();
+    const SeeObjectClass* see_cls = SEE_OBJECT_CLASS(cls);
+
+    if (!cls)
+        return SEE_NOT_INITIALIZED;
+
+    if (!batch || *batch)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return see_cls->new_obj(see_cls, 0, (SeeObject**) batch, error);
+}
+
+int
+psy_shape_batch_add(
+    PsyShapeBatch*          batch,
+    PsyShapeKind            kind,
+    const PsyShapeInstance* instances,
+    size_t                  num_instances,
+    SeeError**              error
+    )
+{
+    const PsyShapeBatchClass* cls;
+
+    if (!batch || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+    if (kind < 0 || kind >= PSY_SHAPE_NUM_KINDS)
+        return SEE_INVALID_ARGUMENT;
+    if (num_instances && !instances)
+        return SEE_INVALID_ARGUMENT;
+
+    cls = PSY_SHAPE_BATCH_GET_CLASS(batch);
+    return cls->add(batch, kind, instances, num_instances, error);
+}
+
+void
+psy_shape_batch_clear(PsyShapeBatch* batch)
+{
+    if (!batch)
+        return;
+    PSY_SHAPE_BATCH_GET_CLASS(batch)->clear(batch);
+}
+
+size_t
+psy_shape_batch_size(const PsyShapeBatch* batch, PsyShapeKind kind)
+{
+    if (!batch || kind < 0 || kind >= PSY_SHAPE_NUM_KINDS)
+        return 0;
+    return batch->num_instances[kind];
+}
+
+void
+psy_shape_batch_set_line_width(PsyShapeBatch* batch, GLfloat line_width)
+{
+    if (!batch || line_width <= 0.0f || line_width > 1.0f)
+        return;
+    batch->line_width = line_width;
+}
+
+int
+psy_shape_batch_draw(
+    PsyShapeBatch*  batch,
+    const GLfloat*  transform,
+    SeeError**      error
+    )
+{
+    const PsyShapeBatchClass* cls;
+
+    if (!batch || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    cls = PSY_SHAPE_BATCH_GET_CLASS(batch);
+    return cls->draw(batch, transform, error);
+}
+
+int
+psy_shape_batch_draw_stereo(
+    PsyShapeBatch*          batch,
+    const PsyStereoEyes*    eyes,
+    SeeError**              error
+    )
+{
+    const PsyShapeBatchClass* cls;
+
+    if (!batch || !eyes || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    cls = PSY_SHAPE_BATCH_GET_CLASS(batch);
+    return cls->draw_stereo(batch, eyes, error);
+}
+
+/* **** initialization of the class **** */
+
+PsyShapeBatchClass* g_PsyShapeBatchClass = NULL;
+
+static int psy_shape_batch_class_init(SeeObjectClass* new_cls) {
+    int ret = SEE_SUCCESS;
+
+    /* Override the functions on the parent here */
+    new_cls->init = init;
+    new_cls->name = "PsyShapeBatch";
+    new_cls->destroy = destroy;
+
+    /* Set the function pointers of the own class here */
+    PsyShapeBatchClass* cls = (PsyShapeBatchClass*) new_cls;
+
+    cls->shape_batch_init   = shape_batch_init;
+    cls->add                = shape_batch_add;
+    cls->clear              = shape_batch_clear;
+    cls->draw               = shape_batch_draw;
+    cls->draw_stereo        = shape_batch_draw_stereo;
+
+    return ret;
+}
+
+/**
+ * \private
+ * \brief this class initializes PsyShapeBatch(Class).
+ *
+ * You might want to call this from the library initialization func.
+ */
+int
+psy_shape_batch_init() {
+    int ret;
+    const SeeMetaClass* meta = see_meta_class_class();
+
+    ret = see_meta_class_new_class(
+        meta,
+        (SeeObjectClass**) &g_PsyShapeBatchClass,
+        sizeof(PsyShapeBatchClass),
+        sizeof(PsyShapeBatch),
+        see_object_class(),
+        sizeof(SeeObjectClass),
+        psy_shape_batch_class_init
+        );
+
+    return ret;
+}
+
+void
+psy_shape_batch_deinit()
+{
+    if(!g_PsyShapeBatchClass)
+        return;
+
+    see_object_decref((SeeObject*) g_PsyShapeBatchClass);
+    g_PsyShapeBatchClass = NULL;
+}
+
+const PsyShapeBatchClass*
+psy_shape_batch_class()
+{
+    return g_PsyShapeBatchClass;
+}
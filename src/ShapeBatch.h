@@ -0,0 +1,297 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file ShapeBatch.h
+ * \brief Draw large numbers of simple shapes with a few draw calls.
+ *
+ * A PsyShapeBatch collects discs, bars and crosses. Every shape is an
+ * instance with a position, size, orientation and colour. All instances are
+ * uploaded to one buffer and all shapes of one kind are drawn with a single
+ * instanced draw call. On OpenGL ES 2.0, which has no instancing, the
+ * instances are expanded on the CPU and every kind is still drawn with one
+ * draw call.
+ *
+ * psy_shape_batch_draw_stereo() draws the views of both eyes in the same
+ * call, see Stereo.h; each shape can have its own disparity.
+ */
+
+#ifndef PSY_SHAPE_BATCH_H
+#define PSY_SHAPE_BATCH_H
+
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+
+#include "ShaderProgram.h"
+#include "Stereo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _PsyShapeBatch PsyShapeBatch;
+typedef struct _PsyShapeBatchClass PsyShapeBatchClass;
+
+/**
+ * \brief The kinds of shapes a PsyShapeBatch can draw.
+ */
+typedef enum {
+    PSY_SHAPE_DISC,     ///< An ellipse that fits the size of the shape.
+    PSY_SHAPE_BAR,      ///< A rectangle.
+    PSY_SHAPE_CROSS,    ///< Two bars crossing in the center.
+    PSY_SHAPE_NUM_KINDS ///< The number of kinds, not a kind itself.
+} PsyShapeKind;
+
+/**
+ * \brief The attributes of one shape.
+ *
+ * This is also the layout of one instance in the instance buffer.
+ */
+typedef struct _PsyShapeInstance {
+    GLfloat x;              ///< The x-coordinate of the center.
+    GLfloat y;              ///< The y-coordinate of the center.
+    GLfloat width;          ///< The width of the shape.
+    GLfloat height;         ///< The height of the shape.
+    GLfloat orientation;    ///< The orientation in degrees counter clockwise.
+    GLfloat color[4];       ///< The rgba colour in the range [0, 1].
+    GLfloat disparity;      ///< In stereo, the left eye sees the shape
+                            ///< disparity / 2 to the right, the right eye
+                            ///< disparity / 2 to the left.
+} PsyShapeInstance;
+
+struct _PsyShapeBatch {
+    SeeObject parent_obj;
+
+    /*expand PsyShapeBatch data here*/
+
+    PsyShaderProgram*   program;
+    GLuint              vao;
+    GLuint              quad_vbo;
+    GLuint              instance_vbo;
+    GLsizeiptr          instance_vbo_size;
+    int                 instanced;
+    GLfloat             line_width;
+
+    PsyShapeInstance*   instances[PSY_SHAPE_NUM_KINDS];
+    size_t              num_instances[PSY_SHAPE_NUM_KINDS];
+    size_t              capacity[PSY_SHAPE_NUM_KINDS];
+
+    void*               vertices;   // the expanded instances without instancing
+    size_t              vertices_capacity;
+
+    GLint               a_corner;
+    GLint               a_position;
+    GLint               a_size;
+    GLint               a_orientation;
+    GLint               a_color;
+    GLint               a_disparity;
+    GLint               u_transform;
+    GLint               u_shape;
+    GLint               u_line_width;
+    GLint               u_disparity_sign;
+    GLint               u_stereo;
+    GLint               u_eye_transforms;
+    GLint               u_clip_planes;
+    unsigned            program_generation; // when the locations were found
+};
+
+struct _PsyShapeBatchClass {
+    SeeObjectClass parent_cls;
+
+    int (*shape_batch_init)(
+        PsyShapeBatch*              batch,
+        const PsyShapeBatchClass*   batch_cls,
+        SeeError**                  error
+        );
+
+    int (*add)(
+        PsyShapeBatch*          batch,
+        PsyShapeKind            kind,
+        const PsyShapeInstance* instances,
+        size_t                  num_instances,
+        SeeError**              error
+        );
+
+    void (*clear)(PsyShapeBatch* batch);
+
+    int (*draw)(
+        PsyShapeBatch*  batch,
+        const GLfloat*  transform,
+        SeeError**      error
+        );
+
+    int (*draw_stereo)(
+        PsyShapeBatch*          batch,
+        const PsyStereoEyes*    eyes,
+        SeeError**              error
+        );
+};
+
+/* **** function style macro casts **** */
+
+/**
+ * \brief cast a pointer from a PsyShapeBatch derived instance back to a
+ *        pointer to PsyShapeBatch.
+ */
+#define PSY_SHAPE_BATCH(obj)                      \
+    ((PsyShapeBatch*) obj)
+
+/**
+ * \brief cast a pointer to PsyShapeBatchClass derived class back to a
+ *        pointer to PsyShapeBatchClass.
+ */
+#define PSY_SHAPE_BATCH_CLASS(cls)                      \
+    ((const PsyShapeBatchClass*) cls)
+
+/**
+ * \brief obtain a pointer to PsyShapeBatchClass from a instance of
+ *        derived from PsyShapeBatch.
+ */
+#define PSY_SHAPE_BATCH_GET_CLASS(obj)                \
+    (PSY_SHAPE_BATCH_CLASS(see_object_get_class(SEE_OBJECT(obj)) )  )
+
+/* **** public functions **** */
+
+/**
+ * \brief Create a new PsyShapeBatch.
+ *
+ * The batch creates its program and buffers, so there must be a current
+ * OpenGL context, e.g. create a PsyWindow first.
+ *
+ * @param [out] batch   The new batch is returned here, *batch should be NULL.
+ * @param [out] error   If an error occurs it will be returned here.
+ *
+ * @return SEE_SUCCESS if the batch is created.
+ */
+PSY_EXPORT int
+psy_shape_batch_create(PsyShapeBatch** batch, SeeError** error);
+
+/**
+ * \brief Add shapes of one kind to the batch.
+ *
+ * The shapes are copied, the buffer with instances is only updated when
+ * the batch is drawn.
+ *
+ * @param [in]  batch
+ * @param [in]  kind            The kind of shapes to add.
+ * @param [in]  instances       An array of shapes.
+ * @param [in]  num_instances   The number of shapes in instances.
+ * @param [out] error           If an error occurs it will be returned here.
+ *
+ * @return SEE_SUCCESS, SEE_INVALID_ARGUMENT or SEE_ERROR_RUNTIME when
+ *         out of memory.
+ */
+PSY_EXPORT int
+psy_shape_batch_add(
+    PsyShapeBatch*          batch,
+    PsyShapeKind            kind,
+    const PsyShapeInstance* instances,
+    size_t                  num_instances,
+    SeeError**              error
+    );
+
+/**
+ * \brief Remove all shapes from the batch, typically before building the
+ * next frame. The memory is kept for reuse.
+ */
+PSY_EXPORT void
+psy_shape_batch_clear(PsyShapeBatch* batch);
+
+/**
+ * \brief Returns the number of shapes of kind in the batch.
+ */
+PSY_EXPORT size_t
+psy_shape_batch_size(const PsyShapeBatch* batch, PsyShapeKind kind);
+
+/**
+ * \brief Set the width of the arms of a cross relative to its size.
+ *
+ * @param [in] batch
+ * @param [in] line_width A value in the range (0, 1], the default is 0.2.
+ */
+PSY_EXPORT void
+psy_shape_batch_set_line_width(PsyShapeBatch* batch, GLfloat line_width);
+
+/**
+ * \brief Draw all shapes in the batch.
+ *
+ * This draws one call per kind of shape that is present in the batch. The
+ * program and vertex array of the batch remain bound afterwards.
+ *
+ * @param [in]  batch
+ * @param [in]  transform   A column major 4x4 matrix that maps the
+ *                          coordinates of the shapes to clip space. When
+ *                          NULL the coordinates are in clip space already.
+ * @param [out] error       If an error occurs it will be returned here.
+ *
+ * @return SEE_SUCCESS when the shapes are drawn.
+ */
+PSY_EXPORT int
+psy_shape_batch_draw(
+    PsyShapeBatch*  batch,
+    const GLfloat*  transform,
+    SeeError**      error
+    );
+
+/**
+ * \brief Draw all shapes for both eyes.
+ *
+ * With instancing every shape is drawn as two instances in the same call,
+ * the instance attributes advance every second instance, so the cost of
+ * the second eye is only in the vertices, not in extra calls or uploads.
+ * On OpenGL ES 2.0 the expanded shapes are uploaded once and drawn for each
+ * eye in turn, with a scissor around the eye's part of the viewport.
+ *
+ * @param [in]  batch
+ * @param [in]  eyes    The transforms of the eyes, see psy_stereo_eyes().
+ * @param [out] error   If an error occurs it will be returned here.
+ *
+ * @return SEE_SUCCESS when the shapes are drawn.
+ */
+PSY_EXPORT int
+psy_shape_batch_draw_stereo(
+    PsyShapeBatch*          batch,
+    const PsyStereoEyes*    eyes,
+    SeeError**              error
+    );
+
+/**
+ * Gets the pointer to the PsyShapeBatchClass table.
+ */
+PSY_EXPORT const PsyShapeBatchClass*
+psy_shape_batch_class();
+
+/* **** class initialization functions **** */
+
+/**
+ * Initialize PsyShapeBatch; make it ready for use.
+ */
+PSY_EXPORT
+int psy_shape_batch_init();
+
+/**
+ * Deinitialize PsyShapeBatch, after PsyShapeBatch has been deinitialized,
+ * all functions in this header shouldn't be used anymore.
+ */
+PSY_EXPORT
+void psy_shape_batch_deinit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_SHAPE_BATCH_H
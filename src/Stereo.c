@@ -0,0 +1,127 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file Stereo.c
+ * \brief Computes the layout of the eyes for the stereo modes.
+ */
+
+#include <string.h>
+#include "Stereo.h"
+
+static const GLfloat g_identity[16] = {
+    1.0f, 0.0f, 0.0f, 0.0f,
+    0.0f, 1.0f, 0.0f, 0.0f,
+    0.0f, 0.0f, 1.0f, 0.0f,
+    0.0f, 0.0f, 0.0f, 1.0f
+};
+
+/* out = a * b, all column major. */
+static void
+multiply(GLfloat* out, const GLfloat* a, const GLfloat* b)
+{
+    int row, col, k;
+
+    for (col = 0; col < 4; col++) {
+        for (row = 0; row < 4; row++) {
+            GLfloat sum = 0.0f;
+            for (k = 0; k < 4; k++)
+                sum += a[k * 4 + row] * b[col * 4 + k];
+            out[col * 4 + row] = sum;
+        }
+    }
+}
+
+/*
+ * Squeezes clip space into half of it: along x (axis 0) or y (axis 1) and
+ * towards the positive (side 1) or negative (side -1) half.
+ */
+static void
+half_layout(GLfloat* layout, int axis, GLfloat side)
+{
+    memcpy(layout, g_identity, sizeof(g_identity));
+    layout[axis * 4 + axis] = 0.5f;
+    // Translating in clip space is scaled by w, so it goes in the w column.
+    layout[3 * 4 + axis] = 0.5f * side;
+}
+
+static void
+set4(GLfloat* v, GLfloat a, GLfloat b, GLfloat c, GLfloat d)
+{
+    v[0] = a;
+    v[1] = b;
+    v[2] = c;
+    v[3] = d;
+}
+
+void
+psy_stereo_eyes(
+    PsyStereoMode   mode,
+    const GLfloat*  left,
+    const GLfloat*  right,
+    PsyStereoEyes*  eyes
+    )
+{
+    GLfloat layouts[2][16];
+    const GLfloat* views[2];
+    int eye;
+
+    if (!eyes)
+        return;
+    views[PSY_EYE_LEFT] = left ? left : g_identity;
+    views[PSY_EYE_RIGHT] = right ? right : g_identity;
+
+    switch (mode) {
+        case PSY_STEREO_SIDE_BY_SIDE:
+        case PSY_STEREO_ROW_INTERLEAVED:
+        case PSY_STEREO_ANAGLYPH:
+            half_layout(layouts[PSY_EYE_LEFT], 0, -1.0f);
+            half_layout(layouts[PSY_EYE_RIGHT], 0, 1.0f);
+            // Keep x <= 0 for the left eye and x >= 0 for the right eye.
+            set4(eyes->clip_planes[PSY_EYE_LEFT], -1.0f, 0.0f, 0.0f, 0.0f);
+            set4(eyes->clip_planes[PSY_EYE_RIGHT], 1.0f, 0.0f, 0.0f, 0.0f);
+            set4(eyes->regions[PSY_EYE_LEFT], 0.0f, 0.0f, 0.5f, 1.0f);
+            set4(eyes->regions[PSY_EYE_RIGHT], 0.5f, 0.0f, 0.5f, 1.0f);
+            break;
+        case PSY_STEREO_TOP_BOTTOM:
+            half_layout(layouts[PSY_EYE_LEFT], 1, 1.0f);
+            half_layout(layouts[PSY_EYE_RIGHT], 1, -1.0f);
+            set4(eyes->clip_planes[PSY_EYE_LEFT], 0.0f, 1.0f, 0.0f, 0.0f);
+            set4(eyes->clip_planes[PSY_EYE_RIGHT], 0.0f, -1.0f, 0.0f, 0.0f);
+            set4(eyes->regions[PSY_EYE_LEFT], 0.0f, 0.5f, 1.0f, 0.5f);
+            set4(eyes->regions[PSY_EYE_RIGHT], 0.0f, 0.0f, 1.0f, 0.5f);
+            break;
+        case PSY_STEREO_NONE:
+        default:
+            // Both views cover the whole viewport, w > 0 isn't clipped.
+            for (eye = 0; eye < 2; eye++) {
+                memcpy(layouts[eye], g_identity, sizeof(g_identity));
+                set4(eyes->clip_planes[eye], 0.0f, 0.0f, 0.0f, 1.0f);
+                set4(eyes->regions[eye], 0.0f, 0.0f, 1.0f, 1.0f);
+            }
+            break;
+    }
+
+    for (eye = 0; eye < 2; eye++)
+        multiply(eyes->transforms[eye], layouts[eye], views[eye]);
+}
+
+int
+psy_stereo_is_composited(PsyStereoMode mode)
+{
+    return mode == PSY_STEREO_ROW_INTERLEAVED || mode == PSY_STEREO_ANAGLYPH;
+}
@@ -0,0 +1,104 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file Stereo.h
+ * \brief The layouts of the two eyes' views for stereoscopic displays.
+ *
+ * Haploscopes and stereoscopes show each eye its own half of the screen,
+ * a row-interleaved (polarized) display its own rows and anaglyph glasses
+ * their own colors. Stimuli that support stereo draw both views in one
+ * pass: every element is drawn as two instances, the even instance for
+ * the left eye and the odd one for the right eye. The PsyStereoEyes give
+ * the transform of each eye, which includes where the view of that eye
+ * goes in the viewport, and a clip plane that keeps the view in its half.
+ *
+ * The row-interleaved and anaglyph modes are drawn side by side into a
+ * framebuffer that's twice as wide as the window, PsyWindow combines the
+ * halves afterwards, see psy_window_stereo_begin().
+ */
+
+#ifndef PSY_STEREO_H
+#define PSY_STEREO_H
+
+#include "psy_export.h"
+#include "gl/includes_gl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief How the views of the two eyes are presented.
+ */
+typedef enum {
+    PSY_STEREO_NONE,            ///< One view, both eyes see the same.
+    PSY_STEREO_SIDE_BY_SIDE,    ///< The left eye sees the left half.
+    PSY_STEREO_TOP_BOTTOM,      ///< The left eye sees the top half.
+    PSY_STEREO_ROW_INTERLEAVED, ///< The left eye sees the even rows.
+    PSY_STEREO_ANAGLYPH         ///< The left eye sees red, the right cyan.
+} PsyStereoMode;
+
+/**
+ * \brief Identifies an eye, it's also the index in PsyStereoEyes.
+ */
+typedef enum {
+    PSY_EYE_LEFT,
+    PSY_EYE_RIGHT
+} PsyEye;
+
+/**
+ * \brief Where and how each eye's view is drawn.
+ */
+typedef struct {
+    /** Column major matrices, the view of an eye followed by its layout. */
+    GLfloat transforms[2][16];
+    /** gl_ClipDistance[0] = dot(clip_planes[eye], gl_Position). */
+    GLfloat clip_planes[2][4];
+    /** The part of the viewport of an eye: x, y, width, height in [0, 1],
+     * for drawing the eyes one after the other with a scissor. */
+    GLfloat regions[2][4];
+} PsyStereoEyes;
+
+/**
+ * \brief Compute the transforms of both eyes.
+ *
+ * @param [in]  mode    The mode the window presents the views in.
+ * @param [in]  left    The view of the left eye, NULL for the identity.
+ * @param [in]  right   The view of the right eye, NULL for the identity.
+ * @param [out] eyes
+ */
+PSY_EXPORT void
+psy_stereo_eyes(
+    PsyStereoMode   mode,
+    const GLfloat*  left,
+    const GLfloat*  right,
+    PsyStereoEyes*  eyes
+    );
+
+/**
+ * \brief Returns non zero for the modes that draw the views side by side
+ * into a framebuffer and combine them afterwards.
+ */
+PSY_EXPORT int
+psy_stereo_is_composited(PsyStereoMode mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_STEREO_H
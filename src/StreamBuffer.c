@@ -0,0 +1,429 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include "MetaClass.h"
+#include "Error.h"
+#include "StreamBuffer.h"
+#include "Trace.h"
+#include "gl/GLError.h"
+#include "gl/gl_util.h"
+
+/* Offsets returned by map are aligned to this, enough for any attribute. */
+#define ALIGNMENT 16
+
+/* How long end_frame waits for a segment before giving up, 1 s. */
+#define WAIT_TIMEOUT_NS 1000000000ull
+
+static void
+set_glerror(SeeError** error, const char* func, const char* msg)
+{
+    PsyGLError* glerror = NULL;
+    psy_glerror_create(&glerror);
+    psy_error_printf(PSY_ERROR(glerror), "%s: %s", func, msg);
+    *error = SEE_ERROR(glerror);
+}
+
+static size_t
+segment_start(const PsyStreamBuffer* buffer)
+{
+    return (size_t) buffer->segment * buffer->segment_size;
+}
+
+/* **** functions that implement PsyStreamBuffer or override SeeObject **** */
+
+static int
+stream_buffer_init(
+    PsyStreamBuffer*            buffer,
+    const PsyStreamBufferClass* buffer_cls,
+    GLenum                      target,
+    size_t                      segment_size,
+    SeeError**                  error
+    )
+{
+    const SeeObjectClass* parent_cls = SEE_OBJECT_CLASS(buffer_cls);
+    GLsizeiptr total;
+    PsyGLBufferStorageProc buffer_storage = psy_gl_buffer_storage();
+
+    parent_cls->object_init(
+        SEE_OBJECT(buffer),
+        SEE_OBJECT_CLASS(buffer_cls)
+        );
+
+    segment_size = (segment_size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    total = (GLsizeiptr) (segment_size * PSY_STREAM_BUFFER_SEGMENTS);
+
+    buffer->target = target;
+    buffer->segment_size = segment_size;
+
+    glGenBuffers(1, &buffer->buffer_id);
+    glBindBuffer(target, buffer->buffer_id);
+
+    if (buffer_storage) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | PSY_GL_MAP_PERSISTENT_BIT |
+                                 PSY_GL_MAP_COHERENT_BIT;
+        buffer->mode = PSY_STREAM_BUFFER_PERSISTENT;
+        buffer_storage(target, total, NULL, flags);
+        buffer->persistent = glMapBufferRange(target, 0, total, flags);
+        if (!buffer->persistent) {
+            set_glerror(error, __func__, "unable to map the buffer persistently");
+            return SEE_ERROR_RUNTIME;
+        }
+    }
+    else {
+        buffer->mode = psy_gl_has_pixel_buffers() ?
+            PSY_STREAM_BUFFER_MAP_RANGE : PSY_STREAM_BUFFER_SUB_DATA;
+        glBufferData(target, total, NULL, GL_STREAM_DRAW);
+        if (buffer->mode == PSY_STREAM_BUFFER_SUB_DATA) {
+            buffer->staging = malloc(segment_size);
+            if (!buffer->staging) {
+                set_glerror(error, __func__, "out of memory");
+                return SEE_ERROR_RUNTIME;
+            }
+        }
+    }
+
+    if (glGetError() != GL_NO_ERROR) {
+        set_glerror(error, __func__, "unable to create the buffer");
+        return SEE_ERROR_RUNTIME;
+    }
+
+    return SEE_SUCCESS;
+}
+
+static int
+init(const SeeObjectClass* cls, SeeObject* obj, va_list args)
+{
+    const PsyStreamBufferClass* buffer_cls = PSY_STREAM_BUFFER_CLASS(cls);
+    PsyStreamBuffer* buffer = PSY_STREAM_BUFFER(obj);
+
+    GLenum target = va_arg(args, GLenum);
+    size_t segment_size = va_arg(args, size_t);
+    SeeError** error = va_arg(args, SeeError**);
+
+    return buffer_cls->stream_buffer_init(
+        buffer, buffer_cls, target, segment_size, error
+        );
+}
+
+static void
+destroy(SeeObject* obj)
+{
+    PsyStreamBuffer* buffer = PSY_STREAM_BUFFER(obj);
+    int i;
+
+    for (i = 0; i < PSY_STREAM_BUFFER_SEGMENTS; i++)
+        if (buffer->fences[i])
+            glDeleteSync(buffer->fences[i]);
+
+    if (buffer->buffer_id) {
+        if (buffer->persistent || buffer->mapped) {
+            glBindBuffer(buffer->target, buffer->buffer_id);
+            glUnmapBuffer(buffer->target);
+        }
+        glDeleteBuffers(1, &buffer->buffer_id);
+    }
+    free(buffer->staging);
+
+    see_object_class()->destroy(obj);
+}
+
+static void*
+stream_buffer_map(
+    PsyStreamBuffer*    buffer,
+    size_t              size,
+    size_t*             offset,
+    SeeError**          error
+    )
+{
+    size_t start = (buffer->used + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    void* memory = NULL;
+
+    if (buffer->mapped) {
+        set_glerror(error, __func__, "the previous map hasn't been unmapped");
+        return NULL;
+    }
+    if (size == 0 || start + size > buffer->segment_size) {
+        PsyError* err = NULL;
+        psy_error_create(&err);
+        psy_error_printf(
+            err,
+            "%s: %zu bytes don't fit in a segment of %zu bytes, %zu are used",
+            __func__, size, buffer->segment_size, start
+            );
+        *error = SEE_ERROR(err);
+        return NULL;
+    }
+
+    buffer->mapped_offset = segment_start(buffer) + start;
+    buffer->mapped_size = size;
+
+    switch (buffer->mode) {
+        case PSY_STREAM_BUFFER_PERSISTENT:
+            memory = buffer->persistent + buffer->mapped_offset;
+            break;
+        case PSY_STREAM_BUFFER_MAP_RANGE:
+            glBindBuffer(buffer->target, buffer->buffer_id);
+            // The fence of end_frame guarantees the GPU is done with it.
+            memory = glMapBufferRange(
+                buffer->target,
+                (GLintptr) buffer->mapped_offset,
+                (GLsizeiptr) size,
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+                GL_MAP_UNSYNCHRONIZED_BIT
+                );
+            if (!memory) {
+                set_glerror(error, __func__, "unable to map the range");
+                return NULL;
+            }
+            break;
+        case PSY_STREAM_BUFFER_SUB_DATA:
+            memory = buffer->staging + start;
+            break;
+    }
+
+    buffer->used = start + size;
+    buffer->mapped = 1;
+    *offset = buffer->mapped_offset;
+    return memory;
+}
+
+static int
+stream_buffer_unmap(PsyStreamBuffer* buffer, SeeError** error)
+{
+    if (!buffer->mapped) {
+        set_glerror(error, __func__, "the buffer isn't mapped");
+        return SEE_ERROR_RUNTIME;
+    }
+    buffer->mapped = 0;
+
+    glBindBuffer(buffer->target, buffer->buffer_id);
+
+    PSY_TRACE_BEGIN(trace);
+    switch (buffer->mode) {
+        case PSY_STREAM_BUFFER_PERSISTENT:
+            // The mapping is coherent, nothing needs to be flushed.
+            break;
+        case PSY_STREAM_BUFFER_MAP_RANGE:
+            if (!glUnmapBuffer(buffer->target)) {
+                set_glerror(error, __func__, "the contents of the buffer were lost");
+                return SEE_ERROR_RUNTIME;
+            }
+            break;
+        case PSY_STREAM_BUFFER_SUB_DATA:
+            glBufferSubData(
+                buffer->target,
+                (GLintptr) buffer->mapped_offset,
+                (GLsizeiptr) buffer->mapped_size,
+                buffer->staging + (buffer->mapped_offset - segment_start(buffer))
+                );
+            break;
+    }
+    PSY_TRACE_END(trace, "psylib", "upload");
+
+    return SEE_SUCCESS;
+}
+
+static int
+stream_buffer_end_frame(PsyStreamBuffer* buffer, SeeError** error)
+{
+    GLsync fence;
+
+    if (buffer->mapped) {
+        set_glerror(error, __func__, "the buffer is still mapped");
+        return SEE_ERROR_RUNTIME;
+    }
+
+    // OpenGL ES 2.0 has no fences, there the driver synchronizes
+    // glBufferSubData.
+    if (buffer->mode != PSY_STREAM_BUFFER_SUB_DATA)
+        buffer->fences[buffer->segment] = glFenceSync(
+            GL_SYNC_GPU_COMMANDS_COMPLETE, 0
+            );
+
+    buffer->segment = (buffer->segment + 1) % PSY_STREAM_BUFFER_SEGMENTS;
+    buffer->used = 0;
+
+    fence = buffer->fences[buffer->segment];
+    if (!fence)
+        return SEE_SUCCESS;
+    buffer->fences[buffer->segment] = NULL;
+
+    if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+        GLenum status;
+
+        buffer->waits++;
+        status = glClientWaitSync(
+            fence, GL_SYNC_FLUSH_COMMANDS_BIT, WAIT_TIMEOUT_NS
+            );
+        if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED) {
+            glDeleteSync(fence);
+            set_glerror(error, __func__, "waiting for the GPU failed");
+            return SEE_ERROR_RUNTIME;
+        }
+    }
+    glDeleteSync(fence);
+
+    return SEE_SUCCESS;
+}
+
+/* **** implementation of the public API **** */
+
+int
+psy_stream_buffer_create(
+    PsyStreamBuffer**   buffer,
+    GLenum              target,
+    size_t              segment_size,
+    SeeError**          error
+    )
+{
+    const PsyStreamBufferClass* cls = psy_stream_buffer_class();
+    const SeeObjectClass* see_cls = SEE_OBJECT_CLASS(cls);
+
+    if (!cls)
+        return SEE_NOT_INITIALIZED;
+
+    if (!buffer || *buffer || segment_size == 0)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return see_cls->new_obj(
+        see_cls, 0, (SeeObject**) buffer, target, segment_size, error
+        );
+}
+
+void*
+psy_stream_buffer_map(
+    PsyStreamBuffer*    buffer,
+    size_t              size,
+    size_t*             offset,
+    SeeError**          error
+    )
+{
+    if (!buffer || !offset || !error || *error)
+        return NULL;
+
+    return PSY_STREAM_BUFFER_GET_CLASS(buffer)->map(buffer, size, offset, error);
+}
+
+int
+psy_stream_buffer_unmap(PsyStreamBuffer* buffer, SeeError** error)
+{
+    if (!buffer || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_STREAM_BUFFER_GET_CLASS(buffer)->unmap(buffer, error);
+}
+
+int
+psy_stream_buffer_end_frame(PsyStreamBuffer* buffer, SeeError** error)
+{
+    if (!buffer || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_STREAM_BUFFER_GET_CLASS(buffer)->end_frame(buffer, error);
+}
+
+void
+psy_stream_buffer_bind(const PsyStreamBuffer* buffer)
+{
+    if (buffer)
+        glBindBuffer(buffer->target, buffer->buffer_id);
+}
+
+GLuint
+psy_stream_buffer_id(const PsyStreamBuffer* buffer)
+{
+    return buffer ? buffer->buffer_id : 0;
+}
+
+PsyStreamBufferMode
+psy_stream_buffer_mode(const PsyStreamBuffer* buffer)
+{
+    return buffer ? buffer->mode : PSY_STREAM_BUFFER_SUB_DATA;
+}
+
+unsigned long
+psy_stream_buffer_waits(const PsyStreamBuffer* buffer)
+{
+    return buffer ? buffer->waits : 0;
+}
+
+/* **** initialization of the class **** */
+
+PsyStreamBufferClass* g_PsyStreamBufferClass = NULL;
+
+static int psy_stream_buffer_class_init(SeeObjectClass* new_cls) {
+    int ret = SEE_SUCCESS;
+
+    /* Override the functions on the parent here */
+    new_cls->init = init;
+    new_cls->name = "PsyStreamBuffer";
+    new_cls->destroy = destroy;
+
+    /* Set the function pointers of the own class here */
+    PsyStreamBufferClass* cls = (PsyStreamBufferClass*) new_cls;
+
+    cls->stream_buffer_init = stream_buffer_init;
+    cls->map                = stream_buffer_map;
+    cls->unmap              = stream_buffer_unmap;
+    cls->end_frame          = stream_buffer_end_frame;
+
+    return ret;
+}
+
+/**
+ * \private
+ * \brief this class initializes PsyStreamBuffer(Class).
+ *
+ * You might want to call this from the library initialization func.
+ */
+int
+psy_stream_buffer_init() {
+    int ret;
+    const SeeMetaClass* meta = see_meta_class_class();
+
+    ret = see_meta_class_new_class(
+        meta,
+        (SeeObjectClass**) &g_PsyStreamBufferClass,
+        sizeof(PsyStreamBufferClass),
+        sizeof(PsyStreamBuffer),
+        see_object_class(),
+        sizeof(SeeObjectClass),
+        psy_stream_buffer_class_init
+        );
+
+    return ret;
+}
+
+void
+psy_stream_buffer_deinit()
+{
+    if(!g_PsyStreamBufferClass)
+        return;
+
+    see_object_decref((SeeObject*) g_PsyStreamBufferClass);
+    g_PsyStreamBufferClass = NULL;
+}
+
+const PsyStreamBufferClass*
+psy_stream_buffer_class()
+{
+    return g_PsyStreamBufferClass;
+}
@@ -0,0 +1,257 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file StreamBuffer.h
+ * \brief A buffer for vertex data that changes every frame.
+ *
+ * Uploading fresh data into a buffer that the GPU may still be reading
+ * from either stalls or makes the driver allocate new storage. A
+ * PsyStreamBuffer avoids both: it is a ring of three segments, one for
+ * the frame that is being prepared and two for frames the GPU may still
+ * be drawing. Each frame the data is written into the current segment,
+ * psy_stream_buffer_end_frame() puts a fence behind the draws of that
+ * frame and moves on to the next segment. Only when the GPU is more than
+ * two frames behind, the CPU waits.
+ *
+ * How the data reaches the buffer depends on the context:
+ *  - With ARB_buffer_storage the buffer is mapped persistently, so
+ *    psy_stream_buffer_map() returns a pointer into the buffer without
+ *    calling OpenGL.
+ *  - With OpenGL 3.2 the range is mapped unsynchronized, the fences
+ *    prevent overwriting data that's in use.
+ *  - On OpenGL ES 2.0 the data is written to memory of the buffer object
+ *    and copied with glBufferSubData by psy_stream_buffer_unmap().
+ *
+ * A frame typically looks like:
+ * \code
+ * size_t offset;
+ * MyVertex* v = psy_stream_buffer_map(buffer, n * sizeof(MyVertex), &offset, &error);
+ * // fill v
+ * psy_stream_buffer_unmap(buffer, &error);
+ * psy_stream_buffer_bind(buffer);
+ * glVertexAttribPointer(location, 2, GL_FLOAT, GL_FALSE, sizeof(MyVertex), (void*) offset);
+ * glDrawArrays(GL_TRIANGLES, 0, n);
+ * psy_stream_buffer_end_frame(buffer, &error);
+ * \endcode
+ */
+
+#ifndef PSY_STREAM_BUFFER_H
+#define PSY_STREAM_BUFFER_H
+
+#include <stddef.h>
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+
+#include "psy_export.h"
+#include "gl/includes_gl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The number of segments in the ring. */
+#define PSY_STREAM_BUFFER_SEGMENTS 3
+
+typedef struct _PsyStreamBuffer PsyStreamBuffer;
+typedef struct _PsyStreamBufferClass PsyStreamBufferClass;
+
+/**
+ * \brief How data is transferred to the buffer.
+ */
+typedef enum {
+    PSY_STREAM_BUFFER_PERSISTENT,   ///< A persistent coherent mapping.
+    PSY_STREAM_BUFFER_MAP_RANGE,    ///< Unsynchronized glMapBufferRange.
+    PSY_STREAM_BUFFER_SUB_DATA      ///< glBufferSubData from a copy.
+} PsyStreamBufferMode;
+
+struct _PsyStreamBuffer {
+    SeeObject parent_obj;
+
+    /*expand PsyStreamBuffer data here*/
+
+    GLenum                  target;
+    GLuint                  buffer_id;
+    PsyStreamBufferMode     mode;
+    size_t                  segment_size;
+
+    unsigned char*          persistent; // the mapping in persistent mode
+    unsigned char*          staging;    // a copy of one segment otherwise
+    GLsync                  fences[PSY_STREAM_BUFFER_SEGMENTS];
+
+    int                     segment;
+    size_t                  used;
+    size_t                  mapped_offset;
+    size_t                  mapped_size;
+    int                     mapped;
+    unsigned long           waits;
+};
+
+struct _PsyStreamBufferClass {
+    SeeObjectClass parent_cls;
+
+    int (*stream_buffer_init)(
+        PsyStreamBuffer*            buffer,
+        const PsyStreamBufferClass* buffer_cls,
+        GLenum                      target,
+        size_t                      segment_size,
+        SeeError**                  error
+        );
+
+    void* (*map)(
+        PsyStreamBuffer*    buffer,
+        size_t              size,
+        size_t*             offset,
+        SeeError**          error
+        );
+
+    int (*unmap)(PsyStreamBuffer* buffer, SeeError** error);
+
+    int (*end_frame)(PsyStreamBuffer* buffer, SeeError** error);
+};
+
+/* **** function style macro casts **** */
+
+/**
+ * \brief cast a pointer from a PsyStreamBuffer derived instance back to a
+ *        pointer to PsyStreamBuffer.
+ */
+#define PSY_STREAM_BUFFER(obj)                      \
+    ((PsyStreamBuffer*) obj)
+
+/**
+ * \brief cast a pointer to PsyStreamBufferClass derived class back to a
+ *        pointer to PsyStreamBufferClass.
+ */
+#define PSY_STREAM_BUFFER_CLASS(cls)                      \
+    ((const PsyStreamBufferClass*) cls)
+
+/**
+ * \brief obtain a pointer to PsyStreamBufferClass from a instance of
+ *        derived from PsyStreamBuffer.
+ */
+#define PSY_STREAM_BUFFER_GET_CLASS(obj)                \
+    (PSY_STREAM_BUFFER_CLASS(see_object_get_class(SEE_OBJECT(obj)) ) )
+
+/* **** public functions **** */
+
+/**
+ * \brief Create a stream buffer.
+ *
+ * @param [out] buffer          The new buffer, should be NULL.
+ * @param [in]  target          The target the buffer is bound to, e.g.
+ *                              GL_ARRAY_BUFFER.
+ * @param [in]  segment_size    The number of bytes that can be written per
+ *                              frame, the buffer is three times as large.
+ * @param [out] error           If an error occurs, it's returned here.
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_stream_buffer_create(
+    PsyStreamBuffer**   buffer,
+    GLenum              target,
+    size_t              segment_size,
+    SeeError**          error
+    );
+
+/**
+ * \brief Reserve size bytes in the segment of the current frame.
+ *
+ * A frame may map several times, as long as every map is followed by
+ * psy_stream_buffer_unmap() before the next one.
+ *
+ * @param [in]  buffer
+ * @param [in]  size    The number of bytes that will be written.
+ * @param [out] offset  The offset of the bytes in the buffer, use it as
+ *                      the pointer of glVertexAttribPointer.
+ * @param [out] error
+ * @return The memory to write to or NULL when the segment is full.
+ */
+PSY_EXPORT void*
+psy_stream_buffer_map(
+    PsyStreamBuffer*    buffer,
+    size_t              size,
+    size_t*             offset,
+    SeeError**          error
+    );
+
+/**
+ * \brief Finish writing the bytes of the last map.
+ *
+ * The buffer is bound to its target afterwards.
+ */
+PSY_EXPORT int
+psy_stream_buffer_unmap(PsyStreamBuffer* buffer, SeeError** error);
+
+/**
+ * \brief Call this after the draws of a frame that use the buffer.
+ *
+ * When the GPU is still reading the next segment, this waits for it.
+ */
+PSY_EXPORT int
+psy_stream_buffer_end_frame(PsyStreamBuffer* buffer, SeeError** error);
+
+/**
+ * \brief Bind the buffer to its target.
+ */
+PSY_EXPORT void
+psy_stream_buffer_bind(const PsyStreamBuffer* buffer);
+
+/**
+ * \brief The name of the OpenGL buffer object.
+ */
+PSY_EXPORT GLuint
+psy_stream_buffer_id(const PsyStreamBuffer* buffer);
+
+/**
+ * \brief How data is transferred, this depends on the context.
+ */
+PSY_EXPORT PsyStreamBufferMode
+psy_stream_buffer_mode(const PsyStreamBuffer* buffer);
+
+/**
+ * \brief The number of times end_frame had to wait for the GPU.
+ */
+PSY_EXPORT unsigned long
+psy_stream_buffer_waits(const PsyStreamBuffer* buffer);
+
+/**
+ * Gets the pointer to the PsyStreamBufferClass table.
+ */
+PSY_EXPORT const PsyStreamBufferClass*
+psy_stream_buffer_class();
+
+/* **** class initialization functions **** */
+
+/**
+ * Initialize PsyStreamBuffer; make it ready for use.
+ */
+PSY_EXPORT
+int psy_stream_buffer_init();
+
+/**
+ * Deinitialize PsyStreamBuffer, after PsyStreamBuffer has been deinitialized,
+ * all functions in this header shouldn't be used anymore.
+ */
+PSY_EXPORT
+void psy_stream_buffer_deinit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_STREAM_BUFFER_H
@@ -0,0 +1,430 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "MetaClass.h"
+#include "Text.h"
+#include "gl/GLError.h"
+#include "gl/gl_util.h"
+
+/*
+ * A corner of a glyph quad as it is uploaded, see text.vert.
+ */
+typedef struct _TextVertex {
+    GLfloat position[2];
+    GLfloat texcoord[2];
+    GLfloat color[4];
+} TextVertex;
+
+static const GLfloat g_identity[16] = {
+    1.0f, 0.0f, 0.0f, 0.0f,
+    0.0f, 1.0f, 0.0f, 0.0f,
+    0.0f, 0.0f, 1.0f, 0.0f,
+    0.0f, 0.0f, 0.0f, 1.0f
+};
+
+static void
+set_out_of_memory(SeeError** error, const char* func)
+{
+    PsyGLError* glerror = NULL;
+    psy_glerror_create(&glerror);
+    psy_error_printf(PSY_ERROR(glerror), "%s: out of memory", func);
+    *error = SEE_ERROR(glerror);
+}
+
+static void
+set_attribute(
+    const PsyText*  text,
+    const char*     name,
+    GLint           size,
+    size_t          offset
+    )
+{
+    GLint location = psy_shader_program_attribute_location(
+        text->program, name
+        );
+    if (location < 0)
+        return;
+    glEnableVertexAttribArray((GLuint) location);
+    glVertexAttribPointer(
+        (GLuint) location,
+        size,
+        GL_FLOAT,
+        GL_FALSE,
+        sizeof(TextVertex),
+        (const void*) offset
+        );
+}
+
+/*
+ * Points the attributes into the bound GL_ARRAY_BUFFER.
+ */
+static void
+set_attributes(const PsyText* text)
+{
+    set_attribute(text, "a_position", 2, offsetof(TextVertex, position));
+    set_attribute(text, "a_texcoord", 2, offsetof(TextVertex, texcoord));
+    set_attribute(text, "a_color", 4, offsetof(TextVertex, color));
+}
+
+/* Disables the arrays set_attributes() enabled, without a vao they leak. */
+static void
+disable_attributes(const PsyText* text)
+{
+    const GLint locations[] = {
+        psy_shader_program_attribute_location(text->program, "a_position"),
+        psy_shader_program_attribute_location(text->program, "a_texcoord"),
+        psy_shader_program_attribute_location(text->program, "a_color")
+    };
+    psy_gl_disable_attributes(
+        locations, sizeof(locations) / sizeof(locations[0])
+        );
+}
+
+/* **** functions that implement PsyText or override SeeObject **** */
+
+static int
+text_init(
+    PsyText*            text,
+    const PsyTextClass* text_cls,
+    PsyFont*            font,
+    SeeError**          error
+    )
+{
+    int ret;
+    const SeeObjectClass* parent_cls = SEE_OBJECT_CLASS(text_cls);
+
+    parent_cls->object_init(
+        SEE_OBJECT(text),
+        SEE_OBJECT_CLASS(text_cls)
+        );
+
+    see_object_ref(SEE_OBJECT(font));
+    text->font = font;
+
+    ret = psy_shader_program_create_builtin(
+        &text->program,
+        "text",
+        "text",
+        error
+        );
+    if (ret)
+        return ret;
+
+    glGenBuffers(1, &text->vbo);
+
+    if (psy_gl_has_vertex_arrays()) {
+        glGenVertexArrays(1, &text->vao);
+        glBindVertexArray(text->vao);
+        glBindBuffer(GL_ARRAY_BUFFER, text->vbo);
+        set_attributes(text);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    return SEE_SUCCESS;
+}
+
+static int
+init(const SeeObjectClass* cls, SeeObject* obj, va_list args)
+{
+    const PsyTextClass* text_cls = PSY_TEXT_CLASS(cls);
+    PsyText* text = PSY_TEXT(obj);
+
+    PsyFont* font = va_arg(args, PsyFont*);
+    SeeError** error = va_arg(args, SeeError**);
+
+    return text_cls->text_init(text, text_cls, font, error);
+}
+
+static void
+destroy(SeeObject* obj)
+{
+    PsyText* text = PSY_TEXT(obj);
+
+    if (text->vao)
+        glDeleteVertexArrays(1, &text->vao);
+    if (text->vbo)
+        glDeleteBuffers(1, &text->vbo);
+
+    free(text->vertices);
+
+    if (text->program)
+        see_object_decref(SEE_OBJECT(text->program));
+    if (text->font)
+        see_object_decref(SEE_OBJECT(text->font));
+
+    see_object_class()->destroy(obj);
+}
+
+static int
+text_add(
+    PsyText*        text,
+    const char*     utf8,
+    GLfloat         x,
+    GLfloat         y,
+    GLfloat         size,
+    const GLfloat   color[4],
+    PsyTextAlign    align,
+    SeeError**      error
+    )
+{
+    const PsyTextLayout* layout = NULL;
+    size_t needed, i;
+    GLfloat scale, offset;
+    const GLfloat* src;
+    TextVertex* dest;
+    int ret;
+
+    ret = psy_font_layout(text->font, utf8, &layout, error);
+    if (ret)
+        return ret;
+
+    needed = text->num_vertices + layout->num_vertices;
+    if (needed > text->capacity) {
+        size_t new_capacity = text->capacity ? text->capacity : 6 * 64;
+        void* new_vertices;
+
+        while (new_capacity < needed)
+            new_capacity *= 2;
+
+        new_vertices = realloc(text->vertices, new_capacity * sizeof(TextVertex));
+        if (!new_vertices) {
+            set_out_of_memory(error, __func__);
+            return SEE_ERROR_RUNTIME;
+        }
+        text->vertices = new_vertices;
+        text->capacity = new_capacity;
+    }
+
+    scale = size / (GLfloat) psy_font_pixel_size(text->font);
+    switch (align) {
+        case PSY_TEXT_ALIGN_CENTER:
+            offset = -0.5f * layout->width;
+            break;
+        case PSY_TEXT_ALIGN_RIGHT:
+            offset = -layout->width;
+            break;
+        default:
+            offset = 0.0f;
+            break;
+    }
+
+    src = layout->vertices;
+    dest = (TextVertex*) text->vertices + text->num_vertices;
+    for (i = 0; i < layout->num_vertices; i++, src += 4, dest++) {
+        dest->position[0] = x + (src[0] + offset) * scale;
+        dest->position[1] = y + src[1] * scale;
+        dest->texcoord[0] = src[2];
+        dest->texcoord[1] = src[3];
+        memcpy(dest->color, color, sizeof(dest->color));
+    }
+    text->num_vertices = needed;
+
+    return SEE_SUCCESS;
+}
+
+static void
+text_clear(PsyText* text)
+{
+    text->num_vertices = 0;
+}
+
+static int
+text_draw(PsyText* text, const GLfloat* transform, SeeError** error)
+{
+    const PsyShaderProgram* program = text->program;
+    GLsizeiptr size = (GLsizeiptr) (text->num_vertices * sizeof(TextVertex));
+    GLboolean blend;
+    int ret;
+
+    if (text->num_vertices == 0)
+        return SEE_SUCCESS;
+
+    ret = psy_shader_use_program(program, error);
+    if (ret)
+        return ret;
+
+    glUniformMatrix4fv(
+        psy_shader_program_uniform_location(program, "u_transform"),
+        1,
+        GL_FALSE,
+        transform ? transform : g_identity
+        );
+    glUniform1i(psy_shader_program_uniform_location(program, "u_atlas"), 0);
+
+    psy_gl_bind_texture(0, GL_TEXTURE_2D, psy_font_atlas(text->font));
+
+    if (text->vao)
+        glBindVertexArray(text->vao);
+    glBindBuffer(GL_ARRAY_BUFFER, text->vbo);
+
+    // Orphan the buffer, so we don't wait for the previous draw.
+    if (size > text->vbo_size)
+        text->vbo_size = size;
+    glBufferData(GL_ARRAY_BUFFER, text->vbo_size, NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, text->vertices);
+    if (!text->vao)
+        set_attributes(text);
+
+    blend = glIsEnabled(GL_BLEND);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glDrawArrays(GL_TRIANGLES, 0, (GLsizei) text->num_vertices);
+
+    if (!blend)
+        glDisable(GL_BLEND);
+    if (text->vao)
+        glBindVertexArray(0);
+    else
+        disable_attributes(text);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return SEE_SUCCESS;
+}
+
+/* **** implementation of the public API **** */
+
+int
+psy_text_create(PsyText** text, PsyFont* font, SeeError** error)
+{
+    const PsyTextClass* cls = psy_text_class();
+    const SeeObjectClass* see_cls = SEE_OBJECT_CLASS(cls);
+
+    if (!cls)
+        return SEE_NOT_INITIALIZED;
+
+    if (!text || *text || !font)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return see_cls->new_obj(see_cls, 0, (SeeObject**) text, font, error);
+}
+
+int
+psy_text_add(
+    PsyText*        text,
+    const char*     utf8,
+    GLfloat         x,
+    GLfloat         y,
+    GLfloat         size,
+    const GLfloat   color[4],
+    PsyTextAlign    align,
+    SeeError**      error
+    )
+{
+    if (!text || !utf8 || !color || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+    if (align > PSY_TEXT_ALIGN_RIGHT)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_TEXT_GET_CLASS(text)->add(
+        text, utf8, x, y, size, color, align, error
+        );
+}
+
+void
+psy_text_clear(PsyText* text)
+{
+    if (!text)
+        return;
+
+    PSY_TEXT_GET_CLASS(text)->clear(text);
+}
+
+size_t
+psy_text_num_glyphs(const PsyText* text)
+{
+    return text ? text->num_vertices / 6 : 0;
+}
+
+int
+psy_text_draw(PsyText* text, const GLfloat* transform, SeeError** error)
+{
+    if (!text || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_TEXT_GET_CLASS(text)->draw(text, transform, error);
+}
+
+/* **** initialization of the class **** */
+
+PsyTextClass* g_PsyTextClass = NULL;
+
+static int psy_text_class_init(SeeObjectClass* new_cls) {
+    int ret = SEE_SUCCESS;
+
+    /* Override the functions on the parent here */
+    new_cls->init = init;
+    new_cls->name = "PsyText";
+    new_cls->destroy = destroy;
+
+    /* Set the function pointers of the own class here */
+    PsyTextClass* cls = (PsyTextClass*) new_cls;
+
+    cls->text_init  = text_init;
+    cls->add        = text_add;
+    cls->clear      = text_clear;
+    cls->draw       = text_draw;
+
+    return ret;
+}
+
+/**
+ * \private
+ * \brief this class initializes PsyText(Class).
+ *
+ * You might want to call this from the library initialization func.
+ */
+int
+psy_text_init() {
+    int ret;
+    const SeeMetaClass* meta = see_meta_class_class();
+
+    ret = see_meta_class_new_class(
+        meta,
+        (SeeObjectClass**) &g_PsyTextClass,
+        sizeof(PsyTextClass),
+        sizeof(PsyText),
+        see_object_class(),
+        sizeof(SeeObjectClass),
+        psy_text_class_init
+        );
+
+    return ret;
+}
+
+void
+psy_text_deinit()
+{
+    if(!g_PsyTextClass)
+        return;
+
+    see_object_decref((SeeObject*) g_PsyTextClass);
+    g_PsyTextClass = NULL;
+}
+
+const PsyTextClass*
+psy_text_class()
+{
+    return g_PsyTextClass;
+}
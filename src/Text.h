@@ -0,0 +1,212 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file Text.h
+ * \brief Draws strings with the distance field glyphs of a PsyFont.
+ *
+ * A PsyText collects strings, each with its own position, size, color and
+ * alignment, and draws all of them with one draw call. The layout of a
+ * string comes from the cache of the font, so replacing the word of a
+ * trial with psy_text_clear() and psy_text_add() copies a few quads and
+ * rasterizes nothing, unless the word contains a glyph that is new.
+ */
+
+#ifndef PSY_TEXT_H
+#define PSY_TEXT_H
+
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+
+#include "Font.h"
+#include "ShaderProgram.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _PsyText PsyText;
+typedef struct _PsyTextClass PsyTextClass;
+
+/**
+ * \brief How a string is aligned to its x-coordinate.
+ */
+typedef enum {
+    PSY_TEXT_ALIGN_LEFT,    ///< The string starts at x.
+    PSY_TEXT_ALIGN_CENTER,  ///< The string is centered on x.
+    PSY_TEXT_ALIGN_RIGHT    ///< The string ends at x.
+} PsyTextAlign;
+
+struct _PsyText {
+    SeeObject parent_obj;
+
+    /*expand PsyText data here*/
+
+    PsyFont*            font;
+    PsyShaderProgram*   program;
+    GLuint              vbo;
+    GLsizeiptr          vbo_size;
+    GLuint              vao;
+
+    void*               vertices;
+    size_t              num_vertices;
+    size_t              capacity;
+};
+
+struct _PsyTextClass {
+    SeeObjectClass parent_cls;
+
+    int (*text_init)(
+        PsyText*            text,
+        const PsyTextClass* text_cls,
+        PsyFont*            font,
+        SeeError**          error
+        );
+
+    int (*add)(
+        PsyText*        text,
+        const char*     utf8,
+        GLfloat         x,
+        GLfloat         y,
+        GLfloat         size,
+        const GLfloat   color[4],
+        PsyTextAlign    align,
+        SeeError**      error
+        );
+
+    void (*clear)(PsyText* text);
+
+    int (*draw)(
+        PsyText*        text,
+        const GLfloat*  transform,
+        SeeError**      error
+        );
+};
+
+/* **** function style macro casts **** */
+
+/**
+ * \brief cast a pointer from a PsyText derived instance back to a
+ *        pointer to PsyText.
+ */
+#define PSY_TEXT(obj)                      \
+    ((PsyText*) obj)
+
+/**
+ * \brief cast a pointer to PsyTextClass derived class back to a
+ *        pointer to PsyTextClass.
+ */
+#define PSY_TEXT_CLASS(cls)                      \
+    ((const PsyTextClass*) cls)
+
+/**
+ * \brief obtain a pointer to PsyTextClass from a instance of
+ *        derived from PsyText.
+ */
+#define PSY_TEXT_GET_CLASS(obj)                \
+    (PSY_TEXT_CLASS(see_object_get_class(SEE_OBJECT(obj)) ) )
+
+/* **** public functions **** */
+
+/**
+ * \brief Create an empty text that uses the glyphs of font.
+ *
+ * @param [out] text    The new text, should be NULL.
+ * @param [in]  font    The font, the text holds a reference to it.
+ * @param [out] error   If an error occurs, it's returned here.
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_text_create(PsyText** text, PsyFont* font, SeeError** error);
+
+/**
+ * \brief Add a string to the text.
+ *
+ * @param text
+ * @param utf8  The string, newlines start a new line.
+ * @param x     The x-coordinate the string is aligned to.
+ * @param y     The y-coordinate of the baseline of the first line.
+ * @param size  The size of the font, in the units that are mapped by the
+ *              transform of psy_text_draw().
+ * @param color RGBA in [0, 1].
+ * @param align
+ * @param error
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_text_add(
+    PsyText*        text,
+    const char*     utf8,
+    GLfloat         x,
+    GLfloat         y,
+    GLfloat         size,
+    const GLfloat   color[4],
+    PsyTextAlign    align,
+    SeeError**      error
+    );
+
+/**
+ * \brief Remove all strings.
+ */
+PSY_EXPORT void
+psy_text_clear(PsyText* text);
+
+/**
+ * \brief The number of glyphs that will be drawn.
+ */
+PSY_EXPORT size_t
+psy_text_num_glyphs(const PsyText* text);
+
+/**
+ * \brief Draw all strings with one draw call.
+ *
+ * The glyphs are blended on top of what has been drawn before, the blend
+ * state is restored afterwards. Texture unit 0 is used for the atlas.
+ *
+ * @param text
+ * @param transform A column major 4x4 matrix, or NULL for the identity.
+ * @param error
+ */
+PSY_EXPORT int
+psy_text_draw(PsyText* text, const GLfloat* transform, SeeError** error);
+
+/**
+ * Gets the pointer to the PsyTextClass table.
+ */
+PSY_EXPORT const PsyTextClass*
+psy_text_class();
+
+/* **** class initialization functions **** */
+
+/**
+ * Initialize PsyText; make it ready for use.
+ */
+PSY_EXPORT
+int psy_text_init();
+
+/**
+ * Deinitialize PsyText, after PsyText has been deinitialized,
+ * all functions in this header shouldn't be used anymore.
+ */
+PSY_EXPORT
+void psy_text_deinit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_TEXT_H
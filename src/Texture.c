@@ -0,0 +1,478 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "MetaClass.h"
+#include "Error.h"
+#include "ImageLoader.h"
+#include "Texture.h"
+#include "Time.h"
+#include "Trace.h"
+#include "gl/GLError.h"
+#include "gl/gl_util.h"
+
+static void
+set_glerror(SeeError** error, const char* func, const char* msg)
+{
+    PsyGLError* glerror = NULL;
+    psy_glerror_create(&glerror);
+    psy_error_printf(PSY_ERROR(glerror), "%s: %s", func, msg);
+    *error = SEE_ERROR(glerror);
+}
+
+static void
+release_upload(PsyTexture* texture)
+{
+    if (texture->fence) {
+        glDeleteSync(texture->fence);
+        texture->fence = NULL;
+    }
+    // The pixels live in the texture now, don't keep a second copy.
+    if (texture->pbo) {
+        glDeleteBuffers(1, &texture->pbo);
+        texture->pbo = 0;
+    }
+}
+
+/*
+ * Starts the upload of the pixels. With pixel buffers the pixels are copied
+ * to a buffer first, so glTexImage2D returns without waiting for the copy
+ * to the texture; a fence tells when it has finished.
+ */
+static int
+start_upload(
+    PsyTexture*     texture,
+    int             width,
+    int             height,
+    const void*     rgba,
+    SeeError**      error
+    )
+{
+    GLsizeiptr size = (GLsizeiptr) width * (GLsizeiptr) height * 4;
+
+    release_upload(texture);
+    texture->width  = width;
+    texture->height = height;
+
+    PSY_TRACE_BEGIN(trace);
+    // This may run from a draw function, so the state cache has to know.
+    psy_gl_bind_texture(0, GL_TEXTURE_2D, texture->texture_id);
+
+    if (psy_gl_has_pixel_buffers()) {
+        void* dest;
+
+        glGenBuffers(1, &texture->pbo);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, texture->pbo);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+        dest = glMapBufferRange(
+            GL_PIXEL_UNPACK_BUFFER,
+            0,
+            size,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT
+            );
+        if (!dest) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            psy_gl_bind_texture(0, GL_TEXTURE_2D, 0);
+            release_upload(texture);
+            texture->state = PSY_TEXTURE_FAILED;
+            set_glerror(error, __func__, "unable to map the pixel buffer");
+            return SEE_ERROR_RUNTIME;
+        }
+        memcpy(dest, rgba, (size_t) size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        glTexImage2D(
+            GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0,
+            GL_RGBA, GL_UNSIGNED_BYTE, (const void*) 0
+            );
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        texture->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        // Make sure the commands get to the GPU, otherwise we'd wait forever.
+        glFlush();
+        texture->state = PSY_TEXTURE_UPLOADING;
+    }
+    else {
+        glTexImage2D(
+            GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0,
+            GL_RGBA, GL_UNSIGNED_BYTE, rgba
+            );
+        texture->state = PSY_TEXTURE_READY;
+    }
+
+    psy_gl_bind_texture(0, GL_TEXTURE_2D, 0);
+    PSY_TRACE_END(trace, "psylib", "upload");
+    return SEE_SUCCESS;
+}
+
+/*
+ * Handles a finished decode job, the job is released afterwards.
+ */
+static int
+finish_decode(PsyTexture* texture, SeeError** error)
+{
+    const PsyImage* image = psy_image_job_result(texture->job);
+    int ret;
+
+    if (image->error) {
+        PsyError* err = NULL;
+        psy_error_create(&err);
+        psy_error_printf(err, "%s", image->error);
+        *error = SEE_ERROR(err);
+        texture->state = PSY_TEXTURE_FAILED;
+        ret = SEE_ERROR_RUNTIME;
+    }
+    else {
+        ret = start_upload(
+            texture, image->width, image->height, image->pixels, error
+            );
+    }
+
+    psy_image_job_release(texture->job);
+    texture->job = NULL;
+    return ret;
+}
+
+/* **** functions that implement PsyTexture or override SeeObject **** */
+
+static int
+texture_init(
+    PsyTexture*             texture,
+    const PsyTextureClass*  texture_cls,
+    SeeError**              error
+    )
+{
+    const SeeObjectClass* parent_cls = SEE_OBJECT_CLASS(texture_cls);
+    (void) error;
+
+    parent_cls->object_init(
+        SEE_OBJECT(texture),
+        SEE_OBJECT_CLASS(texture_cls)
+        );
+
+    texture->state = PSY_TEXTURE_EMPTY;
+
+    glGenTextures(1, &texture->texture_id);
+    psy_gl_bind_texture(0, GL_TEXTURE_2D, texture->texture_id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    psy_gl_bind_texture(0, GL_TEXTURE_2D, 0);
+
+    return SEE_SUCCESS;
+}
+
+static int
+init(const SeeObjectClass* cls, SeeObject* obj, va_list args)
+{
+    const PsyTextureClass* texture_cls = PSY_TEXTURE_CLASS(cls);
+    PsyTexture* texture = PSY_TEXTURE(obj);
+
+    SeeError** error = va_arg(args, SeeError**);
+
+    return texture_cls->texture_init(texture, texture_cls, error);
+}
+
+static void
+destroy(SeeObject* obj)
+{
+    PsyTexture* texture = PSY_TEXTURE(obj);
+
+    psy_image_job_release(texture->job);
+    release_upload(texture);
+    if (texture->texture_id)
+        glDeleteTextures(1, &texture->texture_id);
+
+    see_object_class()->destroy(obj);
+}
+
+static int
+texture_load_file(PsyTexture* texture, const char* path, SeeError** error)
+{
+    psy_image_job_release(texture->job);
+    texture->job = psy_image_loader_submit(path);
+    if (!texture->job) {
+        PsyError* err = NULL;
+        psy_error_create(&err);
+        psy_error_printf(err, "Unable to queue \"%s\" for decoding", path);
+        *error = SEE_ERROR(err);
+        texture->state = PSY_TEXTURE_FAILED;
+        return SEE_ERROR_RUNTIME;
+    }
+    texture->state = PSY_TEXTURE_DECODING;
+    return SEE_SUCCESS;
+}
+
+static int
+texture_set_pixels(
+    PsyTexture*     texture,
+    int             width,
+    int             height,
+    const void*     rgba,
+    SeeError**      error
+    )
+{
+    psy_image_job_release(texture->job);
+    texture->job = NULL;
+    return start_upload(texture, width, height, rgba, error);
+}
+
+static int
+texture_poll(PsyTexture* texture, SeeError** error)
+{
+    if (texture->state == PSY_TEXTURE_DECODING) {
+        if (!psy_image_job_done(texture->job))
+            return SEE_SUCCESS;
+        return finish_decode(texture, error);
+    }
+
+    if (texture->state == PSY_TEXTURE_UPLOADING) {
+        GLenum status = glClientWaitSync(texture->fence, 0, 0);
+        if (status == GL_ALREADY_SIGNALED ||
+            status == GL_CONDITION_SATISFIED) {
+            release_upload(texture);
+            texture->state = PSY_TEXTURE_READY;
+        }
+        else if (status == GL_WAIT_FAILED) {
+            release_upload(texture);
+            texture->state = PSY_TEXTURE_FAILED;
+            set_glerror(error, __func__, "waiting for the upload failed");
+            return SEE_ERROR_RUNTIME;
+        }
+    }
+
+    return SEE_SUCCESS;
+}
+
+static int
+texture_bind(const PsyTexture* texture, GLuint unit)
+{
+    if (texture->state != PSY_TEXTURE_READY &&
+        texture->state != PSY_TEXTURE_UPLOADING)
+        return SEE_ERROR_RUNTIME;
+
+    psy_gl_bind_texture(unit, GL_TEXTURE_2D, texture->texture_id);
+    return SEE_SUCCESS;
+}
+
+/* **** implementation of the public API **** */
+
+int
+psy_texture_create(PsyTexture** texture, SeeError** error)
+{
+    const PsyTextureClass* cls = psy_texture_class();
+    const SeeObjectClass* see_cls = SEE_OBJECT_CLASS(cls);
+
+    if (!cls)
+        return SEE_NOT_INITIALIZED;
+
+    if (!texture || *texture)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return see_cls->new_obj(see_cls, 0, (SeeObject**) texture, error);
+}
+
+int
+psy_texture_load_file(PsyTexture* texture, const char* path, SeeError** error)
+{
+    if (!texture || !path || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_TEXTURE_GET_CLASS(texture)->load_file(texture, path, error);
+}
+
+int
+psy_texture_set_pixels(
+    PsyTexture*     texture,
+    int             width,
+    int             height,
+    const void*     rgba,
+    SeeError**      error
+    )
+{
+    if (!texture || !rgba || width <= 0 || height <= 0)
+        return SEE_INVALID_ARGUMENT;
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_TEXTURE_GET_CLASS(texture)->set_pixels(
+        texture, width, height, rgba, error
+        );
+}
+
+int
+psy_texture_poll(PsyTexture* texture, SeeError** error)
+{
+    if (!texture || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_TEXTURE_GET_CLASS(texture)->poll(texture, error);
+}
+
+int
+psy_texture_wait(PsyTexture* texture, double timeout, SeeError** error)
+{
+    const PsyTextureClass* cls;
+    PsyTime start = psy_time_now();
+
+    if (!texture || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    cls = PSY_TEXTURE_GET_CLASS(texture);
+
+    for (;;) {
+        double remaining = timeout - psy_time_seconds(psy_time_now() - start);
+        int ret = cls->poll(texture, error);
+
+        if (ret)
+            return ret;
+
+        switch (texture->state) {
+            case PSY_TEXTURE_READY:
+                return SEE_SUCCESS;
+            case PSY_TEXTURE_EMPTY:
+                set_glerror(error, __func__, "the texture has nothing to load");
+                return SEE_ERROR_RUNTIME;
+            case PSY_TEXTURE_FAILED:
+                set_glerror(error, __func__, "loading the texture failed");
+                return SEE_ERROR_RUNTIME;
+            default:
+                break;
+        }
+
+        if (remaining <= 0.0) {
+            set_glerror(error, __func__, "timed out");
+            return SEE_ERROR_RUNTIME;
+        }
+
+        if (texture->state == PSY_TEXTURE_DECODING) {
+            psy_image_job_wait(texture->job, (unsigned) (remaining * 1000.0) + 1);
+        }
+        else {
+            glClientWaitSync(
+                texture->fence,
+                GL_SYNC_FLUSH_COMMANDS_BIT,
+                (GLuint64) (remaining * 1e9)
+                );
+        }
+    }
+}
+
+PsyTextureState
+psy_texture_state(const PsyTexture* texture)
+{
+    return texture ? texture->state : PSY_TEXTURE_EMPTY;
+}
+
+int
+psy_texture_ready(const PsyTexture* texture)
+{
+    return texture && texture->state == PSY_TEXTURE_READY;
+}
+
+void
+psy_texture_size(const PsyTexture* texture, int* width, int* height)
+{
+    if (width)
+        *width = texture ? texture->width : 0;
+    if (height)
+        *height = texture ? texture->height : 0;
+}
+
+GLuint
+psy_texture_id(const PsyTexture* texture)
+{
+    return texture ? texture->texture_id : 0;
+}
+
+int
+psy_texture_bind(const PsyTexture* texture, GLuint unit)
+{
+    if (!texture)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_TEXTURE_GET_CLASS(texture)->bind(texture, unit);
+}
+
+/* **** initialization of the class **** */
+
+PsyTextureClass* g_PsyTextureClass = NULL;
+
+static int psy_texture_class_init(SeeObjectClass* new_cls) {
+    int ret = SEE_SUCCESS;
+
+    /* Override the functions on the parent here */
+    new_cls->init = init;
+    new_cls->name = "PsyTexture";
+    new_cls->destroy = destroy;
+
+    /* Set the function pointers of the own class here */
+    PsyTextureClass* cls = (PsyTextureClass*) new_cls;
+
+    cls->texture_init   = texture_init;
+    cls->load_file      = texture_load_file;
+    cls->set_pixels     = texture_set_pixels;
+    cls->poll           = texture_poll;
+    cls->bind           = texture_bind;
+
+    return ret;
+}
+
+/**
+ * \private
+ * \brief this class initializes PsyTexture(Class).
+ *
+ * You might want to call this from the library initialization func.
+ */
+int
+psy_texture_init() {
+    int ret;
+    const SeeMetaClass* meta = see_meta_class_class();
+
+    ret = see_meta_class_new_class(
+        meta,
+        (SeeObjectClass**) &g_PsyTextureClass,
+        sizeof(PsyTextureClass),
+        sizeof(PsyTexture),
+        see_object_class(),
+        sizeof(SeeObjectClass),
+        psy_texture_class_init
+        );
+
+    return ret;
+}
+
+void
+psy_texture_deinit()
+{
+    if(!g_PsyTextureClass)
+        return;
+
+    see_object_decref((SeeObject*) g_PsyTextureClass);
+    g_PsyTextureClass = NULL;
+}
+
+const PsyTextureClass*
+psy_texture_class()
+{
+    return g_PsyTextureClass;
+}
@@ -0,0 +1,257 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file Texture.h
+ * \brief Textures that are decoded and uploaded in the background.
+ *
+ * psy_texture_load_file() hands the file to a worker thread that decodes
+ * it, so it returns immediately. Once decoded, psy_texture_poll() copies
+ * the pixels into a pixel unpack buffer and starts the upload from that
+ * buffer, which lets the driver copy the pixels asynchronously. A fence
+ * tells when the upload has finished. Call psy_texture_poll() once per
+ * frame for textures that are loading, or psy_texture_wait() before the
+ * timed part of a trial to make sure the texture is resident.
+ *
+ * On OpenGL ES 2.0 there are no pixel buffers or fences, so there the
+ * pixels are uploaded directly by psy_texture_poll(), decoding still
+ * happens in the background.
+ */
+
+#ifndef PSY_TEXTURE_H
+#define PSY_TEXTURE_H
+
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+
+#include "psy_export.h"
+#include "gl/includes_gl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _PsyTexture PsyTexture;
+typedef struct _PsyTextureClass PsyTextureClass;
+
+/**
+ * \brief The state of a texture.
+ */
+typedef enum {
+    PSY_TEXTURE_EMPTY,      ///< Nothing has been loaded.
+    PSY_TEXTURE_DECODING,   ///< The image is decoded in the background.
+    PSY_TEXTURE_UPLOADING,  ///< The pixels are being uploaded to the GPU.
+    PSY_TEXTURE_READY,      ///< The texture can be drawn without stalling.
+    PSY_TEXTURE_FAILED      ///< Loading or decoding failed.
+} PsyTextureState;
+
+struct _PsyTexture {
+    SeeObject parent_obj;
+
+    /*expand PsyTexture data here*/
+
+    GLuint              texture_id;
+    GLuint              pbo;
+    GLsync              fence;
+    int                 width;
+    int                 height;
+    PsyTextureState     state;
+    struct _PsyImageJob* job;
+};
+
+struct _PsyTextureClass {
+    SeeObjectClass parent_cls;
+
+    int (*texture_init)(
+        PsyTexture*             texture,
+        const PsyTextureClass*  texture_cls,
+        SeeError**              error
+        );
+
+    int (*load_file)(PsyTexture* texture, const char* path, SeeError** error);
+
+    int (*set_pixels)(
+        PsyTexture*     texture,
+        int             width,
+        int             height,
+        const void*     rgba,
+        SeeError**      error
+        );
+
+    int (*poll)(PsyTexture* texture, SeeError** error);
+
+    int (*bind)(const PsyTexture* texture, GLuint unit);
+};
+
+/* **** function style macro casts **** */
+
+/**
+ * \brief cast a pointer from a PsyTexture derived instance back to a
+ *        pointer to PsyTexture.
+ */
+#define PSY_TEXTURE(obj)                      \
+    ((PsyTexture*) obj)
+
+/**
+ * \brief cast a pointer to PsyTextureClass derived class back to a
+ *        pointer to PsyTextureClass.
+ */
+#define PSY_TEXTURE_CLASS(cls)                      \
+    ((const PsyTextureClass*) cls)
+
+/**
+ * \brief obtain a pointer to PsyTextureClass from a instance of
+ *        derived from PsyTexture.
+ */
+#define PSY_TEXTURE_GET_CLASS(obj)                \
+    (PSY_TEXTURE_CLASS(see_object_get_class(SEE_OBJECT(obj)) )  )
+
+/* **** public functions **** */
+
+/**
+ * \brief Create an empty texture.
+ *
+ * This needs a current OpenGL context, e.g. create a PsyWindow first.
+ *
+ * @param [out] texture The new texture, *texture should be NULL.
+ * @param [out] error   If an error occurs it will be returned here.
+ */
+PSY_EXPORT int
+psy_texture_create(PsyTexture** texture, SeeError** error);
+
+/**
+ * \brief Start loading the image at path in the background.
+ *
+ * A load that is in progress is abandoned.
+ *
+ * @param [in]  texture
+ * @param [in]  path    The file to load, without SDL_image only .bmp
+ *                      files are supported.
+ * @param [out] error   If an error occurs it will be returned here.
+ *
+ * @return SEE_SUCCESS when the image is queued for decoding.
+ */
+PSY_EXPORT int
+psy_texture_load_file(PsyTexture* texture, const char* path, SeeError** error);
+
+/**
+ * \brief Upload pixels that are already in memory.
+ *
+ * The pixels are copied to a pixel buffer, so they may be freed once this
+ * function returns. The texture is ready once psy_texture_poll() says so.
+ *
+ * @param [in]  texture
+ * @param [in]  width
+ * @param [in]  height
+ * @param [in]  rgba    width * height RGBA pixels, bottom row first.
+ * @param [out] error   If an error occurs it will be returned here.
+ */
+PSY_EXPORT int
+psy_texture_set_pixels(
+    PsyTexture*     texture,
+    int             width,
+    int             height,
+    const void*     rgba,
+    SeeError**      error
+    );
+
+/**
+ * \brief Advance loading the texture, this doesn't block.
+ *
+ * When the image is decoded, the upload is started, when the upload has
+ * finished the texture becomes ready.
+ *
+ * @param [in]  texture
+ * @param [out] error   When decoding failed the reason is returned here.
+ *
+ * @return SEE_SUCCESS, or SEE_ERROR_RUNTIME when loading failed.
+ */
+PSY_EXPORT int
+psy_texture_poll(PsyTexture* texture, SeeError** error);
+
+/**
+ * \brief Block until the texture is ready or timeout seconds have passed.
+ *
+ * @param [in]  texture
+ * @param [in]  timeout The maximum time to wait in seconds.
+ * @param [out] error   If loading failed or times out the reason is
+ *                      returned here.
+ *
+ * @return SEE_SUCCESS when the texture is ready.
+ */
+PSY_EXPORT int
+psy_texture_wait(PsyTexture* texture, double timeout, SeeError** error);
+
+/**
+ * \brief Returns the state of the texture, as of the last poll.
+ */
+PSY_EXPORT PsyTextureState
+psy_texture_state(const PsyTexture* texture);
+
+/**
+ * \brief Returns non zero when the texture can be drawn without stalling.
+ */
+PSY_EXPORT int
+psy_texture_ready(const PsyTexture* texture);
+
+/**
+ * \brief Obtain the size of the texture, this is known once it is uploading.
+ */
+PSY_EXPORT void
+psy_texture_size(const PsyTexture* texture, int* width, int* height);
+
+/**
+ * \brief Returns the OpenGL name of the texture.
+ */
+PSY_EXPORT GLuint
+psy_texture_id(const PsyTexture* texture);
+
+/**
+ * \brief Bind the texture to texture unit GL_TEXTURE0 + unit.
+ *
+ * @return SEE_SUCCESS, or SEE_ERROR_RUNTIME when the texture has no
+ *         pixels yet.
+ */
+PSY_EXPORT int
+psy_texture_bind(const PsyTexture* texture, GLuint unit);
+
+/**
+ * Gets the pointer to the PsyTextureClass table.
+ */
+PSY_EXPORT const PsyTextureClass*
+psy_texture_class();
+
+/* **** class initialization functions **** */
+
+/**
+ * Initialize PsyTexture; make it ready for use.
+ */
+PSY_EXPORT
+int psy_texture_init();
+
+/**
+ * Deinitialize PsyTexture, after PsyTexture has been deinitialized,
+ * all functions in this header shouldn't be used anymore.
+ */
+PSY_EXPORT
+void psy_texture_deinit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_TEXTURE_H
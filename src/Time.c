@@ -0,0 +1,220 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file Time.c
+ * \brief Implements the clock of psylib and waiting for it.
+ */
+
+#include "psy_config.h"
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <SDL2/SDL.h>
+
+#if defined(HAVE_SCHED_H)
+#include <sched.h>
+#endif
+
+#include "Time.h"
+#include "Trace.h"
+
+// The bounds of the adaptive margin and what's added to the sleep overshoot.
+#define MIN_MARGIN      (100 * PSY_TIME_NS_PER_US)
+#define MAX_MARGIN      (10 * PSY_TIME_NS_PER_MS)
+#define MARGIN_SLACK    (200 * PSY_TIME_NS_PER_US)
+
+static PsyTime      g_margin        = 2 * PSY_TIME_NS_PER_MS;
+static int          g_adaptive      = 1;
+static PsyTime      g_sleep_peak    = 0;
+static PsyWaitStats g_stats;
+
+#if defined(HAVE_CLOCK_GETTIME)
+
+// CLOCK_MONOTONIC_RAW isn't adjusted by NTP, older systems lack it.
+#if defined(CLOCK_MONOTONIC_RAW)
+#define PSY_CLOCK CLOCK_MONOTONIC_RAW
+#else
+#define PSY_CLOCK CLOCK_MONOTONIC
+#endif
+
+PsyTime
+psy_time_now(void)
+{
+    struct timespec ts;
+    clock_gettime(PSY_CLOCK, &ts);
+    return (PsyTime) ts.tv_sec * PSY_TIME_NS_PER_S + (PsyTime) ts.tv_nsec;
+}
+
+PsyTime
+psy_time_resolution(void)
+{
+    struct timespec ts;
+    if (clock_getres(PSY_CLOCK, &ts) != 0)
+        return 1;
+    return (PsyTime) ts.tv_sec * PSY_TIME_NS_PER_S + (PsyTime) ts.tv_nsec;
+}
+
+#else
+
+PsyTime
+psy_time_now(void)
+{
+    static Uint64 freq = 0;
+    Uint64 counter = SDL_GetPerformanceCounter();
+
+    if (!freq)
+        freq = SDL_GetPerformanceFrequency();
+
+    // Split in seconds and the rest, so counter * 1e9 can't overflow.
+    return (PsyTime) (counter / freq) * PSY_TIME_NS_PER_S +
+           (PsyTime) ((counter % freq) * (Uint64) PSY_TIME_NS_PER_S / freq);
+}
+
+PsyTime
+psy_time_resolution(void)
+{
+    Uint64 freq = SDL_GetPerformanceFrequency();
+    PsyTime res = (PsyTime) (PSY_TIME_NS_PER_S / (PsyTime) freq);
+    return res > 0 ? res : 1;
+}
+
+#endif
+
+double
+psy_time_seconds(PsyTime t)
+{
+    return (double) t / (double) PSY_TIME_NS_PER_S;
+}
+
+PsyTime
+psy_time_from_seconds(double seconds)
+{
+    return (PsyTime) (seconds * (double) PSY_TIME_NS_PER_S);
+}
+
+/* Sleep for duration, a bit longer is fine, shorter isn't. */
+static void
+sleep_for(PsyTime duration)
+{
+#if defined(HAVE_CLOCK_NANOSLEEP)
+    struct timespec ts;
+
+    // An absolute deadline isn't moved by signals that interrupt the sleep.
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    duration += (PsyTime) ts.tv_nsec;
+    ts.tv_sec += (time_t) (duration / PSY_TIME_NS_PER_S);
+    ts.tv_nsec = (long) (duration % PSY_TIME_NS_PER_S);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+#else
+    SDL_Delay((Uint32) ((duration + PSY_TIME_NS_PER_MS - 1) / PSY_TIME_NS_PER_MS));
+#endif
+}
+
+static void
+yield(void)
+{
+#if defined(HAVE_SCHED_H)
+    sched_yield();
+#endif
+}
+
+/* The margin follows a peak of the sleep overshoot that decays slowly. */
+static void
+adapt_margin(PsyTime sleep_overshoot)
+{
+    PsyTime decayed = g_sleep_peak - g_sleep_peak / 16;
+
+    g_sleep_peak = sleep_overshoot > decayed ? sleep_overshoot : decayed;
+    g_margin = g_sleep_peak + MARGIN_SLACK;
+    if (g_margin < MIN_MARGIN)
+        g_margin = MIN_MARGIN;
+    else if (g_margin > MAX_MARGIN)
+        g_margin = MAX_MARGIN;
+}
+
+PsyTime
+psy_wait_until(PsyTime deadline)
+{
+    PsyTime now = psy_time_now();
+    PsyTime wake = deadline - g_margin;
+    PsyTime overshoot;
+    PSY_TRACE_BEGIN(trace);
+
+    if (wake > now) {
+        PsyTime sleep_overshoot;
+
+        sleep_for(wake - now);
+        now = psy_time_now();
+        sleep_overshoot = now - wake;
+        if (sleep_overshoot > g_stats.max_sleep_overshoot)
+            g_stats.max_sleep_overshoot = sleep_overshoot;
+        if (g_adaptive)
+            adapt_margin(sleep_overshoot);
+    }
+
+    while (now < deadline) {
+        yield();
+        now = psy_time_now();
+    }
+
+    PSY_TRACE_END(trace, "psylib", "wait");
+
+    overshoot = now - deadline;
+    g_stats.count++;
+    g_stats.last_overshoot = overshoot;
+    g_stats.total_overshoot += overshoot;
+    if (overshoot > g_stats.max_overshoot)
+        g_stats.max_overshoot = overshoot;
+
+    return overshoot;
+}
+
+PsyTime
+psy_wait_for(PsyTime duration)
+{
+    return psy_wait_until(psy_time_now() + duration);
+}
+
+void
+psy_wait_set_margin(PsyTime margin, int adaptive)
+{
+    g_margin = margin > 0 ? margin : 0;
+    g_adaptive = adaptive;
+    g_sleep_peak = 0;
+}
+
+PsyTime
+psy_wait_margin(void)
+{
+    return g_margin;
+}
+
+void
+psy_wait_stats(PsyWaitStats* stats)
+{
+    if (stats)
+        *stats = g_stats;
+}
+
+void
+psy_wait_reset_stats(void)
+{
+    memset(&g_stats, 0, sizeof(g_stats));
+}
@@ -0,0 +1,148 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file Time.h
+ * \brief The clock that all timestamps of psylib are taken from.
+ *
+ * psy_time_now() returns the time in nanoseconds since an arbitrary, but
+ * fixed, moment. On Linux this is CLOCK_MONOTONIC_RAW, which isn't slewed
+ * by NTP, so intervals measured with it are as long as the hardware says.
+ * Elsewhere the high resolution counter of SDL is used. The swaps of a
+ * PsyWindow and everything else psylib timestamps use this clock, so times
+ * can be subtracted from each other without conversion.
+ *
+ * psy_wait_until() waits for a moment on this clock. It sleeps until a
+ * margin before the deadline and spins, yielding the CPU, for the rest. A
+ * sleep alone wakes up too late, up to a millisecond on a busy machine,
+ * spinning alone keeps a core busy that the rendering thread may need. The
+ * margin adapts to how late the sleeps of this machine wake up.
+ */
+
+#ifndef PSY_TIME_H
+#define PSY_TIME_H
+
+#include <stdint.h>
+#include "psy_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief A moment or a duration in nanoseconds.
+ */
+typedef int64_t PsyTime;
+
+#define PSY_TIME_NS_PER_US  ((PsyTime) 1000)
+#define PSY_TIME_NS_PER_MS  ((PsyTime) 1000000)
+#define PSY_TIME_NS_PER_S   ((PsyTime) 1000000000)
+
+/**
+ * \brief Returns the current time in nanoseconds.
+ *
+ * The time is monotonic: it never runs backwards and isn't affected by
+ * changes of the wall clock.
+ */
+PSY_EXPORT PsyTime
+psy_time_now(void);
+
+/**
+ * \brief Returns the resolution of psy_time_now() in nanoseconds.
+ */
+PSY_EXPORT PsyTime
+psy_time_resolution(void);
+
+/**
+ * \brief Convert a time or duration to seconds.
+ */
+PSY_EXPORT double
+psy_time_seconds(PsyTime t);
+
+/**
+ * \brief Convert seconds to a duration.
+ */
+PSY_EXPORT PsyTime
+psy_time_from_seconds(double seconds);
+
+/**
+ * \brief Statistics of the waits since psy_wait_reset_stats().
+ */
+typedef struct {
+    uint64_t    count;              ///< The number of waits.
+    PsyTime     last_overshoot;     ///< How late the last wait returned.
+    PsyTime     max_overshoot;      ///< The most late a wait returned.
+    PsyTime     total_overshoot;    ///< The sum, divide by count for the mean.
+    PsyTime     max_sleep_overshoot;    ///< The most late a sleep woke up.
+} PsyWaitStats;
+
+/**
+ * \brief Wait until psy_time_now() >= deadline.
+ *
+ * @param [in] deadline A time obtained from psy_time_now().
+ *
+ * @return How late the function returns, the time between the deadline and
+ *         the moment the wait was finished. When the deadline has already
+ *         passed, it returns immediately.
+ */
+PSY_EXPORT PsyTime
+psy_wait_until(PsyTime deadline);
+
+/**
+ * \brief Wait for duration nanoseconds, see psy_wait_until().
+ */
+PSY_EXPORT PsyTime
+psy_wait_for(PsyTime duration);
+
+/**
+ * \brief Set the part before a deadline that is spun instead of slept.
+ *
+ * @param [in] margin   The initial margin, 2 ms by default. A margin of 0
+ *                      with adaptive 0 only sleeps.
+ * @param [in] adaptive When non zero (the default) the margin follows how
+ *                      late the sleeps wake up, it's never less than the
+ *                      latest sleep overshoot plus a bit.
+ */
+PSY_EXPORT void
+psy_wait_set_margin(PsyTime margin, int adaptive);
+
+/**
+ * \brief Returns the current margin in nanoseconds.
+ */
+PSY_EXPORT PsyTime
+psy_wait_margin(void);
+
+/**
+ * \brief Obtain the statistics of the waits.
+ *
+ * The statistics and the margin are shared by the whole process; waiting
+ * from more than one thread at a time makes them approximate.
+ */
+PSY_EXPORT void
+psy_wait_stats(PsyWaitStats* stats);
+
+/**
+ * \brief Clear the statistics, e.g. at the start of a trial.
+ */
+PSY_EXPORT void
+psy_wait_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_TIME_H
@@ -0,0 +1,494 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "MetaClass.h"
+#include "Error.h"
+#include "Timeline.h"
+
+#define DEFAULT_FRAME_DURATION (PSY_TIME_NS_PER_S / 60)
+
+static void
+set_error(SeeError** error, const char* func, const char* msg)
+{
+    PsyError* err = NULL;
+    psy_error_create(&err);
+    psy_error_printf(err, "%s: %s", func, msg);
+    *error = SEE_ERROR(err);
+}
+
+static int
+grow(PsyTimeline* timeline)
+{
+    size_t capacity = timeline->capacity ? timeline->capacity * 2 : 16;
+    PsyTimelineEvent* events;
+    size_t* order;
+
+    events = realloc(timeline->events, capacity * sizeof(PsyTimelineEvent));
+    if (!events)
+        return SEE_ERROR_RUNTIME;
+    timeline->events = events;
+
+    order = realloc(timeline->order, capacity * sizeof(size_t));
+    if (!order)
+        return SEE_ERROR_RUNTIME;
+    timeline->order = order;
+
+    timeline->capacity = capacity;
+    return SEE_SUCCESS;
+}
+
+/*
+ * The position in order after the pending events with frame or an earlier
+ * frame, so events on the same frame run in the order they were added.
+ */
+static size_t
+insert_position(const PsyTimeline* timeline, int64_t frame)
+{
+    size_t low = timeline->next, high = timeline->num_events;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (timeline->events[timeline->order[mid]].planned_frame <= frame)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+static int64_t
+current_frame(const PsyTimeline* timeline)
+{
+    return (int64_t) (psy_window_swap_count(timeline->window) -
+                      timeline->start_count);
+}
+
+/* **** functions that implement PsyTimeline or override SeeObject **** */
+
+static int
+timeline_init(
+    PsyTimeline*            timeline,
+    const PsyTimelineClass* timeline_cls,
+    PsyWindow*              window,
+    SeeError**              error
+    )
+{
+    const SeeObjectClass* parent_cls = SEE_OBJECT_CLASS(timeline_cls);
+    (void) error;
+
+    parent_cls->object_init(
+        SEE_OBJECT(timeline),
+        SEE_OBJECT_CLASS(timeline_cls)
+        );
+
+    see_object_ref(SEE_OBJECT(window));
+    timeline->window = window;
+    timeline->frame_duration = psy_window_frame_duration(window);
+    if (timeline->frame_duration <= 0)
+        timeline->frame_duration = DEFAULT_FRAME_DURATION;
+
+    return SEE_SUCCESS;
+}
+
+static int
+init(const SeeObjectClass* cls, SeeObject* obj, va_list args)
+{
+    const PsyTimelineClass* timeline_cls = PSY_TIMELINE_CLASS(cls);
+    PsyTimeline* timeline = PSY_TIMELINE(obj);
+
+    PsyWindow* window = va_arg(args, PsyWindow*);
+    SeeError** error = va_arg(args, SeeError**);
+
+    return timeline_cls->timeline_init(timeline, timeline_cls, window, error);
+}
+
+static void
+destroy(SeeObject* obj)
+{
+    PsyTimeline* timeline = PSY_TIMELINE(obj);
+
+    psy_timeline_clear(timeline);
+    free(timeline->events);
+    free(timeline->order);
+    if (timeline->window)
+        see_object_decref(SEE_OBJECT(timeline->window));
+
+    see_object_class()->destroy(obj);
+}
+
+static int
+timeline_add(
+    PsyTimeline*    timeline,
+    int64_t         frame,
+    PsyTime         time,
+    const char*     name,
+    PsyTimelineFunc func,
+    void*           data,
+    size_t*         id,
+    SeeError**      error
+    )
+{
+    PsyTimelineEvent* event;
+    size_t pos;
+
+    if (timeline->num_events == timeline->capacity) {
+        if (grow(timeline)) {
+            set_error(error, __func__, "out of memory");
+            return SEE_ERROR_RUNTIME;
+        }
+    }
+
+    event = &timeline->events[timeline->num_events];
+    memset(event, 0, sizeof(*event));
+    if (name) {
+        size_t size = strlen(name) + 1;
+        event->name = malloc(size);
+        if (!event->name) {
+            set_error(error, __func__, "out of memory");
+            return SEE_ERROR_RUNTIME;
+        }
+        memcpy(event->name, name, size);
+    }
+    event->func = func;
+    event->data = data;
+    event->state = PSY_TIMELINE_PENDING;
+    event->planned_frame = frame;
+    event->planned_time = time;
+    event->achieved_frame = -1;
+
+    pos = insert_position(timeline, frame);
+    memmove(
+        &timeline->order[pos + 1],
+        &timeline->order[pos],
+        (timeline->num_events - pos) * sizeof(size_t)
+        );
+    timeline->order[pos] = timeline->num_events;
+
+    if (id)
+        *id = timeline->num_events;
+    timeline->num_events++;
+
+    return SEE_SUCCESS;
+}
+
+static void
+timeline_start(PsyTimeline* timeline)
+{
+    size_t i;
+
+    for (i = 0; i < timeline->num_events; i++) {
+        timeline->events[i].state = PSY_TIMELINE_PENDING;
+        timeline->events[i].achieved_frame = -1;
+        timeline->events[i].achieved_time = 0;
+    }
+    timeline->resolved = 0;
+    timeline->next = 0;
+    timeline->start_count = psy_window_swap_count(timeline->window);
+    timeline->origin = 0;
+    timeline->has_origin = 0;
+    timeline->running = 1;
+}
+
+static void
+timeline_update(PsyTimeline* timeline)
+{
+    int64_t frame;
+    PsyTime swap_time;
+
+    if (!timeline->running)
+        return;
+
+    frame = current_frame(timeline);
+
+    // Log the events whose frame has been presented.
+    if (frame > 0) {
+        swap_time = psy_window_swap_time(timeline->window);
+        if (!timeline->has_origin) {
+            timeline->origin = swap_time - (frame - 1) * timeline->frame_duration;
+            timeline->has_origin = 1;
+        }
+        while (timeline->resolved < timeline->next) {
+            PsyTimelineEvent* event =
+                &timeline->events[timeline->order[timeline->resolved]];
+            if (event->achieved_frame >= frame)
+                break;
+            // Estimated when more than one frame passed since the update.
+            event->achieved_time = swap_time - timeline->origin -
+                (frame - 1 - event->achieved_frame) * timeline->frame_duration;
+            event->state = PSY_TIMELINE_PRESENTED;
+            timeline->resolved++;
+        }
+    }
+
+    // Run the events that are due, the callbacks may add events.
+    while (timeline->next < timeline->num_events) {
+        size_t index = timeline->order[timeline->next];
+        PsyTimelineEvent* event = &timeline->events[index];
+
+        if (event->planned_frame > frame)
+            break;
+
+        event->state = PSY_TIMELINE_FIRED;
+        event->achieved_frame = frame;
+        timeline->next++;
+        if (event->func)
+            event->func(timeline, index, event->data);
+    }
+}
+
+/* **** implementation of the public API **** */
+
+int
+psy_timeline_create(
+    PsyTimeline**   timeline,
+    PsyWindow*      window,
+    SeeError**      error
+    )
+{
+    const PsyTimelineClass* cls = psy_timeline_class();
+    const SeeObjectClass* see_cls = SEE_OBJECT_CLASS(cls);
+
+    if (!cls)
+        return SEE_NOT_INITIALIZED;
+
+    if (!timeline || *timeline || !window)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return see_cls->new_obj(see_cls, 0, (SeeObject**) timeline, window, error);
+}
+
+int
+psy_timeline_add_frames(
+    PsyTimeline*    timeline,
+    int64_t         frame,
+    const char*     name,
+    PsyTimelineFunc func,
+    void*           data,
+    size_t*         id,
+    SeeError**      error
+    )
+{
+    if (!timeline || frame < 0 || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_TIMELINE_GET_CLASS(timeline)->add(
+        timeline,
+        frame,
+        frame * timeline->frame_duration,
+        name,
+        func,
+        data,
+        id,
+        error
+        );
+}
+
+int
+psy_timeline_add_ms(
+    PsyTimeline*    timeline,
+    double          ms,
+    const char*     name,
+    PsyTimelineFunc func,
+    void*           data,
+    size_t*         id,
+    SeeError**      error
+    )
+{
+    PsyTime time;
+    int64_t frame;
+
+    if (!timeline || !(ms >= 0.0) || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    time = psy_time_from_seconds(ms / 1000.0);
+    frame = (time + timeline->frame_duration / 2) / timeline->frame_duration;
+
+    return PSY_TIMELINE_GET_CLASS(timeline)->add(
+        timeline, frame, time, name, func, data, id, error
+        );
+}
+
+void
+psy_timeline_clear(PsyTimeline* timeline)
+{
+    size_t i;
+
+    if (!timeline)
+        return;
+    for (i = 0; i < timeline->num_events; i++)
+        free(timeline->events[i].name);
+    timeline->num_events = 0;
+    timeline->resolved = 0;
+    timeline->next = 0;
+    timeline->running = 0;
+}
+
+int
+psy_timeline_start(PsyTimeline* timeline)
+{
+    if (!timeline)
+        return SEE_INVALID_ARGUMENT;
+
+    PSY_TIMELINE_GET_CLASS(timeline)->start(timeline);
+    return SEE_SUCCESS;
+}
+
+int
+psy_timeline_update(PsyTimeline* timeline)
+{
+    if (!timeline)
+        return SEE_INVALID_ARGUMENT;
+
+    PSY_TIMELINE_GET_CLASS(timeline)->update(timeline);
+    return SEE_SUCCESS;
+}
+
+int
+psy_timeline_done(const PsyTimeline* timeline)
+{
+    if (!timeline || !timeline->running)
+        return 0;
+    return timeline->resolved == timeline->num_events;
+}
+
+int64_t
+psy_timeline_frame(const PsyTimeline* timeline)
+{
+    if (!timeline || !timeline->running)
+        return 0;
+    return current_frame(timeline);
+}
+
+void
+psy_timeline_set_frame_duration(PsyTimeline* timeline, PsyTime duration)
+{
+    if (timeline && duration > 0)
+        timeline->frame_duration = duration;
+}
+
+PsyTime
+psy_timeline_origin(const PsyTimeline* timeline)
+{
+    return timeline && timeline->has_origin ? timeline->origin : 0;
+}
+
+size_t
+psy_timeline_num_events(const PsyTimeline* timeline)
+{
+    return timeline ? timeline->num_events : 0;
+}
+
+const PsyTimelineEvent*
+psy_timeline_event(const PsyTimeline* timeline, size_t id)
+{
+    if (!timeline || id >= timeline->num_events)
+        return NULL;
+    return &timeline->events[id];
+}
+
+void
+psy_timeline_print_log(const PsyTimeline* timeline, FILE* out)
+{
+    size_t i;
+
+    if (!timeline || !out)
+        return;
+
+    fprintf(out, "name,planned_frame,achieved_frame,planned_ms,achieved_ms\n");
+    for (i = 0; i < timeline->num_events; i++) {
+        const PsyTimelineEvent* event = &timeline->events[i];
+        int presented = event->state == PSY_TIMELINE_PRESENTED;
+
+        fprintf(
+            out,
+            "%s,%lld,%lld,%.3f,%.3f\n",
+            event->name ? event->name : "",
+            (long long) event->planned_frame,
+            presented ? (long long) event->achieved_frame : -1LL,
+            psy_time_seconds(event->planned_time) * 1000.0,
+            presented ? psy_time_seconds(event->achieved_time) * 1000.0 : 0.0
+            );
+    }
+}
+
+/* **** initialization of the class **** */
+
+PsyTimelineClass* g_PsyTimelineClass = NULL;
+
+static int psy_timeline_class_init(SeeObjectClass* new_cls) {
+    int ret = SEE_SUCCESS;
+
+    /* Override the functions on the parent here */
+    new_cls->init = init;
+    new_cls->name = "PsyTimeline";
+    new_cls->destroy = destroy;
+
+    /* Set the function pointers of the own class here */
+    PsyTimelineClass* cls = (PsyTimelineClass*) new_cls;
+
+    cls->timeline_init  = timeline_init;
+    cls->add            = timeline_add;
+    cls->start          = timeline_start;
+    cls->update         = timeline_update;
+
+    return ret;
+}
+
+/**
+ * \private
+ * \brief this class initializes PsyTimeline(Class).
+ *
+ * You might want to call this from the library initialization func.
+ */
+int
+psy_timeline_init() {
+    int ret;
+    const SeeMetaClass* meta = see_meta_class_class();
+
+    ret = see_meta_class_new_class(
+        meta,
+        (SeeObjectClass**) &g_PsyTimelineClass,
+        sizeof(PsyTimelineClass),
+        sizeof(PsyTimeline),
+        see_object_class(),
+        sizeof(SeeObjectClass),
+        psy_timeline_class_init
+        );
+
+    return ret;
+}
+
+void
+psy_timeline_deinit()
+{
+    if(!g_PsyTimelineClass)
+        return;
+
+    see_object_decref((SeeObject*) g_PsyTimelineClass);
+    g_PsyTimelineClass = NULL;
+}
+
+const PsyTimelineClass*
+psy_timeline_class()
+{
+    return g_PsyTimelineClass;
+}
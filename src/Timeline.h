@@ -0,0 +1,328 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file Timeline.h
+ * \brief Runs the events of a trial on the frames of a window.
+ *
+ * The events of a trial, e.g. a stimulus that appears or disappears, a
+ * marker that's sent, a sound that starts or a response window that opens,
+ * are declared in frames or in milliseconds after the start of the trial.
+ * Frame 0 is the first frame that is presented after psy_timeline_start().
+ * Call psy_timeline_update() once every frame, before drawing it: the
+ * callbacks of the events that are due on that frame are run, so they can
+ * change what is drawn. The timeline counts frames with the flip counter
+ * of the window, see psy_window_swap_count(), so a dropped frame delays
+ * the events instead of shifting the whole trial.
+ *
+ * Every event records the frame and time at which it was presented next to
+ * the frame and time at which it was planned, see psy_timeline_print_log().
+ * The events are kept sorted when they're added; updating the timeline
+ * doesn't allocate memory.
+ */
+
+#ifndef PSY_TIMELINE_H
+#define PSY_TIMELINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+
+#include "psy_export.h"
+#include "Time.h"
+#include "Window.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _PsyTimeline PsyTimeline;
+typedef struct _PsyTimelineClass PsyTimelineClass;
+typedef struct _PsyTimelineEvent PsyTimelineEvent;
+
+/**
+ * \brief Runs an event, it's called from psy_timeline_update().
+ *
+ * The callback may add events to the timeline. Adding an event may move
+ * the events in memory, so the event is passed by id; look it up with
+ * psy_timeline_event() again after adding one.
+ */
+typedef void (*PsyTimelineFunc)(
+    PsyTimeline*    timeline,
+    size_t          id,
+    void*           data
+    );
+
+/**
+ * \brief The progress of an event.
+ */
+typedef enum {
+    PSY_TIMELINE_PENDING,   ///< Not run yet.
+    PSY_TIMELINE_FIRED,     ///< Run, the frame isn't presented yet.
+    PSY_TIMELINE_PRESENTED  ///< The frame of the event has been presented.
+} PsyTimelineState;
+
+/**
+ * \brief An event and its log, the times are relative to frame 0.
+ */
+struct _PsyTimelineEvent {
+    char*               name;           ///< A copy of the name, may be NULL.
+    PsyTimelineFunc     func;           ///< The callback, may be NULL.
+    void*               data;           ///< Passed to func.
+    PsyTimelineState    state;
+    int64_t             planned_frame;
+    PsyTime             planned_time;   ///< As declared, in nanoseconds.
+    int64_t             achieved_frame; ///< The frame it was presented with.
+    PsyTime             achieved_time;  ///< When that frame was presented.
+};
+
+struct _PsyTimeline {
+    SeeObject parent_obj;
+
+    /*expand PsyTimeline data here*/
+
+    PsyWindow*          window;
+    PsyTimelineEvent*   events;         // in the order they were added
+    size_t*             order;          // indices of events sorted by frame
+    size_t              num_events;
+    size_t              capacity;
+    size_t              resolved;       // order[resolved, next) are fired
+    size_t              next;           // order[next, num_events) pending
+    PsyTime             frame_duration;
+    uint64_t            start_count;    // the flip counter at the start
+    PsyTime             origin;         // when frame 0 was presented
+    int                 has_origin;
+    int                 running;
+};
+
+struct _PsyTimelineClass {
+    SeeObjectClass parent_cls;
+
+    int (*timeline_init)(
+        PsyTimeline*            timeline,
+        const PsyTimelineClass* timeline_cls,
+        PsyWindow*              window,
+        SeeError**              error
+        );
+
+    int (*add)(
+        PsyTimeline*    timeline,
+        int64_t         frame,
+        PsyTime         time,
+        const char*     name,
+        PsyTimelineFunc func,
+        void*           data,
+        size_t*         id,
+        SeeError**      error
+        );
+
+    void (*start)(PsyTimeline* timeline);
+
+    void (*update)(PsyTimeline* timeline);
+};
+
+/* **** function style macro casts **** */
+
+/**
+ * \brief cast a pointer from a PsyTimeline derived instance back to a
+ *        pointer to PsyTimeline.
+ */
+#define PSY_TIMELINE(obj)                      \
+    ((PsyTimeline*) obj)
+
+/**
+ * \brief cast a pointer to PsyTimelineClass derived class back to a
+ *        pointer to PsyTimelineClass.
+ */
+#define PSY_TIMELINE_CLASS(cls)                      \
+    ((const PsyTimelineClass*) cls)
+
+/**
+ * \brief obtain a pointer to PsyTimelineClass from a instance of
+ *        derived from PsyTimeline.
+ */
+#define PSY_TIMELINE_GET_CLASS(obj)                \
+    (PSY_TIMELINE_CLASS(see_object_get_class(SEE_OBJECT(obj)) ) )
+
+/* **** public functions **** */
+
+/**
+ * \brief Create an empty timeline for the frames of window.
+ *
+ * The duration of a frame, used for events declared in milliseconds, is
+ * taken from the window, or 60 Hz when the window doesn't know it.
+ *
+ * @param [out] timeline    The new timeline, should be NULL.
+ * @param [in]  window      The window whose frames are counted.
+ * @param [out] error
+ */
+PSY_EXPORT int
+psy_timeline_create(
+    PsyTimeline**   timeline,
+    PsyWindow*      window,
+    SeeError**      error
+    );
+
+/**
+ * \brief Add an event on a frame.
+ *
+ * @param [in]  timeline
+ * @param [in]  frame       The frame after the start, 0 or more.
+ * @param [in]  name        A name for the log, it's copied, may be NULL.
+ * @param [in]  func        The callback, may be NULL for an event that's
+ *                          only logged.
+ * @param [in]  data        Passed to func.
+ * @param [out] id          The id of the event, may be NULL.
+ * @param [out] error
+ * @return SEE_SUCCESS, SEE_INVALID_ARGUMENT or SEE_ERROR_RUNTIME when out
+ *         of memory.
+ */
+PSY_EXPORT int
+psy_timeline_add_frames(
+    PsyTimeline*    timeline,
+    int64_t         frame,
+    const char*     name,
+    PsyTimelineFunc func,
+    void*           data,
+    size_t*         id,
+    SeeError**      error
+    );
+
+/**
+ * \brief Add an event at a time after the start.
+ *
+ * The event is run on the frame whose onset is closest to ms, see
+ * psy_timeline_add_frames() for the other parameters.
+ */
+PSY_EXPORT int
+psy_timeline_add_ms(
+    PsyTimeline*    timeline,
+    double          ms,
+    const char*     name,
+    PsyTimelineFunc func,
+    void*           data,
+    size_t*         id,
+    SeeError**      error
+    );
+
+/**
+ * \brief Remove all events, e.g. to declare the next trial.
+ */
+PSY_EXPORT void
+psy_timeline_clear(PsyTimeline* timeline);
+
+/**
+ * \brief Start the trial, the next frame presented is frame 0.
+ *
+ * The log of a previous run is cleared, so a timeline can be run again.
+ */
+PSY_EXPORT int
+psy_timeline_start(PsyTimeline* timeline);
+
+/**
+ * \brief Log the frames presented since the last update and run the
+ * events that are due on the next frame.
+ *
+ * Call it once every frame, before drawing the frame. An event whose
+ * frame has passed already, because frames were dropped or because it
+ * was added too late, is run straight away.
+ */
+PSY_EXPORT int
+psy_timeline_update(PsyTimeline* timeline);
+
+/**
+ * \brief Returns non zero when all events have been presented.
+ */
+PSY_EXPORT int
+psy_timeline_done(const PsyTimeline* timeline);
+
+/**
+ * \brief The frame that will be presented next, relative to the start.
+ */
+PSY_EXPORT int64_t
+psy_timeline_frame(const PsyTimeline* timeline);
+
+/**
+ * \brief Set the duration of a frame for the events in milliseconds.
+ *
+ * This only affects the events that are added afterwards.
+ */
+PSY_EXPORT void
+psy_timeline_set_frame_duration(PsyTimeline* timeline, PsyTime duration);
+
+/**
+ * \brief When frame 0 was presented, a time from psy_time_now().
+ *
+ * @return The time or 0 when frame 0 hasn't been presented yet.
+ */
+PSY_EXPORT PsyTime
+psy_timeline_origin(const PsyTimeline* timeline);
+
+/**
+ * \brief The number of events in the timeline.
+ */
+PSY_EXPORT size_t
+psy_timeline_num_events(const PsyTimeline* timeline);
+
+/**
+ * \brief Obtain an event and its log.
+ *
+ * @return The event with id or NULL when there is no such event. The
+ *         pointer is valid until the next event is added.
+ */
+PSY_EXPORT const PsyTimelineEvent*
+psy_timeline_event(const PsyTimeline* timeline, size_t id);
+
+/**
+ * \brief Write the planned and achieved onsets of the events as CSV.
+ *
+ * There is one line per event, in the order they were added, with the
+ * name, the planned and achieved frame and the planned and achieved time
+ * in milliseconds. An event that wasn't presented has an achieved frame
+ * of -1.
+ */
+PSY_EXPORT void
+psy_timeline_print_log(const PsyTimeline* timeline, FILE* out);
+
+/**
+ * Gets the pointer to the PsyTimelineClass table.
+ */
+PSY_EXPORT const PsyTimelineClass*
+psy_timeline_class();
+
+/* **** class initialization functions **** */
+
+/**
+ * Initialize PsyTimeline; make it ready for use.
+ */
+PSY_EXPORT
+int psy_timeline_init();
+
+/**
+ * Deinitialize PsyTimeline, after PsyTimeline has been deinitialized,
+ * all functions in this header shouldn't be used anymore.
+ */
+PSY_EXPORT
+void psy_timeline_deinit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_TIMELINE_H
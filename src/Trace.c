@@ -0,0 +1,452 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file Trace.c
+ * \brief Implements the trace buffers of the threads and writing them as
+ * Chrome trace JSON.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#include "Error.h"
+#include "Trace.h"
+
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+#define THREAD_NAME_SIZE 32
+
+typedef struct {
+    const char* category;
+    const char* name;
+    PsyTime     begin;
+    PsyTime     duration;   // < 0 for an instant
+} TraceEvent;
+
+/*
+ * The events of one thread, only the thread that holds it writes to it.
+ * When an SDL thread exits its buffer is released, the events remain until
+ * the next thread that records claims and clears the buffer.
+ * psy_trace_clear() only bumps g_cleared, the events of a buffer whose
+ * cleared differs are forgotten and its owner resets head on its next event.
+ */
+typedef struct TraceBuffer {
+    struct TraceBuffer* next;
+    TraceEvent*         events;     // a ring of mask + 1 events
+    size_t              mask;
+    size_t              head;       // the number of events recorded
+    int                 tid;
+    SDL_atomic_t        in_use;     // 0 when no thread holds it
+    SDL_atomic_t        cleared;    // g_cleared when head was reset
+    char                thread_name[THREAD_NAME_SIZE];
+} TraceBuffer;
+
+static SDL_atomic_t g_enabled;
+static SDL_atomic_t g_num_threads;
+static SDL_atomic_t g_release_tls;  // the SDL_TLSID that releases a buffer
+static SDL_atomic_t g_cleared;      // the number of psy_trace_clear() calls
+static void*        g_buffers;      // the TraceBuffers of all threads
+static size_t       g_capacity = PSY_TRACE_DEFAULT_CAPACITY;
+static unsigned     g_generation = 1; // tells a thread its buffer was freed
+
+static THREAD_LOCAL TraceBuffer*    t_buffer;
+static THREAD_LOCAL unsigned        t_generation;
+static THREAD_LOCAL char            t_thread_name[THREAD_NAME_SIZE];
+
+static void
+set_error(SeeError** error, const char* func, const char* msg)
+{
+    PsyError* err = NULL;
+    psy_error_create(&err);
+    psy_error_printf(err, "%s: %s", func, msg);
+    *error = SEE_ERROR(err);
+}
+
+/* Runs on an SDL thread that exits, it releases the buffer of the thread. */
+static void SDLCALL
+release_buffer(void* data)
+{
+    TraceBuffer* buffer = data;
+
+    // After psy_trace_free() the buffer doesn't exist anymore.
+    if (buffer == t_buffer && t_generation == g_generation)
+        SDL_AtomicSet(&buffer->in_use, 0);
+    t_buffer = NULL;
+}
+
+static SDL_TLSID
+release_tls(void)
+{
+    int id = SDL_AtomicGet(&g_release_tls);
+
+    if (!id) {
+        id = (int) SDL_TLSCreate();
+        // Another thread may have created one at the same time.
+        if (!SDL_AtomicCAS(&g_release_tls, 0, id))
+            id = SDL_AtomicGet(&g_release_tls);
+    }
+    return (SDL_TLSID) id;
+}
+
+/* Only the thread that holds the buffer resets it. */
+static void
+reset_buffer(TraceBuffer* buffer)
+{
+    int cleared = SDL_AtomicGet(&g_cleared);
+
+    buffer->head = 0;
+    // A reader only takes head once it sees the new cleared.
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&buffer->cleared, cleared);
+}
+
+/* A buffer released by a thread that exited, or NULL. */
+static TraceBuffer*
+claim_buffer(void)
+{
+    TraceBuffer* buffer;
+
+    for (buffer = SDL_AtomicGetPtr(&g_buffers); buffer; buffer = buffer->next)
+        if (SDL_AtomicCAS(&buffer->in_use, 0, 1))
+            return buffer;
+    return NULL;
+}
+
+static TraceBuffer*
+new_buffer(void)
+{
+    TraceBuffer* buffer = calloc(1, sizeof(TraceBuffer));
+
+    if (!buffer)
+        return NULL;
+    buffer->events = malloc(g_capacity * sizeof(TraceEvent));
+    if (!buffer->events) {
+        free(buffer);
+        return NULL;
+    }
+    buffer->mask = g_capacity - 1;
+    buffer->tid = SDL_AtomicAdd(&g_num_threads, 1) + 1;
+    SDL_AtomicSet(&buffer->in_use, 1);
+    SDL_AtomicSet(&buffer->cleared, SDL_AtomicGet(&g_cleared));
+
+    // Other threads may add their buffer at the same time.
+    do {
+        buffer->next = SDL_AtomicGetPtr(&g_buffers);
+    } while (!SDL_AtomicCASPtr(&g_buffers, buffer->next, buffer));
+
+    return buffer;
+}
+
+/*
+ * The buffer of the calling thread, it's claimed or created on the first
+ * event of the thread, so only threads that record while tracing is
+ * enabled have one.
+ */
+static TraceBuffer*
+thread_buffer(void)
+{
+    TraceBuffer* buffer;
+
+    if (t_buffer && t_generation == g_generation)
+        return t_buffer;
+
+    // The events of the thread that left it would show with our name.
+    buffer = claim_buffer();
+    if (buffer)
+        reset_buffer(buffer);
+    else
+        buffer = new_buffer();
+    if (!buffer)
+        return NULL;
+    memcpy(buffer->thread_name, t_thread_name, sizeof(buffer->thread_name));
+    SDL_TLSSet(release_tls(), buffer, release_buffer);
+
+    t_buffer = buffer;
+    t_generation = g_generation;
+    return buffer;
+}
+
+static void
+record(const char* category, const char* name, PsyTime begin, PsyTime duration)
+{
+    TraceBuffer* buffer = thread_buffer();
+    TraceEvent* event;
+
+    if (!buffer)
+        return;
+    if (SDL_AtomicGet(&buffer->cleared) != SDL_AtomicGet(&g_cleared))
+        reset_buffer(buffer);
+
+    event = &buffer->events[buffer->head & buffer->mask];
+    event->category = category;
+    event->name = name;
+    event->begin = begin;
+    event->duration = duration;
+
+    // A reader on another thread only sees complete events.
+    SDL_MemoryBarrierRelease();
+    buffer->head++;
+}
+
+/* The range of events a buffer keeps. */
+static void
+kept_events(const TraceBuffer* buffer, size_t* first, size_t* last)
+{
+    size_t head;
+
+    // The owner resets head on its next event.
+    if (SDL_AtomicGet((SDL_atomic_t*) &buffer->cleared)
+            != SDL_AtomicGet(&g_cleared)) {
+        *first = *last = 0;
+        return;
+    }
+    head = buffer->head;
+    SDL_MemoryBarrierAcquire();
+
+    *last = head;
+    *first = head > buffer->mask + 1 ? head - (buffer->mask + 1) : 0;
+}
+
+static void
+write_string(FILE* out, const char* str)
+{
+    fputc('"', out);
+    for (; *str; str++) {
+        unsigned char c = (unsigned char) *str;
+        if (c == '"' || c == '\\')
+            fprintf(out, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(out, "\\u%04x", c);
+        else
+            fputc(c, out);
+    }
+    fputc('"', out);
+}
+
+static double
+microseconds(PsyTime time)
+{
+    return (double) time / PSY_TIME_NS_PER_US;
+}
+
+void
+psy_trace_enable(int enable)
+{
+    SDL_AtomicSet(&g_enabled, enable ? 1 : 0);
+}
+
+int
+psy_trace_enabled(void)
+{
+    return SDL_AtomicGet(&g_enabled);
+}
+
+PsyTime
+psy_trace_begin(void)
+{
+    return SDL_AtomicGet(&g_enabled) ? psy_time_now() : 0;
+}
+
+void
+psy_trace_end(PsyTime begin, const char* category, const char* name)
+{
+    if (!begin)
+        return;
+    record(category, name, begin, psy_time_now() - begin);
+}
+
+void
+psy_trace_instant(const char* category, const char* name)
+{
+    if (!SDL_AtomicGet(&g_enabled))
+        return;
+    record(category, name, psy_time_now(), -1);
+}
+
+void
+psy_trace_set_thread_name(const char* name)
+{
+    if (!name)
+        return;
+    snprintf(t_thread_name, sizeof(t_thread_name), "%s", name);
+
+    // Otherwise it's copied when the thread records its first event.
+    if (t_buffer && t_generation == g_generation)
+        memcpy(t_buffer->thread_name, t_thread_name, sizeof(t_thread_name));
+}
+
+void
+psy_trace_set_capacity(size_t capacity)
+{
+    size_t rounded = 1;
+
+    while (rounded < capacity)
+        rounded <<= 1;
+    g_capacity = rounded;
+}
+
+size_t
+psy_trace_num_events(void)
+{
+    const TraceBuffer* buffer;
+    size_t first, last, num = 0;
+
+    for (buffer = SDL_AtomicGetPtr(&g_buffers); buffer; buffer = buffer->next) {
+        kept_events(buffer, &first, &last);
+        num += last - first;
+    }
+    return num;
+}
+
+uint64_t
+psy_trace_num_overwritten(void)
+{
+    const TraceBuffer* buffer;
+    size_t first, last;
+    uint64_t num = 0;
+
+    for (buffer = SDL_AtomicGetPtr(&g_buffers); buffer; buffer = buffer->next) {
+        kept_events(buffer, &first, &last);
+        num += first;
+    }
+    return num;
+}
+
+void
+psy_trace_clear(void)
+{
+    SDL_AtomicAdd(&g_cleared, 1);
+}
+
+int
+psy_trace_write(FILE* out, SeeError** error)
+{
+    const TraceBuffer* buffer;
+    const char* separator = "\n";
+    PsyTime origin = 0;
+    int have_origin = 0;
+    size_t i, first, last;
+
+    if (!out || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    for (buffer = SDL_AtomicGetPtr(&g_buffers); buffer; buffer = buffer->next) {
+        kept_events(buffer, &first, &last);
+        for (i = first; i < last; i++) {
+            PsyTime begin = buffer->events[i & buffer->mask].begin;
+            if (!have_origin || begin < origin) {
+                origin = begin;
+                have_origin = 1;
+            }
+        }
+    }
+
+    fputs("{\"traceEvents\":[", out);
+    for (buffer = SDL_AtomicGetPtr(&g_buffers); buffer; buffer = buffer->next) {
+        if (buffer->thread_name[0]) {
+            fprintf(
+                out,
+                "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                "\"tid\":%d,\"args\":{\"name\":",
+                separator,
+                buffer->tid
+                );
+            write_string(out, buffer->thread_name);
+            fputs("}}", out);
+            separator = ",\n";
+        }
+
+        kept_events(buffer, &first, &last);
+        for (i = first; i < last; i++) {
+            const TraceEvent* event = &buffer->events[i & buffer->mask];
+
+            fprintf(out, "%s{\"cat\":", separator);
+            write_string(out, event->category);
+            fputs(",\"name\":", out);
+            write_string(out, event->name);
+            if (event->duration < 0)
+                fprintf(
+                    out,
+                    ",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f",
+                    microseconds(event->begin - origin)
+                    );
+            else
+                fprintf(
+                    out,
+                    ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f",
+                    microseconds(event->begin - origin),
+                    microseconds(event->duration)
+                    );
+            fprintf(out, ",\"pid\":1,\"tid\":%d}", buffer->tid);
+            separator = ",\n";
+        }
+    }
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", out);
+
+    if (ferror(out)) {
+        set_error(error, __func__, "unable to write the trace");
+        return SEE_ERROR_RUNTIME;
+    }
+    return SEE_SUCCESS;
+}
+
+int
+psy_trace_save(const char* path, SeeError** error)
+{
+    FILE* file;
+    int ret;
+
+    if (!path || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    file = fopen(path, "w");
+    if (!file) {
+        set_error(error, __func__, "unable to open the file");
+        return SEE_ERROR_RUNTIME;
+    }
+
+    ret = psy_trace_write(file, error);
+    if (fclose(file) != 0 && !ret) {
+        set_error(error, __func__, "unable to write the trace");
+        ret = SEE_ERROR_RUNTIME;
+    }
+    return ret;
+}
+
+void
+psy_trace_free(void)
+{
+    TraceBuffer* buffer;
+
+    SDL_AtomicSet(&g_enabled, 0);
+
+    buffer = SDL_AtomicSetPtr(&g_buffers, NULL);
+    while (buffer) {
+        TraceBuffer* next = buffer->next;
+        free(buffer->events);
+        free(buffer);
+        buffer = next;
+    }
+    SDL_AtomicSet(&g_num_threads, 0);
+    g_generation++;
+}
@@ -0,0 +1,212 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file Trace.h
+ * \brief Record where the time of a frame goes, on every thread.
+ *
+ * psylib marks the work that may cost a frame as scopes: the swap, shader
+ * compiles and links, texture and buffer uploads, the waits of
+ * psy_wait_until() and the decoding and reading on the loader threads.
+ * Experiment code adds its own scopes in the same way:
+ *
+ * \code
+ * PSY_TRACE_BEGIN(trace);
+ * prepare_trial(trial);
+ * PSY_TRACE_END(trace, "experiment", "prepare trial");
+ * \endcode
+ *
+ * Each thread writes to a buffer of its own, so recording takes no locks
+ * and costs about one read of the clock per scope. Nothing is recorded
+ * until psy_trace_enable() is called. At the end of a session
+ * psy_trace_save() writes the scopes of all threads as Chrome trace JSON,
+ * which chrome://tracing or https://ui.perfetto.dev show on a timeline.
+ *
+ * The macros are compiled in when PSY_TRACE is defined, the PSY_TRACE
+ * CMake option of psylib defines it for psylib and the targets that link
+ * to it. Without it they compile to nothing, the functions remain.
+ */
+
+#ifndef PSY_TRACE_H
+#define PSY_TRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+#include "psy_export.h"
+#include "Time.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief The number of events a thread keeps by default, when a thread
+ * records more, its oldest events are overwritten.
+ */
+#define PSY_TRACE_DEFAULT_CAPACITY (1 << 16)
+
+#if defined(PSY_TRACE)
+
+/**
+ * \brief Start a scope, var holds its start time.
+ */
+#define PSY_TRACE_BEGIN(var) PsyTime var = psy_trace_begin()
+
+/**
+ * \brief End the scope that was started with PSY_TRACE_BEGIN(var).
+ *
+ * The category and name aren't copied, they should be string literals.
+ */
+#define PSY_TRACE_END(var, category, name)                          \
+    psy_trace_end(var, category, name)
+
+/**
+ * \brief Mark a moment rather than a scope.
+ */
+#define PSY_TRACE_INSTANT(category, name)                           \
+    psy_trace_instant(category, name)
+
+#else
+
+#define PSY_TRACE_BEGIN(var) (void) 0
+#define PSY_TRACE_END(var, category, name) (void) 0
+#define PSY_TRACE_INSTANT(category, name) (void) 0
+
+#endif
+
+/**
+ * \brief Start or stop recording, it's stopped initially.
+ *
+ * Scopes that were started before recording started, are not recorded.
+ */
+PSY_EXPORT void
+psy_trace_enable(int enable);
+
+/**
+ * \brief Whether psy_trace_enable() started recording.
+ */
+PSY_EXPORT int
+psy_trace_enabled(void);
+
+/**
+ * \brief The start of a scope, prefer PSY_TRACE_BEGIN().
+ *
+ * @return The current time or 0 when recording is stopped.
+ */
+PSY_EXPORT PsyTime
+psy_trace_begin(void);
+
+/**
+ * \brief Record a scope of the calling thread, prefer PSY_TRACE_END().
+ *
+ * @param [in] begin    The result of psy_trace_begin(), nothing is
+ *                      recorded when it's 0.
+ * @param [in] category E.g. "psylib", it's not copied.
+ * @param [in] name     It's not copied.
+ */
+PSY_EXPORT void
+psy_trace_end(PsyTime begin, const char* category, const char* name);
+
+/**
+ * \brief Record a moment of the calling thread, prefer PSY_TRACE_INSTANT().
+ */
+PSY_EXPORT void
+psy_trace_instant(const char* category, const char* name);
+
+/**
+ * \brief The name the calling thread is shown with in the trace.
+ *
+ * It doesn't allocate, so threads may set their name whether or not
+ * tracing is enabled. A thread started with SDL_CreateThread() leaves
+ * its events when it exits. They're written until the next thread that
+ * records reuses its buffer, which forgets them first, so the events of
+ * a thread are never shown with the name of another.
+ *
+ * @param [in] name It's copied, names longer than 31 bytes are cut.
+ */
+PSY_EXPORT void
+psy_trace_set_thread_name(const char* name);
+
+/**
+ * \brief The number of events a thread keeps.
+ *
+ * It's rounded up to a power of two and applies to the threads that
+ * record their first event after it's set.
+ */
+PSY_EXPORT void
+psy_trace_set_capacity(size_t capacity);
+
+/**
+ * \brief The number of events that are kept, of all threads.
+ */
+PSY_EXPORT size_t
+psy_trace_num_events(void);
+
+/**
+ * \brief The number of events that were overwritten, of all threads.
+ */
+PSY_EXPORT uint64_t
+psy_trace_num_overwritten(void);
+
+/**
+ * \brief Forget the events of all threads.
+ *
+ * Other threads may keep recording, each one drops its old events when it
+ * records the next one. Events recorded at the same time as the clear
+ * may be kept or not.
+ */
+PSY_EXPORT void
+psy_trace_clear(void);
+
+/**
+ * \brief Write the events of all threads as Chrome trace JSON.
+ *
+ * The time stamps are in microseconds since the first event. The other
+ * threads shouldn't record while the events are written, stop recording
+ * first.
+ *
+ * @param [in]  out
+ * @param [out] error
+ *
+ * @return SEE_SUCCESS, SEE_INVALID_ARGUMENT or SEE_ERROR_RUNTIME when
+ *         writing failed.
+ */
+PSY_EXPORT int
+psy_trace_write(FILE* out, SeeError** error);
+
+/**
+ * \brief Write the events of all threads to the file at path, see
+ * psy_trace_write().
+ */
+PSY_EXPORT int
+psy_trace_save(const char* path, SeeError** error);
+
+/**
+ * \brief Stop recording and release the buffers of all threads.
+ *
+ * psylib_deinit() calls this, the other threads should be done.
+ */
+PSY_EXPORT void
+psy_trace_free(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,747 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include "MetaClass.h"
+#include "Error.h"
+#include "Trace.h"
+#include "Video.h"
+#include "gl/GLError.h"
+#include "gl/gl_util.h"
+
+/* The number of frames the reader may be ahead. */
+#define RING_SIZE 8
+
+/* The longest stream header we accept. */
+#define MAX_HEADER 1024
+
+/*
+ * The file, the reader thread and the frames it has read. The reader
+ * writes the slots after head + count, the render thread reads the slot at
+ * head, so only head, count and the flags need the mutex.
+ */
+typedef struct _PsyVideoStream {
+    FILE*           file;
+    SDL_Thread*     thread;
+    SDL_mutex*      mutex;
+    SDL_cond*       cond;
+    unsigned char*  ring;
+    size_t          frame_size;
+    int             head;
+    int             count;
+    int             eof;
+    int             broken;
+    int             stop;
+} VideoStream;
+
+static const GLfloat g_quad[4][2] = {
+    {0.0f, 0.0f}, {1.0f, 0.0f}, {0.0f, 1.0f}, {1.0f, 1.0f}
+};
+
+static const GLfloat g_identity[16] = {
+    1.0f, 0.0f, 0.0f, 0.0f,
+    0.0f, 1.0f, 0.0f, 0.0f,
+    0.0f, 0.0f, 1.0f, 0.0f,
+    0.0f, 0.0f, 0.0f, 1.0f
+};
+
+static void
+set_error(SeeError** error, const char* func, const char* msg, const char* arg)
+{
+    PsyError* err = NULL;
+    psy_error_create(&err);
+    psy_error_printf(err, "%s: %s%s", func, msg, arg ? arg : "");
+    *error = SEE_ERROR(err);
+}
+
+static int
+chroma_size(int size)
+{
+    return (size + 1) / 2;
+}
+
+static void
+plane_size(const PsyVideo* video, int plane, int* width, int* height)
+{
+    *width = plane ? chroma_size(video->width) : video->width;
+    *height = plane ? chroma_size(video->height) : video->height;
+}
+
+/* ES 2.0 has no single channel formats other than luminance. */
+static GLenum
+plane_format(void)
+{
+    return psy_gl_context_is_es() ? GL_LUMINANCE : GL_RED;
+}
+
+static GLint
+plane_internal_format(void)
+{
+    return psy_gl_context_is_es() ? GL_LUMINANCE : GL_R8;
+}
+
+/*
+ * Reads the "FRAME" line and the planes of one frame.
+ * Returns 0 when a frame was read, 1 at the end of the file and -1 when
+ * the file is broken.
+ */
+static int
+read_frame(FILE* file, unsigned char* dest, size_t frame_size)
+{
+    char tag[6] = {0};
+    int c, n = 0;
+
+    c = fgetc(file);
+    if (c == EOF)
+        return 1;
+
+    // The tag may be followed by parameters, which we ignore.
+    while (c != EOF && c != '\n') {
+        if (n < 5)
+            tag[n++] = (char) c;
+        c = fgetc(file);
+    }
+    if (c == EOF || strcmp(tag, "FRAME") != 0)
+        return -1;
+
+    if (fread(dest, 1, frame_size, file) != frame_size)
+        return -1;
+
+    return 0;
+}
+
+static int
+reader(void* data)
+{
+    VideoStream* stream = data;
+
+    psy_trace_set_thread_name("psy_video");
+    for (;;) {
+        int slot, ret;
+
+        SDL_LockMutex(stream->mutex);
+        while (!stream->stop && stream->count == RING_SIZE)
+            SDL_CondWait(stream->cond, stream->mutex);
+        if (stream->stop) {
+            SDL_UnlockMutex(stream->mutex);
+            break;
+        }
+        slot = (stream->head + stream->count) % RING_SIZE;
+        SDL_UnlockMutex(stream->mutex);
+
+        ret = read_frame(
+            stream->file,
+            stream->ring + (size_t) slot * stream->frame_size,
+            stream->frame_size
+            );
+
+        SDL_LockMutex(stream->mutex);
+        if (ret == 0) {
+            stream->count++;
+        }
+        else {
+            stream->eof = 1;
+            stream->broken = ret < 0;
+        }
+        SDL_CondBroadcast(stream->cond);
+        SDL_UnlockMutex(stream->mutex);
+
+        if (ret)
+            break;
+    }
+
+    return 0;
+}
+
+static void
+stream_free(VideoStream* stream)
+{
+    if (!stream)
+        return;
+
+    if (stream->thread) {
+        SDL_LockMutex(stream->mutex);
+        stream->stop = 1;
+        SDL_CondBroadcast(stream->cond);
+        SDL_UnlockMutex(stream->mutex);
+        SDL_WaitThread(stream->thread, NULL);
+    }
+    if (stream->cond)
+        SDL_DestroyCond(stream->cond);
+    if (stream->mutex)
+        SDL_DestroyMutex(stream->mutex);
+    if (stream->file)
+        fclose(stream->file);
+    free(stream->ring);
+    free(stream);
+}
+
+/*
+ * Parses the stream header, e.g. "YUV4MPEG2 W640 H480 F25:1 Ip A1:1 C420jpeg".
+ */
+static int
+parse_header(PsyVideo* video, FILE* file, SeeError** error)
+{
+    char header[MAX_HEADER];
+    char* token;
+
+    if (!fgets(header, sizeof(header), file) || !strchr(header, '\n') ||
+        strncmp(header, "YUV4MPEG2 ", 10) != 0) {
+        set_error(error, __func__, "not a YUV4MPEG2 file", NULL);
+        return SEE_ERROR_RUNTIME;
+    }
+
+    video->width = video->height = 0;
+    video->rate_num = video->rate_den = 0;
+
+    for (token = strtok(header + 10, " \n"); token; token = strtok(NULL, " \n")) {
+        switch (token[0]) {
+            case 'W':
+                video->width = atoi(token + 1);
+                break;
+            case 'H':
+                video->height = atoi(token + 1);
+                break;
+            case 'F':
+                if (sscanf(token + 1, "%d:%d", &video->rate_num, &video->rate_den) != 2)
+                    video->rate_num = video->rate_den = 0;
+                break;
+            case 'C':
+                // C420, C420jpeg, C420mpeg2 and C420paldv only differ in
+                // the siting of the chroma samples.
+                if (strncmp(token + 1, "420", 3) != 0) {
+                    set_error(error, __func__, "unsupported color space ", token + 1);
+                    return SEE_ERROR_RUNTIME;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (video->width <= 0 || video->height <= 0) {
+        set_error(error, __func__, "invalid frame size in the header", NULL);
+        return SEE_ERROR_RUNTIME;
+    }
+
+    return SEE_SUCCESS;
+}
+
+static void
+upload_frame(PsyVideo* video, const unsigned char* frame)
+{
+    int i;
+    PSY_TRACE_BEGIN(trace);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (i = 0; i < 3; i++) {
+        int width, height;
+        plane_size(video, i, &width, &height);
+        psy_gl_bind_texture(0, GL_TEXTURE_2D, video->planes[i]);
+        glTexSubImage2D(
+            GL_TEXTURE_2D, 0, 0, 0, width, height,
+            plane_format(), GL_UNSIGNED_BYTE, frame
+            );
+        frame += (size_t) width * (size_t) height;
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    psy_gl_bind_texture(0, GL_TEXTURE_2D, 0);
+    PSY_TRACE_END(trace, "psylib", "upload");
+}
+
+static GLint
+set_corner_attribute(const PsyVideo* video)
+{
+    GLint location = psy_shader_program_attribute_location(
+        video->program, "a_corner"
+        );
+    if (location < 0)
+        return location;
+    glEnableVertexAttribArray((GLuint) location);
+    glVertexAttribPointer((GLuint) location, 2, GL_FLOAT, GL_FALSE, 0, NULL);
+    return location;
+}
+
+/* **** functions that implement PsyVideo or override SeeObject **** */
+
+static int
+video_init(
+    PsyVideo*               video,
+    const PsyVideoClass*    video_cls,
+    SeeError**              error
+    )
+{
+    int ret, i;
+    const SeeObjectClass* parent_cls = SEE_OBJECT_CLASS(video_cls);
+
+    parent_cls->object_init(
+        SEE_OBJECT(video),
+        SEE_OBJECT_CLASS(video_cls)
+        );
+
+    video->rect[0] = 0.0f;
+    video->rect[1] = 0.0f;
+    video->rect[2] = 2.0f;
+    video->rect[3] = 2.0f;
+
+    ret = psy_shader_program_create_builtin(
+        &video->program,
+        "video",
+        "video",
+        error
+        );
+    if (ret)
+        return ret;
+
+    glGenTextures(3, video->planes);
+    for (i = 0; i < 3; i++) {
+        glBindTexture(GL_TEXTURE_2D, video->planes[i]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (psy_gl_has_vertex_arrays()) {
+        glGenVertexArrays(1, &video->vao);
+        glBindVertexArray(video->vao);
+    }
+
+    glGenBuffers(1, &video->quad_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, video->quad_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(g_quad), g_quad, GL_STATIC_DRAW);
+
+    if (video->vao) {
+        set_corner_attribute(video);
+        glBindVertexArray(0);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return SEE_SUCCESS;
+}
+
+static int
+init(const SeeObjectClass* cls, SeeObject* obj, va_list args)
+{
+    const PsyVideoClass* video_cls = PSY_VIDEO_CLASS(cls);
+    PsyVideo* video = PSY_VIDEO(obj);
+
+    SeeError** error = va_arg(args, SeeError**);
+
+    return video_cls->video_init(video, video_cls, error);
+}
+
+static void
+destroy(SeeObject* obj)
+{
+    PsyVideo* video = PSY_VIDEO(obj);
+
+    stream_free(video->stream);
+
+    if (video->planes[0])
+        glDeleteTextures(3, video->planes);
+    if (video->vao)
+        glDeleteVertexArrays(1, &video->vao);
+    if (video->quad_vbo)
+        glDeleteBuffers(1, &video->quad_vbo);
+
+    if (video->program)
+        see_object_decref(SEE_OBJECT(video->program));
+
+    see_object_class()->destroy(obj);
+}
+
+static void
+video_close(PsyVideo* video)
+{
+    stream_free(video->stream);
+    video->stream = NULL;
+    video->has_frame = 0;
+}
+
+static int
+video_open(PsyVideo* video, const char* path, SeeError** error)
+{
+    VideoStream* stream;
+    FILE* file;
+    int ret, i;
+
+    video_close(video);
+    video->frames_shown = 0;
+    video->underruns = 0;
+
+    file = fopen(path, "rb");
+    if (!file) {
+        set_error(error, __func__, "unable to open ", path);
+        return SEE_ERROR_RUNTIME;
+    }
+
+    ret = parse_header(video, file, error);
+    if (ret) {
+        fclose(file);
+        return ret;
+    }
+
+    stream = calloc(1, sizeof(VideoStream));
+    if (!stream) {
+        fclose(file);
+        set_error(error, __func__, "out of memory", NULL);
+        return SEE_ERROR_RUNTIME;
+    }
+    stream->file = file;
+    stream->frame_size = (size_t) video->width * (size_t) video->height +
+        2 * (size_t) chroma_size(video->width) *
+            (size_t) chroma_size(video->height);
+    stream->ring = malloc(stream->frame_size * RING_SIZE);
+    stream->mutex = SDL_CreateMutex();
+    stream->cond = SDL_CreateCond();
+    if (!stream->ring || !stream->mutex || !stream->cond) {
+        stream_free(stream);
+        set_error(error, __func__, "out of memory", NULL);
+        return SEE_ERROR_RUNTIME;
+    }
+
+    for (i = 0; i < 3; i++) {
+        int width, height;
+        plane_size(video, i, &width, &height);
+        glBindTexture(GL_TEXTURE_2D, video->planes[i]);
+        glTexImage2D(
+            GL_TEXTURE_2D, 0, plane_internal_format(), width, height, 0,
+            plane_format(), GL_UNSIGNED_BYTE, NULL
+            );
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    stream->thread = SDL_CreateThread(reader, "psy_video", stream);
+    if (!stream->thread) {
+        stream_free(stream);
+        set_error(error, __func__, "unable to start the reader: ", SDL_GetError());
+        return SEE_ERROR_RUNTIME;
+    }
+
+    video->stream = stream;
+    return SEE_SUCCESS;
+}
+
+static int
+video_preroll(PsyVideo* video, SeeError** error)
+{
+    VideoStream* stream = video->stream;
+    (void) error;
+
+    if (!stream)
+        return SEE_SUCCESS;
+
+    SDL_LockMutex(stream->mutex);
+    while (stream->count < RING_SIZE && !stream->eof)
+        SDL_CondWait(stream->cond, stream->mutex);
+    SDL_UnlockMutex(stream->mutex);
+
+    return SEE_SUCCESS;
+}
+
+static int
+video_advance(PsyVideo* video, SeeError** error)
+{
+    VideoStream* stream = video->stream;
+    int count, eof, broken, head;
+
+    if (!stream)
+        return SEE_SUCCESS;
+
+    SDL_LockMutex(stream->mutex);
+    head = stream->head;
+    count = stream->count;
+    eof = stream->eof;
+    broken = stream->broken;
+    stream->broken = 0;
+    SDL_UnlockMutex(stream->mutex);
+
+    if (count == 0) {
+        if (broken) {
+            set_error(error, __func__, "the file is truncated or corrupt", NULL);
+            return SEE_ERROR_RUNTIME;
+        }
+        if (!eof)
+            video->underruns++;
+        return SEE_SUCCESS;
+    }
+
+    // The reader doesn't touch the slot at head until we release it.
+    upload_frame(video, stream->ring + (size_t) head * stream->frame_size);
+
+    SDL_LockMutex(stream->mutex);
+    stream->head = (stream->head + 1) % RING_SIZE;
+    stream->count--;
+    SDL_CondBroadcast(stream->cond);
+    SDL_UnlockMutex(stream->mutex);
+
+    video->has_frame = 1;
+    video->frames_shown++;
+    return SEE_SUCCESS;
+}
+
+static int
+video_draw(PsyVideo* video, const GLfloat* transform, SeeError** error)
+{
+    const PsyShaderProgram* program = video->program;
+    const char* samplers[3] = {"u_plane_y", "u_plane_u", "u_plane_v"};
+    GLint location = -1;
+    int ret, i;
+
+    if (!video->has_frame)
+        return SEE_SUCCESS;
+
+    ret = psy_shader_use_program(program, error);
+    if (ret)
+        return ret;
+
+    glUniformMatrix4fv(
+        psy_shader_program_uniform_location(program, "u_transform"),
+        1,
+        GL_FALSE,
+        transform ? transform : g_identity
+        );
+    glUniform4fv(
+        psy_shader_program_uniform_location(program, "u_rect"),
+        1,
+        video->rect
+        );
+    for (i = 0; i < 3; i++) {
+        psy_gl_bind_texture((GLuint) i, GL_TEXTURE_2D, video->planes[i]);
+        glUniform1i(psy_shader_program_uniform_location(program, samplers[i]), i);
+    }
+
+    if (video->vao) {
+        glBindVertexArray(video->vao);
+    }
+    else {
+        glBindBuffer(GL_ARRAY_BUFFER, video->quad_vbo);
+        location = set_corner_attribute(video);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+    if (video->vao)
+        glBindVertexArray(0);
+    else
+        psy_gl_disable_attributes(&location, 1);
+    // The planes stay bound, a display list may skip binding them again.
+    psy_gl_active_texture(0);
+
+    return SEE_SUCCESS;
+}
+
+/* **** implementation of the public API **** */
+
+int
+psy_video_create(PsyVideo** video, SeeError** error)
+{
+    const PsyVideoClass* cls = psy_video_class();
+    const SeeObjectClass* see_cls = SEE_OBJECT_CLASS(cls);
+
+    if (!cls)
+        return SEE_NOT_INITIALIZED;
+
+    if (!video || *video)
+        return SEE_INVALID_ARGUMENT;
+
+    if (!error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return see_cls->new_obj(see_cls, 0, (SeeObject**) video, error);
+}
+
+int
+psy_video_open(PsyVideo* video, const char* path, SeeError** error)
+{
+    if (!video || !path || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_VIDEO_GET_CLASS(video)->open(video, path, error);
+}
+
+void
+psy_video_close(PsyVideo* video)
+{
+    if (!video)
+        return;
+
+    PSY_VIDEO_GET_CLASS(video)->close(video);
+}
+
+int
+psy_video_preroll(PsyVideo* video, SeeError** error)
+{
+    if (!video || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_VIDEO_GET_CLASS(video)->preroll(video, error);
+}
+
+int
+psy_video_advance(PsyVideo* video, SeeError** error)
+{
+    if (!video || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_VIDEO_GET_CLASS(video)->advance(video, error);
+}
+
+void
+psy_video_set_rect(
+    PsyVideo*   video,
+    GLfloat     x,
+    GLfloat     y,
+    GLfloat     width,
+    GLfloat     height
+    )
+{
+    if (!video)
+        return;
+
+    video->rect[0] = x;
+    video->rect[1] = y;
+    video->rect[2] = width;
+    video->rect[3] = height;
+}
+
+int
+psy_video_draw(PsyVideo* video, const GLfloat* transform, SeeError** error)
+{
+    if (!video || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    return PSY_VIDEO_GET_CLASS(video)->draw(video, transform, error);
+}
+
+void
+psy_video_size(const PsyVideo* video, int* width, int* height)
+{
+    if (width)
+        *width = video ? video->width : 0;
+    if (height)
+        *height = video ? video->height : 0;
+}
+
+void
+psy_video_frame_rate(const PsyVideo* video, int* numerator, int* denominator)
+{
+    if (numerator)
+        *numerator = video ? video->rate_num : 0;
+    if (denominator)
+        *denominator = video ? video->rate_den : 0;
+}
+
+unsigned long
+psy_video_frames_shown(const PsyVideo* video)
+{
+    return video ? video->frames_shown : 0;
+}
+
+unsigned long
+psy_video_underruns(const PsyVideo* video)
+{
+    return video ? video->underruns : 0;
+}
+
+int
+psy_video_finished(const PsyVideo* video)
+{
+    VideoStream* stream;
+    int finished;
+
+    if (!video || !video->stream)
+        return 0;
+
+    stream = video->stream;
+    SDL_LockMutex(stream->mutex);
+    finished = stream->eof && stream->count == 0;
+    SDL_UnlockMutex(stream->mutex);
+
+    return finished;
+}
+
+/* **** initialization of the class **** */
+
+PsyVideoClass* g_PsyVideoClass = NULL;
+
+static int psy_video_class_init(SeeObjectClass* new_cls) {
+    int ret = SEE_SUCCESS;
+
+    /* Override the functions on the parent here */
+    new_cls->init = init;
+    new_cls->name = "PsyVideo";
+    new_cls->destroy = destroy;
+
+    /* Set the function pointers of the own class here */
+    PsyVideoClass* cls = (PsyVideoClass*) new_cls;
+
+    cls->video_init = video_init;
+    cls->open       = video_open;
+    cls->close      = video_close;
+    cls->preroll    = video_preroll;
+    cls->advance    = video_advance;
+    cls->draw       = video_draw;
+
+    return ret;
+}
+
+/**
+ * \private
+ * \brief this class initializes PsyVideo(Class).
+ *
+ * You might want to call this from the library initialization func.
+ */
+int
+psy_video_init() {
+    int ret;
+    const SeeMetaClass* meta = see_meta_class_class();
+
+    ret = see_meta_class_new_class(
+        meta,
+        (SeeObjectClass**) &g_PsyVideoClass,
+        sizeof(PsyVideoClass),
+        sizeof(PsyVideo),
+        see_object_class(),
+        sizeof(SeeObjectClass),
+        psy_video_class_init
+        );
+
+    return ret;
+}
+
+void
+psy_video_deinit()
+{
+    if(!g_PsyVideoClass)
+        return;
+
+    see_object_decref((SeeObject*) g_PsyVideoClass);
+    g_PsyVideoClass = NULL;
+}
+
+const PsyVideoClass*
+psy_video_class()
+{
+    return g_PsyVideoClass;
+}
@@ -0,0 +1,257 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file Video.h
+ * \brief Plays uncompressed 4:2:0 video from YUV4MPEG2 (.y4m) files.
+ *
+ * A reader thread streams the frames from disk into a ring of frames, so
+ * the thread that draws never waits for the disk and never decodes
+ * anything. Call psy_video_advance() once for every refresh of the
+ * display to show the next frame, the planes of the frame are uploaded as
+ * they are and converted to RGB by the fragment shader. Hence frame k of
+ * the file is shown on the k-th refresh after the first advance. When the
+ * reader couldn't keep up, the previous frame is shown again and the
+ * underrun is counted, check psy_video_underruns() after a trial.
+ *
+ * Y4M files can be made with e.g.:
+ * ffmpeg -i clip.mp4 -pix_fmt yuv420p clip.y4m
+ */
+
+#ifndef PSY_VIDEO_H
+#define PSY_VIDEO_H
+
+#include <SeeObject.h>
+#include <SeeObject-0.0/Error.h>
+
+#include "ShaderProgram.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct _PsyVideo PsyVideo;
+typedef struct _PsyVideoClass PsyVideoClass;
+
+struct _PsyVideo {
+    SeeObject parent_obj;
+
+    /*expand PsyVideo data here*/
+
+    PsyShaderProgram*       program;
+    GLuint                  planes[3];  // Y, U and V
+    GLuint                  quad_vbo;
+    GLuint                  vao;
+    GLfloat                 rect[4];
+
+    int                     width;
+    int                     height;
+    int                     rate_num;
+    int                     rate_den;
+    int                     has_frame;
+    unsigned long           frames_shown;
+    unsigned long           underruns;
+
+    struct _PsyVideoStream* stream;
+};
+
+struct _PsyVideoClass {
+    SeeObjectClass parent_cls;
+
+    int (*video_init)(
+        PsyVideo*               video,
+        const PsyVideoClass*    video_cls,
+        SeeError**              error
+        );
+
+    int (*open)(PsyVideo* video, const char* path, SeeError** error);
+
+    void (*close)(PsyVideo* video);
+
+    int (*preroll)(PsyVideo* video, SeeError** error);
+
+    int (*advance)(PsyVideo* video, SeeError** error);
+
+    int (*draw)(
+        PsyVideo*       video,
+        const GLfloat*  transform,
+        SeeError**      error
+        );
+};
+
+/* **** function style macro casts **** */
+
+/**
+ * \brief cast a pointer from a PsyVideo derived instance back to a
+ *        pointer to PsyVideo.
+ */
+#define PSY_VIDEO(obj)                      \
+    ((PsyVideo*) obj)
+
+/**
+ * \brief cast a pointer to PsyVideoClass derived class back to a
+ *        pointer to PsyVideoClass.
+ */
+#define PSY_VIDEO_CLASS(cls)                      \
+    ((const PsyVideoClass*) cls)
+
+/**
+ * \brief obtain a pointer to PsyVideoClass from a instance of
+ *        derived from PsyVideo.
+ */
+#define PSY_VIDEO_GET_CLASS(obj)                \
+    (PSY_VIDEO_CLASS(see_object_get_class(SEE_OBJECT(obj)) ) )
+
+/* **** public functions **** */
+
+/**
+ * \brief Create a new video, that has nothing to play yet.
+ *
+ * Drawing needs an OpenGL context, so create a window first.
+ *
+ * @param [out] video   The new video, should be NULL.
+ * @param [out] error   If an error occurs, it's returned here.
+ * @return SEE_SUCCESS when successful.
+ */
+PSY_EXPORT int
+psy_video_create(PsyVideo** video, SeeError** error);
+
+/**
+ * \brief Open a .y4m file and start reading frames in the background.
+ *
+ * Only 4:2:0 chroma subsampling is supported. A video that was open is
+ * closed first.
+ *
+ * @return SEE_SUCCESS when the header was read successfully.
+ */
+PSY_EXPORT int
+psy_video_open(PsyVideo* video, const char* path, SeeError** error);
+
+/**
+ * \brief Stop reading and close the file.
+ */
+PSY_EXPORT void
+psy_video_close(PsyVideo* video);
+
+/**
+ * \brief Wait until the ring of frames is full, or the whole file has
+ * been read. Call this before the timed part of a trial.
+ */
+PSY_EXPORT int
+psy_video_preroll(PsyVideo* video, SeeError** error);
+
+/**
+ * \brief Make the next frame the current one, call this once per refresh.
+ *
+ * When no frame is available, the current frame remains, and this counts
+ * as an underrun unless the end of the file has been reached.
+ *
+ * @return SEE_SUCCESS, or an error when the file turned out to be broken.
+ */
+PSY_EXPORT int
+psy_video_advance(PsyVideo* video, SeeError** error);
+
+/**
+ * \brief Set the rectangle on which the video is drawn.
+ *
+ * @param video
+ * @param x         The x-coordinate of the center.
+ * @param y         The y-coordinate of the center.
+ * @param width
+ * @param height
+ *
+ * The units are those that are mapped by the transform of psy_video_draw(),
+ * by default the video covers -1.0 to 1.0.
+ */
+PSY_EXPORT void
+psy_video_set_rect(
+    PsyVideo*   video,
+    GLfloat     x,
+    GLfloat     y,
+    GLfloat     width,
+    GLfloat     height
+    );
+
+/**
+ * \brief Draw the current frame.
+ *
+ * Nothing is drawn before the first frame has been advanced to. The
+ * texture units 0 to 2 are used for the planes.
+ *
+ * @param video
+ * @param transform A column major 4x4 matrix, or NULL for the identity.
+ * @param error
+ */
+PSY_EXPORT int
+psy_video_draw(PsyVideo* video, const GLfloat* transform, SeeError** error);
+
+/**
+ * \brief Obtain the size in pixels of the open video.
+ */
+PSY_EXPORT void
+psy_video_size(const PsyVideo* video, int* width, int* height);
+
+/**
+ * \brief Obtain the frame rate from the header of the file as a fraction.
+ */
+PSY_EXPORT void
+psy_video_frame_rate(const PsyVideo* video, int* numerator, int* denominator);
+
+/**
+ * \brief The number of frames that have been advanced to.
+ */
+PSY_EXPORT unsigned long
+psy_video_frames_shown(const PsyVideo* video);
+
+/**
+ * \brief The number of times psy_video_advance() found no frame to show.
+ */
+PSY_EXPORT unsigned long
+psy_video_underruns(const PsyVideo* video);
+
+/**
+ * \brief Returns non zero when all frames of the file have been shown.
+ */
+PSY_EXPORT int
+psy_video_finished(const PsyVideo* video);
+
+/**
+ * Gets the pointer to the PsyVideoClass table.
+ */
+PSY_EXPORT const PsyVideoClass*
+psy_video_class();
+
+/* **** class initialization functions **** */
+
+/**
+ * Initialize PsyVideo; make it ready for use.
+ */
+PSY_EXPORT
+int psy_video_init();
+
+/**
+ * Deinitialize PsyVideo, after PsyVideo has been deinitialized,
+ * all functions in this header shouldn't be used anymore.
+ */
+PSY_EXPORT
+void psy_video_deinit();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_VIDEO_H
@@ -26,8 +26,11 @@
 #include <assert.h>
 
 #include "Error.h"
+#include "Framebuffer.h"
+#include "Trace.h"
 #include "Window.h"
 #include "gl/includes_gl.h"
+#include "gl/gl_util.h"
 
 
 // constants
@@ -45,10 +48,26 @@ const PsyRect g_default_window_rect = {
 
 const char* g_default_window_name = "PsyWindow default name";
 
+static const GLfloat g_stereo_quad[4][2] = {
+    {-1.0f, -1.0f}, {1.0f, -1.0f}, {-1.0f, 1.0f}, {1.0f, 1.0f}
+};
+
 struct _WindowPrivate {
     SDL_Window*     pwin;
     SDL_GLContext   context;
     float           clear_color[4];
+    PsyTime         swap_time;
+    uint64_t        swap_count;
+    PsyDisplayList* display_list;
+    PsyMeshCache*   mesh_cache;
+    PsyGpuTimer*    gpu_timer;
+
+    // the views of both eyes drawn side by side for the composited modes
+    PsyStereoMode       stereo_mode;
+    PsyFramebuffer*     stereo_fb;
+    PsyShaderProgram*   stereo_program;
+    GLuint              stereo_vbo;
+    GLuint              stereo_vao;
 };
 
 // Set attributes for OpenGL for Embedded Systems
@@ -153,6 +172,21 @@ window_destroy(SeeObject* obj)
     PsyWindow* win = (PsyWindow*) obj;
     WindowPrivate* priv = win->window_priv;
     if (priv) {
+        // The items may hold programs, release them while the context lives.
+        if (priv->display_list)
+            see_object_decref(SEE_OBJECT(priv->display_list));
+        if (priv->mesh_cache)
+            see_object_decref(SEE_OBJECT(priv->mesh_cache));
+        if (priv->gpu_timer)
+            see_object_decref(SEE_OBJECT(priv->gpu_timer));
+        if (priv->stereo_fb)
+            see_object_decref(SEE_OBJECT(priv->stereo_fb));
+        if (priv->stereo_program)
+            see_object_decref(SEE_OBJECT(priv->stereo_program));
+        if (priv->stereo_vao)
+            glDeleteVertexArrays(1, &priv->stereo_vao);
+        if (priv->stereo_vbo)
+            glDeleteBuffers(1, &priv->stereo_vbo);
 
         SDL_GL_DeleteContext(priv->context);
         if (priv->pwin) {
@@ -193,7 +227,13 @@ window_swap_buffers(const PsyWindow* window)
     if (!(window && window->window_priv))
         return SEE_INVALID_ARGUMENT;
 
+    PSY_TRACE_BEGIN(trace);
     SDL_GL_SwapWindow(window->window_priv->pwin);
+    PSY_TRACE_END(trace, "psylib", "swap");
+    window->window_priv->swap_time = psy_time_now();
+    window->window_priv->swap_count++;
+    if (window->window_priv->gpu_timer)
+        psy_gpu_timer_next_frame(window->window_priv->gpu_timer);
     return 0;
 }
 
@@ -499,6 +539,32 @@ psy_window_swap(const PsyWindow* win)
     return win_cls->swap_buffers(win);
 }
 
+PsyTime
+psy_window_swap_time(const PsyWindow* win)
+{
+    assert(win && win->window_priv);
+    return win->window_priv->swap_time;
+}
+
+uint64_t
+psy_window_swap_count(const PsyWindow* win)
+{
+    assert(win && win->window_priv);
+    return win->window_priv->swap_count;
+}
+
+PsyTime
+psy_window_frame_duration(const PsyWindow* win)
+{
+    SDL_DisplayMode mode;
+
+    assert(win && win->window_priv);
+    if (SDL_GetWindowDisplayMode(win->window_priv->pwin, &mode) != 0 ||
+        mode.refresh_rate <= 0)
+        return 0;
+    return PSY_TIME_NS_PER_S / mode.refresh_rate;
+}
+
 int
 psy_window_id(const PsyWindow* win, uint32_t* id)
 {
@@ -543,6 +609,281 @@ psy_window_clear(
     return win_cls->clear(window);
 }
 
+int
+psy_window_display_list(
+        PsyWindow*          window,
+        PsyDisplayList**    list,
+        SeeError**          error
+        )
+{
+    WindowPrivate* priv;
+    int ret;
+
+    if (!window || !list || *list || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    priv = window->window_priv;
+    if (!priv->display_list) {
+        ret = psy_display_list_create(&priv->display_list, error);
+        if (ret)
+            return ret;
+        psy_display_list_set_gpu_timer(priv->display_list, priv->gpu_timer);
+    }
+
+    *list = priv->display_list;
+    return SEE_SUCCESS;
+}
+
+int
+psy_window_draw(
+        PsyWindow*      window,
+        const GLfloat*  transform,
+        SeeError**      error
+        )
+{
+    WindowPrivate* priv;
+
+    if (!window || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    priv = window->window_priv;
+    if (!priv->display_list)
+        return SEE_SUCCESS;
+
+    return psy_display_list_draw(priv->display_list, transform, error);
+}
+
+int
+psy_window_set_gpu_timing(
+        PsyWindow*  window,
+        int         enable,
+        SeeError**  error
+        )
+{
+    WindowPrivate* priv;
+    int ret;
+
+    if (!window || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    priv = window->window_priv;
+    if (enable && !priv->gpu_timer) {
+        ret = psy_gpu_timer_create(&priv->gpu_timer, error);
+        if (ret)
+            return ret;
+    }
+    else if (!enable && priv->gpu_timer) {
+        see_object_decref(SEE_OBJECT(priv->gpu_timer));
+        priv->gpu_timer = NULL;
+    }
+
+    if (priv->display_list)
+        psy_display_list_set_gpu_timer(priv->display_list, priv->gpu_timer);
+
+    return SEE_SUCCESS;
+}
+
+PsyGpuTimer*
+psy_window_gpu_timer(PsyWindow* window)
+{
+    assert(window && window->window_priv);
+    return window->window_priv->gpu_timer;
+}
+
+int
+psy_window_mesh_cache(
+        PsyWindow*      window,
+        PsyMeshCache**  cache,
+        SeeError**      error
+        )
+{
+    WindowPrivate* priv;
+    int ret;
+
+    if (!window || !cache || *cache || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    priv = window->window_priv;
+    if (!priv->mesh_cache) {
+        ret = psy_mesh_cache_create(&priv->mesh_cache, error);
+        if (ret)
+            return ret;
+    }
+
+    *cache = priv->mesh_cache;
+    return SEE_SUCCESS;
+}
+
+int
+psy_window_set_stereo_mode(
+        PsyWindow*      window,
+        PsyStereoMode   mode,
+        SeeError**      error
+        )
+{
+    if (!window || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+    if (mode < PSY_STEREO_NONE || mode > PSY_STEREO_ANAGLYPH)
+        return SEE_INVALID_ARGUMENT;
+
+    window->window_priv->stereo_mode = mode;
+    return SEE_SUCCESS;
+}
+
+PsyStereoMode
+psy_window_stereo_mode(const PsyWindow* window)
+{
+    assert(window);
+    return window->window_priv->stereo_mode;
+}
+
+void
+psy_window_stereo_eyes(
+        const PsyWindow*    window,
+        const GLfloat*      left,
+        const GLfloat*      right,
+        PsyStereoEyes*      eyes
+        )
+{
+    assert(window && eyes);
+    psy_stereo_eyes(window->window_priv->stereo_mode, left, right, eyes);
+}
+
+int
+psy_window_stereo_begin(
+        PsyWindow*  window,
+        SeeError**  error
+        )
+{
+    WindowPrivate* priv;
+    int w, h, fb_w, fb_h;
+    int ret;
+
+    if (!window || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    priv = window->window_priv;
+    if (!psy_stereo_is_composited(priv->stereo_mode))
+        return SEE_SUCCESS;
+
+    // Each eye gets the full resolution of the window.
+    SDL_GL_GetDrawableSize(priv->pwin, &w, &h);
+    if (!priv->stereo_fb) {
+        ret = psy_framebuffer_create(
+            &priv->stereo_fb, 2 * w, h, PSY_FRAMEBUFFER_RGBA8, 0, error
+            );
+        if (ret)
+            return ret;
+        psy_framebuffer_set_filter(priv->stereo_fb, GL_NEAREST);
+    }
+    else {
+        psy_framebuffer_size(priv->stereo_fb, &fb_w, &fb_h);
+        if (fb_w != 2 * w || fb_h != h) {
+            ret = psy_framebuffer_resize(priv->stereo_fb, 2 * w, h, error);
+            if (ret)
+                return ret;
+        }
+    }
+
+    psy_framebuffer_bind(priv->stereo_fb);
+    glClearColor(
+        priv->clear_color[0],
+        priv->clear_color[1],
+        priv->clear_color[2],
+        priv->clear_color[3]
+        );
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    return SEE_SUCCESS;
+}
+
+int
+psy_window_stereo_end(
+        PsyWindow*  window,
+        SeeError**  error
+        )
+{
+    WindowPrivate* priv;
+    GLint location = -1;
+    GLboolean blend;
+    int ret;
+
+    if (!window || !error || *error)
+        return SEE_INVALID_ARGUMENT;
+
+    priv = window->window_priv;
+    if (!psy_stereo_is_composited(priv->stereo_mode) || !priv->stereo_fb)
+        return SEE_SUCCESS;
+
+    psy_framebuffer_unbind(priv->stereo_fb);
+
+    if (!priv->stereo_program) {
+        ret = psy_shader_program_create_builtin(
+            &priv->stereo_program, "blit", "stereo", error
+            );
+        if (ret)
+            return ret;
+
+        if (psy_gl_has_vertex_arrays()) {
+            glGenVertexArrays(1, &priv->stereo_vao);
+            glBindVertexArray(priv->stereo_vao);
+        }
+        glGenBuffers(1, &priv->stereo_vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, priv->stereo_vbo);
+        glBufferData(
+            GL_ARRAY_BUFFER, sizeof(g_stereo_quad), g_stereo_quad, GL_STATIC_DRAW
+            );
+        location = psy_shader_program_attribute_location(
+            priv->stereo_program, "a_position"
+            );
+        if (location >= 0) {
+            glEnableVertexAttribArray((GLuint) location);
+            glVertexAttribPointer((GLuint) location, 2, GL_FLOAT, GL_FALSE, 0, 0);
+        }
+    }
+    else if (priv->stereo_vao) {
+        glBindVertexArray(priv->stereo_vao);
+    }
+    else {
+        location = psy_shader_program_attribute_location(
+            priv->stereo_program, "a_position"
+            );
+        glBindBuffer(GL_ARRAY_BUFFER, priv->stereo_vbo);
+        if (location >= 0) {
+            glEnableVertexAttribArray((GLuint) location);
+            glVertexAttribPointer((GLuint) location, 2, GL_FLOAT, GL_FALSE, 0, 0);
+        }
+    }
+
+    ret = psy_shader_use_program(priv->stereo_program, error);
+    if (ret)
+        return ret;
+    glUniform1i(
+        psy_shader_program_uniform_location(priv->stereo_program, "u_texture"),
+        0
+        );
+    glUniform1i(
+        psy_shader_program_uniform_location(priv->stereo_program, "u_mode"),
+        priv->stereo_mode == PSY_STEREO_ROW_INTERLEAVED ? 0 : 1
+        );
+    psy_gl_bind_texture(
+        0, GL_TEXTURE_2D, psy_framebuffer_texture(priv->stereo_fb)
+        );
+
+    blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_BLEND);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    if (blend)
+        glEnable(GL_BLEND);
+
+    if (priv->stereo_vao)
+        glBindVertexArray(0);
+    else
+        psy_gl_disable_attributes(&location, 1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return SEE_SUCCESS;
+}
 
 /* **** Class management **** */
 
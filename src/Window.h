@@ -27,6 +27,11 @@
 #include <psy_export.h>
 #include <stdint.h>
 #include "Error.h"
+#include "DisplayList.h"
+#include "GpuTimer.h"
+#include "MeshCache.h"
+#include "Stereo.h"
+#include "Time.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -306,6 +311,32 @@ psy_window_hide(PsyWindow* win);
 PSY_EXPORT int
 psy_window_swap(const PsyWindow* window);
 
+/**
+ * \brief The time at which the last call to psy_window_swap() returned.
+ *
+ * The time is taken from psy_time_now() directly after the swap, with vsync
+ * enabled it's the closest psylib gets to the moment the frame became
+ * visible. It's 0 before the first swap.
+ */
+PSY_EXPORT PsyTime
+psy_window_swap_time(const PsyWindow* window);
+
+/**
+ * \brief The number of times psy_window_swap() has been called, the flip
+ * counter of the window.
+ */
+PSY_EXPORT uint64_t
+psy_window_swap_count(const PsyWindow* window);
+
+/**
+ * \brief The duration of one refresh of the display the window is on.
+ *
+ * @return The duration in nanoseconds, or 0 when SDL doesn't know the
+ *         refresh rate.
+ */
+PSY_EXPORT PsyTime
+psy_window_frame_duration(const PsyWindow* window);
+
 
 /**
  * Return the window id of the window.
@@ -346,6 +377,152 @@ PSY_EXPORT int psy_window_set_clear_color(
  */
 PSY_EXPORT int psy_window_clear(PsyWindow* window);
 
+/**
+ * @brief Obtain the display list of the window.
+ *
+ * The stimuli that are shown each frame may register with this list,
+ * psy_window_draw() draws them sorted by layer, program and texture. The
+ * list is created the first time it's asked for and belongs to the
+ * window.
+ *
+ * @param [in]  window
+ * @param [out] list    The list of the window, should be NULL.
+ * @param [out] error   If the list can't be created, the error is returned
+ *                      here.
+ * return SEE_SUCCESS, SEE_INVALID_ARGUMENT
+ */
+PSY_EXPORT int psy_window_display_list(
+        PsyWindow*          window,
+        PsyDisplayList**    list,
+        SeeError**          error
+        );
+
+/**
+ * @brief Draws the display list of the window, if it has one.
+ *
+ * @param [in]  window
+ * @param [in]  transform   Passed to the items of the list, may be NULL.
+ * @param [out] error
+ *
+ * return SEE_SUCCESS, SEE_INVALID_ARGUMENT
+ */
+PSY_EXPORT int psy_window_draw(
+        PsyWindow*      window,
+        const GLfloat*  transform,
+        SeeError**      error
+        );
+
+/**
+ * @brief Measure how long the gpu spends on the items of the display list.
+ *
+ * When enabled, every item of the display list of the window is timed in
+ * a PsyGpuTimer and the timer advances a frame each time the window is
+ * swapped. The results of a frame are read a few frames later, so timing
+ * never stalls the pipeline. Without timer queries (OpenGL ES) the timer
+ * is created, but psy_gpu_timer_supported() returns false.
+ *
+ * @param [in]  window
+ * @param [in]  enable  non zero to start timing, 0 releases the timer.
+ * @param [out] error
+ *
+ * return SEE_SUCCESS, SEE_INVALID_ARGUMENT
+ */
+PSY_EXPORT int psy_window_set_gpu_timing(
+        PsyWindow*  window,
+        int         enable,
+        SeeError**  error
+        );
+
+/**
+ * @brief The gpu timer of the window, NULL when gpu timing isn't enabled.
+ *
+ * Other work, e.g. a PsyPostChain, may be timed in the same timer.
+ */
+PSY_EXPORT PsyGpuTimer* psy_window_gpu_timer(PsyWindow* window);
+
+/**
+ * @brief Obtain the cache with the meshes of primitives for this window.
+ *
+ * The cache is created the first time it's asked for and belongs to the
+ * window; its meshes are released with the OpenGL context.
+ *
+ * @param [in]  window
+ * @param [out] cache   The cache of the window, should be NULL.
+ * @param [out] error   If the cache can't be created, the error is
+ *                      returned here.
+ * return SEE_SUCCESS, SEE_INVALID_ARGUMENT
+ */
+PSY_EXPORT int psy_window_mesh_cache(
+        PsyWindow*      window,
+        PsyMeshCache**  cache,
+        SeeError**      error
+        );
+
+/**
+ * @brief Set how the window presents the views of the two eyes.
+ *
+ * The side-by-side and top-bottom modes are drawn into the window
+ * directly, the row-interleaved and anaglyph modes are drawn side by side
+ * between psy_window_stereo_begin() and psy_window_stereo_end().
+ *
+ * @param [in]  window
+ * @param [in]  mode
+ * @param [out] error
+ * return SEE_SUCCESS, SEE_INVALID_ARGUMENT
+ */
+PSY_EXPORT int psy_window_set_stereo_mode(
+        PsyWindow*      window,
+        PsyStereoMode   mode,
+        SeeError**      error
+        );
+
+/**
+ * @brief Obtain the stereo mode of the window, PSY_STEREO_NONE by default.
+ */
+PSY_EXPORT PsyStereoMode psy_window_stereo_mode(const PsyWindow* window);
+
+/**
+ * @brief Compute the transforms of the eyes for the stereo mode of the
+ * window, see psy_stereo_eyes().
+ */
+PSY_EXPORT void psy_window_stereo_eyes(
+        const PsyWindow*    window,
+        const GLfloat*      left,
+        const GLfloat*      right,
+        PsyStereoEyes*      eyes
+        );
+
+/**
+ * @brief Start drawing both eyes.
+ *
+ * For the composited modes the following drawing goes to a framebuffer
+ * that's twice as wide as the window and it's cleared. The other modes
+ * draw into the window and nothing happens here.
+ *
+ * @param [in]  window
+ * @param [out] error
+ * return SEE_SUCCESS, SEE_INVALID_ARGUMENT
+ */
+PSY_EXPORT int psy_window_stereo_begin(
+        PsyWindow*  window,
+        SeeError**  error
+        );
+
+/**
+ * @brief Finish drawing both eyes.
+ *
+ * For the composited modes the halves of the framebuffer are combined
+ * into the window with one full screen pass.
+ *
+ * @param [in]  window
+ * @param [out] error
+ * return SEE_SUCCESS, SEE_INVALID_ARGUMENT
+ */
+PSY_EXPORT int psy_window_stereo_end(
+        PsyWindow*  window,
+        SeeError**  error
+        );
+
 /* *** class related functions *** */
 
 /**
@@ -0,0 +1,174 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <SDL2/SDL.h>
+#include "gl_util.h"
+
+typedef struct GLStateCache {
+    int                 enabled;
+    int                 program_known;
+    GLuint              program;
+    int                 unit_known;
+    GLuint              active_unit;
+    int                 texture_known[PSY_GL_CACHED_TEXTURE_UNITS];
+    GLenum              targets[PSY_GL_CACHED_TEXTURE_UNITS];
+    GLuint              textures[PSY_GL_CACHED_TEXTURE_UNITS];
+    PsyGLStateCounters  counters;
+} GLStateCache;
+
+static GLStateCache g_state;
+
+int
+psy_gl_context_is_es(void)
+{
+    static const char prefix[] = "OpenGL ES";
+    const char* version = (const char*) glGetString(GL_VERSION);
+
+    if (!version)
+        return 0;
+
+    return strncmp(version, prefix, sizeof(prefix) - 1) == 0;
+}
+
+int
+psy_gl_has_instancing(void)
+{
+    return GLAD_GL_VERSION_3_3 && !psy_gl_context_is_es();
+}
+
+int
+psy_gl_has_timer_queries(void)
+{
+    return GLAD_GL_VERSION_3_3 && !psy_gl_context_is_es();
+}
+
+int
+psy_gl_has_vertex_arrays(void)
+{
+    return GLAD_GL_VERSION_3_0 && !psy_gl_context_is_es();
+}
+
+int
+psy_gl_has_pixel_buffers(void)
+{
+    return GLAD_GL_VERSION_3_2 && !psy_gl_context_is_es();
+}
+
+int
+psy_gl_has_texture_arrays(void)
+{
+    return GLAD_GL_VERSION_3_0 && !psy_gl_context_is_es();
+}
+
+PsyGLBufferStorageProc
+psy_gl_buffer_storage(void)
+{
+    PsyGLBufferStorageProc proc = NULL;
+    void* address;
+
+    if (psy_gl_context_is_es() || !GLAD_GL_VERSION_3_0)
+        return NULL;
+    if (!SDL_GL_ExtensionSupported("GL_ARB_buffer_storage"))
+        return NULL;
+
+    // ISO C has no cast from a void* to a function pointer, POSIX and
+    // Windows guarantee they have the same representation.
+    address = SDL_GL_GetProcAddress("glBufferStorage");
+    memcpy(&proc, &address, sizeof(proc));
+    return proc;
+}
+
+void
+psy_gl_disable_attributes(const GLint* locations, size_t num_locations)
+{
+    for (size_t i = 0; i < num_locations; i++)
+        if (locations[i] >= 0)
+            glDisableVertexAttribArray((GLuint) locations[i]);
+}
+
+void
+psy_gl_state_cache_begin(void)
+{
+    psy_gl_state_forget();
+    g_state.enabled = 1;
+}
+
+void
+psy_gl_state_cache_end(void)
+{
+    psy_gl_active_texture(0);
+    g_state.enabled = 0;
+    psy_gl_state_forget();
+}
+
+void
+psy_gl_state_forget(void)
+{
+    g_state.program_known = 0;
+    g_state.unit_known = 0;
+    memset(g_state.texture_known, 0, sizeof(g_state.texture_known));
+}
+
+void
+psy_gl_use_program(GLuint program)
+{
+    if (g_state.enabled && g_state.program_known && g_state.program == program)
+        return;
+
+    glUseProgram(program);
+    g_state.counters.program_changes++;
+    g_state.program = program;
+    g_state.program_known = 1;
+}
+
+void
+psy_gl_active_texture(GLuint unit)
+{
+    if (g_state.enabled && g_state.unit_known && g_state.active_unit == unit)
+        return;
+
+    glActiveTexture(GL_TEXTURE0 + unit);
+    g_state.active_unit = unit;
+    g_state.unit_known = 1;
+}
+
+void
+psy_gl_bind_texture(GLuint unit, GLenum target, GLuint texture)
+{
+    int cached = unit < PSY_GL_CACHED_TEXTURE_UNITS;
+
+    if (g_state.enabled && cached && g_state.texture_known[unit] &&
+        g_state.targets[unit] == target && g_state.textures[unit] == texture)
+        return;
+
+    psy_gl_active_texture(unit);
+    glBindTexture(target, texture);
+    g_state.counters.texture_changes++;
+
+    if (cached) {
+        g_state.targets[unit] = target;
+        g_state.textures[unit] = texture;
+        g_state.texture_known[unit] = 1;
+    }
+}
+
+void
+psy_gl_state_counters(PsyGLStateCounters* counters)
+{
+    *counters = g_state.counters;
+}
@@ -0,0 +1,186 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * \file gl_util.h
+ * \brief Small utilities to query the current OpenGL context.
+ * \private
+ */
+
+#ifndef PSY_GL_UTIL_H
+#define PSY_GL_UTIL_H
+
+#include <stddef.h>
+#include "includes_gl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Returns non zero when the current context is an OpenGL ES context.
+ *
+ * Make sure there is a current context, typically psylib has one once a
+ * PsyWindow is created.
+ */
+int
+psy_gl_context_is_es(void);
+
+/**
+ * \brief Returns non zero when instanced drawing is available.
+ *
+ * Instancing (glDrawArraysInstanced together with glVertexAttribDivisor) is
+ * used with OpenGL 3.3 and up. On OpenGL ES 2.0, e.g. on the Raspberry Pi,
+ * the callers should fall back to expanding the instances on the CPU.
+ */
+int
+psy_gl_has_instancing(void);
+
+/**
+ * \brief Returns non zero when vertex array objects are available.
+ *
+ * A core profile cannot draw without a bound vertex array object, whereas
+ * OpenGL ES 2.0 doesn't have them.
+ */
+int
+psy_gl_has_vertex_arrays(void);
+
+/**
+ * \brief Returns non zero when GL_TIMESTAMP queries are available.
+ *
+ * Timer queries are core in OpenGL 3.3, OpenGL ES 2.0 only has them as an
+ * extension that the Raspberry Pi doesn't offer.
+ */
+int
+psy_gl_has_timer_queries(void);
+
+/**
+ * \brief Returns non zero when pixel buffers can be streamed asynchronously.
+ *
+ * This requires pixel buffer objects, glMapBufferRange and fence sync
+ * objects, hence OpenGL 3.2. OpenGL ES 2.0 has none of them.
+ */
+int
+psy_gl_has_pixel_buffers(void);
+
+/**
+ * \brief Returns non zero when GL_TEXTURE_2D_ARRAY is available.
+ *
+ * Texture arrays are core since OpenGL 3.0, OpenGL ES 2.0 doesn't have them.
+ */
+int
+psy_gl_has_texture_arrays(void);
+
+/*
+ * ARB_buffer_storage is core in OpenGL 4.4, glad is generated for 3.3, so
+ * the function and its flags are defined here.
+ */
+#define PSY_GL_MAP_PERSISTENT_BIT   0x0040
+#define PSY_GL_MAP_COHERENT_BIT     0x0080
+
+typedef void (APIENTRYP PsyGLBufferStorageProc)(
+    GLenum          target,
+    GLsizeiptr      size,
+    const void*     data,
+    GLbitfield      flags
+    );
+
+/**
+ * \brief Returns glBufferStorage when the context supports
+ * ARB_buffer_storage, NULL otherwise.
+ */
+PsyGLBufferStorageProc
+psy_gl_buffer_storage(void);
+
+/**
+ * \brief glDisableVertexAttribArray for the locations that are >= 0.
+ *
+ * Without a vertex array object, as on OpenGL ES 2.0, the enabled arrays
+ * are global state. A draw disables the arrays it enabled, otherwise the
+ * next draw reads them too, from a buffer that may no longer exist.
+ */
+void
+psy_gl_disable_attributes(const GLint* locations, size_t num_locations);
+
+/*
+ * A cache of the program and texture bindings. While it's enabled, the
+ * functions below don't call OpenGL when the state is already what is
+ * asked for. Outside psy_gl_state_cache_begin() and
+ * psy_gl_state_cache_end() they always call OpenGL, because code that
+ * uses OpenGL directly invalidates whatever the cache knows.
+ */
+
+/** The number of texture units whose bindings are cached. */
+#define PSY_GL_CACHED_TEXTURE_UNITS 16
+
+/**
+ * \brief Counts of the state changes that reached OpenGL.
+ */
+typedef struct PsyGLStateCounters {
+    unsigned long program_changes;
+    unsigned long texture_changes;
+} PsyGLStateCounters;
+
+/**
+ * \brief Start caching, everything that was cached before is forgotten.
+ */
+void
+psy_gl_state_cache_begin(void);
+
+/**
+ * \brief Stop caching and make texture unit 0 the active unit again.
+ */
+void
+psy_gl_state_cache_end(void);
+
+/**
+ * \brief Forget the cached state, e.g. after binding with OpenGL directly.
+ */
+void
+psy_gl_state_forget(void);
+
+/**
+ * \brief glUseProgram, unless program is in use already.
+ */
+void
+psy_gl_use_program(GLuint program);
+
+/**
+ * \brief glActiveTexture, unless unit is the active unit already.
+ *
+ * @param unit The number of the unit, so 0 for GL_TEXTURE0.
+ */
+void
+psy_gl_active_texture(GLuint unit);
+
+/**
+ * \brief Bind texture to target of unit, unless it's bound already.
+ */
+void
+psy_gl_bind_texture(GLuint unit, GLenum target, GLuint texture);
+
+/**
+ * \brief Obtain the counts of the changes that weren't skipped.
+ */
+void
+psy_gl_state_counters(PsyGLStateCounters* counters);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //ifndef PSY_GL_UTIL_H
@@ -15,6 +15,7 @@
  * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "psy_config.h"
 #include "psy_init.h"
 #include <see_init.h>
 #include "Error.h"
@@ -22,9 +23,36 @@
 #include "Window.h"
 #include "Shader.h"
 #include "ShaderProgram.h"
+#include "ShaderReload.h"
+#include "ShapeBatch.h"
+#include "Rdk.h"
+#include "Grating.h"
+#include "ImageLoader.h"
+#include "Texture.h"
+#include "ImageSet.h"
+#include "Video.h"
+#include "Font.h"
+#include "Text.h"
+#include "StreamBuffer.h"
+#include "DisplayList.h"
+#include "CommandBuffer.h"
+#include "Framebuffer.h"
+#include "FrameCache.h"
+#include "Noise.h"
+#include "PostChain.h"
+#include "Mesh.h"
+#include "MeshCache.h"
+#include "Realtime.h"
+#include "Timeline.h"
+#include "Trace.h"
+#include "GpuTimer.h"
 #include <assert.h>
 #include <SDL2/SDL.h>
 
+#if defined(HAVE_SDL_TTF)
+#include <SDL2/SDL_ttf.h>
+#endif
+
 static void
 generate_sdl_error(PsyError** error)
 {
@@ -108,6 +136,9 @@ init_sdl(PsyError** error)
 static void
 deinit_external_libs()
 {
+#if defined(HAVE_SDL_TTF)
+    TTF_Quit();
+#endif
     SDL_Quit();
 }
 
@@ -123,6 +154,14 @@ init_external_libs(PsyError** error)
 
     // INIT ... library.
 
+#if defined(HAVE_SDL_TTF)
+    // SDL_ttf rasterizes the glyphs of PsyFont.
+    if (TTF_Init()) {
+        generate_sdl_error(error);
+        return 1;
+    }
+#endif
+
     return ret;
 }
 
@@ -142,6 +181,44 @@ int psylib_init(PsyError** error)
         return ret;
     if ((ret = psy_shader_program_init()) != 0)
         return ret;
+    if ((ret = psy_shape_batch_init()) != 0)
+        return ret;
+    if ((ret = psy_rdk_init()) != 0)
+        return ret;
+    if ((ret = psy_grating_init()) != 0)
+        return ret;
+    if ((ret = psy_texture_init()) != 0)
+        return ret;
+    if ((ret = psy_image_set_init()) != 0)
+        return ret;
+    if ((ret = psy_video_init()) != 0)
+        return ret;
+    if ((ret = psy_font_init()) != 0)
+        return ret;
+    if ((ret = psy_text_init()) != 0)
+        return ret;
+    if ((ret = psy_stream_buffer_init()) != 0)
+        return ret;
+    if ((ret = psy_display_list_init()) != 0)
+        return ret;
+    if ((ret = psy_command_buffer_init()) != 0)
+        return ret;
+    if ((ret = psy_framebuffer_init()) != 0)
+        return ret;
+    if ((ret = psy_frame_cache_init()) != 0)
+        return ret;
+    if ((ret = psy_noise_init()) != 0)
+        return ret;
+    if ((ret = psy_post_chain_init()) != 0)
+        return ret;
+    if ((ret = psy_mesh_init()) != 0)
+        return ret;
+    if ((ret = psy_mesh_cache_init()) != 0)
+        return ret;
+    if ((ret = psy_timeline_init()) != 0)
+        return ret;
+    if ((ret = psy_gpu_timer_init()) != 0)
+        return ret;
     if ((ret = psy_window_init()) != 0)
         return ret;
 
@@ -153,11 +230,34 @@ int psylib_init(PsyError** error)
 
 void psylib_deinit()
 {
+    psy_shader_reload_disable();
+    psy_realtime_disable();
+    psy_image_loader_stop();
+    psy_trace_free();
     deinit_external_libs();
 
     psy_error_deinit();
     psy_glerror_deinit();
     psy_shader_deinit();
     psy_shader_program_deinit();
+    psy_shape_batch_deinit();
+    psy_rdk_deinit();
+    psy_grating_deinit();
+    psy_texture_deinit();
+    psy_image_set_deinit();
+    psy_video_deinit();
+    psy_font_deinit();
+    psy_text_deinit();
+    psy_stream_buffer_deinit();
+    psy_display_list_deinit();
+    psy_command_buffer_deinit();
+    psy_framebuffer_deinit();
+    psy_frame_cache_deinit();
+    psy_noise_deinit();
+    psy_post_chain_deinit();
+    psy_mesh_deinit();
+    psy_mesh_cache_deinit();
+    psy_timeline_deinit();
+    psy_gpu_timer_deinit();
     psy_window_deinit();
 }
@@ -0,0 +1,54 @@
+#version 330 core
+
+// Evaluates the stimuli of a PsyGrating. v_position is relative to the
+// center of the stimulus in the frame of the stimulus, so the luminance of
+// a grating varies along x. The kinds match PsyGratingKind:
+// 0 = sine, 1 = square, 2 = gabor, 3 = plaid, 4 = radial checkerboard.
+// When sigma > 0 the stimulus is multiplied with a gaussian envelope.
+
+in vec2 v_position;
+in vec4 v_wave;
+in vec3 v_extra;
+in float v_radius;
+
+uniform vec4 u_mean;
+uniform vec4 u_amplitude;
+
+out vec4 frag_color;
+
+const float TWO_PI = 6.28318530718;
+
+void main()
+{
+    float frequency = v_wave.x;
+    float phase = v_wave.y;
+    float contrast = v_wave.z;
+    float sigma = v_wave.w;
+    int kind = int(v_extra.z + 0.5);
+    float r = length(v_position);
+    float value;
+
+    if (kind == 3) {
+        float angle = v_extra.x;
+        float x2 = dot(v_position, vec2(cos(angle), sin(angle)));
+        value = 0.5 * (sin(TWO_PI * frequency * v_position.x + phase) +
+                       sin(TWO_PI * frequency * x2 + phase));
+    }
+    else if (kind == 4) {
+        if (r > v_radius)
+            discard;
+        float theta = atan(v_position.y, v_position.x);
+        value = sign(sin(TWO_PI * frequency * r + phase) *
+                     sin(0.5 * v_extra.y * theta));
+    }
+    else {
+        value = sin(TWO_PI * frequency * v_position.x + phase);
+        if (kind == 1)
+            value = sign(value);
+    }
+
+    if (sigma > 0.0)
+        value *= exp(-(r * r) / (2.0 * sigma * sigma));
+
+    frag_color = u_mean + contrast * value * u_amplitude;
+}
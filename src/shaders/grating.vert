@@ -0,0 +1,32 @@
+#version 330 core
+
+// Places the quads of a PsyGrating, one instance per stimulus.
+// a_geometry: x, y, size and orientation (radians) of the quad
+// a_wave:     spatial frequency, phase (radians), contrast and sigma
+// a_extra:    plaid angle (radians), number of segments and the kind
+
+layout (location = 0) in vec2 a_corner;
+layout (location = 1) in vec4 a_geometry;
+layout (location = 2) in vec4 a_wave;
+layout (location = 3) in vec3 a_extra;
+
+uniform mat4 u_transform;
+
+out vec2 v_position;
+out vec4 v_wave;
+out vec3 v_extra;
+out float v_radius;
+
+void main()
+{
+    float angle = a_geometry.w;
+    mat2 rotation = mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+    vec2 local = a_corner * a_geometry.z;
+
+    gl_Position = u_transform * vec4(a_geometry.xy + rotation * local,
+                                     0.0, 1.0);
+    v_position = local;
+    v_wave = a_wave;
+    v_extra = a_extra;
+    v_radius = 0.5 * a_geometry.z;
+}
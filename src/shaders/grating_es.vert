@@ -0,0 +1,30 @@
+#version 100
+
+// Places the quads of a PsyGrating, see grating.vert. Without instancing
+// every vertex carries the attributes of its stimulus.
+
+attribute vec2 a_corner;
+attribute vec4 a_geometry;
+attribute vec4 a_wave;
+attribute vec3 a_extra;
+
+uniform mat4 u_transform;
+
+varying vec2 v_position;
+varying vec4 v_wave;
+varying vec3 v_extra;
+varying float v_radius;
+
+void main()
+{
+    float angle = a_geometry.w;
+    mat2 rotation = mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+    vec2 local = a_corner * a_geometry.z;
+
+    gl_Position = u_transform * vec4(a_geometry.xy + rotation * local,
+                                     0.0, 1.0);
+    v_position = local;
+    v_wave = a_wave;
+    v_extra = a_extra;
+    v_radius = 0.5 * a_geometry.z;
+}
@@ -0,0 +1,87 @@
+#version 330 core
+
+// Generates the noise of a PsyNoise.
+// u_kind:      0 white, 1 binary, 2 octaves (pink and band-pass)
+// u_octaves:   the first and last octave that are summed, octave k is
+//              gaussian noise on a lattice of 2^k pixels, interpolated
+//              smoothly. Each octave gets the same variance, which gives
+//              a 1/f amplitude spectrum over the range of the octaves.
+// The values are approximately gaussian with a standard deviation of
+// u_contrast around u_mean.
+
+const int MAX_OCTAVES = 13;
+
+// The average variance of an octave above 0, due to the interpolation.
+const float INTERPOLATED_VARIANCE = 0.5518;
+
+uniform int   u_kind;
+uniform uint  u_seed;
+uniform ivec2 u_octaves;
+uniform float u_mean;
+uniform float u_contrast;
+
+out vec4 frag_color;
+
+// A counter based hash, every cell of every octave has its own numbers.
+uint hash(uint x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+float uniform01(uvec2 cell, uint stream)
+{
+    uint h = hash(cell.x ^ hash(cell.y ^ hash(stream ^ hash(u_seed))));
+    return (float(h >> 8) + 0.5) / 16777216.0;
+}
+
+float gaussian(uvec2 cell, uint octave)
+{
+    float u1 = uniform01(cell, 2u * octave);
+    float u2 = uniform01(cell, 2u * octave + 1u);
+    return sqrt(-2.0 * log(u1)) * cos(6.28318530718 * u2);
+}
+
+float octave_noise(vec2 pixel, int octave)
+{
+    // The pixel centers of octave 0 are on the lattice.
+    vec2 p = pixel / exp2(float(octave)) - 0.5;
+    vec2 i = floor(p);
+    vec2 f = p - i;
+    uvec2 c = uvec2(ivec2(i) + 65536);
+    uint o = uint(octave);
+
+    f = f * f * (3.0 - 2.0 * f);
+    return mix(
+        mix(gaussian(c, o), gaussian(c + uvec2(1u, 0u), o), f.x),
+        mix(gaussian(c + uvec2(0u, 1u), o), gaussian(c + uvec2(1u, 1u), o), f.x),
+        f.y
+        );
+}
+
+void main()
+{
+    vec2 pixel = gl_FragCoord.xy;
+    float value;
+
+    if (u_kind < 2) {
+        value = gaussian(uvec2(pixel), 0u);
+        if (u_kind == 1)
+            value = value < 0.0 ? -1.0 : 1.0;
+    }
+    else {
+        float variance = 0.0;
+        value = 0.0;
+        for (int k = u_octaves.x; k <= u_octaves.y && k < MAX_OCTAVES; k++) {
+            value += octave_noise(pixel, k);
+            variance += k == 0 ? 1.0 : INTERPOLATED_VARIANCE;
+        }
+        value /= sqrt(max(variance, 1.0e-6));
+    }
+
+    frag_color = vec4(vec3(u_mean + u_contrast * value), 1.0);
+}
@@ -0,0 +1,10 @@
+#version 330 core
+
+// Covers the framebuffer of a PsyNoise, see noise.frag.
+
+layout (location = 0) in vec2 a_position;
+
+void main()
+{
+    gl_Position = vec4(a_position, 0.0, 1.0);
+}
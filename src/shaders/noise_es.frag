@@ -0,0 +1,75 @@
+#version 100
+
+// Generates the noise of a PsyNoise, see noise.frag. GLSL ES 1.00 has no
+// unsigned integers, so the hash is made of floats, the noise differs from
+// the one of noise.frag for the same seed.
+
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+
+const int MAX_OCTAVES = 13;
+
+const float INTERPOLATED_VARIANCE = 0.5518;
+
+uniform int   u_kind;
+uniform float u_seed;
+uniform ivec2 u_octaves;
+uniform float u_mean;
+uniform float u_contrast;
+
+float uniform01(vec2 cell, float stream)
+{
+    vec3 p = fract(vec3(cell, stream + u_seed) * vec3(0.1031, 0.1030, 0.0973));
+    p += dot(p, p.yxz + 33.33);
+    return clamp(fract((p.x + p.y) * p.z), 1.0e-6, 1.0);
+}
+
+float gaussian(vec2 cell, float octave)
+{
+    float u1 = uniform01(cell, 2.0 * octave);
+    float u2 = uniform01(cell, 2.0 * octave + 1.0);
+    return sqrt(-2.0 * log(u1)) * cos(6.28318530718 * u2);
+}
+
+float octave_noise(vec2 pixel, int octave)
+{
+    vec2 p = pixel / exp2(float(octave)) - 0.5;
+    vec2 i = floor(p);
+    vec2 f = p - i;
+    float o = float(octave);
+
+    f = f * f * (3.0 - 2.0 * f);
+    return mix(
+        mix(gaussian(i, o), gaussian(i + vec2(1.0, 0.0), o), f.x),
+        mix(gaussian(i + vec2(0.0, 1.0), o), gaussian(i + vec2(1.0, 1.0), o), f.x),
+        f.y
+        );
+}
+
+void main()
+{
+    vec2 pixel = gl_FragCoord.xy;
+    float value = 0.0;
+
+    if (u_kind < 2) {
+        value = gaussian(floor(pixel), 0.0);
+        if (u_kind == 1)
+            value = value < 0.0 ? -1.0 : 1.0;
+    }
+    else {
+        float variance = 0.0;
+        // Loops need a constant bound in GLSL ES 1.00.
+        for (int k = 0; k < MAX_OCTAVES; k++) {
+            if (k < u_octaves.x || k > u_octaves.y)
+                continue;
+            value += octave_noise(pixel, k);
+            variance += k == 0 ? 1.0 : INTERPOLATED_VARIANCE;
+        }
+        value /= sqrt(max(variance, 1.0e-6));
+    }
+
+    gl_FragColor = vec4(vec3(u_mean + u_contrast * value), 1.0);
+}
@@ -0,0 +1,15 @@
+#version 330 core
+
+// Draws a round dot in a point sprite, see rdk.vert.
+
+uniform vec4 u_color;
+
+out vec4 frag_color;
+
+void main()
+{
+    vec2 uv = 2.0 * gl_PointCoord - 1.0;
+    if (dot(uv, uv) > 1.0)
+        discard;
+    frag_color = u_color;
+}
@@ -0,0 +1,18 @@
+#version 330 core
+
+// Draws the dots of a PsyRdk as point sprites. The positions are in
+// the aperture, a unit circle that is placed with u_center and u_radius.
+
+layout (location = 0) in vec2 a_position;
+
+uniform mat4 u_transform;
+uniform vec2 u_center;
+uniform float u_radius;
+uniform float u_dot_size;
+
+void main()
+{
+    gl_Position = u_transform * vec4(u_center + u_radius * a_position,
+                                     0.0, 1.0);
+    gl_PointSize = u_dot_size;
+}
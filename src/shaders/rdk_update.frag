@@ -0,0 +1,11 @@
+#version 330 core
+
+// Nothing is rasterized while the dots of a PsyRdk are updated, but a
+// program needs a fragment shader to link.
+
+out vec4 frag_color;
+
+void main()
+{
+    frag_color = vec4(0.0);
+}
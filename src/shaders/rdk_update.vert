@@ -0,0 +1,75 @@
+#version 330 core
+
+// Advances the dots of a PsyRdk by one frame, the results are captured with
+// transform feedback. Every dot has a position in the aperture (radius 1),
+// the number of frames it has left to live, a number that selects whether
+// it moves coherently and the direction it moves in when it doesn't.
+// The random numbers depend only on the seed, the frame and the dot, so a
+// sequence of frames is reproducible.
+
+layout (location = 0) in vec2 a_position;
+layout (location = 1) in float a_age;
+layout (location = 2) in float a_select;
+layout (location = 3) in float a_noise_direction;
+
+uniform uint u_seed;
+uniform uint u_frame;
+uniform int u_reset;
+uniform float u_coherence;
+uniform float u_direction;
+uniform float u_speed;
+uniform float u_lifetime;
+
+out vec2 o_position;
+out float o_age;
+out float o_select;
+out float o_noise_direction;
+
+const float TWO_PI = 6.28318530718;
+
+uint hash(uint x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+float random(inout uint state)
+{
+    state = hash(state);
+    return float(state >> 8) * (1.0 / 16777216.0);
+}
+
+void main()
+{
+    uint state = hash(u_seed ^ hash(uint(gl_VertexID) ^ hash(u_frame)));
+
+    if (u_reset != 0 || a_age <= 0.0) {
+        // A new dot somewhere uniformly in the aperture.
+        float radius = sqrt(random(state));
+        float angle = TWO_PI * random(state);
+        o_position = radius * vec2(cos(angle), sin(angle));
+        // Stagger the lifetimes at the start, so not all dots die at once.
+        o_age = u_reset != 0 ? ceil(u_lifetime * random(state)) : u_lifetime;
+        o_select = random(state);
+        o_noise_direction = TWO_PI * random(state);
+    }
+    else {
+        float direction = a_select < u_coherence ? u_direction
+                                                 : a_noise_direction;
+        vec2 position = a_position + u_speed * vec2(cos(direction),
+                                                    sin(direction));
+        float distance = length(position);
+        // Dots that leave the aperture reenter at the opposite side.
+        if (distance > 1.0)
+            position -= 2.0 * position / distance;
+        o_position = position;
+        o_age = a_age - 1.0;
+        o_select = a_select;
+        o_noise_direction = a_noise_direction;
+    }
+    gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
+}
@@ -0,0 +1,23 @@
+#version 330 core
+
+// Cuts a shape out of the quad of shape.vert. v_uv runs from -1 to 1.
+// u_shape: 0 = disc, 1 = bar, 2 = cross
+// u_line_width: the width of the arms of a cross relative to its size.
+
+in vec2 v_uv;
+in vec4 v_color;
+
+uniform int u_shape;
+uniform float u_line_width;
+
+out vec4 frag_color;
+
+void main()
+{
+    if (u_shape == 0 && dot(v_uv, v_uv) > 1.0)
+        discard;
+    if (u_shape == 2 &&
+        abs(v_uv.x) > u_line_width && abs(v_uv.y) > u_line_width)
+        discard;
+    frag_color = v_color;
+}
@@ -0,0 +1,45 @@
+#version 330 core
+
+// Draws the shapes of a PsyShapeBatch, one instance per shape.
+// a_corner is a corner of the unit quad, the other attributes are per
+// instance. The orientation is in degrees counter clockwise.
+// In stereo every shape is drawn as two instances, the even one for the
+// left eye and the odd one for the right eye; a_disparity shifts the shape
+// half to the right for the left eye and half to the left for the right.
+
+layout (location = 0) in vec2 a_corner;
+layout (location = 1) in vec2 a_position;
+layout (location = 2) in vec2 a_size;
+layout (location = 3) in float a_orientation;
+layout (location = 4) in vec4 a_color;
+layout (location = 5) in float a_disparity;
+
+uniform mat4 u_transform;
+uniform float u_disparity_sign;     // the eye without u_stereo, +0.5 or -0.5
+uniform bool u_stereo;
+uniform mat4 u_eye_transforms[2];
+uniform vec4 u_clip_planes[2];
+
+out vec2 v_uv;
+out vec4 v_color;
+
+void main()
+{
+    float angle = radians(a_orientation);
+    mat2 rotation = mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+    vec2 position = a_position + rotation * (a_corner * a_size);
+
+    if (u_stereo) {
+        int eye = gl_InstanceID % 2;
+        position.x += (eye == 0 ? 0.5 : -0.5) * a_disparity;
+        gl_Position = u_eye_transforms[eye] * vec4(position, 0.0, 1.0);
+        gl_ClipDistance[0] = dot(u_clip_planes[eye], gl_Position);
+    }
+    else {
+        position.x += u_disparity_sign * a_disparity;
+        gl_Position = u_transform * vec4(position, 0.0, 1.0);
+        gl_ClipDistance[0] = 1.0;
+    }
+    v_uv = a_corner * 2.0;
+    v_color = a_color;
+}
@@ -0,0 +1,21 @@
+#version 100
+
+// Cuts a shape out of the quad of shape_es.vert, see shape.frag.
+
+precision mediump float;
+
+varying vec2 v_uv;
+varying vec4 v_color;
+
+uniform int u_shape;
+uniform float u_line_width;
+
+void main()
+{
+    if (u_shape == 0 && dot(v_uv, v_uv) > 1.0)
+        discard;
+    if (u_shape == 2 &&
+        abs(v_uv.x) > u_line_width && abs(v_uv.y) > u_line_width)
+        discard;
+    gl_FragColor = v_color;
+}
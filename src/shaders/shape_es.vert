@@ -0,0 +1,31 @@
+#version 100
+
+// Draws the shapes of a PsyShapeBatch, see shape.vert. Without instancing
+// every vertex carries the attributes of its shape. In stereo the eyes are
+// drawn one after the other, u_disparity_sign is +0.5 for the left eye and
+// -0.5 for the right eye.
+
+attribute vec2 a_corner;
+attribute vec2 a_position;
+attribute vec2 a_size;
+attribute float a_orientation;
+attribute vec4 a_color;
+attribute float a_disparity;
+
+uniform mat4 u_transform;
+uniform float u_disparity_sign;
+
+varying vec2 v_uv;
+varying vec4 v_color;
+
+void main()
+{
+    float angle = radians(a_orientation);
+    mat2 rotation = mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+    vec2 position = a_position + rotation * (a_corner * a_size);
+
+    position.x += u_disparity_sign * a_disparity;
+    gl_Position = u_transform * vec4(position, 0.0, 1.0);
+    v_uv = a_corner * 2.0;
+    v_color = a_color;
+}
@@ -0,0 +1,25 @@
+#version 330 core
+
+// Combines the views of both eyes, drawn side by side into u_texture, for
+// the window, see blit.vert.
+// u_mode: 0 = row interleaved, the left eye on the even rows counted from
+// the bottom, 1 = anaglyph, red for the left eye and cyan for the right.
+
+uniform sampler2D u_texture;
+uniform int u_mode;
+
+in vec2 v_texcoord;
+
+out vec4 frag_color;
+
+void main()
+{
+    vec2 left_uv = vec2(v_texcoord.x * 0.5, v_texcoord.y);
+    vec4 left = texture(u_texture, left_uv);
+    vec4 right = texture(u_texture, left_uv + vec2(0.5, 0.0));
+
+    if (u_mode == 0)
+        frag_color = mod(floor(gl_FragCoord.y), 2.0) < 0.5 ? left : right;
+    else
+        frag_color = vec4(left.r, right.g, right.b, 1.0);
+}
@@ -0,0 +1,26 @@
+#version 100
+
+// Combines the views of both eyes, see stereo.frag.
+
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+
+uniform sampler2D u_texture;
+uniform int u_mode;
+
+varying vec2 v_texcoord;
+
+void main()
+{
+    vec2 left_uv = vec2(v_texcoord.x * 0.5, v_texcoord.y);
+    vec4 left = texture2D(u_texture, left_uv);
+    vec4 right = texture2D(u_texture, left_uv + vec2(0.5, 0.0));
+
+    if (u_mode == 0)
+        gl_FragColor = mod(floor(gl_FragCoord.y), 2.0) < 0.5 ? left : right;
+    else
+        gl_FragColor = vec4(left.r, right.g, right.b, 1.0);
+}
@@ -0,0 +1,20 @@
+#version 330 core
+
+// Draws glyphs from their signed distance fields, the edge is at 0.5. The
+// edge is smoothed over about one pixel, whatever the size of the text.
+
+in vec2 v_texcoord;
+in vec4 v_color;
+
+uniform sampler2D u_atlas;
+
+out vec4 color;
+
+void main()
+{
+    float distance = texture(u_atlas, v_texcoord).r;
+    float width = max(fwidth(distance), 0.001);
+    float alpha = smoothstep(0.5 - width, 0.5 + width, distance);
+
+    color = vec4(v_color.rgb, v_color.a * alpha);
+}
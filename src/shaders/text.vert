@@ -0,0 +1,19 @@
+#version 330 core
+
+// Places the glyph quads of a PsyText.
+
+layout (location = 0) in vec2 a_position;
+layout (location = 1) in vec2 a_texcoord;
+layout (location = 2) in vec4 a_color;
+
+uniform mat4 u_transform;
+
+out vec2 v_texcoord;
+out vec4 v_color;
+
+void main()
+{
+    gl_Position = u_transform * vec4(a_position, 0.0, 1.0);
+    v_texcoord = a_texcoord;
+    v_color = a_color;
+}
@@ -0,0 +1,32 @@
+#version 100
+
+// Draws glyphs from their signed distance fields, see text.frag. Without
+// derivatives the edge is smoothed over a fixed range.
+
+#ifdef GL_OES_standard_derivatives
+#extension GL_OES_standard_derivatives : enable
+#endif
+
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+
+varying vec2 v_texcoord;
+varying vec4 v_color;
+
+uniform sampler2D u_atlas;
+
+void main()
+{
+    float distance = texture2D(u_atlas, v_texcoord).r;
+#ifdef GL_OES_standard_derivatives
+    float width = max(fwidth(distance), 0.001);
+#else
+    float width = 0.05;
+#endif
+    float alpha = smoothstep(0.5 - width, 0.5 + width, distance);
+
+    gl_FragColor = vec4(v_color.rgb, v_color.a * alpha);
+}
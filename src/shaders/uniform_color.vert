@@ -0,0 +1,12 @@
+#version 330 core
+
+// Draws geometry in a single colour, see uniform_color.frag.
+
+layout (location = 0) in vec2 a_position;
+
+uniform mat4 u_transform;
+
+void main()
+{
+    gl_Position = u_transform * vec4(a_position, 0.0, 1.0);
+}
@@ -0,0 +1,12 @@
+#version 100
+
+// Draws geometry in a single colour, see uniform_color_es.frag.
+
+attribute vec2 a_position;
+
+uniform mat4 u_transform;
+
+void main()
+{
+    gl_Position = u_transform * vec4(a_position, 0.0, 1.0);
+}
@@ -0,0 +1,26 @@
+#version 330 core
+
+// Converts the planes of a 4:2:0 frame to RGB. The coefficients are those
+// of BT.601 with limited range, which is what Y4M files normally contain.
+
+in vec2 v_texcoord;
+
+uniform sampler2D u_plane_y;
+uniform sampler2D u_plane_u;
+uniform sampler2D u_plane_v;
+
+out vec4 color;
+
+void main()
+{
+    float y = 1.164383 * (texture(u_plane_y, v_texcoord).r - 0.0625);
+    float u = texture(u_plane_u, v_texcoord).r - 0.5;
+    float v = texture(u_plane_v, v_texcoord).r - 0.5;
+
+    color = vec4(
+        y + 1.596027 * v,
+        y - 0.391762 * u - 0.812968 * v,
+        y + 2.017232 * u,
+        1.0
+        );
+}
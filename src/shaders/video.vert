@@ -0,0 +1,19 @@
+#version 330 core
+
+// Draws the current frame of a PsyVideo on a rectangle.
+// u_rect: x and y of the center, width and height of the rectangle
+
+layout (location = 0) in vec2 a_corner;
+
+uniform mat4 u_transform;
+uniform vec4 u_rect;
+
+out vec2 v_texcoord;
+
+void main()
+{
+    gl_Position = u_transform * vec4(u_rect.xy + (a_corner - 0.5) * u_rect.zw,
+                                     0.0, 1.0);
+    // The first row of a frame is the top of the image.
+    v_texcoord = vec2(a_corner.x, 1.0 - a_corner.y);
+}
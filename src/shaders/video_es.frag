@@ -0,0 +1,30 @@
+#version 100
+
+// Converts the planes of a 4:2:0 frame to RGB, see video.frag. The planes
+// are GL_LUMINANCE textures here.
+
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+
+varying vec2 v_texcoord;
+
+uniform sampler2D u_plane_y;
+uniform sampler2D u_plane_u;
+uniform sampler2D u_plane_v;
+
+void main()
+{
+    float y = 1.164383 * (texture2D(u_plane_y, v_texcoord).r - 0.0625);
+    float u = texture2D(u_plane_u, v_texcoord).r - 0.5;
+    float v = texture2D(u_plane_v, v_texcoord).r - 0.5;
+
+    gl_FragColor = vec4(
+        y + 1.596027 * v,
+        y - 0.391762 * u - 0.812968 * v,
+        y + 2.017232 * u,
+        1.0
+        );
+}
@@ -0,0 +1,17 @@
+#version 100
+
+// Draws the current frame of a PsyVideo, see video.vert.
+
+attribute vec2 a_corner;
+
+uniform mat4 u_transform;
+uniform vec4 u_rect;
+
+varying vec2 v_texcoord;
+
+void main()
+{
+    gl_Position = u_transform * vec4(u_rect.xy + (a_corner - 0.5) * u_rect.zw,
+                                     0.0, 1.0);
+    v_texcoord = vec2(a_corner.x, 1.0 - a_corner.y);
+}
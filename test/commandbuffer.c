@@ -0,0 +1,233 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <CUnit/CUnit.h>
+#include "../src/CommandBuffer.h"
+#include "../src/ShaderProgram.h"
+#include "../src/Window.h"
+#include "globals.h"
+#include "psy_test_macros.h"
+
+static PsyWindow* g_win = NULL;
+
+static int g_win_x;
+static int g_win_y;
+static int g_win_width;
+static int g_win_height;
+
+static const char* suite_name = "commandbuffer";
+
+static const GLfloat g_identity[16] = {
+    1.0f, 0.0f, 0.0f, 0.0f,
+    0.0f, 1.0f, 0.0f, 0.0f,
+    0.0f, 0.0f, 1.0f, 0.0f,
+    0.0f, 0.0f, 0.0f, 1.0f
+};
+
+static int g_num_calls;
+
+static int
+count_call(void* stimulus, const GLfloat* transform, SeeError** error)
+{
+    (void) error;
+    CU_ASSERT_PTR_EQUAL(stimulus, &g_num_calls);
+    CU_ASSERT_PTR_EQUAL(transform, g_identity);
+    g_num_calls++;
+    return SEE_SUCCESS;
+}
+
+static int setup(void)
+{
+    SeeError*   error   = NULL;
+    PsyRect     rect    = {
+        {.x = g_win_x, .y = g_win_y},
+        {.width = g_win_width, .height = g_win_height}
+    };
+    int ret;
+
+    ret = psy_window_create_rect(&g_win, rect, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return 1;
+    }
+    psy_window_show(g_win);
+
+    return 0;
+}
+
+static int
+teardown(void)
+{
+    if (g_win) {
+        see_object_decref(SEE_OBJECT(g_win));
+        g_win = NULL;
+    }
+    return 0;
+}
+
+void command_buffer_replay(void)
+{
+    int ret, frame;
+    PsyCommandBuffer* buffer = NULL;
+    PsyShaderProgram* program = NULL;
+    SeeError* error = NULL;
+    GLuint vao = 0, vbo = 0;
+    GLubyte pixel[4] = {0};
+    size_t color;
+    const GLfloat red[4] = {1.0f, 0.0f, 0.0f, 1.0f};
+    const GLfloat green[4] = {0.0f, 1.0f, 0.0f, 1.0f};
+    const GLfloat quad[6][2] = {
+        {-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f},
+        {-1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f}
+    };
+
+    ret = psy_command_buffer_create(&buffer, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto command_buffer_replay_error;
+    ret = psy_shader_program_create_builtin(
+        &program, "uniform_color", "uniform_color", &error
+        );
+    if (ret)
+        goto command_buffer_replay_error;
+
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (GLAD_GL_VERSION_3_0)
+        glGenVertexArrays(1, &vao);
+
+    // Record the display once.
+    ret = psy_command_buffer_use_program(buffer, program, &error);
+    if (ret)
+        goto command_buffer_replay_error;
+    ret = psy_command_buffer_uniform(
+        buffer,
+        psy_shader_program_uniform_location(program, "u_transform"),
+        PSY_UNIFORM_MAT4, 1, g_identity, NULL, &error
+        );
+    if (ret)
+        goto command_buffer_replay_error;
+    ret = psy_command_buffer_uniform(
+        buffer,
+        psy_shader_program_uniform_location(program, "u_color"),
+        PSY_UNIFORM_VEC4, 1, red, &color, &error
+        );
+    if (ret)
+        goto command_buffer_replay_error;
+    if (vao) {
+        ret = psy_command_buffer_bind_vertex_array(buffer, vao, &error);
+        if (ret)
+            goto command_buffer_replay_error;
+    }
+    ret = psy_command_buffer_vertex_attribute(
+        buffer,
+        (GLuint) psy_shader_program_attribute_location(program, "a_position"),
+        vbo, 2, GL_FLOAT, 0, 0, &error
+        );
+    if (ret)
+        goto command_buffer_replay_error;
+    ret = psy_command_buffer_draw_arrays(buffer, GL_TRIANGLES, 0, 6, &error);
+    if (ret)
+        goto command_buffer_replay_error;
+    ret = psy_command_buffer_call(buffer, count_call, &g_num_calls, &error);
+    if (ret)
+        goto command_buffer_replay_error;
+    CU_ASSERT_EQUAL(psy_command_buffer_size(buffer), vao ? 7 : 6);
+
+    glViewport(0, 0, g_win_width, g_win_height);
+    g_num_calls = 0;
+
+    // And replay it, with the color patched on the last frame.
+    for (frame = 0; frame < 3; frame++) {
+        if (frame == 2) {
+            ret = psy_command_buffer_set_uniform(buffer, color, green);
+            CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+        }
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        ret = psy_command_buffer_replay(buffer, g_identity, &error);
+        CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+        if (ret)
+            goto command_buffer_replay_error;
+
+        glReadPixels(
+            g_win_width / 2, g_win_height / 2, 1, 1,
+            GL_RGBA, GL_UNSIGNED_BYTE, pixel
+            );
+        CU_ASSERT_EQUAL(pixel[0], frame == 2 ? 0 : 255);
+        CU_ASSERT_EQUAL(pixel[1], frame == 2 ? 255 : 0);
+    }
+    CU_ASSERT_EQUAL(g_num_calls, 3);
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+    // Only uniforms can be patched.
+    ret = psy_command_buffer_set_uniform(buffer, 0, green);
+    CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+
+    psy_command_buffer_clear(buffer);
+    CU_ASSERT_EQUAL(psy_command_buffer_size(buffer), 0);
+
+command_buffer_replay_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    if (vao) {
+        glBindVertexArray(0);
+        glDeleteVertexArrays(1, &vao);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (vbo)
+        glDeleteBuffers(1, &vbo);
+    see_object_decref(SEE_OBJECT(buffer));
+    see_object_decref(SEE_OBJECT(program));
+}
+
+int add_command_buffer_suite(void)
+{
+    g_win_width     = g_settings.window_settings.width;
+    g_win_height    = g_settings.window_settings.height;
+    g_win_x         = g_settings.window_settings.x;
+    g_win_y         = g_settings.window_settings.y;
+
+    CU_pSuite suite = CU_add_suite(
+        suite_name,
+        setup,
+        teardown
+        );
+
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(
+            stderr,
+            "Unable to create suite: \"%s\": %s\n",
+            suite_name,
+            CU_get_error_msg()
+        );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, command_buffer_replay);
+
+    return 0;
+}
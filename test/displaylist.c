@@ -0,0 +1,310 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <CUnit/CUnit.h>
+#include "../src/DisplayList.h"
+#include "../src/ShaderProgram.h"
+#include "../src/Window.h"
+#include "globals.h"
+#include "psy_test_macros.h"
+
+static PsyWindow* g_win = NULL;
+
+static int g_win_x;
+static int g_win_y;
+static int g_win_width;
+static int g_win_height;
+
+static const char* suite_name = "displaylist";
+
+#define NUM_STIMULI 7
+
+/* A stimulus that checks the state the list has bound for it. */
+typedef struct TestStimulus {
+    int     layer;
+    GLuint  program;
+    GLuint  texture;
+} TestStimulus;
+
+static const TestStimulus* g_drawn[NUM_STIMULI];
+static size_t g_num_drawn;
+
+static int
+draw_stimulus(void* stimulus, const GLfloat* transform, SeeError** error)
+{
+    const TestStimulus* stim = stimulus;
+    GLint program, texture;
+    (void) transform;
+    (void) error;
+
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    CU_ASSERT_EQUAL((GLuint) program, stim->program);
+    if (stim->texture) {
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture);
+        CU_ASSERT_EQUAL((GLuint) texture, stim->texture);
+    }
+
+    if (g_num_drawn < NUM_STIMULI)
+        g_drawn[g_num_drawn++] = stim;
+    return SEE_SUCCESS;
+}
+
+static int setup(void)
+{
+    SeeError*   error   = NULL;
+    PsyRect     rect    = {
+        {.x = g_win_x, .y = g_win_y},
+        {.width = g_win_width, .height = g_win_height}
+    };
+    int ret;
+
+    ret = psy_window_create_rect(&g_win, rect, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return 1;
+    }
+    psy_window_show(g_win);
+
+    return 0;
+}
+
+static int
+teardown(void)
+{
+    if (g_win) {
+        see_object_decref(SEE_OBJECT(g_win));
+        g_win = NULL;
+    }
+    return 0;
+}
+
+void display_list_sort(void)
+{
+    int ret;
+    size_t i, handles[NUM_STIMULI], hidden;
+    PsyDisplayList* list = NULL;
+    PsyShaderProgram* programs[2] = {NULL, NULL};
+    TestStimulus stimuli[NUM_STIMULI];
+    PsyDisplayListStats stats;
+    SeeError* error = NULL;
+
+    ret = psy_window_display_list(g_win, &list, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto display_list_sort_error;
+
+    for (i = 0; i < 2; i++) {
+        ret = psy_shader_program_create_builtin(
+            &programs[i], "uniform_color", "uniform_color", &error
+            );
+        if (ret)
+            goto display_list_sort_error;
+    }
+
+    // Interleaved conditions in layer 0, the last one is on top.
+    for (i = 0; i < NUM_STIMULI; i++) {
+        PsyDisplayItem item = {0};
+        PsyShaderProgram* program = programs[i % 2];
+
+        stimuli[i].layer = i == NUM_STIMULI - 1 ? 1 : 0;
+        stimuli[i].program = program->program_id;
+        stimuli[i].texture = 0;
+
+        item.layer = stimuli[i].layer;
+        item.program = program;
+        item.draw = draw_stimulus;
+        item.stimulus = &stimuli[i];
+        ret = psy_display_list_add(list, &item, &handles[i], &error);
+        CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+        if (ret)
+            goto display_list_sort_error;
+    }
+    CU_ASSERT_EQUAL(psy_display_list_size(list), NUM_STIMULI);
+
+    g_num_drawn = 0;
+    ret = psy_window_draw(g_win, NULL, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto display_list_sort_error;
+
+    psy_display_list_stats(list, &stats);
+    CU_ASSERT_EQUAL(stats.items_drawn, NUM_STIMULI);
+    CU_ASSERT_EQUAL(stats.sorts, 1);
+    // One switch per program in layer 0, perhaps one more for layer 1.
+    CU_ASSERT(stats.program_changes <= 3);
+    CU_ASSERT_EQUAL(g_num_drawn, NUM_STIMULI);
+    CU_ASSERT_EQUAL(g_drawn[NUM_STIMULI - 1], &stimuli[NUM_STIMULI - 1]);
+    for (i = 1; i < g_num_drawn; i++) {
+        CU_ASSERT(g_drawn[i - 1]->layer <= g_drawn[i]->layer);
+        // Equal items keep the order in which they were added.
+        if (g_drawn[i - 1]->program == g_drawn[i]->program)
+            CU_ASSERT(g_drawn[i - 1] < g_drawn[i]);
+    }
+
+    // An unchanged list isn't sorted again, hiding doesn't change it.
+    hidden = handles[0];
+    ret = psy_display_list_set_visible(list, hidden, 0);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    g_num_drawn = 0;
+    ret = psy_window_draw(g_win, NULL, &error);
+    if (ret)
+        goto display_list_sort_error;
+    psy_display_list_stats(list, &stats);
+    CU_ASSERT_EQUAL(stats.sorts, 1);
+    CU_ASSERT_EQUAL(stats.items_drawn, NUM_STIMULI - 1);
+
+    ret = psy_display_list_remove(list, hidden, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    CU_ASSERT_EQUAL(psy_display_list_size(list), NUM_STIMULI - 1);
+    ret = psy_display_list_remove(list, hidden, &error);
+    CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+    if (error) {
+        see_object_decref(SEE_OBJECT(error));
+        error = NULL;
+    }
+
+    g_num_drawn = 0;
+    ret = psy_window_draw(g_win, NULL, &error);
+    if (ret)
+        goto display_list_sort_error;
+    psy_display_list_stats(list, &stats);
+    CU_ASSERT_EQUAL(stats.sorts, 2);
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+    for (i = 1; i < NUM_STIMULI; i++)
+        psy_display_list_remove(list, handles[i], &error);
+    CU_ASSERT_EQUAL(psy_display_list_size(list), 0);
+
+display_list_sort_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(programs[0]));
+    see_object_decref(SEE_OBJECT(programs[1]));
+}
+
+void display_list_textures(void)
+{
+    int ret;
+    size_t i, handle;
+    PsyDisplayList* list = NULL;
+    PsyShaderProgram* program = NULL;
+    GLuint textures[2] = {0, 0};
+    TestStimulus stimuli[NUM_STIMULI];
+    PsyDisplayListStats stats;
+    SeeError* error = NULL;
+
+    ret = psy_display_list_create(&list, &error);
+    if (ret)
+        goto display_list_textures_error;
+    ret = psy_shader_program_create_builtin(
+        &program, "uniform_color", "uniform_color", &error
+        );
+    if (ret)
+        goto display_list_textures_error;
+    glGenTextures(2, textures);
+
+    for (i = 0; i < NUM_STIMULI; i++) {
+        PsyDisplayItem item = {0};
+
+        stimuli[i].layer = 0;
+        stimuli[i].program = program->program_id;
+        stimuli[i].texture = textures[i % 2];
+
+        item.program = program;
+        item.texture_target = GL_TEXTURE_2D;
+        item.textures[0] = stimuli[i].texture;
+        item.blend = PSY_BLEND_ALPHA;
+        item.draw = draw_stimulus;
+        item.stimulus = &stimuli[i];
+        ret = psy_display_list_add(list, &item, &handle, &error);
+        if (ret)
+            goto display_list_textures_error;
+    }
+
+    g_num_drawn = 0;
+    ret = psy_display_list_draw(list, NULL, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto display_list_textures_error;
+
+    psy_display_list_stats(list, &stats);
+    CU_ASSERT_EQUAL(stats.items_drawn, NUM_STIMULI);
+    CU_ASSERT_EQUAL(stats.program_changes, 1);
+    CU_ASSERT_EQUAL(stats.texture_changes, 2);
+    CU_ASSERT_EQUAL(stats.blend_changes, 1);
+    CU_ASSERT_EQUAL(glIsEnabled(GL_BLEND), GL_FALSE);
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+    // An item without a draw function is refused.
+    {
+        PsyDisplayItem item = {0};
+        ret = psy_display_list_add(list, &item, &handle, &error);
+        CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+        CU_ASSERT_PTR_NOT_NULL(error);
+        if (error) {
+            see_object_decref(SEE_OBJECT(error));
+            error = NULL;
+        }
+    }
+
+display_list_textures_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    if (textures[0])
+        glDeleteTextures(2, textures);
+    see_object_decref(SEE_OBJECT(list));
+    see_object_decref(SEE_OBJECT(program));
+}
+
+int add_display_list_suite(void)
+{
+    g_win_width     = g_settings.window_settings.width;
+    g_win_height    = g_settings.window_settings.height;
+    g_win_x         = g_settings.window_settings.x;
+    g_win_y         = g_settings.window_settings.y;
+
+    CU_pSuite suite = CU_add_suite(
+        suite_name,
+        setup,
+        teardown
+        );
+
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(
+            stderr,
+            "Unable to create suite: \"%s\": %s\n",
+            suite_name,
+            CU_get_error_msg()
+        );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, display_list_sort);
+    PSY_SUITE_ADD_TEST(suite_name, display_list_textures);
+
+    return 0;
+}
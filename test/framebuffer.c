@@ -0,0 +1,233 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <CUnit/CUnit.h>
+#include "../src/Framebuffer.h"
+#include "../src/Window.h"
+#include "globals.h"
+#include "psy_test_macros.h"
+
+static PsyWindow* g_win = NULL;
+
+static int g_win_x;
+static int g_win_y;
+static int g_win_width;
+static int g_win_height;
+
+static const char* suite_name = "framebuffer";
+
+#define FB_WIDTH 32
+#define FB_HEIGHT 16
+
+static int setup(void)
+{
+    SeeError*   error   = NULL;
+    PsyRect     rect    = {
+        {.x = g_win_x, .y = g_win_y},
+        {.width = g_win_width, .height = g_win_height}
+    };
+    int ret;
+
+    ret = psy_window_create_rect(&g_win, rect, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return 1;
+    }
+    psy_window_show(g_win);
+
+    return 0;
+}
+
+static int
+teardown(void)
+{
+    if (g_win) {
+        see_object_decref(SEE_OBJECT(g_win));
+        g_win = NULL;
+    }
+    return 0;
+}
+
+void framebuffer_create(void)
+{
+    int ret, width = 0, height = 0;
+    PsyFramebuffer* fb = NULL;
+    SeeError* error = NULL;
+
+    ret = psy_framebuffer_create(
+        &fb, FB_WIDTH, FB_HEIGHT, PSY_FRAMEBUFFER_RGBA8, 1, &error
+        );
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto framebuffer_create_error;
+
+    CU_ASSERT_NOT_EQUAL(psy_framebuffer_id(fb), 0);
+    CU_ASSERT_NOT_EQUAL(psy_framebuffer_texture(fb), 0);
+    CU_ASSERT_EQUAL(psy_framebuffer_format(fb), PSY_FRAMEBUFFER_RGBA8);
+    psy_framebuffer_size(fb, &width, &height);
+    CU_ASSERT_EQUAL(width, FB_WIDTH);
+    CU_ASSERT_EQUAL(height, FB_HEIGHT);
+    // 4 bytes of color and 4 of depth per pixel.
+    CU_ASSERT_EQUAL(psy_framebuffer_memory_used(fb), FB_WIDTH * FB_HEIGHT * 8);
+
+    ret = psy_framebuffer_resize(fb, FB_HEIGHT, FB_WIDTH, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    psy_framebuffer_size(fb, &width, &height);
+    CU_ASSERT_EQUAL(width, FB_HEIGHT);
+    CU_ASSERT_EQUAL(height, FB_WIDTH);
+
+    ret = psy_framebuffer_resize(fb, 0, FB_WIDTH, &error);
+    CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+framebuffer_create_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(fb));
+}
+
+void framebuffer_bind_read(void)
+{
+    int ret;
+    PsyFramebuffer* fb = NULL;
+    SeeError* error = NULL;
+    unsigned char pixels[FB_WIDTH * FB_HEIGHT * 4];
+    GLint viewport[4], restored[4];
+
+    ret = psy_framebuffer_create(
+        &fb, FB_WIDTH, FB_HEIGHT, PSY_FRAMEBUFFER_RGBA8, 0, &error
+        );
+    if (ret)
+        goto framebuffer_bind_read_error;
+
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    psy_framebuffer_bind(fb);
+    glClearColor(1.0f, 0.0f, 1.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    psy_framebuffer_unbind(fb);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+    // Unbind restores the viewport of the window.
+    glGetIntegerv(GL_VIEWPORT, restored);
+    CU_ASSERT_EQUAL(restored[2], viewport[2]);
+    CU_ASSERT_EQUAL(restored[3], viewport[3]);
+
+    ret = psy_framebuffer_read(fb, pixels, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto framebuffer_bind_read_error;
+    CU_ASSERT_EQUAL(pixels[0], 255);
+    CU_ASSERT_EQUAL(pixels[1], 0);
+    CU_ASSERT_EQUAL(pixels[2], 255);
+    CU_ASSERT_EQUAL(pixels[sizeof(pixels) - 4], 255);
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+framebuffer_bind_read_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(fb));
+}
+
+void framebuffer_blit(void)
+{
+    int ret;
+    PsyFramebuffer* source = NULL;
+    PsyFramebuffer* target = NULL;
+    SeeError* error = NULL;
+    unsigned char pixels[FB_WIDTH * FB_HEIGHT * 4];
+
+    ret = psy_framebuffer_create(
+        &source, FB_WIDTH, FB_HEIGHT, PSY_FRAMEBUFFER_RGBA8, 0, &error
+        );
+    if (ret)
+        goto framebuffer_blit_error;
+    ret = psy_framebuffer_create(
+        &target, FB_WIDTH, FB_HEIGHT, PSY_FRAMEBUFFER_RGBA8, 0, &error
+        );
+    if (ret)
+        goto framebuffer_blit_error;
+
+    psy_framebuffer_bind(source);
+    glClearColor(0.0f, 1.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    psy_framebuffer_unbind(source);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+    psy_framebuffer_bind(target);
+    ret = psy_framebuffer_blit(source, &error);
+    psy_framebuffer_unbind(target);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto framebuffer_blit_error;
+
+    ret = psy_framebuffer_read(target, pixels, &error);
+    if (ret)
+        goto framebuffer_blit_error;
+    CU_ASSERT_EQUAL(pixels[0], 0);
+    CU_ASSERT_EQUAL(pixels[1], 255);
+    CU_ASSERT_EQUAL(pixels[2], 0);
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+framebuffer_blit_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(source));
+    see_object_decref(SEE_OBJECT(target));
+}
+
+int add_framebuffer_suite(void)
+{
+    g_win_width     = g_settings.window_settings.width;
+    g_win_height    = g_settings.window_settings.height;
+    g_win_x         = g_settings.window_settings.x;
+    g_win_y         = g_settings.window_settings.y;
+
+    CU_pSuite suite = CU_add_suite(
+        suite_name,
+        setup,
+        teardown
+        );
+
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(
+            stderr,
+            "Unable to create suite: \"%s\": %s\n",
+            suite_name,
+            CU_get_error_msg()
+        );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, framebuffer_create);
+    PSY_SUITE_ADD_TEST(suite_name, framebuffer_bind_read);
+    PSY_SUITE_ADD_TEST(suite_name, framebuffer_blit);
+
+    return 0;
+}
@@ -0,0 +1,202 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <CUnit/CUnit.h>
+#include "../src/FrameCache.h"
+#include "../src/Window.h"
+#include "globals.h"
+#include "psy_test_macros.h"
+
+static PsyWindow* g_win = NULL;
+
+static int g_win_x;
+static int g_win_y;
+static int g_win_width;
+static int g_win_height;
+
+static const char* suite_name = "framecache";
+
+static int setup(void)
+{
+    SeeError*   error   = NULL;
+    PsyRect     rect    = {
+        {.x = g_win_x, .y = g_win_y},
+        {.width = g_win_width, .height = g_win_height}
+    };
+    int ret;
+
+    ret = psy_window_create_rect(&g_win, rect, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return 1;
+    }
+    psy_window_show(g_win);
+
+    return 0;
+}
+
+static int
+teardown(void)
+{
+    if (g_win) {
+        see_object_decref(SEE_OBJECT(g_win));
+        g_win = NULL;
+    }
+    return 0;
+}
+
+/* Renders a frame that is cleared to one color. */
+static int
+render_frame(PsyFrameCache* cache, unsigned key, float red, SeeError** error)
+{
+    int ret = psy_frame_cache_begin(cache, key, error);
+    if (ret)
+        return ret;
+    glClearColor(red, 0.0f, 1.0f - red, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    return psy_frame_cache_end(cache, error);
+}
+
+void frame_cache_present(void)
+{
+    int ret;
+    PsyFrameCache* cache = NULL;
+    SeeError* error = NULL;
+    GLubyte pixel[4] = {0};
+    const size_t frame_bytes = (size_t) g_win_width * g_win_height * 4;
+
+    ret = psy_frame_cache_create(
+        &cache, g_win_width, g_win_height, 2 * frame_bytes, &error
+        );
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto frame_cache_present_error;
+    CU_ASSERT_EQUAL(psy_frame_cache_capacity(cache), 2);
+    CU_ASSERT_EQUAL(psy_frame_cache_memory_used(cache), 0);
+
+    ret = render_frame(cache, 1, 1.0f, &error);
+    if (ret)
+        goto frame_cache_present_error;
+    ret = render_frame(cache, 2, 0.0f, &error);
+    if (ret)
+        goto frame_cache_present_error;
+    ret = psy_frame_cache_finish(cache, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    CU_ASSERT(psy_frame_cache_ready(cache, 1));
+    CU_ASSERT_EQUAL(psy_frame_cache_size(cache), 2);
+    CU_ASSERT_EQUAL(psy_frame_cache_memory_used(cache), 2 * frame_bytes);
+
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    ret = psy_frame_cache_present(cache, 1, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto frame_cache_present_error;
+    glReadPixels(
+        g_win_width / 2, g_win_height / 2, 1, 1,
+        GL_RGBA, GL_UNSIGNED_BYTE, pixel
+        );
+    CU_ASSERT_EQUAL(pixel[0], 255);
+    CU_ASSERT_EQUAL(pixel[2], 0);
+
+    // A third frame reuses the framebuffer of frame 2, used longest ago.
+    ret = render_frame(cache, 3, 0.0f, &error);
+    if (ret)
+        goto frame_cache_present_error;
+    CU_ASSERT(psy_frame_cache_contains(cache, 1));
+    CU_ASSERT(!psy_frame_cache_contains(cache, 2));
+    CU_ASSERT(psy_frame_cache_contains(cache, 3));
+    CU_ASSERT_EQUAL(psy_frame_cache_memory_used(cache), 2 * frame_bytes);
+
+    ret = psy_frame_cache_present(cache, 2, &error);
+    CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+    CU_ASSERT_PTR_NOT_NULL(error);
+    if (error) {
+        see_object_decref(SEE_OBJECT(error));
+        error = NULL;
+    }
+
+    ret = psy_frame_cache_present(cache, 3, &error);
+    if (ret)
+        goto frame_cache_present_error;
+    glReadPixels(
+        g_win_width / 2, g_win_height / 2, 1, 1,
+        GL_RGBA, GL_UNSIGNED_BYTE, pixel
+        );
+    CU_ASSERT_EQUAL(pixel[0], 0);
+    CU_ASSERT_EQUAL(pixel[2], 255);
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+    psy_frame_cache_clear(cache);
+    CU_ASSERT_EQUAL(psy_frame_cache_size(cache), 0);
+
+frame_cache_present_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(cache));
+}
+
+void frame_cache_budget(void)
+{
+    int ret;
+    PsyFrameCache* cache = NULL;
+    SeeError* error = NULL;
+
+    // A budget that doesn't fit a single frame is refused.
+    ret = psy_frame_cache_create(&cache, g_win_width, g_win_height, 16, &error);
+    CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+    CU_ASSERT_PTR_NOT_NULL(error);
+    if (error)
+        see_object_decref(SEE_OBJECT(error));
+    see_object_decref(SEE_OBJECT(cache));
+}
+
+int add_frame_cache_suite(void)
+{
+    g_win_width     = g_settings.window_settings.width;
+    g_win_height    = g_settings.window_settings.height;
+    g_win_x         = g_settings.window_settings.x;
+    g_win_y         = g_settings.window_settings.y;
+
+    CU_pSuite suite = CU_add_suite(
+        suite_name,
+        setup,
+        teardown
+        );
+
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(
+            stderr,
+            "Unable to create suite: \"%s\": %s\n",
+            suite_name,
+            CU_get_error_msg()
+        );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, frame_cache_present);
+    PSY_SUITE_ADD_TEST(suite_name, frame_cache_budget);
+
+    return 0;
+}
@@ -17,6 +17,7 @@
 
 #include <CUnit/CUnit.h>
 #include "../src/ShaderProgram.h"
+#include "../src/BuiltinShaders.h"
 #include "../src/Window.h"
 #include "globals.h"
 #include "psy_test_macros.h"
@@ -32,6 +33,9 @@ static int g_win_height;
 
 static const char* suite_name = "gl shader program";
 
+extern const PsyBuiltinShader   psy_test_shaders[];
+extern const size_t             psy_test_shaders_size;
+
 //static const char* vert_shader_src =
 //    "#version 330 core\n"
 //    "\n"
@@ -72,23 +76,9 @@ static int setup(void)
         {.x = g_win_x, .y = g_win_y},
         {.width = g_win_width, .height = g_win_height}
     };
-    FILE* file = NULL;
     int ret;
+    const PsyBuiltinShader* source = NULL;
 
-    const char* vertex_shader[] =  {
-        "./gl_shaders/test_vertex_shader.vert",
-        "./test/gl_shaders/test_vertex_shader.vert",
-        "./gl_shaders/test_vertex_shader_es.vert",
-        "./test/gl_shaders/test_vertex_shader_es.vert"
-    };
-
-    const char* fragment_shader[] =  {
-        "./gl_shaders/test_fragment_shader.frag",
-        "./test/gl_shaders/test_fragment_shader.frag",
-        "./gl_shaders/test_fragment_shader_es.frag",
-        "./test/gl_shaders/test_fragment_shader_es.frag"
-    };
-    
     ret = psy_window_create_rect(&g_win, rect, &error);
     if (ret != SEE_SUCCESS) {
         fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
@@ -117,64 +107,46 @@ static int setup(void)
         goto setup_failure;
     }
 
-
-    for (size_t i = 0;
-         i < sizeof(vertex_shader)/sizeof(vertex_shader[0]);
-         i++
-         )
-    {
-        file = fopen(vertex_shader[i], "r");
-        if (!file)
-            continue;
-
-        ret = psy_shader_compile_file(g_vertex_shader, file, &error);
-        fclose(file);
-        file = NULL;
-        if (ret) {
-            if (g_settings.verbose)
-                fprintf(stderr, "%s", see_error_msg(SEE_ERROR(error)));
-            see_object_decref(SEE_OBJECT(error));
-            error = NULL;
-        }
-        else
-            break;
+    // The test shaders are embedded in the unittest by the build.
+    source = psy_builtin_shader_find(
+        psy_test_shaders,
+        psy_test_shaders_size,
+        "test_vertex_shader",
+        PSY_SHADER_VERTEX
+        );
+    if (!source) {
+        fprintf(stderr, "Unable to find the test vertex shader\n");
+        goto setup_failure;
     }
-    if (!psy_shader_compiled(g_vertex_shader)) {
-        fprintf(stderr, "Unable to compile a vertex shader\n");
+    ret = psy_shader_compile(g_vertex_shader, source->source, &error);
+    if (ret) {
+        fprintf(stderr, "Unable to compile a vertex shader: %s\n",
+                see_error_msg(SEE_ERROR(error))
+                );
         goto setup_failure;
     }
 
-    for (size_t i = 0;
-         i < sizeof(fragment_shader)/sizeof(fragment_shader[0]);
-         i++)
-    {
-        file = fopen(fragment_shader[i], "r");
-        if (!file)
-            continue;
-
-        ret = psy_shader_compile_file(g_fragment_shader, file, &error);
-        fclose(file);
-        file = NULL;
-        if (ret) {
-            if (g_settings.verbose)
-                fprintf(stderr, "%s", see_error_msg(SEE_ERROR(error)));
-            see_object_decref(SEE_OBJECT(error));
-            error = NULL;
-        }
-        else
-            break;
+    source = psy_builtin_shader_find(
+        psy_test_shaders,
+        psy_test_shaders_size,
+        "test_fragment_shader",
+        PSY_SHADER_FRAGMENT
+        );
+    if (!source) {
+        fprintf(stderr, "Unable to find the test fragment shader\n");
+        goto setup_failure;
     }
-
-    if (!psy_shader_compiled(g_fragment_shader)) {
-        fprintf(stderr, "Unable to compile a fragment shader\n");
+    ret = psy_shader_compile(g_fragment_shader, source->source, &error);
+    if (ret) {
+        fprintf(stderr, "Unable to compile a fragment shader: %s\n",
+                see_error_msg(SEE_ERROR(error))
+                );
         goto setup_failure;
     }
 
     return 0;
 
     setup_failure:
-    if (file)
-        fclose(file);
     see_object_decref(SEE_OBJECT(g_win));
     see_object_decref(SEE_OBJECT(error));
     see_object_decref(SEE_OBJECT(g_vertex_shader));
@@ -397,6 +369,147 @@ gl_shader_program_src_error:
     see_object_decref(SEE_OBJECT(program));
 }
 
+void gl_shader_program_warm_up(void)
+{
+    int ret;
+    PsyShaderProgram* program = NULL;
+    SeeError*         error = NULL;
+    double            duration = -1.0;
+    PsyWarmUpResult   results[16];
+    size_t            num_warmed = 0;
+    int               found = 0;
+
+    ret = psy_shader_program_create(
+        &program,
+        g_vertex_shader,
+        g_fragment_shader,
+        &error
+        );
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto gl_shader_program_warm_up_error;
+
+    // An unlinked program cannot be warmed up.
+    ret = psy_shader_program_warm_up(program, &duration, &error);
+    CU_ASSERT_EQUAL(ret, SEE_ERROR_RUNTIME);
+    CU_ASSERT_PTR_NOT_EQUAL(error, NULL);
+    see_object_decref(SEE_OBJECT(error));
+    error = NULL;
+
+    ret = psy_shader_program_link(program, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto gl_shader_program_warm_up_error;
+    CU_ASSERT(psy_shader_program_num_linked() >= 1);
+
+    ret = psy_shader_program_warm_up(program, &duration, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    CU_ASSERT(duration >= 0.0);
+    if (ret)
+        goto gl_shader_program_warm_up_error;
+
+    ret = psy_shader_program_warm_up_all(
+        results,
+        sizeof(results) / sizeof(results[0]),
+        &num_warmed,
+        &error
+        );
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    CU_ASSERT_EQUAL(num_warmed, psy_shader_program_num_linked());
+    for (size_t i = 0; i < num_warmed && i < 16; i++) {
+        if (results[i].program == program)
+            found = 1;
+        CU_ASSERT(results[i].duration >= 0.0);
+    }
+    CU_ASSERT(found);
+
+gl_shader_program_warm_up_error:
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(program));
+}
+
+void gl_shader_program_reflection(void)
+{
+    int ret;
+    PsyShaderProgram*           program     = NULL;
+    PsyShader*                  vertex      = NULL;
+    PsyShader*                  fragment    = NULL;
+    SeeError*                   error       = NULL;
+    const PsyProgramResource*   resources   = NULL;
+    const PsyProgramResource*   color       = NULL;
+    size_t                      num         = 0;
+
+    ret = psy_shader_create(&vertex, PSY_SHADER_VERTEX, &error);
+    if (ret)
+        goto gl_shader_program_reflection_error;
+    ret = psy_shader_compile_builtin(vertex, "uniform_color", &error);
+    if (ret)
+        goto gl_shader_program_reflection_error;
+    ret = psy_shader_create(&fragment, PSY_SHADER_FRAGMENT, &error);
+    if (ret)
+        goto gl_shader_program_reflection_error;
+    ret = psy_shader_compile_builtin(fragment, "uniform_color", &error);
+    if (ret)
+        goto gl_shader_program_reflection_error;
+
+    ret = psy_shader_program_create(&program, vertex, fragment, &error);
+    if (ret)
+        goto gl_shader_program_reflection_error;
+
+    // Nothing to reflect before the program is linked.
+    CU_ASSERT_PTR_NULL(psy_shader_program_resources(program, &num));
+    CU_ASSERT_EQUAL(num, 0);
+
+    ret = psy_shader_program_link(program, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto gl_shader_program_reflection_error;
+
+    resources = psy_shader_program_resources(program, &num);
+    CU_ASSERT_PTR_NOT_NULL(resources);
+    CU_ASSERT_EQUAL(num, 3);
+    for (size_t i = 1; i < num; i++)
+        CU_ASSERT(resources[i - 1].kind <= resources[i].kind);
+
+    color = psy_shader_program_find_resource(
+        program, PSY_PROGRAM_UNIFORM, "u_color"
+        );
+    CU_ASSERT_PTR_NOT_NULL(color);
+    if (color) {
+        CU_ASSERT_EQUAL(color->type, GL_FLOAT_VEC4);
+        CU_ASSERT_EQUAL(color->size, 1);
+        CU_ASSERT_EQUAL(
+            color->location,
+            glGetUniformLocation(program->program_id, "u_color")
+            );
+    }
+    CU_ASSERT_NOT_EQUAL(
+        psy_shader_program_uniform_location(program, "u_transform"), -1
+        );
+    CU_ASSERT_NOT_EQUAL(
+        psy_shader_program_attribute_location(program, "a_position"), -1
+        );
+    CU_ASSERT_EQUAL(
+        psy_shader_program_uniform_location(program, "a_position"), -1
+        );
+    CU_ASSERT_EQUAL(
+        psy_shader_program_uniform_location(program, "u_nonexisting"), -1
+        );
+
+gl_shader_program_reflection_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(program));
+    see_object_decref(SEE_OBJECT(vertex));
+    see_object_decref(SEE_OBJECT(fragment));
+}
+
 int add_glshader_program_suite(void)
 {
     g_win_width     = g_settings.window_settings.width;
@@ -426,6 +539,8 @@ int add_glshader_program_suite(void)
     PSY_SUITE_ADD_TEST(suite_name, gl_shader_program_link);
     PSY_SUITE_ADD_TEST(suite_name, gl_shader_program_src);
     PSY_SUITE_ADD_TEST(suite_name, gl_shader_program_failure);
+    PSY_SUITE_ADD_TEST(suite_name, gl_shader_program_warm_up);
+    PSY_SUITE_ADD_TEST(suite_name, gl_shader_program_reflection);
 
     return 0;
 }
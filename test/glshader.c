@@ -313,6 +313,37 @@ static void gl_shader_compile_failure(void)
     see_object_decref(SEE_OBJECT(error));
 }
 
+static void gl_shader_compile_builtin(void)
+{
+    int ret;
+    PsyShader* shader = NULL;
+    SeeError*   error = NULL;
+    psy_shader_t type;
+
+    ret = psy_shader_create(&shader, PSY_SHADER_FRAGMENT, &error);
+    if (ret != SEE_SUCCESS) {
+        CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+        return;
+    }
+
+    ret = psy_shader_compile_builtin(shader, "uniform_color", &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "%s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        error = NULL;
+    }
+    CU_ASSERT(psy_shader_compiled(shader));
+    psy_shader_type(shader, &type);
+    CU_ASSERT_EQUAL(type, PSY_SHADER_FRAGMENT);
+
+    ret = psy_shader_compile_builtin(shader, "no_such_shader", &error);
+    CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+    CU_ASSERT_PTR_NOT_EQUAL(error, NULL);
+    see_object_decref(SEE_OBJECT(error));
+
+    see_object_decref(SEE_OBJECT(shader));
+}
 
 int add_glshader_suite()
 {
@@ -343,6 +374,7 @@ int add_glshader_suite()
     PSY_SUITE_ADD_TEST(suite_name, gl_shader_compile);
     PSY_SUITE_ADD_TEST(suite_name, gl_shader_compile_file);
     PSY_SUITE_ADD_TEST(suite_name, gl_shader_compile_fragment_file);
+    PSY_SUITE_ADD_TEST(suite_name, gl_shader_compile_builtin);
     PSY_SUITE_ADD_TEST(suite_name, gl_shader_compile_failure);
 
     return 0;
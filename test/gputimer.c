@@ -0,0 +1,246 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <CUnit/CUnit.h>
+#include "../src/GpuTimer.h"
+#include "../src/Window.h"
+#include "globals.h"
+#include "psy_test_macros.h"
+
+static PsyWindow* g_win = NULL;
+
+static int g_win_x;
+static int g_win_y;
+static int g_win_width;
+static int g_win_height;
+
+static const char* suite_name = "gputimer";
+
+static int
+draw_clear(void* stimulus, const GLfloat* transform, SeeError** error)
+{
+    (void) stimulus;
+    (void) transform;
+    (void) error;
+    glClear(GL_COLOR_BUFFER_BIT);
+    return SEE_SUCCESS;
+}
+
+static int setup(void)
+{
+    SeeError*   error   = NULL;
+    PsyRect     rect    = {
+        {.x = g_win_x, .y = g_win_y},
+        {.width = g_win_width, .height = g_win_height}
+    };
+    int ret;
+
+    ret = psy_window_create_rect(&g_win, rect, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return 1;
+    }
+    psy_window_show(g_win);
+
+    return 0;
+}
+
+static int
+teardown(void)
+{
+    if (g_win) {
+        see_object_decref(SEE_OBJECT(g_win));
+        g_win = NULL;
+    }
+    return 0;
+}
+
+void gpu_timer_scope(void)
+{
+    int ret, a = -1, b = -1, again = -1;
+    PsyGpuTimer* timer = NULL;
+    SeeError* error = NULL;
+
+    ret = psy_gpu_timer_create(&timer, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto gpu_timer_scope_error;
+
+    psy_gpu_timer_scope(timer, "a", &a, &error);
+    psy_gpu_timer_scope(timer, "b", &b, &error);
+    psy_gpu_timer_scope(timer, "a", &again, &error);
+    CU_ASSERT_PTR_NULL(error);
+    CU_ASSERT_EQUAL(a, 0);
+    CU_ASSERT_EQUAL(b, 1);
+    CU_ASSERT_EQUAL(again, a);
+
+    CU_ASSERT_EQUAL(psy_gpu_timer_num_scopes(timer), 2);
+    CU_ASSERT_STRING_EQUAL(psy_gpu_timer_stats(timer, b)->name, "b");
+    CU_ASSERT_EQUAL(psy_gpu_timer_stats(timer, b)->count, 0);
+    CU_ASSERT_PTR_NULL(psy_gpu_timer_stats(timer, 2));
+
+gpu_timer_scope_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(timer));
+}
+
+void gpu_timer_measure(void)
+{
+    int ret, outer = -1, inner = -1;
+    PsyGpuTimer* timer = NULL;
+    SeeError* error = NULL;
+    const PsyGpuTimerStats *outer_stats, *inner_stats;
+
+    ret = psy_gpu_timer_create(&timer, &error);
+    if (ret)
+        goto gpu_timer_measure_error;
+
+    psy_gpu_timer_scope(timer, "outer", &outer, &error);
+    psy_gpu_timer_scope(timer, "inner", &inner, &error);
+
+    for (int i = 0; i < 2 * PSY_GPU_TIMER_FRAMES; i++) {
+        psy_gpu_timer_begin(timer, outer);
+        psy_window_clear(g_win);
+        psy_gpu_timer_begin(timer, inner);
+        psy_window_clear(g_win);
+        psy_gpu_timer_end(timer, inner);
+        psy_gpu_timer_end(timer, outer);
+        psy_window_swap(g_win);
+        // Make sure the results are in when the frame is collected.
+        glFinish();
+        psy_gpu_timer_next_frame(timer);
+    }
+
+    outer_stats = psy_gpu_timer_stats(timer, outer);
+    inner_stats = psy_gpu_timer_stats(timer, inner);
+    if (!psy_gpu_timer_supported(timer)) {
+        CU_ASSERT_EQUAL(outer_stats->count, 0);
+        goto gpu_timer_measure_error;
+    }
+
+    CU_ASSERT(outer_stats->count > 0);
+    CU_ASSERT_EQUAL(outer_stats->count, inner_stats->count);
+    CU_ASSERT(outer_stats->total >= inner_stats->total);
+    CU_ASSERT(outer_stats->max >= outer_stats->last);
+    CU_ASSERT_EQUAL(psy_gpu_timer_dropped(timer), 0);
+
+    if (g_settings.verbose)
+        psy_gpu_timer_print_stats(timer, stdout);
+
+    psy_gpu_timer_reset_stats(timer);
+    CU_ASSERT_EQUAL(psy_gpu_timer_stats(timer, outer)->count, 0);
+    CU_ASSERT_EQUAL(psy_gpu_timer_num_scopes(timer), 2);
+
+gpu_timer_measure_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(timer));
+}
+
+void gpu_timer_window(void)
+{
+    int ret, scope = -1;
+    size_t handle = 0;
+    PsyDisplayList* list = NULL;
+    PsyGpuTimer* timer = NULL;
+    SeeError* error = NULL;
+    PsyDisplayItem item = {0};
+
+    CU_ASSERT_PTR_NULL(psy_window_gpu_timer(g_win));
+    ret = psy_window_set_gpu_timing(g_win, 1, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto gpu_timer_window_error;
+    timer = psy_window_gpu_timer(g_win);
+    CU_ASSERT_PTR_NOT_NULL(timer);
+
+    ret = psy_window_display_list(g_win, &list, &error);
+    if (ret)
+        goto gpu_timer_window_error;
+
+    item.draw = draw_clear;
+    item.name = "clear";
+    ret = psy_display_list_add(list, &item, &handle, &error);
+    if (ret)
+        goto gpu_timer_window_error;
+
+    // The window advances the frames of the timer when it swaps.
+    for (int i = 0; i < 2 * PSY_GPU_TIMER_FRAMES && !ret; i++) {
+        ret = psy_window_draw(g_win, NULL, &error);
+        glFinish();
+        psy_window_swap(g_win);
+    }
+
+    ret = psy_gpu_timer_scope(timer, "clear", &scope, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    CU_ASSERT_EQUAL(psy_gpu_timer_num_scopes(timer), 1);
+    if (psy_gpu_timer_supported(timer))
+        CU_ASSERT(psy_gpu_timer_stats(timer, scope)->count > 0);
+
+    psy_display_list_remove(list, handle, &error);
+
+gpu_timer_window_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    psy_window_set_gpu_timing(g_win, 0, &error);
+    CU_ASSERT_PTR_NULL(psy_window_gpu_timer(g_win));
+}
+
+int add_gpu_timer_suite(void)
+{
+    g_win_width     = g_settings.window_settings.width;
+    g_win_height    = g_settings.window_settings.height;
+    g_win_x         = g_settings.window_settings.x;
+    g_win_y         = g_settings.window_settings.y;
+
+    CU_pSuite suite = CU_add_suite(
+        suite_name,
+        setup,
+        teardown
+        );
+
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(
+            stderr,
+            "Unable to create suite: \"%s\": %s\n",
+            suite_name,
+            CU_get_error_msg()
+        );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, gpu_timer_scope);
+    PSY_SUITE_ADD_TEST(suite_name, gpu_timer_measure);
+    PSY_SUITE_ADD_TEST(suite_name, gpu_timer_window);
+
+    return 0;
+}
@@ -0,0 +1,199 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <CUnit/CUnit.h>
+#include "../src/Grating.h"
+#include "../src/Window.h"
+#include "globals.h"
+#include "psy_test_macros.h"
+
+static PsyWindow* g_win = NULL;
+
+static int g_win_x;
+static int g_win_y;
+static int g_win_width;
+static int g_win_height;
+
+static const char* suite_name = "grating";
+
+static int setup(void)
+{
+    SeeError*   error   = NULL;
+    PsyRect     rect    = {
+        {.x = g_win_x, .y = g_win_y},
+        {.width = g_win_width, .height = g_win_height}
+    };
+    int ret;
+
+    ret = psy_window_create_rect(&g_win, rect, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return 1;
+    }
+    psy_window_show(g_win);
+
+    return 0;
+}
+
+static int
+teardown(void)
+{
+    if (g_win) {
+        see_object_decref(SEE_OBJECT(g_win));
+        g_win = NULL;
+    }
+    return 0;
+}
+
+void grating_add(void)
+{
+    int ret;
+    PsyGrating* grating = NULL;
+    SeeError* error = NULL;
+    PsyGratingParameters parameters[64] = {{0}};
+
+    ret = psy_grating_create(&grating, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto grating_add_error;
+
+    parameters[0].kind = PSY_GRATING_RADIAL_CHECKERBOARD + 1;
+    ret = psy_grating_add(grating, parameters, 1, &error);
+    CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+    CU_ASSERT_EQUAL(psy_grating_size(grating), 0);
+
+    parameters[0].kind = PSY_GRATING_GABOR;
+    ret = psy_grating_add(grating, parameters, 64, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    CU_ASSERT_EQUAL(psy_grating_size(grating), 64);
+
+    psy_grating_clear(grating);
+    CU_ASSERT_EQUAL(psy_grating_size(grating), 0);
+
+grating_add_error:
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(grating));
+}
+
+void grating_draw(void)
+{
+    int ret;
+    PsyGrating* grating = NULL;
+    SeeError* error = NULL;
+    GLubyte pixel[4] = {0};
+
+    // A cosine phase grating has its peak at the center, the other kinds
+    // are there to check that they compile and draw.
+    const PsyGratingParameters parameters[] = {
+        {
+            .kind = PSY_GRATING_SINE, .x = 0.0f, .y = 0.0f, .size = 0.5f,
+            .orientation = 0.0f, .frequency = 4.0f, .phase = 90.0f,
+            .contrast = 1.0f, .sigma = 0.0f
+        },
+        {
+            .kind = PSY_GRATING_GABOR, .x = -0.6f, .y = 0.6f, .size = 0.3f,
+            .orientation = 45.0f, .frequency = 10.0f, .contrast = 0.5f,
+            .sigma = 0.05f
+        },
+        {
+            .kind = PSY_GRATING_SQUARE, .x = 0.6f, .y = 0.6f, .size = 0.3f,
+            .frequency = 10.0f, .contrast = 1.0f
+        },
+        {
+            .kind = PSY_GRATING_PLAID, .x = -0.6f, .y = -0.6f, .size = 0.3f,
+            .frequency = 10.0f, .contrast = 1.0f, .plaid_angle = 90.0f
+        },
+        {
+            .kind = PSY_GRATING_RADIAL_CHECKERBOARD, .x = 0.6f, .y = -0.6f,
+            .size = 0.3f, .frequency = 10.0f, .contrast = 1.0f,
+            .segments = 16.0f
+        }
+    };
+
+    ret = psy_grating_create(&grating, &error);
+    if (ret)
+        goto grating_draw_error;
+    ret = psy_grating_add(
+        grating,
+        parameters,
+        sizeof(parameters) / sizeof(parameters[0]),
+        &error
+        );
+    if (ret)
+        goto grating_draw_error;
+
+    glViewport(0, 0, g_win_width, g_win_height);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    ret = psy_grating_draw(grating, NULL, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto grating_draw_error;
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+    glReadPixels(
+        g_win_width / 2, g_win_height / 2, 1, 1,
+        GL_RGBA, GL_UNSIGNED_BYTE, pixel
+        );
+    CU_ASSERT(pixel[0] > 240);
+    CU_ASSERT(pixel[1] > 240);
+    CU_ASSERT(pixel[2] > 240);
+
+grating_draw_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(grating));
+}
+
+int add_grating_suite(void)
+{
+    g_win_width     = g_settings.window_settings.width;
+    g_win_height    = g_settings.window_settings.height;
+    g_win_x         = g_settings.window_settings.x;
+    g_win_y         = g_settings.window_settings.y;
+
+    CU_pSuite suite = CU_add_suite(
+        suite_name,
+        setup,
+        teardown
+        );
+
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(
+            stderr,
+            "Unable to create suite: \"%s\": %s\n",
+            suite_name,
+            CU_get_error_msg()
+        );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, grating_add);
+    PSY_SUITE_ADD_TEST(suite_name, grating_draw);
+
+    return 0;
+}
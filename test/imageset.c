@@ -0,0 +1,289 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include <CUnit/CUnit.h>
+#include "../src/ImageLoader.h"
+#include "../src/ImageSet.h"
+#include "../src/Window.h"
+#include "globals.h"
+#include "psy_test_macros.h"
+
+static PsyWindow* g_win = NULL;
+
+static int g_win_x;
+static int g_win_y;
+static int g_win_width;
+static int g_win_height;
+
+static const char* suite_name = "imageset";
+
+/* Three images of 16x16 and one of 8x8. */
+static const char* g_paths[] = {
+    "psy_image_set_0.bmp",
+    "psy_image_set_1.bmp",
+    "psy_image_set_2.bmp",
+    "psy_image_set_small.bmp"
+};
+
+enum {
+    NUM_IMAGES  = 4,
+    LARGE       = 16,
+    SMALL       = 8,
+    // room for two large images
+    BUDGET      = 2 * LARGE * LARGE * 4
+};
+
+static int
+write_bitmap(const char* path, int size)
+{
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(
+        0, size, size, 32, SDL_PIXELFORMAT_RGBA32
+        );
+    int ret;
+
+    if (!surface)
+        return -1;
+    memset(surface->pixels, 0x40, (size_t) (surface->pitch * surface->h));
+    ret = SDL_SaveBMP(surface, path);
+    SDL_FreeSurface(surface);
+    return ret;
+}
+
+static int setup(void)
+{
+    SeeError*   error   = NULL;
+    PsyRect     rect    = {
+        {.x = g_win_x, .y = g_win_y},
+        {.width = g_win_width, .height = g_win_height}
+    };
+    int ret, i;
+
+    for (i = 0; i < NUM_IMAGES; i++) {
+        int size = i == NUM_IMAGES - 1 ? SMALL : LARGE;
+        if (write_bitmap(g_paths[i], size) != 0) {
+            fprintf(stderr, "Unable to write %s: %s\n", g_paths[i], SDL_GetError());
+            return 1;
+        }
+    }
+
+    ret = psy_window_create_rect(&g_win, rect, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return 1;
+    }
+    psy_window_show(g_win);
+
+    return 0;
+}
+
+static int
+teardown(void)
+{
+    int i;
+
+    if (g_win) {
+        see_object_decref(SEE_OBJECT(g_win));
+        g_win = NULL;
+    }
+    for (i = 0; i < NUM_IMAGES; i++)
+        remove(g_paths[i]);
+    return 0;
+}
+
+static int
+create_set(PsyImageSet** set, SeeError** error)
+{
+    int ret, i;
+
+    ret = psy_image_set_create(set, BUDGET, error);
+    if (ret)
+        return ret;
+    for (i = 0; i < NUM_IMAGES; i++) {
+        ret = psy_image_set_add(*set, g_paths[i], NULL, error);
+        if (ret)
+            return ret;
+    }
+    return ret;
+}
+
+void image_set_budget(void)
+{
+    int ret;
+    PsyImageSet* set = NULL;
+    SeeError* error = NULL;
+    PsyImageLocation location;
+
+    ret = create_set(&set, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto image_set_budget_error;
+    CU_ASSERT_EQUAL(psy_image_set_size(set), NUM_IMAGES);
+    CU_ASSERT_EQUAL(psy_image_set_memory_used(set), 0);
+
+    ret = psy_image_set_acquire(set, 0, &location, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto image_set_budget_error;
+    CU_ASSERT_EQUAL(location.width, LARGE);
+    CU_ASSERT_EQUAL(location.height, LARGE);
+    CU_ASSERT_NOT_EQUAL(location.texture, 0);
+
+    // The first two share one page, the third evicts the first.
+    ret = psy_image_set_acquire(set, 1, &location, &error);
+    if (ret)
+        goto image_set_budget_error;
+    ret = psy_image_set_acquire(set, 2, &location, &error);
+    if (ret)
+        goto image_set_budget_error;
+    CU_ASSERT_FALSE(psy_image_set_is_resident(set, 0));
+    CU_ASSERT_TRUE(psy_image_set_is_resident(set, 1));
+    CU_ASSERT_TRUE(psy_image_set_is_resident(set, 2));
+    CU_ASSERT_EQUAL(psy_image_set_memory_used(set), BUDGET);
+
+    // An image of another size needs a page of its own.
+    ret = psy_image_set_acquire(set, 3, &location, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto image_set_budget_error;
+    CU_ASSERT_EQUAL(location.width, SMALL);
+    CU_ASSERT_FALSE(psy_image_set_is_resident(set, 1));
+    CU_ASSERT_FALSE(psy_image_set_is_resident(set, 2));
+    CU_ASSERT_TRUE(psy_image_set_is_resident(set, 3));
+    CU_ASSERT(psy_image_set_memory_used(set) <= BUDGET);
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+image_set_budget_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(set));
+}
+
+void image_set_prefetch(void)
+{
+    int ret, i;
+    PsyImageSet* set = NULL;
+    SeeError* error = NULL;
+    const size_t upcoming[] = {1, 2};
+
+    ret = create_set(&set, &error);
+    if (ret)
+        goto image_set_prefetch_error;
+
+    ret = psy_image_set_prefetch(set, upcoming, 2, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto image_set_prefetch_error;
+
+    for (i = 0; i < 500; i++) {
+        ret = psy_image_set_update(set, &error);
+        CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+        if (ret)
+            goto image_set_prefetch_error;
+        if (psy_image_set_is_resident(set, 1) &&
+            psy_image_set_is_resident(set, 2))
+            break;
+        SDL_Delay(10);
+    }
+    CU_ASSERT_TRUE(psy_image_set_is_resident(set, 1));
+    CU_ASSERT_TRUE(psy_image_set_is_resident(set, 2));
+    CU_ASSERT_FALSE(psy_image_set_is_resident(set, 0));
+
+image_set_prefetch_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(set));
+}
+
+void image_set_loader_stopped(void)
+{
+    int ret, i;
+    PsyImageSet* set = NULL;
+    SeeError* error = NULL;
+    PsyImageLocation location;
+    const size_t upcoming[] = {0, 1, 2, 3};
+
+    ret = create_set(&set, &error);
+    if (ret)
+        goto image_set_loader_stopped_error;
+
+    ret = psy_image_set_prefetch(set, upcoming, NUM_IMAGES, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto image_set_loader_stopped_error;
+
+    // The images that weren't decoded yet are cancelled, acquiring them
+    // fails instead of waiting forever.
+    psy_image_loader_stop();
+    for (i = 0; i < NUM_IMAGES; i++) {
+        ret = psy_image_set_acquire(set, (size_t) i, &location, &error);
+        if (ret) {
+            CU_ASSERT_PTR_NOT_NULL(error);
+            see_object_decref(SEE_OBJECT(error));
+            error = NULL;
+        }
+    }
+
+image_set_loader_stopped_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(set));
+}
+
+int add_image_set_suite(void)
+{
+    g_win_width     = g_settings.window_settings.width;
+    g_win_height    = g_settings.window_settings.height;
+    g_win_x         = g_settings.window_settings.x;
+    g_win_y         = g_settings.window_settings.y;
+
+    CU_pSuite suite = CU_add_suite(
+        suite_name,
+        setup,
+        teardown
+        );
+
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(
+            stderr,
+            "Unable to create suite: \"%s\": %s\n",
+            suite_name,
+            CU_get_error_msg()
+        );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, image_set_budget);
+    PSY_SUITE_ADD_TEST(suite_name, image_set_prefetch);
+    PSY_SUITE_ADD_TEST(suite_name, image_set_loader_stopped);
+
+    return 0;
+}
@@ -0,0 +1,233 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <CUnit/CUnit.h>
+#include "../src/Mesh.h"
+#include "../src/Framebuffer.h"
+#include "../src/Window.h"
+#include "globals.h"
+#include "psy_test_macros.h"
+
+static PsyWindow* g_win = NULL;
+
+static int g_win_x;
+static int g_win_y;
+static int g_win_width;
+static int g_win_height;
+
+static const char* suite_name = "mesh";
+
+#define TARGET_SIZE 16
+
+static int setup(void)
+{
+    SeeError*   error   = NULL;
+    PsyRect     rect    = {
+        {.x = g_win_x, .y = g_win_y},
+        {.width = g_win_width, .height = g_win_height}
+    };
+    int ret;
+
+    ret = psy_window_create_rect(&g_win, rect, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return 1;
+    }
+    psy_window_show(g_win);
+
+    return 0;
+}
+
+static int
+teardown(void)
+{
+    if (g_win) {
+        see_object_decref(SEE_OBJECT(g_win));
+        g_win = NULL;
+    }
+    return 0;
+}
+
+void mesh_primitives(void)
+{
+    int ret;
+    PsyMesh* mesh = NULL;
+    SeeError* error = NULL;
+    PsyPrimitive circle = {.shape = PSY_MESH_CIRCLE, .segments = 32};
+    PsyPrimitive annulus = {.shape = PSY_MESH_ANNULUS, .segments = 32, .ratio = 0.5f};
+    PsyPrimitive rectangle = {.shape = PSY_MESH_RECTANGLE};
+    PsyPrimitive cross = {.shape = PSY_MESH_CROSS, .ratio = 0.2f};
+
+    ret = psy_mesh_create_primitive(&mesh, &circle, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto mesh_primitives_error;
+    CU_ASSERT_EQUAL(psy_mesh_mode(mesh), GL_TRIANGLE_FAN);
+    CU_ASSERT_EQUAL(psy_mesh_num_vertices(mesh), 34);
+    see_object_decref(SEE_OBJECT(mesh));
+    mesh = NULL;
+
+    ret = psy_mesh_create_primitive(&mesh, &annulus, &error);
+    if (ret)
+        goto mesh_primitives_error;
+    CU_ASSERT_EQUAL(psy_mesh_mode(mesh), GL_TRIANGLE_STRIP);
+    CU_ASSERT_EQUAL(psy_mesh_num_vertices(mesh), 66);
+    see_object_decref(SEE_OBJECT(mesh));
+    mesh = NULL;
+
+    ret = psy_mesh_create_primitive(&mesh, &rectangle, &error);
+    if (ret)
+        goto mesh_primitives_error;
+    CU_ASSERT_EQUAL(psy_mesh_num_vertices(mesh), 4);
+    see_object_decref(SEE_OBJECT(mesh));
+    mesh = NULL;
+
+    ret = psy_mesh_create_primitive(&mesh, &cross, &error);
+    if (ret)
+        goto mesh_primitives_error;
+    CU_ASSERT_EQUAL(psy_mesh_mode(mesh), GL_TRIANGLES);
+    CU_ASSERT_EQUAL(psy_mesh_num_vertices(mesh), 18);
+    see_object_decref(SEE_OBJECT(mesh));
+    mesh = NULL;
+
+    // A ring without a hole isn't an annulus.
+    annulus.ratio = 1.0f;
+    ret = psy_mesh_create_primitive(&mesh, &annulus, &error);
+    CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+    CU_ASSERT_PTR_NULL(mesh);
+    if (error) {
+        see_object_decref(SEE_OBJECT(error));
+        error = NULL;
+    }
+    circle.segments = 2;
+    ret = psy_mesh_create_primitive(&mesh, &circle, &error);
+    CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+    if (error) {
+        see_object_decref(SEE_OBJECT(error));
+        error = NULL;
+    }
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+mesh_primitives_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(mesh));
+}
+
+void mesh_draw(void)
+{
+    int ret;
+    PsyMesh* mesh = NULL;
+    PsyShaderProgram* program = NULL;
+    PsyFramebuffer* target = NULL;
+    SeeError* error = NULL;
+    unsigned char pixels[TARGET_SIZE * TARGET_SIZE * 4];
+    size_t center = (TARGET_SIZE / 2 * TARGET_SIZE + TARGET_SIZE / 2) * 4;
+    PsyPrimitive annulus = {.shape = PSY_MESH_ANNULUS, .segments = 64, .ratio = 0.5f};
+    // Scale the unit primitive to the whole viewport.
+    const GLfloat transform[16] = {
+        2.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 2.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+    const GLfloat red[4] = {1.0f, 0.0f, 0.0f, 1.0f};
+
+    ret = psy_mesh_create_primitive(&mesh, &annulus, &error);
+    if (ret)
+        goto mesh_draw_error;
+    ret = psy_shader_program_create_builtin(
+        &program, "uniform_color", "uniform_color", &error
+        );
+    if (ret)
+        goto mesh_draw_error;
+    ret = psy_framebuffer_create(
+        &target, TARGET_SIZE, TARGET_SIZE, PSY_FRAMEBUFFER_RGBA8, 0, &error
+        );
+    if (ret)
+        goto mesh_draw_error;
+
+    psy_framebuffer_bind(target);
+    glClear(GL_COLOR_BUFFER_BIT);
+    ret = psy_shader_use_program(program, &error);
+    if (ret == SEE_SUCCESS) {
+        glUniformMatrix4fv(
+            psy_shader_program_uniform_location(program, "u_transform"),
+            1, GL_FALSE, transform
+            );
+        glUniform4fv(psy_shader_program_uniform_location(program, "u_color"), 1, red);
+        ret = psy_mesh_draw(mesh, program, &error);
+    }
+    psy_framebuffer_unbind(target);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto mesh_draw_error;
+
+    ret = psy_framebuffer_read(target, pixels, &error);
+    if (ret)
+        goto mesh_draw_error;
+    // The hole in the center is empty, the ring near the edge is red.
+    CU_ASSERT_EQUAL(pixels[center], 0);
+    CU_ASSERT_EQUAL(pixels[center + TARGET_SIZE / 8 * 3 * 4], 255);
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+mesh_draw_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(mesh));
+    see_object_decref(SEE_OBJECT(program));
+    see_object_decref(SEE_OBJECT(target));
+}
+
+int add_mesh_suite(void)
+{
+    g_win_width     = g_settings.window_settings.width;
+    g_win_height    = g_settings.window_settings.height;
+    g_win_x         = g_settings.window_settings.x;
+    g_win_y         = g_settings.window_settings.y;
+
+    CU_pSuite suite = CU_add_suite(
+        suite_name,
+        setup,
+        teardown
+        );
+
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(
+            stderr,
+            "Unable to create suite: \"%s\": %s\n",
+            suite_name,
+            CU_get_error_msg()
+        );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, mesh_primitives);
+    PSY_SUITE_ADD_TEST(suite_name, mesh_draw);
+
+    return 0;
+}
@@ -0,0 +1,207 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <CUnit/CUnit.h>
+#include "../src/MeshCache.h"
+#include "../src/Framebuffer.h"
+#include "../src/Window.h"
+#include "globals.h"
+#include "psy_test_macros.h"
+
+static PsyWindow* g_win = NULL;
+
+static int g_win_x;
+static int g_win_y;
+static int g_win_width;
+static int g_win_height;
+
+static const char* suite_name = "meshcache";
+
+#define TARGET_SIZE 16
+
+static int setup(void)
+{
+    SeeError*   error   = NULL;
+    PsyRect     rect    = {
+        {.x = g_win_x, .y = g_win_y},
+        {.width = g_win_width, .height = g_win_height}
+    };
+    int ret;
+
+    ret = psy_window_create_rect(&g_win, rect, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return 1;
+    }
+    psy_window_show(g_win);
+
+    return 0;
+}
+
+static int
+teardown(void)
+{
+    if (g_win) {
+        see_object_decref(SEE_OBJECT(g_win));
+        g_win = NULL;
+    }
+    return 0;
+}
+
+void mesh_cache_get(void)
+{
+    int ret;
+    PsyMeshCache* cache = NULL;
+    PsyMesh* first = NULL;
+    PsyMesh* second = NULL;
+    SeeError* error = NULL;
+    PsyPrimitive circle = {.shape = PSY_MESH_CIRCLE, .segments = 32};
+    PsyPrimitive rectangle = {.shape = PSY_MESH_RECTANGLE};
+
+    ret = psy_mesh_cache_create(&cache, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto mesh_cache_get_error;
+
+    ret = psy_mesh_cache_get(cache, &circle, &first, &error);
+    if (ret)
+        goto mesh_cache_get_error;
+    ret = psy_mesh_cache_get(cache, &circle, &second, &error);
+    if (ret)
+        goto mesh_cache_get_error;
+    CU_ASSERT_PTR_EQUAL(first, second);
+    CU_ASSERT_EQUAL(psy_mesh_cache_size(cache), 1);
+
+    // Another tessellation is another mesh.
+    circle.segments = 64;
+    second = NULL;
+    ret = psy_mesh_cache_get(cache, &circle, &second, &error);
+    if (ret)
+        goto mesh_cache_get_error;
+    CU_ASSERT_PTR_NOT_EQUAL(first, second);
+    CU_ASSERT_EQUAL(psy_mesh_cache_size(cache), 2);
+
+    // The segments of a rectangle don't matter.
+    first = second = NULL;
+    ret = psy_mesh_cache_get(cache, &rectangle, &first, &error);
+    if (ret)
+        goto mesh_cache_get_error;
+    rectangle.segments = 12;
+    ret = psy_mesh_cache_get(cache, &rectangle, &second, &error);
+    if (ret)
+        goto mesh_cache_get_error;
+    CU_ASSERT_PTR_EQUAL(first, second);
+    CU_ASSERT_EQUAL(psy_mesh_cache_size(cache), 3);
+
+    psy_mesh_cache_clear(cache);
+    CU_ASSERT_EQUAL(psy_mesh_cache_size(cache), 0);
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+mesh_cache_get_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(cache));
+}
+
+void mesh_cache_draw(void)
+{
+    int ret;
+    PsyMeshCache* cache = NULL;
+    PsyFramebuffer* target = NULL;
+    SeeError* error = NULL;
+    unsigned char pixels[TARGET_SIZE * TARGET_SIZE * 4];
+    size_t center = (TARGET_SIZE / 2 * TARGET_SIZE + TARGET_SIZE / 2) * 4;
+    PsyPrimitive cross = {.shape = PSY_MESH_CROSS, .ratio = 0.25f};
+    const GLfloat transform[16] = {
+        2.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 2.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f
+    };
+    const GLfloat green[4] = {0.0f, 1.0f, 0.0f, 1.0f};
+
+    // The cache of the window lives as long as the window.
+    ret = psy_window_mesh_cache(g_win, &cache, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto mesh_cache_draw_error;
+    ret = psy_framebuffer_create(
+        &target, TARGET_SIZE, TARGET_SIZE, PSY_FRAMEBUFFER_RGBA8, 0, &error
+        );
+    if (ret)
+        goto mesh_cache_draw_error;
+
+    psy_framebuffer_bind(target);
+    glClear(GL_COLOR_BUFFER_BIT);
+    ret = psy_mesh_cache_draw(cache, &cross, transform, green, &error);
+    psy_framebuffer_unbind(target);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto mesh_cache_draw_error;
+
+    ret = psy_framebuffer_read(target, pixels, &error);
+    if (ret)
+        goto mesh_cache_draw_error;
+    // The center is on the cross, the corners are not.
+    CU_ASSERT_EQUAL(pixels[center + 1], 255);
+    CU_ASSERT_EQUAL(pixels[1], 0);
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+mesh_cache_draw_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(target));
+}
+
+int add_mesh_cache_suite(void)
+{
+    g_win_width     = g_settings.window_settings.width;
+    g_win_height    = g_settings.window_settings.height;
+    g_win_x         = g_settings.window_settings.x;
+    g_win_y         = g_settings.window_settings.y;
+
+    CU_pSuite suite = CU_add_suite(
+        suite_name,
+        setup,
+        teardown
+        );
+
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(
+            stderr,
+            "Unable to create suite: \"%s\": %s\n",
+            suite_name,
+            CU_get_error_msg()
+        );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, mesh_cache_get);
+    PSY_SUITE_ADD_TEST(suite_name, mesh_cache_draw);
+
+    return 0;
+}
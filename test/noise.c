@@ -0,0 +1,281 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <CUnit/CUnit.h>
+#include "../src/Noise.h"
+#include "../src/Window.h"
+#include "globals.h"
+#include "psy_test_macros.h"
+
+static PsyWindow* g_win = NULL;
+
+static int g_win_x;
+static int g_win_y;
+static int g_win_width;
+static int g_win_height;
+
+static const char* suite_name = "noise";
+
+#define NOISE_SIZE 64
+#define NUM_PIXELS (NOISE_SIZE * NOISE_SIZE)
+
+static int setup(void)
+{
+    SeeError*   error   = NULL;
+    PsyRect     rect    = {
+        {.x = g_win_x, .y = g_win_y},
+        {.width = g_win_width, .height = g_win_height}
+    };
+    int ret;
+
+    ret = psy_window_create_rect(&g_win, rect, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return 1;
+    }
+    psy_window_show(g_win);
+
+    return 0;
+}
+
+static int
+teardown(void)
+{
+    if (g_win) {
+        see_object_decref(SEE_OBJECT(g_win));
+        g_win = NULL;
+    }
+    return 0;
+}
+
+static void
+statistics(const unsigned char* pixels, double* mean, double* var, double* r)
+{
+    double sum = 0, sum_sq = 0, sum_lag = 0;
+    int i;
+
+    for (i = 0; i < NUM_PIXELS; i++) {
+        sum += pixels[i];
+        sum_sq += pixels[i] * (double) pixels[i];
+    }
+    *mean = sum / NUM_PIXELS;
+    *var = sum_sq / NUM_PIXELS - *mean * *mean;
+
+    // The correlation of horizontally adjacent pixels.
+    for (i = 0; i < NUM_PIXELS - 1; i++)
+        sum_lag += (pixels[i] - *mean) * (pixels[i + 1] - *mean);
+    *r = sum_lag / (NUM_PIXELS - 1) / *var;
+}
+
+void noise_white(void)
+{
+    int ret;
+    PsyNoise* noise = NULL;
+    SeeError* error = NULL;
+    unsigned char first[NUM_PIXELS], second[NUM_PIXELS];
+    double mean, var, r;
+    PsyNoiseParameters params = {
+        .kind = PSY_NOISE_WHITE,
+        .seed = 1,
+        .mean = 0.5f,
+        .contrast = 0.125f
+    };
+
+    ret = psy_noise_create(&noise, NOISE_SIZE, NOISE_SIZE, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto noise_white_error;
+    CU_ASSERT_NOT_EQUAL(psy_noise_texture(noise), 0);
+
+    ret = psy_noise_generate(noise, &params, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto noise_white_error;
+    ret = psy_noise_read(noise, first, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto noise_white_error;
+
+    statistics(first, &mean, &var, &r);
+    CU_ASSERT_DOUBLE_EQUAL(mean, 127.5, 4.0);
+    // A standard deviation of 0.125 * 255 = 31.9 +/- 4
+    CU_ASSERT(var > 28.0 * 28.0 && var < 36.0 * 36.0);
+    CU_ASSERT_DOUBLE_EQUAL(r, 0.0, 0.1);
+
+    // The same seed gives the same noise, another seed other noise.
+    ret = psy_noise_generate(noise, &params, &error);
+    if (ret)
+        goto noise_white_error;
+    ret = psy_noise_read(noise, second, &error);
+    if (ret)
+        goto noise_white_error;
+    CU_ASSERT_EQUAL(memcmp(first, second, sizeof(first)), 0);
+
+    params.seed = 2;
+    ret = psy_noise_generate(noise, &params, &error);
+    if (ret)
+        goto noise_white_error;
+    ret = psy_noise_read(noise, second, &error);
+    if (ret)
+        goto noise_white_error;
+    CU_ASSERT_NOT_EQUAL(memcmp(first, second, sizeof(first)), 0);
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+noise_white_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(noise));
+}
+
+void noise_binary(void)
+{
+    int ret, i, levels_ok = 1;
+    PsyNoise* noise = NULL;
+    SeeError* error = NULL;
+    unsigned char pixels[NUM_PIXELS];
+    double mean, var, r;
+    PsyNoiseParameters params = {
+        .kind = PSY_NOISE_BINARY,
+        .seed = 3,
+        .mean = 0.5f,
+        .contrast = 0.5f
+    };
+
+    ret = psy_noise_create(&noise, NOISE_SIZE, NOISE_SIZE, &error);
+    if (ret)
+        goto noise_binary_error;
+    ret = psy_noise_generate(noise, &params, &error);
+    if (ret)
+        goto noise_binary_error;
+    ret = psy_noise_read(noise, pixels, &error);
+    if (ret)
+        goto noise_binary_error;
+
+    for (i = 0; i < NUM_PIXELS; i++)
+        if (pixels[i] != 0 && pixels[i] != 255)
+            levels_ok = 0;
+    CU_ASSERT(levels_ok);
+    statistics(pixels, &mean, &var, &r);
+    CU_ASSERT_DOUBLE_EQUAL(mean, 127.5, 10.0);
+
+noise_binary_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(noise));
+}
+
+void noise_filtered(void)
+{
+    int ret;
+    PsyNoise* noise = NULL;
+    SeeError* error = NULL;
+    unsigned char pixels[NUM_PIXELS];
+    double mean, var, r_pink, r_band;
+    PsyNoiseParameters params = {
+        .kind = PSY_NOISE_PINK,
+        .seed = 4,
+        .mean = 0.5f,
+        .contrast = 0.1f
+    };
+
+    ret = psy_noise_create(&noise, NOISE_SIZE, NOISE_SIZE, &error);
+    if (ret)
+        goto noise_filtered_error;
+
+    // 1/f noise has most of its power at low frequencies.
+    ret = psy_noise_generate(noise, &params, &error);
+    if (ret)
+        goto noise_filtered_error;
+    ret = psy_noise_read(noise, pixels, &error);
+    if (ret)
+        goto noise_filtered_error;
+    statistics(pixels, &mean, &var, &r_pink);
+    CU_ASSERT(r_pink > 0.5);
+
+    // A band of high frequencies is less correlated.
+    params.kind = PSY_NOISE_BANDPASS;
+    params.low_frequency = 0.125f;
+    params.high_frequency = 0.5f;
+    ret = psy_noise_generate(noise, &params, &error);
+    if (ret)
+        goto noise_filtered_error;
+    ret = psy_noise_read(noise, pixels, &error);
+    if (ret)
+        goto noise_filtered_error;
+    statistics(pixels, &mean, &var, &r_band);
+    CU_ASSERT(r_band < r_pink);
+
+    // A band beyond the Nyquist frequency is refused.
+    params.high_frequency = 1.0f;
+    ret = psy_noise_generate(noise, &params, &error);
+    CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+    CU_ASSERT_PTR_NOT_NULL(error);
+    if (error) {
+        see_object_decref(SEE_OBJECT(error));
+        error = NULL;
+    }
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+noise_filtered_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(noise));
+}
+
+int add_noise_suite(void)
+{
+    g_win_width     = g_settings.window_settings.width;
+    g_win_height    = g_settings.window_settings.height;
+    g_win_x         = g_settings.window_settings.x;
+    g_win_y         = g_settings.window_settings.y;
+
+    CU_pSuite suite = CU_add_suite(
+        suite_name,
+        setup,
+        teardown
+        );
+
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(
+            stderr,
+            "Unable to create suite: \"%s\": %s\n",
+            suite_name,
+            CU_get_error_msg()
+        );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, noise_white);
+    PSY_SUITE_ADD_TEST(suite_name, noise_binary);
+    PSY_SUITE_ADD_TEST(suite_name, noise_filtered);
+
+    return 0;
+}
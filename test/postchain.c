@@ -0,0 +1,258 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <CUnit/CUnit.h>
+#include "../src/PostChain.h"
+#include "../src/Window.h"
+#include "globals.h"
+#include "psy_test_macros.h"
+
+static PsyWindow* g_win = NULL;
+
+static int g_win_x;
+static int g_win_y;
+static int g_win_width;
+static int g_win_height;
+
+static const char* suite_name = "postchain";
+
+#define CHAIN_SIZE 16
+
+static int setup(void)
+{
+    SeeError*   error   = NULL;
+    PsyRect     rect    = {
+        {.x = g_win_x, .y = g_win_y},
+        {.width = g_win_width, .height = g_win_height}
+    };
+    int ret;
+
+    ret = psy_window_create_rect(&g_win, rect, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return 1;
+    }
+    psy_window_show(g_win);
+
+    return 0;
+}
+
+static int
+teardown(void)
+{
+    if (g_win) {
+        see_object_decref(SEE_OBJECT(g_win));
+        g_win = NULL;
+    }
+    return 0;
+}
+
+void post_chain_fusion(void)
+{
+    int ret;
+    PsyPostChain* chain = NULL;
+    SeeError* error = NULL;
+
+    ret = psy_post_chain_create(
+        &chain, CHAIN_SIZE, CHAIN_SIZE, PSY_FRAMEBUFFER_RGBA8, &error
+        );
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto post_chain_fusion_error;
+    CU_ASSERT_PTR_NOT_NULL(psy_post_chain_input(chain));
+
+    // Without passes the frame is copied.
+    ret = psy_post_chain_build(chain, &error);
+    if (ret)
+        goto post_chain_fusion_error;
+    CU_ASSERT_EQUAL(psy_post_chain_num_programs(chain), 1);
+
+    // Passes on single pixels join the pass before them.
+    ret = psy_post_chain_add_warp(chain, 0.1f, 0.0f, &error);
+    if (ret)
+        goto post_chain_fusion_error;
+    ret = psy_post_chain_add_gamma(chain, 2.2f, &error);
+    if (ret)
+        goto post_chain_fusion_error;
+    ret = psy_post_chain_add_encode_mono(chain, &error);
+    if (ret)
+        goto post_chain_fusion_error;
+    CU_ASSERT_EQUAL(psy_post_chain_num_programs(chain), 0);
+    ret = psy_post_chain_build(chain, &error);
+    if (ret)
+        goto post_chain_fusion_error;
+    CU_ASSERT_EQUAL(psy_post_chain_num_passes(chain), 3);
+    CU_ASSERT_EQUAL(psy_post_chain_num_programs(chain), 1);
+
+    // Both halves of a blur sample their neighbours.
+    psy_post_chain_clear(chain);
+    ret = psy_post_chain_add_blur(chain, 1.5f, &error);
+    if (ret)
+        goto post_chain_fusion_error;
+    ret = psy_post_chain_add_gamma(chain, 2.2f, &error);
+    if (ret)
+        goto post_chain_fusion_error;
+    ret = psy_post_chain_build(chain, &error);
+    if (ret)
+        goto post_chain_fusion_error;
+    CU_ASSERT_EQUAL(psy_post_chain_num_passes(chain), 3);
+    CU_ASSERT_EQUAL(psy_post_chain_num_programs(chain), 2);
+
+    ret = psy_post_chain_add_blur(chain, 0.0f, &error);
+    CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+    CU_ASSERT_PTR_NOT_NULL(error);
+    if (error) {
+        see_object_decref(SEE_OBJECT(error));
+        error = NULL;
+    }
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+post_chain_fusion_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(chain));
+}
+
+/* Draws a gray frame through the chain into output and reads it back. */
+static int
+apply_gray(
+    PsyPostChain*       chain,
+    PsyFramebuffer*     output,
+    GLfloat             gray,
+    unsigned char*      pixels,
+    SeeError**          error
+    )
+{
+    int ret;
+
+    psy_post_chain_begin(chain);
+    glClearColor(gray, gray, gray, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    psy_post_chain_end(chain);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+    psy_framebuffer_bind(output);
+    ret = psy_post_chain_apply(chain, error);
+    psy_framebuffer_unbind(output);
+    if (ret)
+        return ret;
+
+    return psy_framebuffer_read(output, pixels, error);
+}
+
+void post_chain_apply(void)
+{
+    int ret, value;
+    PsyPostChain* chain = NULL;
+    PsyFramebuffer* output = NULL;
+    SeeError* error = NULL;
+    unsigned char pixels[CHAIN_SIZE * CHAIN_SIZE * 4];
+    size_t center = (CHAIN_SIZE / 2 * CHAIN_SIZE + CHAIN_SIZE / 2) * 4;
+
+    ret = psy_post_chain_create(
+        &chain, CHAIN_SIZE, CHAIN_SIZE, PSY_FRAMEBUFFER_RGBA8, &error
+        );
+    if (ret)
+        goto post_chain_apply_error;
+    ret = psy_framebuffer_create(
+        &output, CHAIN_SIZE, CHAIN_SIZE, PSY_FRAMEBUFFER_RGBA8, 0, &error
+        );
+    if (ret)
+        goto post_chain_apply_error;
+
+    // 64 / 255 to the power 1 / 2 is 128 / 255.
+    ret = psy_post_chain_add_gamma(chain, 2.0f, &error);
+    if (ret)
+        goto post_chain_apply_error;
+    ret = apply_gray(chain, output, 0.25f, pixels, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto post_chain_apply_error;
+    CU_ASSERT(pixels[center] >= 126 && pixels[center] <= 130);
+
+    // A blur doesn't change a uniform frame and it takes two intermediate
+    // framebuffers before the gamma is applied.
+    ret = psy_post_chain_add_blur(chain, 1.0f, &error);
+    if (ret)
+        goto post_chain_apply_error;
+    ret = psy_post_chain_add_gamma(chain, 0.5f, &error);
+    if (ret)
+        goto post_chain_apply_error;
+    ret = apply_gray(chain, output, 0.25f, pixels, &error);
+    if (ret)
+        goto post_chain_apply_error;
+    CU_ASSERT_EQUAL(psy_post_chain_num_programs(chain), 3);
+    CU_ASSERT(pixels[center] >= 62 && pixels[center] <= 66);
+
+    // Mono++ puts the most significant byte in red, the least in green.
+    psy_post_chain_clear(chain);
+    ret = psy_post_chain_add_encode_mono(chain, &error);
+    if (ret)
+        goto post_chain_apply_error;
+    ret = apply_gray(chain, output, 0.5f, pixels, &error);
+    if (ret)
+        goto post_chain_apply_error;
+    value = pixels[center] * 256 + pixels[center + 1];
+    CU_ASSERT(value >= 32896 - 64 && value <= 32896 + 64);
+    CU_ASSERT_EQUAL(pixels[center + 2], 0);
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+post_chain_apply_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(chain));
+    see_object_decref(SEE_OBJECT(output));
+}
+
+int add_post_chain_suite(void)
+{
+    g_win_width     = g_settings.window_settings.width;
+    g_win_height    = g_settings.window_settings.height;
+    g_win_x         = g_settings.window_settings.x;
+    g_win_y         = g_settings.window_settings.y;
+
+    CU_pSuite suite = CU_add_suite(
+        suite_name,
+        setup,
+        teardown
+        );
+
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(
+            stderr,
+            "Unable to create suite: \"%s\": %s\n",
+            suite_name,
+            CU_get_error_msg()
+        );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, post_chain_fusion);
+    PSY_SUITE_ADD_TEST(suite_name, post_chain_apply);
+
+    return 0;
+}
@@ -0,0 +1,234 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <CUnit/CUnit.h>
+#include "../src/Rdk.h"
+#include "../src/Window.h"
+#include "globals.h"
+#include "psy_test_macros.h"
+
+static PsyWindow* g_win = NULL;
+
+static int g_win_x;
+static int g_win_y;
+static int g_win_width;
+static int g_win_height;
+
+static const char* suite_name = "rdk";
+
+static const PsyRdkParameters g_parameters = {
+    .num_dots   = 5000,
+    .seed       = 12345,
+    .coherence  = 0.5f,
+    .direction  = 90.0f,
+    .speed      = 0.01f,
+    .lifetime   = 10.0f,
+    .dot_size   = 3.0f,
+    .center     = {0.0f, 0.0f},
+    .radius     = 0.8f,
+    .color      = {1.0f, 1.0f, 1.0f, 1.0f}
+};
+
+static int setup(void)
+{
+    SeeError*   error   = NULL;
+    PsyRect     rect    = {
+        {.x = g_win_x, .y = g_win_y},
+        {.width = g_win_width, .height = g_win_height}
+    };
+    int ret;
+
+    ret = psy_window_create_rect(&g_win, rect, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return 1;
+    }
+    psy_window_show(g_win);
+
+    return 0;
+}
+
+static int
+teardown(void)
+{
+    if (g_win) {
+        see_object_decref(SEE_OBJECT(g_win));
+        g_win = NULL;
+    }
+    return 0;
+}
+
+/*
+ * Creates an rdk, returns NULL when the context doesn't support it.
+ */
+static PsyRdk*
+create_rdk(void)
+{
+    PsyRdk* rdk = NULL;
+    SeeError* error = NULL;
+    int ret = psy_rdk_create(&rdk, &g_parameters, &error);
+
+    if (ret == SEE_ERROR_RUNTIME && !GLAD_GL_VERSION_3_3) {
+        if (g_settings.verbose)
+            fprintf(stderr, "Expected error: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return NULL;
+    }
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return NULL;
+    }
+    return rdk;
+}
+
+/*
+ * Steps n frames from a reset and copies the current dots to dots.
+ */
+static int
+run_frames(PsyRdk* rdk, int n, void* dots, size_t size)
+{
+    SeeError* error = NULL;
+
+    psy_rdk_reset(rdk);
+    for (int i = 0; i < n; i++) {
+        if (psy_rdk_step(rdk, &error)) {
+            fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+            see_object_decref(SEE_OBJECT(error));
+            return 1;
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, rdk->vbo[rdk->current]);
+    glGetBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr) size, dots);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return 0;
+}
+
+void rdk_create(void)
+{
+    int ret;
+    PsyRdk* rdk = NULL;
+    SeeError* error = NULL;
+    PsyRdkParameters parameters = g_parameters;
+
+    parameters.num_dots = 0;
+    ret = psy_rdk_create(&rdk, &parameters, &error);
+    CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+
+    rdk = create_rdk();
+    if (!rdk)
+        return;
+    CU_ASSERT_EQUAL(psy_rdk_frame(rdk), 0);
+    see_object_decref(SEE_OBJECT(rdk));
+}
+
+void rdk_step_and_draw(void)
+{
+    int ret;
+    PsyRdk* rdk = create_rdk();
+    SeeError* error = NULL;
+
+    if (!rdk)
+        return;
+
+    glViewport(0, 0, g_win_width, g_win_height);
+    glClear(GL_COLOR_BUFFER_BIT);
+    for (int i = 0; i < 60; i++) {
+        ret = psy_rdk_step(rdk, &error);
+        CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+        if (ret)
+            break;
+        ret = psy_rdk_draw(rdk, NULL, &error);
+        CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+        if (ret)
+            break;
+        if (i == 30)
+            psy_rdk_set_coherence(rdk, 1.0f);
+    }
+    CU_ASSERT_EQUAL(psy_rdk_frame(rdk), 60);
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(rdk));
+}
+
+void rdk_reproducible(void)
+{
+    PsyRdk* rdk = create_rdk();
+    size_t size = g_parameters.num_dots * 5 * sizeof(GLfloat);
+    GLfloat* first  = malloc(size);
+    GLfloat* second = malloc(size);
+
+    if (!rdk || !first || !second)
+        goto rdk_reproducible_error;
+
+    if (run_frames(rdk, 25, first, size) || run_frames(rdk, 25, second, size)) {
+        CU_FAIL("Unable to run the rdk");
+        goto rdk_reproducible_error;
+    }
+    CU_ASSERT_EQUAL(memcmp(first, second, size), 0);
+
+    // All dots remain inside the aperture.
+    for (size_t i = 0; i < g_parameters.num_dots; i++) {
+        GLfloat x = first[i * 5], y = first[i * 5 + 1];
+        CU_ASSERT(x * x + y * y <= 1.0001f);
+    }
+
+rdk_reproducible_error:
+    free(first);
+    free(second);
+    see_object_decref(SEE_OBJECT(rdk));
+}
+
+int add_rdk_suite(void)
+{
+    g_win_width     = g_settings.window_settings.width;
+    g_win_height    = g_settings.window_settings.height;
+    g_win_x         = g_settings.window_settings.x;
+    g_win_y         = g_settings.window_settings.y;
+
+    CU_pSuite suite = CU_add_suite(
+        suite_name,
+        setup,
+        teardown
+        );
+
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(
+            stderr,
+            "Unable to create suite: \"%s\": %s\n",
+            suite_name,
+            CU_get_error_msg()
+        );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, rdk_create);
+    PSY_SUITE_ADD_TEST(suite_name, rdk_step_and_draw);
+    PSY_SUITE_ADD_TEST(suite_name, rdk_reproducible);
+
+    return 0;
+}
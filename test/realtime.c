@@ -0,0 +1,97 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include "globals.h"
+#include "psy_test_macros.h"
+#include "../src/Realtime.h"
+
+static const char* suite_name = "realtime";
+
+static void
+realtime_options(void)
+{
+    PsyRealtimeOptions options;
+    SeeError* error = NULL;
+    int ret;
+
+    psy_realtime_options_init(&options);
+    CU_ASSERT_EQUAL(options.policy, PSY_REALTIME_FIFO);
+    CU_ASSERT(options.priority >= 1 && options.priority <= 99);
+    CU_ASSERT_FALSE(options.steps & PSY_REALTIME_AFFINITY);
+
+    options.priority = 0;
+    ret = psy_realtime_enable(&options, NULL, &error);
+    CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+
+    psy_realtime_options_init(&options);
+    options.steps = PSY_REALTIME_AFFINITY;
+    ret = psy_realtime_enable(&options, NULL, &error);
+    CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+    CU_ASSERT_PTR_NULL(error);
+}
+
+static void
+realtime_report(void)
+{
+    PsyRealtimeOptions options;
+    SeeError* error = NULL;
+    unsigned achieved = ~0u;
+    int ret;
+
+    // These need privileges the tests may not have, so either outcome is
+    // fine as long as it's reported consistently.
+    psy_realtime_options_init(&options);
+    options.steps = PSY_REALTIME_MEMORY_LOCK | PSY_REALTIME_DMA_LATENCY;
+    ret = psy_realtime_enable(&options, &achieved, &error);
+
+    CU_ASSERT_EQUAL(achieved & ~options.steps, 0);
+    if (achieved == options.steps) {
+        CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+        CU_ASSERT_PTR_NULL(error);
+    }
+    else {
+        CU_ASSERT_EQUAL(ret, SEE_ERROR_RUNTIME);
+        CU_ASSERT_PTR_NOT_NULL(error);
+        if (error && g_settings.verbose)
+            fprintf(stdout, "\n%s\n", see_error_msg(error));
+    }
+
+    see_object_decref(SEE_OBJECT(error));
+    psy_realtime_disable();
+}
+
+int add_realtime_suite()
+{
+    CU_pSuite suite = CU_add_suite(suite_name, NULL, NULL);
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(stderr,
+                "Unable to create suite: \"%s\": %s\n",
+                suite_name,
+                CU_get_error_msg()
+               );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, realtime_options);
+    PSY_SUITE_ADD_TEST(suite_name, realtime_report);
+
+    return 0;
+}
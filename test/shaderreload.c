@@ -0,0 +1,306 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <CUnit/CUnit.h>
+#include <SDL2/SDL.h>
+#include "../src/ShaderProgram.h"
+#include "../src/ShaderReload.h"
+#include "../src/BuiltinShaders.h"
+#include "../src/Window.h"
+#include "globals.h"
+#include "psy_test_macros.h"
+
+static PsyWindow* g_win = NULL;
+
+static int g_win_x;
+static int g_win_y;
+static int g_win_width;
+static int g_win_height;
+
+static char g_dir[] = "/tmp/psy_reload_XXXXXX";
+static char g_vertex_path[BUFSIZ];
+static char g_fragment_path[BUFSIZ];
+
+static const char* suite_name = "shader reload";
+
+extern const PsyBuiltinShader   psy_test_shaders[];
+extern const size_t             psy_test_shaders_size;
+
+static int
+write_shader(const char* path, const char* name, psy_shader_t type, int touch)
+{
+    const PsyBuiltinShader* source = psy_builtin_shader_find(
+        psy_test_shaders,
+        psy_test_shaders_size,
+        name,
+        type
+        );
+    FILE* file;
+
+    if (!source)
+        return 1;
+
+    file = fopen(path, "w");
+    if (!file)
+        return 1;
+    fputs(source->source, file);
+    if (touch)
+        fputs("\n// changed\n", file);
+    return fclose(file) != 0;
+}
+
+static int
+compile_file(PsyShader** shader, psy_shader_t type, const char* path)
+{
+    SeeError* error = NULL;
+    FILE* file = NULL;
+    int ret = psy_shader_create(shader, type, &error);
+    if (ret)
+        goto compile_file_error;
+
+    file = fopen(path, "r");
+    if (!file) {
+        ret = 1;
+        goto compile_file_error;
+    }
+    ret = psy_shader_compile_file(*shader, file, &error);
+
+compile_file_error:
+    if (file)
+        fclose(file);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    return ret;
+}
+
+static int setup(void)
+{
+    SeeError*   error   = NULL;
+    PsyRect     rect    = {
+        {.x = g_win_x, .y = g_win_y},
+        {.width = g_win_width, .height = g_win_height}
+    };
+    int ret;
+
+    if (!mkdtemp(g_dir)) {
+        fprintf(stderr, "Unable to create a temporary directory\n");
+        return 1;
+    }
+    snprintf(g_vertex_path, sizeof(g_vertex_path), "%s/test.vert", g_dir);
+    snprintf(g_fragment_path, sizeof(g_fragment_path), "%s/test.frag", g_dir);
+
+    if (write_shader(g_vertex_path, "test_vertex_shader", PSY_SHADER_VERTEX, 0)
+        || write_shader(
+            g_fragment_path, "test_fragment_shader", PSY_SHADER_FRAGMENT, 0
+            )
+        ) {
+        fprintf(stderr, "Unable to write the test shaders\n");
+        goto setup_error;
+    }
+
+    // The window is created last, so a failure above leaves nothing open.
+    ret = psy_window_create_rect(&g_win, rect, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        goto setup_error;
+    }
+    psy_window_show(g_win);
+
+    return 0;
+
+setup_error:
+    remove(g_vertex_path);
+    remove(g_fragment_path);
+    rmdir(g_dir);
+    return 1;
+}
+
+static int
+teardown(void)
+{
+    psy_shader_reload_disable();
+    remove(g_vertex_path);
+    remove(g_fragment_path);
+    rmdir(g_dir);
+    if (g_win) {
+        see_object_decref(SEE_OBJECT(g_win));
+        g_win = NULL;
+    }
+    return 0;
+}
+
+void shader_reload_file_path(void)
+{
+    PsyShader* shader = NULL;
+    const char* path;
+
+    if (compile_file(&shader, PSY_SHADER_VERTEX, g_vertex_path)) {
+        CU_FAIL("Unable to compile the vertex shader");
+        see_object_decref(SEE_OBJECT(shader));
+        return;
+    }
+
+    path = psy_shader_file_path(shader);
+#if defined(__linux__)
+    CU_ASSERT_PTR_NOT_NULL(path);
+    if (path)
+        CU_ASSERT_PTR_NOT_NULL(strstr(path, "test.vert"));
+#else
+    (void) path;
+#endif
+
+    see_object_decref(SEE_OBJECT(shader));
+}
+
+void shader_reload_poll(void)
+{
+    int ret;
+    SeeError*         error    = NULL;
+    PsyShader*        vertex   = NULL;
+    PsyShader*        fragment = NULL;
+    PsyShaderProgram* program  = NULL;
+    PsyShaderProgram* other    = NULL;
+    size_t            num_reloaded = 0;
+
+    ret = psy_shader_reload_enable(&error);
+    if (ret) {
+        // Not supported on this platform.
+        if (g_settings.verbose)
+            fprintf(stderr, "Skipping %s: %s\n", __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return;
+    }
+    CU_ASSERT(psy_shader_reload_enabled());
+
+    if (compile_file(&vertex, PSY_SHADER_VERTEX, g_vertex_path) ||
+        compile_file(&fragment, PSY_SHADER_FRAGMENT, g_fragment_path)) {
+        CU_FAIL("Unable to compile the test shaders");
+        goto shader_reload_poll_error;
+    }
+
+    ret = psy_shader_program_create(&program, vertex, fragment, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto shader_reload_poll_error;
+    ret = psy_shader_program_link(program, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto shader_reload_poll_error;
+
+    // A second program with the same shaders.
+    ret = psy_shader_program_create(&other, vertex, fragment, &error);
+    if (ret)
+        goto shader_reload_poll_error;
+    ret = psy_shader_program_link(other, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto shader_reload_poll_error;
+
+    // The shaders are kept in order to be able to relink the program.
+    CU_ASSERT_PTR_EQUAL(psy_shader_program_get_vertex_shader(program), vertex);
+    CU_ASSERT_PTR_EQUAL(
+        psy_shader_program_get_fragment_shader(program), fragment
+        );
+
+    // Nothing changed yet.
+    ret = psy_shader_reload_poll(&num_reloaded, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    CU_ASSERT_EQUAL(num_reloaded, 0);
+    CU_ASSERT_EQUAL(psy_shader_program_generation(program), 0);
+
+    // Saving twice yields several events, the file is compiled once.
+    ret = write_shader(
+        g_fragment_path, "test_fragment_shader", PSY_SHADER_FRAGMENT, 1
+        );
+    CU_ASSERT_EQUAL(ret, 0);
+    ret = write_shader(
+        g_fragment_path, "test_fragment_shader", PSY_SHADER_FRAGMENT, 1
+        );
+    CU_ASSERT_EQUAL(ret, 0);
+
+    // The events should be there immediately, but give the kernel some slack.
+    for (int i = 0; i < 100 && num_reloaded == 0 && !error; i++) {
+        ret = psy_shader_reload_poll(&num_reloaded, &error);
+        if (num_reloaded == 0)
+            SDL_Delay(10);
+    }
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    CU_ASSERT_EQUAL(num_reloaded, 2);
+    CU_ASSERT(psy_shader_program_linked(program));
+    CU_ASSERT(psy_shader_program_linked(other));
+    // Cached uniform locations must be looked up again.
+    CU_ASSERT_EQUAL(psy_shader_program_generation(program), 1);
+    CU_ASSERT_EQUAL(psy_shader_program_generation(other), 1);
+    // Only the fragment shader is recompiled and both programs share it.
+    CU_ASSERT_PTR_EQUAL(psy_shader_program_get_vertex_shader(program), vertex);
+    CU_ASSERT_PTR_NOT_EQUAL(
+        psy_shader_program_get_fragment_shader(program), fragment
+        );
+    CU_ASSERT_PTR_EQUAL(
+        psy_shader_program_get_fragment_shader(program),
+        psy_shader_program_get_fragment_shader(other)
+        );
+
+shader_reload_poll_error:
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(program));
+    see_object_decref(SEE_OBJECT(other));
+    see_object_decref(SEE_OBJECT(vertex));
+    see_object_decref(SEE_OBJECT(fragment));
+    psy_shader_reload_disable();
+}
+
+int add_shader_reload_suite(void)
+{
+    g_win_width     = g_settings.window_settings.width;
+    g_win_height    = g_settings.window_settings.height;
+    g_win_x         = g_settings.window_settings.x;
+    g_win_y         = g_settings.window_settings.y;
+
+    CU_pSuite suite = CU_add_suite(
+        suite_name,
+        setup,
+        teardown
+        );
+
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(
+            stderr,
+            "Unable to create suite: \"%s\": %s\n",
+            suite_name,
+            CU_get_error_msg()
+        );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, shader_reload_file_path);
+    PSY_SUITE_ADD_TEST(suite_name, shader_reload_poll);
+
+    return 0;
+}
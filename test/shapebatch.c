@@ -0,0 +1,211 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <CUnit/CUnit.h>
+#include "../src/ShapeBatch.h"
+#include "../src/Window.h"
+#include "globals.h"
+#include "psy_test_macros.h"
+
+static PsyWindow* g_win = NULL;
+
+static int g_win_x;
+static int g_win_y;
+static int g_win_width;
+static int g_win_height;
+
+static const char* suite_name = "shape batch";
+
+static int setup(void)
+{
+    SeeError*   error   = NULL;
+    PsyRect     rect    = {
+        {.x = g_win_x, .y = g_win_y},
+        {.width = g_win_width, .height = g_win_height}
+    };
+    int ret;
+
+    ret = psy_window_create_rect(&g_win, rect, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return 1;
+    }
+    psy_window_show(g_win);
+
+    return 0;
+}
+
+static int
+teardown(void)
+{
+    if (g_win) {
+        see_object_decref(SEE_OBJECT(g_win));
+        g_win = NULL;
+    }
+    return 0;
+}
+
+void shape_batch_create(void)
+{
+    int ret;
+    PsyShapeBatch* batch = NULL;
+    SeeError* error = NULL;
+
+    ret = psy_shape_batch_create(&batch, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return;
+    }
+    for (int kind = 0; kind < PSY_SHAPE_NUM_KINDS; kind++)
+        CU_ASSERT_EQUAL(psy_shape_batch_size(batch, kind), 0);
+
+    see_object_decref(SEE_OBJECT(batch));
+}
+
+void shape_batch_add(void)
+{
+    int ret;
+    PsyShapeBatch* batch = NULL;
+    SeeError* error = NULL;
+    PsyShapeInstance shapes[1000];
+
+    memset(shapes, 0, sizeof(shapes));
+
+    ret = psy_shape_batch_create(&batch, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto shape_batch_add_error;
+
+    ret = psy_shape_batch_add(batch, PSY_SHAPE_NUM_KINDS, shapes, 1, &error);
+    CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+
+    ret = psy_shape_batch_add(batch, PSY_SHAPE_BAR, shapes, 1000, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    ret = psy_shape_batch_add(batch, PSY_SHAPE_BAR, shapes, 10, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    CU_ASSERT_EQUAL(psy_shape_batch_size(batch, PSY_SHAPE_BAR), 1010);
+    CU_ASSERT_EQUAL(psy_shape_batch_size(batch, PSY_SHAPE_DISC), 0);
+
+    psy_shape_batch_clear(batch);
+    CU_ASSERT_EQUAL(psy_shape_batch_size(batch, PSY_SHAPE_BAR), 0);
+
+shape_batch_add_error:
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(batch));
+}
+
+void shape_batch_draw(void)
+{
+    int ret;
+    PsyShapeBatch* batch = NULL;
+    SeeError* error = NULL;
+    GLubyte pixel[4] = {0};
+
+    // A red disc, a green bar and a blue cross in clip space, the disc
+    // covers the center of the window.
+    const PsyShapeInstance disc = {
+        .x = 0.0f, .y = 0.0f, .width = 0.5f, .height = 0.5f,
+        .orientation = 0.0f, .color = {1.0f, 0.0f, 0.0f, 1.0f}
+    };
+    const PsyShapeInstance bar = {
+        .x = -0.75f, .y = 0.0f, .width = 0.1f, .height = 0.4f,
+        .orientation = 45.0f, .color = {0.0f, 1.0f, 0.0f, 1.0f}
+    };
+    const PsyShapeInstance cross = {
+        .x = 0.75f, .y = 0.0f, .width = 0.2f, .height = 0.2f,
+        .orientation = 0.0f, .color = {0.0f, 0.0f, 1.0f, 1.0f}
+    };
+
+    ret = psy_shape_batch_create(&batch, &error);
+    if (ret)
+        goto shape_batch_draw_error;
+
+    ret = psy_shape_batch_add(batch, PSY_SHAPE_DISC, &disc, 1, &error);
+    if (ret)
+        goto shape_batch_draw_error;
+    ret = psy_shape_batch_add(batch, PSY_SHAPE_BAR, &bar, 1, &error);
+    if (ret)
+        goto shape_batch_draw_error;
+    ret = psy_shape_batch_add(batch, PSY_SHAPE_CROSS, &cross, 1, &error);
+    if (ret)
+        goto shape_batch_draw_error;
+
+    glViewport(0, 0, g_win_width, g_win_height);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    ret = psy_shape_batch_draw(batch, NULL, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto shape_batch_draw_error;
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+    glReadPixels(
+        g_win_width / 2, g_win_height / 2, 1, 1,
+        GL_RGBA, GL_UNSIGNED_BYTE, pixel
+        );
+    CU_ASSERT_EQUAL(pixel[0], 255);
+    CU_ASSERT_EQUAL(pixel[1], 0);
+    CU_ASSERT_EQUAL(pixel[2], 0);
+
+shape_batch_draw_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(batch));
+}
+
+int add_shape_batch_suite(void)
+{
+    g_win_width     = g_settings.window_settings.width;
+    g_win_height    = g_settings.window_settings.height;
+    g_win_x         = g_settings.window_settings.x;
+    g_win_y         = g_settings.window_settings.y;
+
+    CU_pSuite suite = CU_add_suite(
+        suite_name,
+        setup,
+        teardown
+        );
+
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(
+            stderr,
+            "Unable to create suite: \"%s\": %s\n",
+            suite_name,
+            CU_get_error_msg()
+        );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, shape_batch_create);
+    PSY_SUITE_ADD_TEST(suite_name, shape_batch_add);
+    PSY_SUITE_ADD_TEST(suite_name, shape_batch_draw);
+
+    return 0;
+}
@@ -0,0 +1,235 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <CUnit/CUnit.h>
+#include "../src/Framebuffer.h"
+#include "../src/ShapeBatch.h"
+#include "../src/Stereo.h"
+#include "../src/Window.h"
+#include "globals.h"
+#include "psy_test_macros.h"
+
+static PsyWindow* g_win = NULL;
+
+static int g_win_x;
+static int g_win_y;
+static int g_win_width;
+static int g_win_height;
+
+static const char* suite_name = "stereo";
+
+#define EYE_WIDTH 32
+#define EYE_HEIGHT 32
+
+static int setup(void)
+{
+    SeeError*   error   = NULL;
+    PsyRect     rect    = {
+        {.x = g_win_x, .y = g_win_y},
+        {.width = g_win_width, .height = g_win_height}
+    };
+    int ret;
+
+    ret = psy_window_create_rect(&g_win, rect, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return 1;
+    }
+    psy_window_show(g_win);
+
+    return 0;
+}
+
+static int
+teardown(void)
+{
+    if (g_win) {
+        see_object_decref(SEE_OBJECT(g_win));
+        g_win = NULL;
+    }
+    return 0;
+}
+
+void stereo_eyes(void)
+{
+    PsyStereoEyes eyes;
+
+    // The left eye is squeezed into the left half and the right eye into
+    // the right half of clip space.
+    psy_stereo_eyes(PSY_STEREO_SIDE_BY_SIDE, NULL, NULL, &eyes);
+    CU_ASSERT_DOUBLE_EQUAL(eyes.transforms[PSY_EYE_LEFT][0], 0.5, 1e-6);
+    CU_ASSERT_DOUBLE_EQUAL(eyes.transforms[PSY_EYE_LEFT][5], 1.0, 1e-6);
+    CU_ASSERT_DOUBLE_EQUAL(eyes.transforms[PSY_EYE_LEFT][12], -0.5, 1e-6);
+    CU_ASSERT_DOUBLE_EQUAL(eyes.transforms[PSY_EYE_RIGHT][12], 0.5, 1e-6);
+    CU_ASSERT_DOUBLE_EQUAL(eyes.clip_planes[PSY_EYE_LEFT][0], -1.0, 1e-6);
+    CU_ASSERT_DOUBLE_EQUAL(eyes.clip_planes[PSY_EYE_RIGHT][0], 1.0, 1e-6);
+    CU_ASSERT_DOUBLE_EQUAL(eyes.regions[PSY_EYE_RIGHT][0], 0.5, 1e-6);
+
+    // The left eye is on top.
+    psy_stereo_eyes(PSY_STEREO_TOP_BOTTOM, NULL, NULL, &eyes);
+    CU_ASSERT_DOUBLE_EQUAL(eyes.transforms[PSY_EYE_LEFT][5], 0.5, 1e-6);
+    CU_ASSERT_DOUBLE_EQUAL(eyes.transforms[PSY_EYE_LEFT][13], 0.5, 1e-6);
+    CU_ASSERT_DOUBLE_EQUAL(eyes.transforms[PSY_EYE_RIGHT][13], -0.5, 1e-6);
+    CU_ASSERT_DOUBLE_EQUAL(eyes.regions[PSY_EYE_LEFT][1], 0.5, 1e-6);
+
+    // Without stereo both eyes see everything.
+    psy_stereo_eyes(PSY_STEREO_NONE, NULL, NULL, &eyes);
+    CU_ASSERT_DOUBLE_EQUAL(eyes.transforms[PSY_EYE_RIGHT][0], 1.0, 1e-6);
+    CU_ASSERT_DOUBLE_EQUAL(eyes.transforms[PSY_EYE_RIGHT][12], 0.0, 1e-6);
+    CU_ASSERT_DOUBLE_EQUAL(eyes.clip_planes[PSY_EYE_LEFT][3], 1.0, 1e-6);
+
+    CU_ASSERT_FALSE(psy_stereo_is_composited(PSY_STEREO_SIDE_BY_SIDE));
+    CU_ASSERT_TRUE(psy_stereo_is_composited(PSY_STEREO_ANAGLYPH));
+}
+
+void stereo_window_mode(void)
+{
+    int ret;
+    SeeError* error = NULL;
+
+    CU_ASSERT_EQUAL(psy_window_stereo_mode(g_win), PSY_STEREO_NONE);
+
+    ret = psy_window_set_stereo_mode(g_win, PSY_STEREO_ANAGLYPH, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    CU_ASSERT_EQUAL(psy_window_stereo_mode(g_win), PSY_STEREO_ANAGLYPH);
+
+    ret = psy_window_set_stereo_mode(g_win, (PsyStereoMode) 42, &error);
+    CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+    CU_ASSERT_EQUAL(psy_window_stereo_mode(g_win), PSY_STEREO_ANAGLYPH);
+
+    // Drawing both eyes into the window and combining them.
+    ret = psy_window_stereo_begin(g_win, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret == SEE_SUCCESS) {
+        ret = psy_window_stereo_end(g_win, &error);
+        CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    }
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+    psy_window_set_stereo_mode(g_win, PSY_STEREO_NONE, &error);
+
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+}
+
+void stereo_shape_batch(void)
+{
+    int ret;
+    PsyFramebuffer* fb = NULL;
+    PsyShapeBatch* batch = NULL;
+    SeeError* error = NULL;
+    PsyStereoEyes eyes;
+    unsigned char pixels[2 * EYE_WIDTH * EYE_HEIGHT * 4];
+    const unsigned char* pixel;
+
+    // A red bar in the center, with a disparity the size of the bar, the
+    // left eye sees it a quarter to the right and the right eye a quarter
+    // to the left of its view.
+    const PsyShapeInstance bar = {
+        .x = 0.0f, .y = 0.0f, .width = 0.5f, .height = 2.0f,
+        .orientation = 0.0f, .color = {1.0f, 0.0f, 0.0f, 1.0f},
+        .disparity = 0.5f
+    };
+
+    ret = psy_framebuffer_create(
+        &fb, 2 * EYE_WIDTH, EYE_HEIGHT, PSY_FRAMEBUFFER_RGBA8, 0, &error
+        );
+    if (ret)
+        goto stereo_shape_batch_error;
+    ret = psy_shape_batch_create(&batch, &error);
+    if (ret)
+        goto stereo_shape_batch_error;
+    ret = psy_shape_batch_add(batch, PSY_SHAPE_BAR, &bar, 1, &error);
+    if (ret)
+        goto stereo_shape_batch_error;
+
+    psy_stereo_eyes(PSY_STEREO_SIDE_BY_SIDE, NULL, NULL, &eyes);
+
+    psy_framebuffer_bind(fb);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    ret = psy_shape_batch_draw_stereo(batch, &eyes, &error);
+    psy_framebuffer_unbind(fb);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto stereo_shape_batch_error;
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+    ret = psy_framebuffer_read(fb, pixels, &error);
+    if (ret)
+        goto stereo_shape_batch_error;
+
+    // The bar of the left eye covers [0.0, 0.5] of the left view, which is
+    // columns [16, 24) of the framebuffer.
+    pixel = &pixels[((EYE_HEIGHT / 2) * 2 * EYE_WIDTH + 20) * 4];
+    CU_ASSERT_EQUAL(pixel[0], 255);
+    pixel = &pixels[((EYE_HEIGHT / 2) * 2 * EYE_WIDTH + 12) * 4];
+    CU_ASSERT_EQUAL(pixel[0], 0);
+
+    // The bar of the right eye covers [-0.5, 0.0] of the right view, which
+    // is columns [40, 48).
+    pixel = &pixels[((EYE_HEIGHT / 2) * 2 * EYE_WIDTH + 44) * 4];
+    CU_ASSERT_EQUAL(pixel[0], 255);
+    pixel = &pixels[((EYE_HEIGHT / 2) * 2 * EYE_WIDTH + 52) * 4];
+    CU_ASSERT_EQUAL(pixel[0], 0);
+
+stereo_shape_batch_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(batch));
+    see_object_decref(SEE_OBJECT(fb));
+}
+
+int add_stereo_suite(void)
+{
+    g_win_width     = g_settings.window_settings.width;
+    g_win_height    = g_settings.window_settings.height;
+    g_win_x         = g_settings.window_settings.x;
+    g_win_y         = g_settings.window_settings.y;
+
+    CU_pSuite suite = CU_add_suite(
+        suite_name,
+        setup,
+        teardown
+        );
+
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(
+            stderr,
+            "Unable to create suite: \"%s\": %s\n",
+            suite_name,
+            CU_get_error_msg()
+        );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, stereo_eyes);
+    PSY_SUITE_ADD_TEST(suite_name, stereo_window_mode);
+    PSY_SUITE_ADD_TEST(suite_name, stereo_shape_batch);
+
+    return 0;
+}
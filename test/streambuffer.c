@@ -0,0 +1,248 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <CUnit/CUnit.h>
+#include "../src/ShaderProgram.h"
+#include "../src/StreamBuffer.h"
+#include "../src/Window.h"
+#include "globals.h"
+#include "psy_test_macros.h"
+
+static PsyWindow* g_win = NULL;
+
+static int g_win_x;
+static int g_win_y;
+static int g_win_width;
+static int g_win_height;
+
+static const char* suite_name = "streambuffer";
+
+static const GLfloat g_identity[16] = {
+    1.0f, 0.0f, 0.0f, 0.0f,
+    0.0f, 1.0f, 0.0f, 0.0f,
+    0.0f, 0.0f, 1.0f, 0.0f,
+    0.0f, 0.0f, 0.0f, 1.0f
+};
+
+static int setup(void)
+{
+    SeeError*   error   = NULL;
+    PsyRect     rect    = {
+        {.x = g_win_x, .y = g_win_y},
+        {.width = g_win_width, .height = g_win_height}
+    };
+    int ret;
+
+    ret = psy_window_create_rect(&g_win, rect, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return 1;
+    }
+    psy_window_show(g_win);
+
+    return 0;
+}
+
+static int
+teardown(void)
+{
+    if (g_win) {
+        see_object_decref(SEE_OBJECT(g_win));
+        g_win = NULL;
+    }
+    return 0;
+}
+
+void stream_buffer_map(void)
+{
+    int ret;
+    PsyStreamBuffer* buffer = NULL;
+    SeeError* error = NULL;
+    size_t offset = 1;
+    void* memory;
+
+    ret = psy_stream_buffer_create(&buffer, GL_ARRAY_BUFFER, 1024, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto stream_buffer_map_error;
+    CU_ASSERT_NOT_EQUAL(psy_stream_buffer_id(buffer), 0);
+
+    memory = psy_stream_buffer_map(buffer, 100, &offset, &error);
+    CU_ASSERT_PTR_NOT_NULL(memory);
+    CU_ASSERT_EQUAL(offset, 0);
+    ret = psy_stream_buffer_unmap(buffer, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto stream_buffer_map_error;
+
+    // Offsets are aligned
+    memory = psy_stream_buffer_map(buffer, 32, &offset, &error);
+    CU_ASSERT_PTR_NOT_NULL(memory);
+    CU_ASSERT_EQUAL(offset, 112);
+    ret = psy_stream_buffer_unmap(buffer, &error);
+    if (ret)
+        goto stream_buffer_map_error;
+
+    memory = psy_stream_buffer_map(buffer, 1024, &offset, &error);
+    CU_ASSERT_PTR_NULL(memory);
+    CU_ASSERT_PTR_NOT_NULL(error);
+    if (error) {
+        see_object_decref(SEE_OBJECT(error));
+        error = NULL;
+    }
+
+    // The next frame starts in the next segment.
+    ret = psy_stream_buffer_end_frame(buffer, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto stream_buffer_map_error;
+    memory = psy_stream_buffer_map(buffer, 1024, &offset, &error);
+    CU_ASSERT_PTR_NOT_NULL(memory);
+    CU_ASSERT_EQUAL(offset, 1024);
+    ret = psy_stream_buffer_unmap(buffer, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+stream_buffer_map_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(buffer));
+}
+
+void stream_buffer_draw(void)
+{
+    int ret, frame;
+    PsyStreamBuffer* buffer = NULL;
+    PsyShaderProgram* program = NULL;
+    SeeError* error = NULL;
+    GLuint vao = 0;
+    GLubyte pixel[4] = {0};
+    const GLfloat color[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    const GLfloat quad[6][2] = {
+        {-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f},
+        {-1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f}
+    };
+
+    ret = psy_stream_buffer_create(&buffer, GL_ARRAY_BUFFER, sizeof(quad), &error);
+    if (ret)
+        goto stream_buffer_draw_error;
+    ret = psy_shader_program_create_builtin(
+        &program, "uniform_color", "uniform_color", &error
+        );
+    if (ret)
+        goto stream_buffer_draw_error;
+    ret = psy_shader_use_program(program, &error);
+    if (ret)
+        goto stream_buffer_draw_error;
+    glUniformMatrix4fv(
+        psy_shader_program_uniform_location(program, "u_transform"),
+        1, GL_FALSE, g_identity
+        );
+    glUniform4fv(psy_shader_program_uniform_location(program, "u_color"), 1, color);
+
+    if (GLAD_GL_VERSION_3_0) {
+        glGenVertexArrays(1, &vao);
+        glBindVertexArray(vao);
+    }
+    glViewport(0, 0, g_win_width, g_win_height);
+
+    // More frames than segments, so the ring wraps around.
+    for (frame = 0; frame < 2 * PSY_STREAM_BUFFER_SEGMENTS; frame++) {
+        size_t offset;
+        GLint location = psy_shader_program_attribute_location(
+            program, "a_position"
+            );
+        void* memory = psy_stream_buffer_map(buffer, sizeof(quad), &offset, &error);
+        if (!memory)
+            goto stream_buffer_draw_error;
+        memcpy(memory, quad, sizeof(quad));
+        ret = psy_stream_buffer_unmap(buffer, &error);
+        if (ret)
+            goto stream_buffer_draw_error;
+
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glEnableVertexAttribArray((GLuint) location);
+        glVertexAttribPointer(
+            (GLuint) location, 2, GL_FLOAT, GL_FALSE, 0, (const void*) offset
+            );
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+
+        ret = psy_stream_buffer_end_frame(buffer, &error);
+        CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+        if (ret)
+            goto stream_buffer_draw_error;
+    }
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+    glReadPixels(
+        g_win_width / 2, g_win_height / 2, 1, 1,
+        GL_RGBA, GL_UNSIGNED_BYTE, pixel
+        );
+    CU_ASSERT_EQUAL(pixel[0], 255);
+
+stream_buffer_draw_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    if (vao) {
+        glBindVertexArray(0);
+        glDeleteVertexArrays(1, &vao);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    see_object_decref(SEE_OBJECT(program));
+    see_object_decref(SEE_OBJECT(buffer));
+}
+
+int add_stream_buffer_suite(void)
+{
+    g_win_width     = g_settings.window_settings.width;
+    g_win_height    = g_settings.window_settings.height;
+    g_win_x         = g_settings.window_settings.x;
+    g_win_y         = g_settings.window_settings.y;
+
+    CU_pSuite suite = CU_add_suite(
+        suite_name,
+        setup,
+        teardown
+        );
+
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(
+            stderr,
+            "Unable to create suite: \"%s\": %s\n",
+            suite_name,
+            CU_get_error_msg()
+        );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, stream_buffer_map);
+    PSY_SUITE_ADD_TEST(suite_name, stream_buffer_draw);
+
+    return 0;
+}
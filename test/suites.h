@@ -50,6 +50,167 @@ int add_glshader_suite();
  */
 int add_glshader_program_suite();
 
+/**
+ * @private
+ * @brief Test whether shaders are reloaded once their files change.
+ * @return 0 when the suite was properly registered.
+ */
+int add_shader_reload_suite();
+
+/**
+ * @private
+ * @brief Test whether a PsyShapeBatch draws its shapes.
+ * @return 0 when the suite was properly registered.
+ */
+int add_shape_batch_suite();
+
+/**
+ * @private
+ * @brief Test the random dot kinematogram.
+ * @return 0 when the suite was properly registered.
+ */
+int add_rdk_suite();
+
+/**
+ * @private
+ * @brief Test the procedural gratings.
+ * @return 0 when the suite was properly registered.
+ */
+int add_grating_suite();
+
+/**
+ * @private
+ * @brief Test loading and uploading textures.
+ * @return 0 when the suite was properly registered.
+ */
+int add_texture_suite();
+
+/**
+ * @private
+ * @brief Test the image sets and their memory budget.
+ * @return 0 when the suite was properly registered.
+ */
+int add_image_set_suite();
+
+/**
+ * @private
+ * @brief Test playing video from .y4m files.
+ * @return 0 when the suite was properly registered.
+ */
+int add_video_suite();
+
+/**
+ * @private
+ * @brief Test the fonts and drawing text.
+ * @return 0 when the suite was properly registered.
+ */
+int add_text_suite();
+
+/**
+ * @private
+ * @brief Test streaming vertex data through a PsyStreamBuffer.
+ * @return 0 when the suite was properly registered.
+ */
+int add_stream_buffer_suite();
+
+/**
+ * @private
+ * @brief Test drawing stimuli sorted by a PsyDisplayList.
+ * @return 0 when the suite was properly registered.
+ */
+int add_display_list_suite();
+
+/**
+ * @private
+ * @brief Test recording and replaying a PsyCommandBuffer.
+ * @return 0 when the suite was properly registered.
+ */
+int add_command_buffer_suite();
+
+/**
+ * @private
+ * @brief Test rendering frames ahead of time with a PsyFrameCache.
+ * @return 0 when the suite was properly registered.
+ */
+int add_frame_cache_suite();
+
+/**
+ * @private
+ * @brief Test generating noise textures with PsyNoise.
+ * @return 0 when the suite was properly registered.
+ */
+int add_noise_suite();
+
+/**
+ * @private
+ * @brief Test rendering into a PsyFramebuffer.
+ * @return 0 when the suite was properly registered.
+ */
+int add_framebuffer_suite();
+
+/**
+ * @private
+ * @brief Test the fused full screen passes of PsyPostChain.
+ * @return 0 when the suite was properly registered.
+ */
+int add_post_chain_suite();
+
+/**
+ * @private
+ * @brief Test the tessellated primitives of PsyMesh.
+ * @return 0 when the suite was properly registered.
+ */
+int add_mesh_suite();
+
+/**
+ * @private
+ * @brief Test sharing meshes with PsyMeshCache.
+ * @return 0 when the suite was properly registered.
+ */
+int add_mesh_cache_suite();
+
+/**
+ * @private
+ * @brief Test drawing the views of both eyes.
+ * @return 0 when the suite was properly registered.
+ */
+int add_stereo_suite();
+
+/**
+ * @private
+ * @brief Test the clock of psylib.
+ * @return 0 when the suite was properly registered.
+ */
+int add_time_suite();
+
+/**
+ * @private
+ * @brief Test the real-time steps for timing critical threads.
+ * @return 0 when the suite was properly registered.
+ */
+int add_realtime_suite();
+
+/**
+ * @private
+ * @brief Test running the events of a trial with PsyTimeline.
+ * @return 0 when the suite was properly registered.
+ */
+int add_timeline_suite();
+
+/**
+ * @private
+ * @brief Test timing the draws on the GPU with PsyGpuTimer.
+ * @return 0 when the suite was properly registered.
+ */
+int add_gpu_timer_suite();
+
+/**
+ * @private
+ * @brief Test recording scopes of several threads and writing the trace.
+ * @return 0 when the suite was properly registered.
+ */
+int add_trace_suite();
+
 /**
  * \private
  * \brief Tests whether the windowing suite is working as expected.
@@ -0,0 +1,248 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <CUnit/CUnit.h>
+#include "../src/Text.h"
+#include "../src/Window.h"
+#include "globals.h"
+#include "psy_test_macros.h"
+
+static PsyWindow* g_win = NULL;
+static PsyFont* g_font = NULL;
+
+static int g_win_x;
+static int g_win_y;
+static int g_win_width;
+static int g_win_height;
+
+static const char* suite_name = "text";
+
+/* PSY_TEST_FONT may point to a font, otherwise these are tried. */
+static const char* g_font_paths[] = {
+    "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+    "/usr/share/fonts/dejavu/DejaVuSans.ttf",
+    "/usr/share/fonts/TTF/DejaVuSans.ttf"
+};
+
+static const char*
+find_font(void)
+{
+    const char* path = getenv("PSY_TEST_FONT");
+    size_t i;
+
+    if (path)
+        return path;
+
+    for (i = 0; i < sizeof(g_font_paths) / sizeof(g_font_paths[0]); i++) {
+        FILE* file = fopen(g_font_paths[i], "rb");
+        if (file) {
+            fclose(file);
+            return g_font_paths[i];
+        }
+    }
+    return NULL;
+}
+
+static int setup(void)
+{
+    SeeError*   error   = NULL;
+    PsyRect     rect    = {
+        {.x = g_win_x, .y = g_win_y},
+        {.width = g_win_width, .height = g_win_height}
+    };
+    const char* font_path;
+    int ret;
+
+    ret = psy_window_create_rect(&g_win, rect, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return 1;
+    }
+    psy_window_show(g_win);
+
+    font_path = find_font();
+    if (!psy_font_available() || !font_path) {
+        fprintf(stderr, "No SDL_ttf or no font, the text tests are skipped\n");
+        return 0;
+    }
+
+    ret = psy_font_create(&g_font, font_path, 48, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open font: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return 1;
+    }
+
+    return 0;
+}
+
+static int
+teardown(void)
+{
+    if (g_font) {
+        see_object_decref(SEE_OBJECT(g_font));
+        g_font = NULL;
+    }
+    if (g_win) {
+        see_object_decref(SEE_OBJECT(g_win));
+        g_win = NULL;
+    }
+    return 0;
+}
+
+void text_layout_cache(void)
+{
+    int ret;
+    SeeError* error = NULL;
+    const PsyTextLayout* first = NULL;
+    const PsyTextLayout* second = NULL;
+    size_t num_glyphs;
+
+    if (!g_font)
+        return;
+
+    num_glyphs = psy_font_num_glyphs(g_font);
+    CU_ASSERT(num_glyphs >= 95);
+
+    ret = psy_font_layout(g_font, "word", &first, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto text_layout_cache_error;
+    CU_ASSERT_EQUAL(first->num_vertices, 4 * 6);
+    CU_ASSERT_EQUAL(first->num_lines, 1);
+    CU_ASSERT(first->width > 0.0f);
+
+    ret = psy_font_layout(g_font, "word", &second, &error);
+    if (ret)
+        goto text_layout_cache_error;
+    CU_ASSERT_PTR_EQUAL(first, second);
+    CU_ASSERT_EQUAL(psy_font_num_glyphs(g_font), num_glyphs);
+
+    // A space has no ink, a new line starts on the next line.
+    ret = psy_font_layout(g_font, "two\nwords", &first, &error);
+    if (ret)
+        goto text_layout_cache_error;
+    CU_ASSERT_EQUAL(first->num_vertices, 8 * 6);
+    CU_ASSERT_EQUAL(first->num_lines, 2);
+
+    // Glyphs outside ASCII are rasterized when they are first used.
+    ret = psy_font_layout(g_font, "caf\xc3\xa9", &first, &error);
+    if (ret)
+        goto text_layout_cache_error;
+    CU_ASSERT_EQUAL(first->num_vertices, 4 * 6);
+    CU_ASSERT_EQUAL(psy_font_num_glyphs(g_font), num_glyphs + 1);
+
+text_layout_cache_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+}
+
+void text_draw(void)
+{
+    int ret;
+    PsyText* text = NULL;
+    SeeError* error = NULL;
+    const GLfloat white[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    GLubyte pixel[4] = {0};
+
+    if (!g_font)
+        return;
+
+    ret = psy_text_create(&text, g_font, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto text_draw_error;
+
+    // A huge "I" centered on the middle of the window covers its center.
+    ret = psy_text_add(
+        text, "I", 0.0f, -0.5f, 2.0f, white, PSY_TEXT_ALIGN_CENTER, &error
+        );
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto text_draw_error;
+    ret = psy_text_add(
+        text, "right", 1.0f, -0.9f, 0.1f, white, PSY_TEXT_ALIGN_RIGHT, &error
+        );
+    if (ret)
+        goto text_draw_error;
+    CU_ASSERT_EQUAL(psy_text_num_glyphs(text), 6);
+
+    glViewport(0, 0, g_win_width, g_win_height);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    ret = psy_text_draw(text, NULL, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto text_draw_error;
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+    CU_ASSERT_FALSE(glIsEnabled(GL_BLEND));
+
+    glReadPixels(
+        g_win_width / 2, g_win_height / 2, 1, 1,
+        GL_RGBA, GL_UNSIGNED_BYTE, pixel
+        );
+    CU_ASSERT(pixel[0] > 240);
+
+    psy_text_clear(text);
+    CU_ASSERT_EQUAL(psy_text_num_glyphs(text), 0);
+
+text_draw_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(text));
+}
+
+int add_text_suite(void)
+{
+    g_win_width     = g_settings.window_settings.width;
+    g_win_height    = g_settings.window_settings.height;
+    g_win_x         = g_settings.window_settings.x;
+    g_win_y         = g_settings.window_settings.y;
+
+    CU_pSuite suite = CU_add_suite(
+        suite_name,
+        setup,
+        teardown
+        );
+
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(
+            stderr,
+            "Unable to create suite: \"%s\": %s\n",
+            suite_name,
+            CU_get_error_msg()
+        );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, text_layout_cache);
+    PSY_SUITE_ADD_TEST(suite_name, text_draw);
+
+    return 0;
+}
@@ -0,0 +1,235 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include <CUnit/CUnit.h>
+#include "../src/Texture.h"
+#include "../src/Window.h"
+#include "globals.h"
+#include "psy_test_macros.h"
+
+static PsyWindow* g_win = NULL;
+
+static int g_win_x;
+static int g_win_y;
+static int g_win_width;
+static int g_win_height;
+
+static const char* suite_name = "texture";
+static const char* g_bmp_path = "psy_texture_test.bmp";
+
+enum {
+    BMP_WIDTH   = 37,
+    BMP_HEIGHT  = 19
+};
+
+/* Writes a small bitmap that the tests decode again. */
+static int
+write_bitmap(void)
+{
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(
+        0, BMP_WIDTH, BMP_HEIGHT, 32, SDL_PIXELFORMAT_RGBA32
+        );
+    int ret;
+
+    if (!surface)
+        return -1;
+    memset(surface->pixels, 0xff, (size_t) (surface->pitch * surface->h));
+    ret = SDL_SaveBMP(surface, g_bmp_path);
+    SDL_FreeSurface(surface);
+    return ret;
+}
+
+static int setup(void)
+{
+    SeeError*   error   = NULL;
+    PsyRect     rect    = {
+        {.x = g_win_x, .y = g_win_y},
+        {.width = g_win_width, .height = g_win_height}
+    };
+    int ret;
+
+    if (write_bitmap() != 0) {
+        fprintf(stderr, "Unable to write %s: %s\n", g_bmp_path, SDL_GetError());
+        return 1;
+    }
+
+    ret = psy_window_create_rect(&g_win, rect, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return 1;
+    }
+    psy_window_show(g_win);
+
+    return 0;
+}
+
+static int
+teardown(void)
+{
+    if (g_win) {
+        see_object_decref(SEE_OBJECT(g_win));
+        g_win = NULL;
+    }
+    remove(g_bmp_path);
+    return 0;
+}
+
+void texture_load_file(void)
+{
+    int ret, width, height;
+    PsyTexture* texture = NULL;
+    SeeError* error = NULL;
+
+    ret = psy_texture_create(&texture, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto texture_load_file_error;
+    CU_ASSERT_EQUAL(psy_texture_state(texture), PSY_TEXTURE_EMPTY);
+    CU_ASSERT_NOT_EQUAL(psy_texture_id(texture), 0);
+
+    ret = psy_texture_load_file(texture, g_bmp_path, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto texture_load_file_error;
+    CU_ASSERT_FALSE(psy_texture_ready(texture));
+
+    ret = psy_texture_wait(texture, 5.0, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto texture_load_file_error;
+    CU_ASSERT_TRUE(psy_texture_ready(texture));
+
+    psy_texture_size(texture, &width, &height);
+    CU_ASSERT_EQUAL(width, BMP_WIDTH);
+    CU_ASSERT_EQUAL(height, BMP_HEIGHT);
+
+    CU_ASSERT_EQUAL(psy_texture_bind(texture, 0), SEE_SUCCESS);
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+texture_load_file_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(texture));
+}
+
+void texture_load_missing(void)
+{
+    int ret;
+    PsyTexture* texture = NULL;
+    SeeError* error = NULL;
+
+    ret = psy_texture_create(&texture, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto texture_load_missing_error;
+
+    ret = psy_texture_load_file(texture, "no/such/image.bmp", &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto texture_load_missing_error;
+
+    ret = psy_texture_wait(texture, 5.0, &error);
+    CU_ASSERT_NOT_EQUAL(ret, SEE_SUCCESS);
+    CU_ASSERT_PTR_NOT_NULL(error);
+    CU_ASSERT_EQUAL(psy_texture_state(texture), PSY_TEXTURE_FAILED);
+    CU_ASSERT_NOT_EQUAL(psy_texture_bind(texture, 0), SEE_SUCCESS);
+
+texture_load_missing_error:
+    if (error)
+        see_object_decref(SEE_OBJECT(error));
+    see_object_decref(SEE_OBJECT(texture));
+}
+
+void texture_set_pixels(void)
+{
+    int ret, width, height;
+    PsyTexture* texture = NULL;
+    SeeError* error = NULL;
+    GLubyte pixels[4 * 8 * 4];
+
+    memset(pixels, 0x80, sizeof(pixels));
+
+    ret = psy_texture_create(&texture, &error);
+    if (ret)
+        goto texture_set_pixels_error;
+
+    ret = psy_texture_set_pixels(texture, 0, 4, pixels, &error);
+    CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+
+    ret = psy_texture_set_pixels(texture, 8, 4, pixels, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto texture_set_pixels_error;
+
+    ret = psy_texture_wait(texture, 5.0, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto texture_set_pixels_error;
+
+    psy_texture_size(texture, &width, &height);
+    CU_ASSERT_EQUAL(width, 8);
+    CU_ASSERT_EQUAL(height, 4);
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+texture_set_pixels_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(texture));
+}
+
+int add_texture_suite(void)
+{
+    g_win_width     = g_settings.window_settings.width;
+    g_win_height    = g_settings.window_settings.height;
+    g_win_x         = g_settings.window_settings.x;
+    g_win_y         = g_settings.window_settings.y;
+
+    CU_pSuite suite = CU_add_suite(
+        suite_name,
+        setup,
+        teardown
+        );
+
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(
+            stderr,
+            "Unable to create suite: \"%s\": %s\n",
+            suite_name,
+            CU_get_error_msg()
+        );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, texture_load_file);
+    PSY_SUITE_ADD_TEST(suite_name, texture_load_missing);
+    PSY_SUITE_ADD_TEST(suite_name, texture_set_pixels);
+
+    return 0;
+}
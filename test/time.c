@@ -0,0 +1,121 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include <SDL2/SDL.h>
+#include "psy_test_macros.h"
+#include "../src/Time.h"
+
+static const char* suite_name = "time";
+
+static void
+time_monotonic(void)
+{
+    PsyTime prev = psy_time_now();
+
+    for (int i = 0; i < 10000; i++) {
+        PsyTime now = psy_time_now();
+        CU_ASSERT(now >= prev);
+        prev = now;
+    }
+
+    // At least a microsecond resolution.
+    CU_ASSERT(psy_time_resolution() > 0);
+    CU_ASSERT(psy_time_resolution() <= PSY_TIME_NS_PER_US);
+}
+
+static void
+time_conversion(void)
+{
+    CU_ASSERT_DOUBLE_EQUAL(psy_time_seconds(PSY_TIME_NS_PER_S), 1.0, 1e-12);
+    CU_ASSERT_DOUBLE_EQUAL(psy_time_seconds(1500 * PSY_TIME_NS_PER_MS), 1.5, 1e-12);
+    CU_ASSERT_EQUAL(psy_time_from_seconds(0.25), 250 * PSY_TIME_NS_PER_MS);
+}
+
+static void
+time_sleep(void)
+{
+    PsyTime start = psy_time_now();
+    PsyTime elapsed;
+
+    SDL_Delay(20);
+    elapsed = psy_time_now() - start;
+
+    // Sleeping is never shorter than asked for.
+    CU_ASSERT(elapsed >= 20 * PSY_TIME_NS_PER_MS);
+    CU_ASSERT(elapsed < PSY_TIME_NS_PER_S);
+}
+
+static void
+time_wait_until(void)
+{
+    PsyWaitStats stats;
+    PsyTime deadline, overshoot, margin;
+
+    margin = psy_wait_margin();
+    psy_wait_reset_stats();
+
+    for (int i = 0; i < 10; i++) {
+        deadline = psy_time_now() + 5 * PSY_TIME_NS_PER_MS;
+        overshoot = psy_wait_until(deadline);
+        // Never early and with spinning the last bit, hardly late.
+        CU_ASSERT(psy_time_now() >= deadline);
+        CU_ASSERT(overshoot >= 0);
+        CU_ASSERT(overshoot < 2 * PSY_TIME_NS_PER_MS);
+    }
+
+    psy_wait_stats(&stats);
+    CU_ASSERT_EQUAL(stats.count, 10);
+    CU_ASSERT_EQUAL(stats.last_overshoot, overshoot);
+    CU_ASSERT(stats.max_overshoot >= overshoot);
+    CU_ASSERT(stats.total_overshoot >= stats.max_overshoot);
+
+    // A deadline in the past returns at once.
+    overshoot = psy_wait_until(psy_time_now() - PSY_TIME_NS_PER_MS);
+    CU_ASSERT(overshoot >= PSY_TIME_NS_PER_MS);
+
+    psy_wait_set_margin(PSY_TIME_NS_PER_MS, 0);
+    CU_ASSERT_EQUAL(psy_wait_margin(), PSY_TIME_NS_PER_MS);
+    psy_wait_for(2 * PSY_TIME_NS_PER_MS);
+    CU_ASSERT_EQUAL(psy_wait_margin(), PSY_TIME_NS_PER_MS);
+
+    psy_wait_set_margin(margin, 1);
+    psy_wait_reset_stats();
+}
+
+int add_time_suite()
+{
+    CU_pSuite suite = CU_add_suite(suite_name, NULL, NULL);
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(stderr,
+                "Unable to create suite: \"%s\": %s\n",
+                suite_name,
+                CU_get_error_msg()
+               );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, time_monotonic);
+    PSY_SUITE_ADD_TEST(suite_name, time_conversion);
+    PSY_SUITE_ADD_TEST(suite_name, time_sleep);
+    PSY_SUITE_ADD_TEST(suite_name, time_wait_until);
+
+    return 0;
+}
@@ -0,0 +1,314 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <CUnit/CUnit.h>
+#include "../src/Timeline.h"
+#include "../src/Window.h"
+#include "globals.h"
+#include "psy_test_macros.h"
+
+static PsyWindow* g_win = NULL;
+
+static int g_win_x;
+static int g_win_y;
+static int g_win_width;
+static int g_win_height;
+
+static const char* suite_name = "timeline";
+
+// Records the order in which the events ran.
+typedef struct {
+    char    names[8];
+    int     count;
+} RunOrder;
+
+static int setup(void)
+{
+    SeeError*   error   = NULL;
+    PsyRect     rect    = {
+        {.x = g_win_x, .y = g_win_y},
+        {.width = g_win_width, .height = g_win_height}
+    };
+    int ret;
+
+    ret = psy_window_create_rect(&g_win, rect, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return 1;
+    }
+    psy_window_show(g_win);
+
+    return 0;
+}
+
+static int
+teardown(void)
+{
+    if (g_win) {
+        see_object_decref(SEE_OBJECT(g_win));
+        g_win = NULL;
+    }
+    return 0;
+}
+
+static void
+record(PsyTimeline* timeline, size_t id, void* data)
+{
+    RunOrder* order = data;
+    const PsyTimelineEvent* event = psy_timeline_event(timeline, id);
+    if (order->count < (int) sizeof(order->names) - 1)
+        order->names[order->count++] = event->name[0];
+}
+
+/*
+ * Adds enough events to move the events in memory, then records its own
+ * name, which must still be valid.
+ */
+static void
+add_and_record(PsyTimeline* timeline, size_t id, void* data)
+{
+    SeeError* error = NULL;
+    for (int i = 0; i < 64; i++)
+        psy_timeline_add_frames(timeline, 1000, NULL, NULL, NULL, NULL, &error);
+    CU_ASSERT_PTR_NULL(error);
+    record(timeline, id, data);
+}
+
+/* Draws and swaps frames until the timeline is done, at most max frames. */
+static void
+run(PsyTimeline* timeline, int max)
+{
+    psy_timeline_start(timeline);
+    for (int i = 0; i < max && !psy_timeline_done(timeline); i++) {
+        psy_timeline_update(timeline);
+        psy_window_clear(g_win);
+        psy_window_swap(g_win);
+    }
+    // The update after the last swap logs it.
+    psy_timeline_update(timeline);
+}
+
+void timeline_add(void)
+{
+    int ret;
+    PsyTimeline* timeline = NULL;
+    SeeError* error = NULL;
+    size_t id = 42;
+
+    ret = psy_timeline_create(&timeline, g_win, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto timeline_add_error;
+
+    ret = psy_timeline_add_frames(timeline, -1, "a", NULL, NULL, &id, &error);
+    CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+    ret = psy_timeline_add_ms(timeline, -1.0, "a", NULL, NULL, &id, &error);
+    CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+    CU_ASSERT_EQUAL(id, 42);
+
+    ret = psy_timeline_add_frames(timeline, 3, "a", NULL, NULL, &id, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    CU_ASSERT_EQUAL(id, 0);
+
+    // 50 ms at 100 Hz is frame 5, 14 ms rounds to frame 1.
+    psy_timeline_set_frame_duration(timeline, 10 * PSY_TIME_NS_PER_MS);
+    ret = psy_timeline_add_ms(timeline, 50.0, "b", NULL, NULL, &id, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    CU_ASSERT_EQUAL(id, 1);
+    CU_ASSERT_EQUAL(psy_timeline_event(timeline, 1)->planned_frame, 5);
+    CU_ASSERT_EQUAL(psy_timeline_event(timeline, 1)->planned_time,
+                    50 * PSY_TIME_NS_PER_MS);
+    ret = psy_timeline_add_ms(timeline, 14.0, "c", NULL, NULL, &id, &error);
+    CU_ASSERT_EQUAL(psy_timeline_event(timeline, 2)->planned_frame, 1);
+
+    CU_ASSERT_EQUAL(psy_timeline_num_events(timeline), 3);
+    CU_ASSERT_STRING_EQUAL(psy_timeline_event(timeline, 0)->name, "a");
+    CU_ASSERT_EQUAL(psy_timeline_event(timeline, 0)->state, PSY_TIMELINE_PENDING);
+    CU_ASSERT_PTR_NULL(psy_timeline_event(timeline, 3));
+
+    psy_timeline_clear(timeline);
+    CU_ASSERT_EQUAL(psy_timeline_num_events(timeline), 0);
+
+timeline_add_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(timeline));
+}
+
+void timeline_run(void)
+{
+    int ret;
+    PsyTimeline* timeline = NULL;
+    SeeError* error = NULL;
+    RunOrder order;
+    const PsyTimelineEvent* event;
+
+    memset(&order, 0, sizeof(order));
+
+    ret = psy_timeline_create(&timeline, g_win, &error);
+    if (ret)
+        goto timeline_run_error;
+
+    // Added out of order, they run sorted by frame, the same frame in the
+    // order they were added.
+    psy_timeline_add_frames(timeline, 4, "d", record, &order, NULL, &error);
+    psy_timeline_add_frames(timeline, 0, "a", record, &order, NULL, &error);
+    psy_timeline_add_frames(timeline, 2, "b", record, &order, NULL, &error);
+    psy_timeline_add_frames(timeline, 2, "c", record, &order, NULL, &error);
+    CU_ASSERT_PTR_NULL(error);
+
+    run(timeline, 100);
+    CU_ASSERT_TRUE(psy_timeline_done(timeline));
+    CU_ASSERT_STRING_EQUAL(order.names, "abcd");
+    CU_ASSERT_NOT_EQUAL(psy_timeline_origin(timeline), 0);
+
+    for (size_t i = 0; i < psy_timeline_num_events(timeline); i++) {
+        event = psy_timeline_event(timeline, i);
+        CU_ASSERT_EQUAL(event->state, PSY_TIMELINE_PRESENTED);
+        // An event is never early, a dropped frame may make it late.
+        CU_ASSERT(event->achieved_frame >= event->planned_frame);
+        CU_ASSERT(event->achieved_time >= 0);
+    }
+    event = psy_timeline_event(timeline, 1);
+    CU_ASSERT_EQUAL(event->achieved_time, 0);
+
+    if (g_settings.verbose)
+        psy_timeline_print_log(timeline, stdout);
+
+    // Running it again starts over.
+    memset(&order, 0, sizeof(order));
+    run(timeline, 100);
+    CU_ASSERT_STRING_EQUAL(order.names, "abcd");
+
+timeline_run_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(timeline));
+}
+
+void timeline_late(void)
+{
+    int ret;
+    PsyTimeline* timeline = NULL;
+    SeeError* error = NULL;
+    const PsyTimelineEvent* event;
+
+    ret = psy_timeline_create(&timeline, g_win, &error);
+    if (ret)
+        goto timeline_late_error;
+
+    psy_timeline_start(timeline);
+    for (int i = 0; i < 3; i++) {
+        psy_timeline_update(timeline);
+        psy_window_swap(g_win);
+    }
+
+    // Frame 1 has passed, the event runs on the next frame and is logged
+    // as late.
+    ret = psy_timeline_add_frames(timeline, 1, "late", NULL, NULL, NULL, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    CU_ASSERT_FALSE(psy_timeline_done(timeline));
+    psy_timeline_update(timeline);
+    psy_window_swap(g_win);
+    psy_timeline_update(timeline);
+
+    CU_ASSERT_TRUE(psy_timeline_done(timeline));
+    event = psy_timeline_event(timeline, 0);
+    CU_ASSERT_EQUAL(event->achieved_frame, 3);
+    CU_ASSERT(event->achieved_time > 0);
+
+timeline_late_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(timeline));
+}
+
+void timeline_add_from_callback(void)
+{
+    int ret;
+    PsyTimeline* timeline = NULL;
+    SeeError* error = NULL;
+    RunOrder order;
+
+    memset(&order, 0, sizeof(order));
+
+    ret = psy_timeline_create(&timeline, g_win, &error);
+    if (ret)
+        goto timeline_add_from_callback_error;
+
+    psy_timeline_add_frames(timeline, 0, "a", add_and_record, &order, NULL, &error);
+    psy_timeline_add_frames(timeline, 0, "b", record, &order, NULL, &error);
+    CU_ASSERT_PTR_NULL(error);
+
+    psy_timeline_start(timeline);
+    psy_timeline_update(timeline);
+    CU_ASSERT_STRING_EQUAL(order.names, "ab");
+    CU_ASSERT_EQUAL(psy_timeline_num_events(timeline), 66);
+
+timeline_add_from_callback_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(timeline));
+}
+
+int add_timeline_suite(void)
+{
+    g_win_width     = g_settings.window_settings.width;
+    g_win_height    = g_settings.window_settings.height;
+    g_win_x         = g_settings.window_settings.x;
+    g_win_y         = g_settings.window_settings.y;
+
+    CU_pSuite suite = CU_add_suite(
+        suite_name,
+        setup,
+        teardown
+        );
+
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(
+            stderr,
+            "Unable to create suite: \"%s\": %s\n",
+            suite_name,
+            CU_get_error_msg()
+        );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, timeline_add);
+    PSY_SUITE_ADD_TEST(suite_name, timeline_run);
+    PSY_SUITE_ADD_TEST(suite_name, timeline_late);
+    PSY_SUITE_ADD_TEST(suite_name, timeline_add_from_callback);
+
+    return 0;
+}
@@ -0,0 +1,241 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <CUnit/CUnit.h>
+#include <stdio.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include "psy_test_macros.h"
+#include "../src/Trace.h"
+
+#define NUM_THREADS         2
+#define EVENTS_PER_THREAD   100
+
+static const char* suite_name = "trace";
+
+static int
+record_scopes(void* data)
+{
+    psy_trace_set_thread_name(data);
+    for (int i = 0; i < EVENTS_PER_THREAD; i++) {
+        PsyTime begin = psy_trace_begin();
+        psy_trace_end(begin, "test", "thread scope");
+    }
+    return 0;
+}
+
+static void
+trace_record(void)
+{
+    PsyTime begin;
+
+    psy_trace_free();
+    CU_ASSERT_FALSE(psy_trace_enabled());
+
+    // Stopped, nothing is recorded.
+    begin = psy_trace_begin();
+    CU_ASSERT_EQUAL(begin, 0);
+    psy_trace_end(begin, "test", "scope");
+    psy_trace_instant("test", "instant");
+    CU_ASSERT_EQUAL(psy_trace_num_events(), 0);
+
+    psy_trace_enable(1);
+    CU_ASSERT_TRUE(psy_trace_enabled());
+    begin = psy_trace_begin();
+    CU_ASSERT_NOT_EQUAL(begin, 0);
+    psy_trace_end(begin, "test", "scope");
+    psy_trace_instant("test", "instant");
+    CU_ASSERT_EQUAL(psy_trace_num_events(), 2);
+
+#if defined(PSY_TRACE)
+    {
+        PSY_TRACE_BEGIN(trace);
+        PSY_TRACE_END(trace, "test", "macro scope");
+        PSY_TRACE_INSTANT("test", "macro instant");
+    }
+    // psylib records its own scopes too.
+    psy_wait_for(PSY_TIME_NS_PER_MS);
+    CU_ASSERT_EQUAL(psy_trace_num_events(), 5);
+#endif
+
+    psy_trace_clear();
+    CU_ASSERT_EQUAL(psy_trace_num_events(), 0);
+    psy_trace_enable(0);
+}
+
+static void
+trace_threads(void)
+{
+    SDL_Thread* threads[NUM_THREADS];
+    char* names[NUM_THREADS] = {"first", "second"};
+
+    psy_trace_free();
+    psy_trace_enable(1);
+
+    for (int i = 0; i < NUM_THREADS; i++)
+        threads[i] = SDL_CreateThread(record_scopes, names[i], names[i]);
+    for (int i = 0; i < NUM_THREADS; i++) {
+        CU_ASSERT_PTR_NOT_NULL(threads[i]);
+        SDL_WaitThread(threads[i], NULL);
+    }
+
+    psy_trace_enable(0);
+    CU_ASSERT_EQUAL(psy_trace_num_events(), NUM_THREADS * EVENTS_PER_THREAD);
+    CU_ASSERT_EQUAL(psy_trace_num_overwritten(), 0);
+    psy_trace_free();
+}
+
+/* Writes the trace to json, which holds size bytes. */
+static void
+write_json(char* json, size_t size)
+{
+    SeeError* error = NULL;
+    FILE* file = tmpfile();
+    size_t n = 0;
+
+    CU_ASSERT_PTR_NOT_NULL(file);
+    if (file) {
+        CU_ASSERT_EQUAL(psy_trace_write(file, &error), SEE_SUCCESS);
+        rewind(file);
+        n = fread(json, 1, size - 1, file);
+        fclose(file);
+    }
+    json[n] = '\0';
+
+    if (error)
+        see_object_decref(SEE_OBJECT(error));
+}
+
+static void
+trace_reuse(void)
+{
+    SDL_Thread* thread;
+    char* names[NUM_THREADS] = {"first", "second"};
+    static char json[1 << 16];
+
+    psy_trace_free();
+
+    // Naming a thread while disabled doesn't create a buffer.
+    psy_trace_set_thread_name("main");
+    write_json(json, sizeof(json));
+    CU_ASSERT_PTR_NULL(strstr(json, "thread_name"));
+
+    // The second thread clears the buffer the first one left and reuses it.
+    psy_trace_enable(1);
+    for (int i = 0; i < NUM_THREADS; i++) {
+        thread = SDL_CreateThread(record_scopes, names[i], names[i]);
+        CU_ASSERT_PTR_NOT_NULL(thread);
+        SDL_WaitThread(thread, NULL);
+    }
+    psy_trace_enable(0);
+
+    CU_ASSERT_EQUAL(psy_trace_num_events(), EVENTS_PER_THREAD);
+    write_json(json, sizeof(json));
+    CU_ASSERT_PTR_NULL(strstr(json, "\"first\""));
+    CU_ASSERT_PTR_NOT_NULL(strstr(json, "\"second\""));
+    CU_ASSERT_PTR_NULL(strstr(json, "\"tid\":2"));
+
+    psy_trace_free();
+}
+
+static void
+trace_overwrite(void)
+{
+    psy_trace_free();
+
+    // 5 is rounded up to 8, the first 12 events are overwritten.
+    psy_trace_set_capacity(5);
+    psy_trace_enable(1);
+    for (int i = 0; i < 20; i++)
+        psy_trace_instant("test", "instant");
+    psy_trace_enable(0);
+
+    CU_ASSERT_EQUAL(psy_trace_num_events(), 8);
+    CU_ASSERT_EQUAL(psy_trace_num_overwritten(), 12);
+
+    psy_trace_set_capacity(PSY_TRACE_DEFAULT_CAPACITY);
+    psy_trace_free();
+}
+
+static void
+trace_write(void)
+{
+    SeeError* error = NULL;
+    char json[1024];
+    size_t size;
+    FILE* file;
+    int ret;
+
+    psy_trace_free();
+    psy_trace_set_thread_name("main");
+    psy_trace_enable(1);
+    psy_trace_end(psy_trace_begin(), "test", "a \"quoted\" name");
+    psy_trace_instant("test", "instant");
+    psy_trace_enable(0);
+
+    ret = psy_trace_write(NULL, &error);
+    CU_ASSERT_EQUAL(ret, SEE_INVALID_ARGUMENT);
+
+    file = tmpfile();
+    CU_ASSERT_PTR_NOT_NULL(file);
+    if (!file) {
+        psy_trace_free();
+        return;
+    }
+    ret = psy_trace_write(file, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    CU_ASSERT_PTR_NULL(error);
+
+    rewind(file);
+    size = fread(json, 1, sizeof(json) - 1, file);
+    json[size] = '\0';
+    fclose(file);
+
+    CU_ASSERT_EQUAL(strncmp(json, "{\"traceEvents\":[", 16), 0);
+    CU_ASSERT_PTR_NOT_NULL(strstr(json, "\"args\":{\"name\":\"main\"}"));
+    CU_ASSERT_PTR_NOT_NULL(strstr(json, "\"name\":\"a \\\"quoted\\\" name\""));
+    CU_ASSERT_PTR_NOT_NULL(strstr(json, "\"ph\":\"X\",\"ts\":0.000"));
+    CU_ASSERT_PTR_NOT_NULL(strstr(json, "\"ph\":\"i\""));
+    CU_ASSERT_PTR_NOT_NULL(strstr(json, "\"displayTimeUnit\":\"ms\"}"));
+
+    if (error)
+        see_object_decref(SEE_OBJECT(error));
+    psy_trace_free();
+}
+
+int add_trace_suite()
+{
+    CU_pSuite suite = CU_add_suite(suite_name, NULL, NULL);
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(stderr,
+                "Unable to create suite: \"%s\": %s\n",
+                suite_name,
+                CU_get_error_msg()
+               );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, trace_record);
+    PSY_SUITE_ADD_TEST(suite_name, trace_threads);
+    PSY_SUITE_ADD_TEST(suite_name, trace_reuse);
+    PSY_SUITE_ADD_TEST(suite_name, trace_overwrite);
+    PSY_SUITE_ADD_TEST(suite_name, trace_write);
+
+    return 0;
+}
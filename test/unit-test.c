@@ -48,6 +48,52 @@ int add_suites()
         return 1;
     if (add_glshader_program_suite())
         return 1;
+    if (add_shader_reload_suite())
+        return 1;
+    if (add_shape_batch_suite())
+        return 1;
+    if (add_rdk_suite())
+        return 1;
+    if (add_grating_suite())
+        return 1;
+    if (add_texture_suite())
+        return 1;
+    if (add_image_set_suite())
+        return 1;
+    if (add_video_suite())
+        return 1;
+    if (add_text_suite())
+        return 1;
+    if (add_stream_buffer_suite())
+        return 1;
+    if (add_display_list_suite())
+        return 1;
+    if (add_command_buffer_suite())
+        return 1;
+    if (add_frame_cache_suite())
+        return 1;
+    if (add_noise_suite())
+        return 1;
+    if (add_framebuffer_suite())
+        return 1;
+    if (add_post_chain_suite())
+        return 1;
+    if (add_mesh_suite())
+        return 1;
+    if (add_mesh_cache_suite())
+        return 1;
+    if (add_stereo_suite())
+        return 1;
+    if (add_time_suite())
+        return 1;
+    if (add_realtime_suite())
+        return 1;
+    if (add_timeline_suite())
+        return 1;
+    if (add_gpu_timer_suite())
+        return 1;
+    if (add_trace_suite())
+        return 1;
 
     return 0;
 }
@@ -0,0 +1,246 @@
+/*
+ * This file is part of psylib.
+ *
+ * psylib is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * psylib is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with psylib.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <CUnit/CUnit.h>
+#include "../src/Video.h"
+#include "../src/Window.h"
+#include "globals.h"
+#include "psy_test_macros.h"
+
+static PsyWindow* g_win = NULL;
+
+static int g_win_x;
+static int g_win_y;
+static int g_win_width;
+static int g_win_height;
+
+static const char* suite_name = "video";
+static const char* g_y4m_path = "psy_video_test.y4m";
+static const char* g_broken_path = "psy_video_broken.y4m";
+
+enum {
+    VIDEO_WIDTH     = 16,
+    VIDEO_HEIGHT    = 8,
+    NUM_FRAMES      = 3
+};
+
+/*
+ * Writes white frames: Y at 235 is white in limited range and U and V at
+ * 128 carry no color.
+ */
+static int
+write_y4m(const char* path, int num_frames, int truncate)
+{
+    unsigned char luma[VIDEO_WIDTH * VIDEO_HEIGHT];
+    unsigned char chroma[2 * (VIDEO_WIDTH / 2) * (VIDEO_HEIGHT / 2)];
+    FILE* file = fopen(path, "wb");
+    int i;
+
+    if (!file)
+        return -1;
+
+    memset(luma, 235, sizeof(luma));
+    memset(chroma, 128, sizeof(chroma));
+
+    fprintf(file, "YUV4MPEG2 W%d H%d F60:1 Ip A1:1 C420jpeg\n",
+            VIDEO_WIDTH, VIDEO_HEIGHT);
+    for (i = 0; i < num_frames; i++) {
+        fprintf(file, "FRAME\n");
+        fwrite(luma, 1, sizeof(luma), file);
+        fwrite(chroma, 1, truncate ? sizeof(chroma) / 2 : sizeof(chroma), file);
+    }
+    return fclose(file);
+}
+
+static int setup(void)
+{
+    SeeError*   error   = NULL;
+    PsyRect     rect    = {
+        {.x = g_win_x, .y = g_win_y},
+        {.width = g_win_width, .height = g_win_height}
+    };
+    int ret;
+
+    if (write_y4m(g_y4m_path, NUM_FRAMES, 0) != 0 ||
+        write_y4m(g_broken_path, 1, 1) != 0) {
+        fprintf(stderr, "Unable to write the test videos\n");
+        return 1;
+    }
+
+    ret = psy_window_create_rect(&g_win, rect, &error);
+    if (ret != SEE_SUCCESS) {
+        fprintf(stderr, "Unable to open window: %s\n", see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+        return 1;
+    }
+    psy_window_show(g_win);
+
+    return 0;
+}
+
+static int
+teardown(void)
+{
+    if (g_win) {
+        see_object_decref(SEE_OBJECT(g_win));
+        g_win = NULL;
+    }
+    remove(g_y4m_path);
+    remove(g_broken_path);
+    return 0;
+}
+
+void video_play(void)
+{
+    int ret, i, width, height, num, den;
+    PsyVideo* video = NULL;
+    SeeError* error = NULL;
+    GLubyte pixel[4] = {0};
+
+    ret = psy_video_create(&video, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto video_play_error;
+
+    ret = psy_video_open(video, g_y4m_path, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto video_play_error;
+
+    psy_video_size(video, &width, &height);
+    CU_ASSERT_EQUAL(width, VIDEO_WIDTH);
+    CU_ASSERT_EQUAL(height, VIDEO_HEIGHT);
+    psy_video_frame_rate(video, &num, &den);
+    CU_ASSERT_EQUAL(num, 60);
+    CU_ASSERT_EQUAL(den, 1);
+
+    ret = psy_video_preroll(video, &error);
+    if (ret)
+        goto video_play_error;
+
+    for (i = 0; i < NUM_FRAMES; i++) {
+        ret = psy_video_advance(video, &error);
+        CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+        if (ret)
+            goto video_play_error;
+    }
+    CU_ASSERT_EQUAL(psy_video_frames_shown(video), NUM_FRAMES);
+    CU_ASSERT_EQUAL(psy_video_underruns(video), 0);
+    CU_ASSERT_TRUE(psy_video_finished(video));
+
+    // Advancing past the end isn't an underrun.
+    ret = psy_video_advance(video, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    CU_ASSERT_EQUAL(psy_video_frames_shown(video), NUM_FRAMES);
+    CU_ASSERT_EQUAL(psy_video_underruns(video), 0);
+
+    glViewport(0, 0, g_win_width, g_win_height);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    ret = psy_video_draw(video, NULL, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto video_play_error;
+    CU_ASSERT_EQUAL(glGetError(), GL_NO_ERROR);
+
+    glReadPixels(
+        g_win_width / 2, g_win_height / 2, 1, 1,
+        GL_RGBA, GL_UNSIGNED_BYTE, pixel
+        );
+    CU_ASSERT(pixel[0] > 250);
+    CU_ASSERT(pixel[1] > 250);
+    CU_ASSERT(pixel[2] > 250);
+
+video_play_error:
+    CU_ASSERT_PTR_NULL(error);
+    if (error) {
+        fprintf(stderr, "%s:%s:%s", __FILE__, __func__, see_error_msg(error));
+        see_object_decref(SEE_OBJECT(error));
+    }
+    see_object_decref(SEE_OBJECT(video));
+}
+
+void video_broken(void)
+{
+    int ret;
+    PsyVideo* video = NULL;
+    SeeError* error = NULL;
+
+    ret = psy_video_create(&video, &error);
+    if (ret)
+        goto video_broken_error;
+
+    ret = psy_video_open(video, "no/such/video.y4m", &error);
+    CU_ASSERT_NOT_EQUAL(ret, SEE_SUCCESS);
+    if (error) {
+        see_object_decref(SEE_OBJECT(error));
+        error = NULL;
+    }
+
+    ret = psy_video_open(video, g_broken_path, &error);
+    CU_ASSERT_EQUAL(ret, SEE_SUCCESS);
+    if (ret)
+        goto video_broken_error;
+
+    ret = psy_video_preroll(video, &error);
+    if (ret)
+        goto video_broken_error;
+
+    ret = psy_video_advance(video, &error);
+    CU_ASSERT_NOT_EQUAL(ret, SEE_SUCCESS);
+    CU_ASSERT_PTR_NOT_NULL(error);
+    CU_ASSERT_EQUAL(psy_video_frames_shown(video), 0);
+
+video_broken_error:
+    if (error)
+        see_object_decref(SEE_OBJECT(error));
+    see_object_decref(SEE_OBJECT(video));
+}
+
+int add_video_suite(void)
+{
+    g_win_width     = g_settings.window_settings.width;
+    g_win_height    = g_settings.window_settings.height;
+    g_win_x         = g_settings.window_settings.x;
+    g_win_y         = g_settings.window_settings.y;
+
+    CU_pSuite suite = CU_add_suite(
+        suite_name,
+        setup,
+        teardown
+        );
+
+    CU_pTest test = NULL;
+
+    if (!suite) {
+        fprintf(
+            stderr,
+            "Unable to create suite: \"%s\": %s\n",
+            suite_name,
+            CU_get_error_msg()
+        );
+        return CU_get_error();
+    }
+
+    PSY_SUITE_ADD_TEST(suite_name, video_play);
+    PSY_SUITE_ADD_TEST(suite_name, video_broken);
+
+    return 0;
+}
@@ -17,7 +17,6 @@
 
 #include <CUnit/CUnit.h>
 #include <SeeObject-0.0/SeeObject.h>
-#include <SeeObject-0.0/Clock.h>
 #include <SDL2/SDL.h>
 #include <assert.h>
 
@@ -181,9 +180,7 @@ static void window_swap_synced(void)
 {
     PsyWindow* win = NULL;
     SeeError* error= NULL;
-    SeeClock* clk  = NULL;
-    SeeTimePoint*  tzero = NULL, *tnow = NULL;
-    SeeDuration* dur = NULL;
+    PsyTime tzero, tnow;
     int x = g_win_x, y = g_win_y, width = g_win_width, height = g_win_height;
     int ret, n;
     const int N_FRAMES = 60;
@@ -196,13 +193,6 @@ static void window_swap_synced(void)
         {width, height}
     };
 
-    ret = see_clock_new(&clk, &error);
-    if (ret != SEE_SUCCESS) {
-        fprintf(stderr, "Unable to create a new clock: %s\n",
-            error != 0 ? see_error_msg(error) : "Unknown");
-        goto fail;
-    }
-
     n = nth_display_for_position(r.pos, 0);
     SDL_GetCurrentDisplayMode(n, &mode);
     display_dur = 1.0/mode.refresh_rate;
@@ -260,18 +250,14 @@ static void window_swap_synced(void)
     }
     // Set the clear color to something blueish
     psy_window_set_clear_color(win, 0.3, 0.2, 0.8, 1.0);
-    ret = see_clock_time(clk, &tzero, &error);
-    assert(ret == SEE_SUCCESS);
+    tzero = psy_window_swap_time(win);
 
     for (int i = 0; i < N_FRAMES; i++) {
         psy_window_clear(win);
         psy_window_swap(win);
-        ret = see_clock_time(clk, &tnow, &error);
-        assert(ret == SEE_SUCCESS);
-        ret = see_time_point_sub(tnow, tzero, &dur, &error);
-        assert(ret == SEE_SUCCESS);
-        inter_frame_interval[i] = see_duration_seconds_f(dur);
-        see_time_point_set(tzero, tnow, &error);
+        tnow = psy_window_swap_time(win);
+        inter_frame_interval[i] = psy_time_seconds(tnow - tzero);
+        tzero = tnow;
     }
 
     int n_missed = 0;
@@ -302,13 +288,8 @@ static void window_swap_synced(void)
             );
     }
 
-fail:
     free(inter_frame_interval);
     see_object_decref(SEE_OBJECT(win));
-    see_object_decref(SEE_OBJECT(clk));
-    see_object_decref(SEE_OBJECT(tzero));
-    see_object_decref(SEE_OBJECT(tnow));
-    see_object_decref(SEE_OBJECT(dur));
 }
 
 static int rects_equal(PsyRect* r1, PsyRect* r2)